@@ -6,29 +6,6 @@
 
 namespace Nda {
 
-static NdaVariant bytesRange(const NdaVariant &source, const Nda::RuntimeType *bytesType, int64_t pos, int64_t count)
-{
-    NdaVariant ret;
-    ret.initType(bytesType);
-
-    int64_t size = source.lengthOperator();
-    if (pos < 0)
-        pos = 0;
-    if (count < 0)
-        count = 0;
-    if (pos >= size)
-        return ret;
-
-    int64_t end = pos + count;
-    if (end > size)
-        end = size;
-
-    for (int64_t i = pos; i < end; ++i)
-        ret.appendToBytes(source.readBytesAccess((int)i));
-
-    return ret;
-}
-
 static int64_t bytesIndexOf(const NdaVariant &source, const NdaVariant &needle)
 {
     for (int i = 0; i < source.lengthOperator(); ++i) {
@@ -44,7 +21,7 @@ void add_AdaBytes_symbols(NdaState *state)
     assert(state);
 
     // ------------------ Bytes.Length() ---------------------------------------------------------
-    state->bindFnc("bytes", "length", {}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("bytes", "length", {}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -56,7 +33,7 @@ void add_AdaBytes_symbols(NdaState *state)
     });
 
     // ------------------ Bytes.Append(Byte) -----------------------------------------------------
-    state->bindPrc("bytes", "append", {{"v", "byte", Nda::InMode}}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("bytes", "append", {{"v", "byte", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -67,7 +44,7 @@ void add_AdaBytes_symbols(NdaState *state)
     });
 
     // ------------------ Bytes.Append(Bytes) ----------------------------------------------------
-    state->bindPrc("bytes", "append", {{"v", "bytes", Nda::InMode}}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("bytes", "append", {{"v", "bytes", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -84,7 +61,7 @@ void add_AdaBytes_symbols(NdaState *state)
     });
 
     // ------------------ Bytes.Clear() ----------------------------------------------------------
-    state->bindPrc("bytes", "clear", {}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("bytes", "clear", {}, [](NdaState *, const Nda::FncValues& args) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -96,7 +73,7 @@ void add_AdaBytes_symbols(NdaState *state)
     });
 
     // ------------------ Bytes.Contains() -------------------------------------------------------
-    state->bindFnc("bytes", "contains", {{"v", "byte", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("bytes", "contains", {{"v", "byte", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -108,7 +85,7 @@ void add_AdaBytes_symbols(NdaState *state)
     });
 
     // ------------------ Bytes.IndexOf() --------------------------------------------------------
-    state->bindFnc("bytes", "indexOf", {{"v", "byte", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("bytes", "indexOf", {{"v", "byte", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -120,7 +97,7 @@ void add_AdaBytes_symbols(NdaState *state)
     });
 
     // ------------------ Bytes.Insert() ---------------------------------------------------------
-    state->bindPrc("bytes", "insert", {{"pos", "natural", Nda::InMode}, {"v", "byte", Nda::InMode}}, [state](const Nda::FncValues& args) -> bool {
+    state->bindPrc("bytes", "insert", {{"pos", "natural", Nda::InMode}, {"v", "byte", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -147,7 +124,7 @@ void add_AdaBytes_symbols(NdaState *state)
     });
 
     // ------------------ Bytes.Remove() ---------------------------------------------------------
-    state->bindPrc("bytes", "remove", {{"pos", "natural", Nda::InMode}, {"n", "natural", Nda::InMode}}, [state](const Nda::FncValues& args) -> bool {
+    state->bindPrc("bytes", "remove", {{"pos", "natural", Nda::InMode}, {"n", "natural", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -173,7 +150,7 @@ void add_AdaBytes_symbols(NdaState *state)
     });
 
     // ------------------ Bytes.Chop() -----------------------------------------------------------
-    state->bindPrc("bytes", "chop", {{"n", "natural", Nda::InMode}}, [state](const Nda::FncValues& args) -> bool {
+    state->bindPrc("bytes", "chop", {{"n", "natural", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -183,12 +160,12 @@ void add_AdaBytes_symbols(NdaState *state)
 
         int64_t size = self.lengthOperator();
         int64_t newSize = count >= size ? 0 : size - count;
-        auto next = bytesRange(self, state->bytesType(), 0, newSize);
+        auto next = self.midBytes(0, newSize);
         return self.assign(next);
     });
 
     // ------------------ Bytes.Chopped() --------------------------------------------------------
-    state->bindFnc("bytes", "chopped", {{"n", "natural", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("bytes", "chopped", {{"n", "natural", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -198,43 +175,43 @@ void add_AdaBytes_symbols(NdaState *state)
 
         int64_t size = self.lengthOperator();
         int64_t newSize = count >= size ? 0 : size - count;
-        ret = bytesRange(self, state->bytesType(), 0, newSize);
+        ret = self.midBytes(0, newSize);
         return true;
     });
 
     // ------------------ Bytes.Slice() ----------------------------------------------------------
-    state->bindPrc("bytes", "slice", {{"pos", "natural", Nda::InMode}, {"n", "natural", Nda::InMode}}, [state](const Nda::FncValues& args) -> bool {
+    state->bindPrc("bytes", "slice", {{"pos", "natural", Nda::InMode}, {"n", "natural", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
         if (self.type() != Nda::Bytes)
             return false;
 
-        auto next = bytesRange(self, state->bytesType(), args.at("pos").toInt64(), args.at("n").toInt64());
+        auto next = self.midBytes(args.at("pos").toInt64(), args.at("n").toInt64());
         return self.assign(next);
     });
 
     // ------------------ Bytes.Sliced() ---------------------------------------------------------
-    state->bindFnc("bytes", "sliced", {{"pos", "natural", Nda::InMode}, {"n", "natural", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("bytes", "sliced", {{"pos", "natural", Nda::InMode}, {"n", "natural", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
         if (self.type() != Nda::Bytes)
             return false;
 
-        ret = bytesRange(self, state->bytesType(), args.at("pos").toInt64(), args.at("n").toInt64());
+        ret = self.midBytes(args.at("pos").toInt64(), args.at("n").toInt64());
         return true;
     });
 
     // ------------------ Bytes.Mid() ------------------------------------------------------------
-    state->bindFnc("bytes", "mid", {{"pos", "natural", Nda::InMode}, {"n", "natural", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("bytes", "mid", {{"pos", "natural", Nda::InMode}, {"n", "natural", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
         if (self.type() != Nda::Bytes)
             return false;
 
-        ret = bytesRange(self, state->bytesType(), args.at("pos").toInt64(), args.at("n").toInt64());
+        ret = self.midBytes(args.at("pos").toInt64(), args.at("n").toInt64());
         return true;
     });
 }
@@ -16,34 +16,21 @@ struct DateParts { int year; int month; int day; };
 struct TimeParts { int hour; int minute; int second; };
 struct DateTimeParts { DateParts date; TimeParts time; };
 
-NdaVariant stringValue(NdaState *state, const std::string &value)
-{
-    NdaVariant ret;
-    ret.fromString(state->stringType(), value);
-    return ret;
-}
-
-NdaVariant keyValue(NdaState *state, const std::string &key)
-{
-    return stringValue(state, key);
-}
+// Field layout of the record types, see add_AdaDateTime_symbols()
+enum DateField     { DateYear, DateMonth, DateDay };
+enum TimeField     { TimeHour, TimeMinute, TimeSecond };
+enum DateTimeField { DateTimeYear, DateTimeMonth, DateTimeDay, DateTimeHour, DateTimeMinute, DateTimeSecond };
 
-void setMember(NdaState *state, NdaVariant &object, const std::string &key, const NdaVariant &value)
+void setField(NdaState *state, NdaVariant &object, int index, int value)
 {
-    object.appendToDict(keyValue(state, key), value);
+    object.writeFieldAccess(index).fromNatural(state->naturalType(), value);
 }
 
-std::string memberString(NdaState *state, const NdaVariant &object, const std::string &key)
+int fieldInt(const NdaVariant &object, int index)
 {
-    if (object.type() != Nda::Dict)
-        return std::string();
-
-    auto memberKey = keyValue(state, key);
-    if (!object.contains(memberKey))
-        return std::string();
-
-    auto copy = object;
-    return copy.writeDictAccess(memberKey).toString();
+    if (object.type() != Nda::Record || index >= object.recordSize())
+        return 0;
+    return static_cast<int>(object.readFieldAccess(index).toInt64());
 }
 
 std::string padInt(int value, int width)
@@ -104,27 +91,6 @@ DateParts civilFromDays(int64_t z)
     return DateParts{year, static_cast<int>(month), static_cast<int>(day)};
 }
 
-std::string isoDate(const DateParts &date)
-{
-    if (!validDate(date))
-        return std::string();
-    return padInt(date.year, 4) + "-" + padInt(date.month, 2) + "-" + padInt(date.day, 2);
-}
-
-std::string isoTime(const TimeParts &time)
-{
-    if (!validTime(time))
-        return std::string();
-    return padInt(time.hour, 2) + ":" + padInt(time.minute, 2) + ":" + padInt(time.second, 2);
-}
-
-std::string isoDateTime(const DateTimeParts &dateTime)
-{
-    if (!validDate(dateTime.date) || !validTime(dateTime.time))
-        return std::string();
-    return isoDate(dateTime.date) + "T" + isoTime(dateTime.time);
-}
-
 int readFixedInt(const std::string &text, size_t &pos, int width, bool &ok)
 {
     if (pos + static_cast<size_t>(width) > text.size()) {
@@ -237,27 +203,6 @@ std::string formatByPattern(const std::string &format, const DateParts *date, co
     return out;
 }
 
-DateParts parseIsoDate(const std::string &value)
-{
-    DateParts date{0, 0, 0};
-    parseByFormat(value, "yyyy-MM-dd", &date, nullptr);
-    return date;
-}
-
-TimeParts parseIsoTime(const std::string &value)
-{
-    TimeParts time{0, 0, 0};
-    parseByFormat(value, "HH:mm:ss", nullptr, &time);
-    return time;
-}
-
-DateTimeParts parseIsoDateTime(const std::string &value)
-{
-    DateTimeParts dateTime{{0, 0, 0}, {0, 0, 0}};
-    parseByFormat(value, "yyyy-MM-ddTHH:mm:ss", &dateTime.date, &dateTime.time);
-    return dateTime;
-}
-
 DateParts addDays(DateParts date, int64_t days)
 {
     if (!validDate(date))
@@ -305,34 +250,50 @@ DateTimeParts currentDateTime()
 void setDateReturn(NdaState *state, NdaVariant &ret, const DateParts &date)
 {
     ret.initType(state->typeByName("date"));
-    setMember(state, ret, "value", stringValue(state, isoDate(date)));
+    if (!validDate(date))
+        return;
+    setField(state, ret, DateYear,  date.year);
+    setField(state, ret, DateMonth, date.month);
+    setField(state, ret, DateDay,   date.day);
 }
 
 void setTimeReturn(NdaState *state, NdaVariant &ret, const TimeParts &time)
 {
     ret.initType(state->typeByName("time"));
-    setMember(state, ret, "value", stringValue(state, isoTime(time)));
+    if (!validTime(time))
+        return;
+    setField(state, ret, TimeHour,   time.hour);
+    setField(state, ret, TimeMinute, time.minute);
+    setField(state, ret, TimeSecond, time.second);
 }
 
 void setDateTimeReturn(NdaState *state, NdaVariant &ret, const DateTimeParts &dateTime)
 {
     ret.initType(state->typeByName("datetime"));
-    setMember(state, ret, "value", stringValue(state, isoDateTime(dateTime)));
+    if (!validDate(dateTime.date) || !validTime(dateTime.time))
+        return;
+    setField(state, ret, DateTimeYear,   dateTime.date.year);
+    setField(state, ret, DateTimeMonth,  dateTime.date.month);
+    setField(state, ret, DateTimeDay,    dateTime.date.day);
+    setField(state, ret, DateTimeHour,   dateTime.time.hour);
+    setField(state, ret, DateTimeMinute, dateTime.time.minute);
+    setField(state, ret, DateTimeSecond, dateTime.time.second);
 }
 
-DateParts dateFromObject(NdaState *state, const NdaVariant &object)
+DateParts dateFromObject(NdaState *, const NdaVariant &object)
 {
-    return parseIsoDate(memberString(state, object, "value"));
+    return DateParts{fieldInt(object, DateYear), fieldInt(object, DateMonth), fieldInt(object, DateDay)};
 }
 
-TimeParts timeFromObject(NdaState *state, const NdaVariant &object)
+TimeParts timeFromObject(NdaState *, const NdaVariant &object)
 {
-    return parseIsoTime(memberString(state, object, "value"));
+    return TimeParts{fieldInt(object, TimeHour), fieldInt(object, TimeMinute), fieldInt(object, TimeSecond)};
 }
 
-DateTimeParts dateTimeFromObject(NdaState *state, const NdaVariant &object)
+DateTimeParts dateTimeFromObject(NdaState *, const NdaVariant &object)
 {
-    return parseIsoDateTime(memberString(state, object, "value"));
+    return DateTimeParts{{fieldInt(object, DateTimeYear), fieldInt(object, DateTimeMonth), fieldInt(object, DateTimeDay)},
+                         {fieldInt(object, DateTimeHour), fieldInt(object, DateTimeMinute), fieldInt(object, DateTimeSecond)}};
 }
 
 int64_t secondsFromTime(const TimeParts &time)
@@ -373,31 +334,32 @@ void add_AdaDateTime_symbols(NdaState *state)
 {
     assert(state);
 
-    state->registerType("Date", "dict");
-    state->registerType("Time", "dict");
-    state->registerType("DateTime", "dict");
+    state->registerRecord("Date",     {{"Year", "natural"}, {"Month", "natural"}, {"Day", "natural"}});
+    state->registerRecord("Time",     {{"Hour", "natural"}, {"Minute", "natural"}, {"Second", "natural"}});
+    state->registerRecord("DateTime", {{"Year", "natural"}, {"Month", "natural"}, {"Day", "natural"},
+                                       {"Hour", "natural"}, {"Minute", "natural"}, {"Second", "natural"}});
 
-    state->bindFnc("date", "now", {}, [state](const Nda::FncValues&, NdaVariant &ret) -> bool {
+    state->bindFnc("date", "now", {}, [](NdaState *state, const Nda::FncValues&, NdaVariant &ret) -> bool {
         setDateReturn(state, ret, currentDate());
         return true;
     });
-    state->bindFnc("date", "today", {}, [state](const Nda::FncValues&, NdaVariant &ret) -> bool {
+    state->bindFnc("date", "today", {}, [](NdaState *state, const Nda::FncValues&, NdaVariant &ret) -> bool {
         setDateReturn(state, ret, currentDate());
         return true;
     });
-    state->bindFnc("date", "fromString", {{"text", "string", Nda::InMode}, {"format", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("date", "fromString", {{"text", "string", Nda::InMode}, {"format", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         DateParts date{0, 0, 0};
         parseByFormat(stringArg(args, "text"), stringArg(args, "format"), &date, nullptr);
         setDateReturn(state, ret, date);
         return true;
     });
-    state->bindFnc("date", "toString", {{"format", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("date", "toString", {{"format", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         DateParts date = dateFromObject(state, args.at("this"));
         ret.fromString(state->stringType(), formatByPattern(stringArg(args, "format"), &date, nullptr));
         return true;
     });
-    state->bindFnc("date", "addDays", {{"days", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("date", "addDays", {{"days", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         bool ok;
         int64_t days = intArg(args, "days", ok);
@@ -407,23 +369,23 @@ void add_AdaDateTime_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("time", "now", {}, [state](const Nda::FncValues&, NdaVariant &ret) -> bool {
+    state->bindFnc("time", "now", {}, [](NdaState *state, const Nda::FncValues&, NdaVariant &ret) -> bool {
         setTimeReturn(state, ret, currentTime());
         return true;
     });
-    state->bindFnc("time", "fromString", {{"text", "string", Nda::InMode}, {"format", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("time", "fromString", {{"text", "string", Nda::InMode}, {"format", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         TimeParts time{0, 0, 0};
         parseByFormat(stringArg(args, "text"), stringArg(args, "format"), nullptr, &time);
         setTimeReturn(state, ret, time);
         return true;
     });
-    state->bindFnc("time", "toString", {{"format", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("time", "toString", {{"format", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         TimeParts time = timeFromObject(state, args.at("this"));
         ret.fromString(state->stringType(), formatByPattern(stringArg(args, "format"), nullptr, &time));
         return true;
     });
-    state->bindFnc("time", "addSecs", {{"secs", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("time", "addSecs", {{"secs", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         bool ok;
         int64_t secs = intArg(args, "secs", ok);
@@ -433,23 +395,23 @@ void add_AdaDateTime_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("datetime", "now", {}, [state](const Nda::FncValues&, NdaVariant &ret) -> bool {
+    state->bindFnc("datetime", "now", {}, [](NdaState *state, const Nda::FncValues&, NdaVariant &ret) -> bool {
         setDateTimeReturn(state, ret, currentDateTime());
         return true;
     });
-    state->bindFnc("datetime", "fromString", {{"text", "string", Nda::InMode}, {"format", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("datetime", "fromString", {{"text", "string", Nda::InMode}, {"format", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         DateTimeParts dateTime{{0, 0, 0}, {0, 0, 0}};
         parseByFormat(stringArg(args, "text"), stringArg(args, "format"), &dateTime.date, &dateTime.time);
         setDateTimeReturn(state, ret, dateTime);
         return true;
     });
-    state->bindFnc("datetime", "toString", {{"format", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("datetime", "toString", {{"format", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         DateTimeParts dateTime = dateTimeFromObject(state, args.at("this"));
         ret.fromString(state->stringType(), formatByPattern(stringArg(args, "format"), &dateTime.date, &dateTime.time));
         return true;
     });
-    state->bindFnc("datetime", "addDays", {{"days", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("datetime", "addDays", {{"days", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         bool ok;
         int64_t days = intArg(args, "days", ok);
@@ -460,7 +422,7 @@ void add_AdaDateTime_symbols(NdaState *state)
         setDateTimeReturn(state, ret, dateTime);
         return true;
     });
-    state->bindFnc("datetime", "addSecs", {{"secs", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("datetime", "addSecs", {{"secs", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         bool ok;
         int64_t secs = intArg(args, "secs", ok);
@@ -474,7 +436,7 @@ void add_AdaDateTime_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("datetime", "secsTo", {{"other", "datetime", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("datetime", "secsTo", {{"other", "datetime", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         DateTimeParts self = dateTimeFromObject(state, args.at("this"));
         DateTimeParts other = dateTimeFromObject(state, args.at("other"));
@@ -484,7 +446,7 @@ void add_AdaDateTime_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("datetime", "setDate", {{"year", "natural", Nda::InMode}, {"month", "natural", Nda::InMode}, {"day", "natural", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("datetime", "setDate", {{"year", "natural", Nda::InMode}, {"month", "natural", Nda::InMode}, {"day", "natural", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         bool okYear;
         bool okMonth;
@@ -500,7 +462,7 @@ void add_AdaDateTime_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("datetime", "setDate", {{"date", "date", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("datetime", "setDate", {{"date", "date", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         DateParts date = dateFromObject(state, args.at("date"));
         if (!validDate(date))
@@ -513,7 +475,7 @@ void add_AdaDateTime_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("datetime", "setTime", {{"hour", "natural", Nda::InMode}, {"minute", "natural", Nda::InMode}, {"second", "natural", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("datetime", "setTime", {{"hour", "natural", Nda::InMode}, {"minute", "natural", Nda::InMode}, {"second", "natural", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         bool okHour;
         bool okMinute;
@@ -529,7 +491,7 @@ void add_AdaDateTime_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("datetime", "setTime", {{"time", "time", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("datetime", "setTime", {{"time", "time", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
         TimeParts time = timeFromObject(state, args.at("time"));
         if (!validTime(time))
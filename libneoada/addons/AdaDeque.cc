@@ -0,0 +1,122 @@
+#include "AdaDeque.h"
+#include "../state.h"
+#include <cassert>
+
+#define CHECK_INSTANCE_CALL if (args.find("this") == args.end()) return false
+
+namespace Nda {
+
+void add_AdaDeque_symbols(NdaState *state)
+{
+    assert(state);
+
+    // ------------------ Deque.Length() --------------------------------------------------------
+    state->bindFnc("deque","length",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::Deque)
+            return false;
+
+        ret.fromNatural(state->typeByName("natural"),self.dequeSize());
+        return true;
+    });
+
+    // ------------------ Deque.IsEmpty() -------------------------------------------------------
+    state->bindFnc("deque","isEmpty",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::Deque)
+            return false;
+
+        ret.fromBool(state->typeByName("boolean"),self.dequeSize() == 0);
+        return true;
+    });
+
+    // ------------------ Deque.Clear() ---------------------------------------------------------
+    state->bindPrc("deque","clear",{}, [](NdaState *, const Nda::FncValues& args) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::Deque)
+            return false;
+
+        self.clearDeque();
+        return true;
+    });
+
+    // ------------------ Deque.PushFront() / PushBack() ----------------------------------------
+    for (bool front : {true, false}) {
+        state->bindPrc("deque",front ? "pushFront" : "pushBack",{{"v", "any", Nda::InMode}}, [front](NdaState *, const Nda::FncValues& args) -> bool {
+
+            CHECK_INSTANCE_CALL;
+
+            auto self    = args.at("this");
+            auto element = args.at("v");
+
+            if (self.type() != Nda::Deque)
+                return false;
+
+            self.pushToDeque(element, front);
+            return true;
+        });
+    }
+
+    // ------------------ Deque.PopFront() / PopBack() ------------------------------------------
+    for (bool front : {true, false}) {
+        state->bindFnc("deque",front ? "popFront" : "popBack",{}, [front](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+            CHECK_INSTANCE_CALL;
+
+            auto self = args.at("this");
+            if (self.type() != Nda::Deque)
+                return false;
+
+            if (!self.popFromDeque(ret, front)) {
+                state->raiseException("constrainterror");
+                return false;
+            }
+            return true;
+        });
+    }
+
+    // ------------------ Deque.Front() / Back() ------------------------------------------------
+    for (bool front : {true, false}) {
+        state->bindFnc("deque",front ? "front" : "back",{}, [front](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+            CHECK_INSTANCE_CALL;
+
+            auto self = args.at("this");
+            if (self.type() != Nda::Deque)
+                return false;
+
+            if (!self.peekDeque(ret, front)) {
+                state->raiseException("constrainterror");
+                return false;
+            }
+            return true;
+        });
+    }
+
+    // ------------------ Deque.ToList() --------------------------------------------------------
+    state->bindFnc("deque","toList",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::Deque)
+            return false;
+
+        ret.reset();
+        ret.initType(state->listType());
+        for (const auto &element : self.dequeItems())
+            ret.appendToList(element);
+        return true;
+    });
+}
+
+}
@@ -0,0 +1,12 @@
+#ifndef NEOADA_ADDON_ADADEQUE_H
+#define NEOADA_ADDON_ADADEQUE_H
+
+class NdaState;
+
+namespace Nda {
+
+void add_AdaDeque_symbols(NdaState *state);
+
+}
+
+#endif // ADADEQUE_H
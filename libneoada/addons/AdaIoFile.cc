@@ -15,6 +15,9 @@ struct FileHandle {
     std::fstream stream;
 };
 
+// Field layout of the record types, see add_AdaIoFile_symbols()
+enum FileField { FileHandleField, FilePathField, FileModeField, FileClosedField, TextFileEncodingField };
+
 std::unordered_map<int64_t, std::unique_ptr<FileHandle>>& fileHandles()
 {
     static std::unordered_map<int64_t, std::unique_ptr<FileHandle>> handles;
@@ -78,41 +81,26 @@ NdaVariant boolValue(NdaState *state, bool value)
     return ret;
 }
 
-NdaVariant fileKey(NdaState *state, const std::string &key)
+int64_t fileIdFromSelf(const NdaVariant &self)
 {
-    return stringValue(state, key);
-}
-
-int64_t fileIdFromSelf(NdaState *state, const NdaVariant &self)
-{
-    if (self.type() != Nda::Dict)
-        return 0;
-
-    auto key = fileKey(state, "__handle");
-    if (!self.contains(key))
+    if (self.type() != Nda::Record || FileHandleField >= self.recordSize())
         return 0;
 
     bool ok;
-    auto id = const_cast<NdaVariant&>(self).writeDictAccess(key).toInt64(&ok);
+    auto id = self.readFieldAccess(FileHandleField).toInt64(&ok);
     return ok ? id : 0;
 }
 
-void setFileMember(NdaState *state, NdaVariant &file, const std::string &key, const NdaVariant &value)
-{
-    file.appendToDict(fileKey(state, key), value);
-}
-
-void setFileReturn(NdaState *state, NdaVariant &ret, const std::string &runtimeType, const std::string &displayType,
+void setFileReturn(NdaState *state, NdaVariant &ret, const std::string &runtimeType,
                    int64_t id, const std::string &path, const std::string &mode, const std::string &encoding = "")
 {
     ret.initType(state->typeByName(runtimeType));
-    setFileMember(state, ret, "__handle", naturalValue(state, id));
-    setFileMember(state, ret, "__type", stringValue(state, displayType));
-    setFileMember(state, ret, "path", stringValue(state, path));
-    setFileMember(state, ret, "mode", stringValue(state, mode));
+    ret.writeFieldAccess(FileHandleField) = naturalValue(state, id);
+    ret.writeFieldAccess(FilePathField)   = stringValue(state, path);
+    ret.writeFieldAccess(FileModeField)   = stringValue(state, mode);
+    ret.writeFieldAccess(FileClosedField) = boolValue(state, id == 0);
     if (!encoding.empty())
-        setFileMember(state, ret, "encoding", stringValue(state, encoding));
-    setFileMember(state, ret, "closed", boolValue(state, id == 0));
+        ret.writeFieldAccess(TextFileEncodingField) = stringValue(state, encoding);
 }
 
 bool fileExists(const std::string &path)
@@ -124,7 +112,7 @@ bool fileExists(const std::string &path)
 bool closeFile(NdaState *state, const Nda::FncValues& args)
 {
     CHECK_INSTANCE_CALL;
-    auto id = fileIdFromSelf(state, args.at("this"));
+    auto id = fileIdFromSelf(args.at("this"));
     auto &handles = fileHandles();
     auto it = handles.find(id);
     if (it == handles.end())
@@ -134,15 +122,15 @@ bool closeFile(NdaState *state, const Nda::FncValues& args)
     handles.erase(it);
 
     auto self = args.at("this");
-    setFileMember(state, self, "__handle", naturalValue(state, 0));
-    setFileMember(state, self, "closed", boolValue(state, true));
+    self.writeFieldAccess(FileHandleField) = naturalValue(state, 0);
+    self.writeFieldAccess(FileClosedField) = boolValue(state, true);
     return true;
 }
 
-bool flushFile(NdaState *state, const Nda::FncValues& args)
+bool flushFile(NdaState *, const Nda::FncValues& args)
 {
     CHECK_INSTANCE_CALL;
-    auto *handle = handleById(fileIdFromSelf(state, args.at("this")));
+    auto *handle = handleById(fileIdFromSelf(args.at("this")));
     if (!handle)
         return false;
     handle->stream.flush();
@@ -152,7 +140,7 @@ bool flushFile(NdaState *state, const Nda::FncValues& args)
 bool eofFile(NdaState *state, const Nda::FncValues& args, NdaVariant &ret)
 {
     CHECK_INSTANCE_CALL;
-    auto *handle = handleById(fileIdFromSelf(state, args.at("this")));
+    auto *handle = handleById(fileIdFromSelf(args.at("this")));
     ret.fromBool(state->booleanType(), !handle || handle->stream.eof());
     return true;
 }
@@ -160,7 +148,7 @@ bool eofFile(NdaState *state, const Nda::FncValues& args, NdaVariant &ret)
 bool isOpenFile(NdaState *state, const Nda::FncValues& args, NdaVariant &ret)
 {
     CHECK_INSTANCE_CALL;
-    auto id = fileIdFromSelf(state, args.at("this"));
+    auto id = fileIdFromSelf(args.at("this"));
     ret.fromBool(state->booleanType(), handleById(id) != nullptr);
     return true;
 }
@@ -204,19 +192,19 @@ std::string readAllText(std::fstream &stream)
 
 void bindCommonFileMethods(NdaState *state, const std::string &typeName)
 {
-    state->bindFnc(typeName, "isOpen", {}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc(typeName, "isOpen", {}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         return isOpenFile(state, args, ret);
     });
 
-    state->bindPrc(typeName, "close", {}, [state](const Nda::FncValues& args) -> bool {
+    state->bindPrc(typeName, "close", {}, [](NdaState *state, const Nda::FncValues& args) -> bool {
         return closeFile(state, args);
     });
 
-    state->bindPrc(typeName, "flush", {}, [state](const Nda::FncValues& args) -> bool {
+    state->bindPrc(typeName, "flush", {}, [](NdaState *state, const Nda::FncValues& args) -> bool {
         return flushFile(state, args);
     });
 
-    state->bindFnc(typeName, "eof", {}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc(typeName, "eof", {}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         return eofFile(state, args, ret);
     });
 }
@@ -228,7 +216,7 @@ namespace Nda {
 bool adaIoReadAllTextFile(NdaState *state, const NdaVariant &file, std::string &text)
 {
     assert(state);
-    auto *handle = handleById(fileIdFromSelf(state, file));
+    auto *handle = handleById(fileIdFromSelf(file));
     if (!handle)
         return false;
 
@@ -239,7 +227,7 @@ bool adaIoReadAllTextFile(NdaState *state, const NdaVariant &file, std::string &
 bool adaIoWriteTextFile(NdaState *state, const NdaVariant &file, const std::string &text)
 {
     assert(state);
-    auto *handle = handleById(fileIdFromSelf(state, file));
+    auto *handle = handleById(fileIdFromSelf(file));
     if (!handle)
         return false;
 
@@ -251,43 +239,44 @@ void add_AdaIoFile_symbols(NdaState *state)
 {
     assert(state);
 
-    state->registerType("File", "dict");
-    state->registerType("TextFile", "dict");
+    state->registerRecord("File",     {{"Handle", "natural"}, {"Path", "string"}, {"Mode", "string"}, {"Closed", "boolean"}});
+    state->registerRecord("TextFile", {{"Handle", "natural"}, {"Path", "string"}, {"Mode", "string"}, {"Closed", "boolean"},
+                                       {"Encoding", "string"}});
 
     // ------------------ File:Open(path) ---------------------------------------------------------
-    state->bindFnc("file", "open", {{"path", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("file", "open", {{"path", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         auto path = args.at("path").toString();
         auto id = openFile(path, std::ios::in | std::ios::out | std::ios::binary);
-        setFileReturn(state, ret, "file", "File", id, path, "readwrite");
+        setFileReturn(state, ret, "file", id, path, "readwrite");
         return id != 0;
     });
 
     // ------------------ File:OpenRead(path) -----------------------------------------------------
-    state->bindFnc("file", "openRead", {{"path", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("file", "openRead", {{"path", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         auto path = args.at("path").toString();
         auto id = openFile(path, std::ios::in | std::ios::binary);
-        setFileReturn(state, ret, "file", "File", id, path, "read");
+        setFileReturn(state, ret, "file", id, path, "read");
         return id != 0;
     });
 
     // ------------------ File:Create(path) -------------------------------------------------------
-    state->bindFnc("file", "create", {{"path", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("file", "create", {{"path", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         auto path = args.at("path").toString();
         auto id = openFile(path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
-        setFileReturn(state, ret, "file", "File", id, path, "create");
+        setFileReturn(state, ret, "file", id, path, "create");
         return id != 0;
     });
 
     // ------------------ File:Append(path) -------------------------------------------------------
-    state->bindFnc("file", "append", {{"path", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("file", "append", {{"path", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         auto path = args.at("path").toString();
         auto id = openFile(path, std::ios::in | std::ios::out | std::ios::app | std::ios::binary);
-        setFileReturn(state, ret, "file", "File", id, path, "append");
+        setFileReturn(state, ret, "file", id, path, "append");
         return id != 0;
     });
 
     // ------------------ File:Exists(path) -------------------------------------------------------
-    state->bindFnc("file", "exists", {{"path", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("file", "exists", {{"path", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         ret.fromBool(state->booleanType(), fileExists(args.at("path").toString()));
         return true;
     });
@@ -295,9 +284,9 @@ void add_AdaIoFile_symbols(NdaState *state)
     bindCommonFileMethods(state, "file");
 
     // ------------------ File.Write(data) --------------------------------------------------------
-    state->bindPrc("file", "write", {{"data", "bytes", Nda::InMode}}, [state](const Nda::FncValues& args) -> bool {
+    state->bindPrc("file", "write", {{"data", "bytes", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
         CHECK_INSTANCE_CALL;
-        auto *handle = handleById(fileIdFromSelf(state, args.at("this")));
+        auto *handle = handleById(fileIdFromSelf(args.at("this")));
         auto data = args.at("data");
         if (!handle || data.type() != Nda::Bytes)
             return false;
@@ -313,9 +302,9 @@ void add_AdaIoFile_symbols(NdaState *state)
     });
 
     // ------------------ File.ReadAll() ----------------------------------------------------------
-    state->bindFnc("file", "readAll", {}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("file", "readAll", {}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
-        auto *handle = handleById(fileIdFromSelf(state, args.at("this")));
+        auto *handle = handleById(fileIdFromSelf(args.at("this")));
         if (!handle)
             return false;
 
@@ -324,9 +313,9 @@ void add_AdaIoFile_symbols(NdaState *state)
     });
 
     // ------------------ File.ReadAll() ----------------------------------------------------------
-    state->bindFnc("file", "read", {{"blockSize", "natural", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("file", "read", {{"blockSize", "natural", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
-        auto *handle = handleById(fileIdFromSelf(state, args.at("this")));
+        auto *handle = handleById(fileIdFromSelf(args.at("this")));
         auto blockSize = args.at("blockSize");
         if (!handle || blockSize.type() != Nda::Natural)
             return false;
@@ -336,39 +325,39 @@ void add_AdaIoFile_symbols(NdaState *state)
     });
 
     // ------------------ TextFile:Open(path) -----------------------------------------------------
-    state->bindFnc("textfile", "open", {{"path", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("textfile", "open", {{"path", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         auto path = args.at("path").toString();
         auto id = openFile(path, std::ios::in | std::ios::out);
-        setFileReturn(state, ret, "textfile", "TextFile", id, path, "readwrite", "utf-8");
+        setFileReturn(state, ret, "textfile", id, path, "readwrite", "utf-8");
         return id != 0;
     });
 
     // ------------------ TextFile:OpenRead(path) -------------------------------------------------
-    state->bindFnc("textfile", "openRead", {{"path", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("textfile", "openRead", {{"path", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         auto path = args.at("path").toString();
         auto id = openFile(path, std::ios::in);
-        setFileReturn(state, ret, "textfile", "TextFile", id, path, "read", "utf-8");
+        setFileReturn(state, ret, "textfile", id, path, "read", "utf-8");
         return id != 0;
     });
 
     // ------------------ TextFile:Create(path) ---------------------------------------------------
-    state->bindFnc("textfile", "create", {{"path", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("textfile", "create", {{"path", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         auto path = args.at("path").toString();
         auto id = openFile(path, std::ios::in | std::ios::out | std::ios::trunc);
-        setFileReturn(state, ret, "textfile", "TextFile", id, path, "create", "utf-8");
+        setFileReturn(state, ret, "textfile", id, path, "create", "utf-8");
         return id != 0;
     });
 
     // ------------------ TextFile:Append(path) ---------------------------------------------------
-    state->bindFnc("textfile", "append", {{"path", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("textfile", "append", {{"path", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         auto path = args.at("path").toString();
         auto id = openFile(path, std::ios::in | std::ios::out | std::ios::app);
-        setFileReturn(state, ret, "textfile", "TextFile", id, path, "append", "utf-8");
+        setFileReturn(state, ret, "textfile", id, path, "append", "utf-8");
         return id != 0;
     });
 
     // ------------------ TextFile:Exists(path) ---------------------------------------------------
-    state->bindFnc("textfile", "exists", {{"path", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("textfile", "exists", {{"path", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         ret.fromBool(state->booleanType(), fileExists(args.at("path").toString()));
         return true;
     });
@@ -376,9 +365,9 @@ void add_AdaIoFile_symbols(NdaState *state)
     bindCommonFileMethods(state, "textfile");
 
     // ------------------ TextFile.Write(s) -------------------------------------------------------
-    state->bindPrc("textfile", "write", {{"s", "string", Nda::InMode}}, [state](const Nda::FncValues& args) -> bool {
+    state->bindPrc("textfile", "write", {{"s", "string", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
         CHECK_INSTANCE_CALL;
-        auto *handle = handleById(fileIdFromSelf(state, args.at("this")));
+        auto *handle = handleById(fileIdFromSelf(args.at("this")));
         if (!handle)
             return false;
         handle->stream << args.at("s").toString();
@@ -386,9 +375,9 @@ void add_AdaIoFile_symbols(NdaState *state)
     });
 
     // ------------------ TextFile.WriteLine(s) ---------------------------------------------------
-    state->bindPrc("textfile", "writeLine", {{"s", "string", Nda::InMode}}, [state](const Nda::FncValues& args) -> bool {
+    state->bindPrc("textfile", "writeLine", {{"s", "string", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
         CHECK_INSTANCE_CALL;
-        auto *handle = handleById(fileIdFromSelf(state, args.at("this")));
+        auto *handle = handleById(fileIdFromSelf(args.at("this")));
         if (!handle)
             return false;
         handle->stream << args.at("s").toString() << '\n';
@@ -396,9 +385,9 @@ void add_AdaIoFile_symbols(NdaState *state)
     });
 
     // ------------------ TextFile.ReadAll() ------------------------------------------------------
-    state->bindFnc("textfile", "readAll", {}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("textfile", "readAll", {}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
-        auto *handle = handleById(fileIdFromSelf(state, args.at("this")));
+        auto *handle = handleById(fileIdFromSelf(args.at("this")));
         if (!handle)
             return false;
 
@@ -407,9 +396,9 @@ void add_AdaIoFile_symbols(NdaState *state)
     });
 
     // ------------------ TextFile.ReadLine() -----------------------------------------------------
-    state->bindFnc("textfile", "readLine", {}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("textfile", "readLine", {}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         CHECK_INSTANCE_CALL;
-        auto *handle = handleById(fileIdFromSelf(state, args.at("this")));
+        auto *handle = handleById(fileIdFromSelf(args.at("this")));
         if (!handle)
             return false;
 
@@ -1,11 +1,11 @@
 #include "AdaJson.h"
 #include "AdaIoFile.h"
 #include "../state.h"
+#include "../private/numberformat.h"
 
 #include <cassert>
 #include <cctype>
 #include <cmath>
-#include <iomanip>
 #include <locale>
 #include <sstream>
 #include <string>
@@ -92,13 +92,11 @@ std::string serializeJson(const NdaVariant &value)
         const double number = value.toDouble();
         if (!std::isfinite(number))
             return "null";
-        std::ostringstream out;
-        out.imbue(std::locale::classic());
-        out << std::setprecision(17) << number;
-        return out.str();
+        return NdaNumberFormat::formatDouble(number);
     }
     case Nda::Natural:
     case Nda::Supernatural:
+    case Nda::BigNatural:
     case Nda::Byte:
         return value.toString();
     case Nda::List: {
@@ -114,17 +112,58 @@ std::string serializeJson(const NdaVariant &value)
     case Nda::Dict: {
         std::string ret = "{";
         bool first = true;
-        for (const auto &item : value.dictItems()) {
+        value.forEachDictItem([&](const NdaVariant &key, const NdaVariant &item) -> bool {
             if (!first)
                 ret += ",";
             first = false;
-            ret += escapeJsonString(item.first.toString());
+            ret += escapeJsonString(key.toString());
             ret += ":";
-            ret += serializeJson(item.second);
+            ret += serializeJson(item);
+            return true;
+        });
+        ret += "}";
+        return ret;
+    }
+    case Nda::Record: {
+        // an object of the fields, in declaration order
+        const auto &fields = value.runtimeType()->fields;
+        std::string ret = "{";
+        for (int i = 0; i < value.recordSize(); ++i) {
+            if (i > 0)
+                ret += ",";
+            ret += escapeJsonString(fields[i].name.displayValue);
+            ret += ":";
+            ret += serializeJson(value.readFieldAccess(i));
         }
         ret += "}";
         return ret;
     }
+    case Nda::Array: {
+        const auto *arrayType = value.runtimeType();
+        std::string ret = "[";
+        for (int64_t i = arrayType->first; i <= arrayType->last; ++i) {
+            if (i > arrayType->first)
+                ret += ",";
+            ret += serializeJson(value.readArrayElement(i));
+        }
+        ret += "]";
+        return ret;
+    }
+    case Nda::Set:
+    case Nda::Deque:
+    case Nda::PriorityQueue: {
+        const auto items = value.type() == Nda::Set   ? value.setItems()
+                         : value.type() == Nda::Deque ? value.dequeItems()
+                                                      : value.queueItems();
+        std::string ret = "[";
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (i > 0)
+                ret += ",";
+            ret += serializeJson(items[i]);
+        }
+        ret += "]";
+        return ret;
+    }
     case Nda::Reference: {
         NdaVariant copy = value;
         copy.dereference();
@@ -363,22 +402,22 @@ private:
                 ++mPos;
         }
 
-        const std::string literal = mText.substr(start, mPos - start);
-        std::istringstream in(literal);
-        in.imbue(std::locale::classic());
         if (floating) {
             double value = 0.0;
-            in >> value;
-            if (!in || !in.eof())
+            if (!NdaNumberFormat::parseDouble(mText.data() + start, mText.data() + mPos, value))
                 return false;
             ret = numberValue(mState, value);
-        } else {
-            int64_t value = 0;
-            in >> value;
-            if (!in || !in.eof())
-                return false;
-            ret = naturalValue(mState, value);
+            return true;
         }
+
+        const std::string literal = mText.substr(start, mPos - start);
+        std::istringstream in(literal);
+        in.imbue(std::locale::classic());
+        int64_t value = 0;
+        in >> value;
+        if (!in || !in.eof())
+            return false;
+        ret = naturalValue(mState, value);
         return true;
     }
 
@@ -403,7 +442,7 @@ void add_AdaJson_symbols(NdaState *state)
 
     state->registerType("Json", "dict");
 
-    auto stringify = [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    auto stringify = [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         ret.fromString(state->stringType(), serializeJson(args.at("value")));
         return true;
     };
@@ -411,21 +450,21 @@ void add_AdaJson_symbols(NdaState *state)
     state->bindFnc("json", "stringify", {{"value", "any", Nda::InMode}}, stringify);
     state->bindFnc("json", "toString", {{"value", "any", Nda::InMode}}, stringify);
 
-    auto parse = [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    auto parse = [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         return parseJson(state, args.at("text").toString(), ret);
     };
 
     state->bindFnc("json", "parse", {{"text", "string", Nda::InMode}}, parse);
     state->bindFnc("json", "fromString", {{"text", "string", Nda::InMode}}, parse);
 
-    state->bindFnc("json", "read", {{"file", "textfile", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("json", "read", {{"file", "textfile", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         std::string text;
         if (!adaIoReadAllTextFile(state, args.at("file"), text))
             return false;
         return parseJson(state, text, ret);
     });
 
-    state->bindPrc("json", "write", {{"file", "textfile", Nda::InMode}, {"value", "any", Nda::InMode}}, [state](const Nda::FncValues& args) -> bool {
+    state->bindPrc("json", "write", {{"file", "textfile", Nda::InMode}, {"value", "any", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args) -> bool {
         return adaIoWriteTextFile(state, args.at("file"), serializeJson(args.at("value")));
     });
 }
@@ -12,7 +12,7 @@ void add_AdaList_symbols(NdaState *state)
 
     // ------------------ List:Version() ---------------------------------------------------------
     /*
-    state->bind("list","version",{}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bind("list","version",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -26,7 +26,7 @@ void add_AdaList_symbols(NdaState *state)
     */
 
     // ------------------ List.Length() ---------------------------------------------------------
-    state->bindFnc("list","length",{}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("list","length",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -39,7 +39,7 @@ void add_AdaList_symbols(NdaState *state)
     });
 
     // ------------------ List.Clear() ---------------------------------------------------------
-    state->bindPrc("list","clear",{}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("list","clear",{}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -52,7 +52,7 @@ void add_AdaList_symbols(NdaState *state)
     });
 
     // ------------------ List.Append() ---------------------------------------------------------
-    state->bindPrc("list","append",{{"v", "any", Nda::InMode}}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("list","append",{{"v", "any", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -67,7 +67,7 @@ void add_AdaList_symbols(NdaState *state)
     });
 
     // ------------------ List.Insert() ---------------------------------------------------------
-    state->bindPrc("list","insert",{{"p", "Number", Nda::InMode}, {"v", "any", Nda::InMode}}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("list","insert",{{"p", "Number", Nda::InMode}, {"v", "any", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -83,7 +83,7 @@ void add_AdaList_symbols(NdaState *state)
     });
 
     // ------------------ List.RemoveAt() -------------------------------------------------------
-    state->bindPrc("list", "removeAt", {{"pos", "natural", Nda::InMode}}, [state](const Nda::FncValues &args) -> bool {
+    state->bindPrc("list", "removeAt", {{"pos", "natural", Nda::InMode}}, [](NdaState *state, const Nda::FncValues &args) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -102,7 +102,7 @@ void add_AdaList_symbols(NdaState *state)
     });
 
     // ------------------ List.RemoveFirst() ----------------------------------------------------
-    state->bindPrc("list", "removeFirst", {}, [state](const Nda::FncValues &args) -> bool {
+    state->bindPrc("list", "removeFirst", {}, [](NdaState *state, const Nda::FncValues &args) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -118,7 +118,7 @@ void add_AdaList_symbols(NdaState *state)
     });
 
     // ------------------ List.RemoveLast() -----------------------------------------------------
-    state->bindPrc("list", "removeLast", {}, [state](const Nda::FncValues &args) -> bool {
+    state->bindPrc("list", "removeLast", {}, [](NdaState *state, const Nda::FncValues &args) -> bool {
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
@@ -134,7 +134,7 @@ void add_AdaList_symbols(NdaState *state)
     });
 
     // ------------------ List.Concat() ---------------------------------------------------------
-    state->bindPrc("list","concat",{{"v", "any", Nda::InMode}}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("list","concat",{{"v", "any", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -156,7 +156,7 @@ void add_AdaList_symbols(NdaState *state)
     });
 
     // ------------------ List.Contains() ---------------------------------------------------------
-    state->bindFnc("list","contains",{{"v", "any", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("list","contains",{{"v", "any", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -171,7 +171,7 @@ void add_AdaList_symbols(NdaState *state)
     });
 
     // ------------------ List.IndexOf() ---------------------------------------------------------
-    state->bindFnc("list","indexOf",{{"v", "any", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("list","indexOf",{{"v", "any", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -186,7 +186,7 @@ void add_AdaList_symbols(NdaState *state)
     });
 
     // ------------------ List.Flip() ---------------------------------------------------------
-    state->bindPrc("list","flip",{}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("list","flip",{}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -201,7 +201,7 @@ void add_AdaList_symbols(NdaState *state)
     });
 
     // ------------------ List.Flipped() ---------------------------------------------------------
-    state->bindFnc("list","flipped",{}, [](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("list","flipped",{}, [](NdaState *, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -210,9 +210,7 @@ void add_AdaList_symbols(NdaState *state)
         if (self.type() != Nda::List)
             return false;
 
-        ret.initType(self.runtimeType());
-        ret.assign(self);
-        ret.reverseList();
+        ret = self.flippedList();
 
         return true;
     });
@@ -29,7 +29,7 @@ using BinaryMath = double (*)(double, double);
 
 void bindUnary(NdaState *state, const std::string &name, UnaryMath fn)
 {
-    state->bindFnc("math", name, {{"x", "number", Nda::InMode}}, [state, fn](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("math", name, {{"x", "number", Nda::InMode}}, [fn](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         double x;
         if (!argNumber(args, "x", x))
             return false;
@@ -41,7 +41,7 @@ void bindUnary(NdaState *state, const std::string &name, UnaryMath fn)
 
 void bindBinary(NdaState *state, const std::string &name, BinaryMath fn)
 {
-    state->bindFnc("math", name, {{"x", "number", Nda::InMode}, {"y", "number", Nda::InMode}}, [state, fn](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("math", name, {{"x", "number", Nda::InMode}, {"y", "number", Nda::InMode}}, [fn](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         double x;
         double y;
         if (!argNumber(args, "x", x) || !argNumber(args, "y", y))
@@ -62,27 +62,27 @@ void add_AdaMath_symbols(NdaState *state)
 
     state->registerType("Math", "dict");
 
-    state->bindFnc("math", "pi", {}, [state](const Nda::FncValues&, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "pi", {}, [](NdaState *state, const Nda::FncValues&, NdaVariant &ret) -> bool {
         retNumber(state, ret, std::acos(-1.0));
         return true;
     });
 
-    state->bindFnc("math", "e", {}, [state](const Nda::FncValues&, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "e", {}, [](NdaState *state, const Nda::FncValues&, NdaVariant &ret) -> bool {
         retNumber(state, ret, std::exp(1.0));
         return true;
     });
 
-    state->bindFnc("math", "tau", {}, [state](const Nda::FncValues&, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "tau", {}, [](NdaState *state, const Nda::FncValues&, NdaVariant &ret) -> bool {
         retNumber(state, ret, 2.0 * std::acos(-1.0));
         return true;
     });
 
-    state->bindFnc("math", "infinity", {}, [state](const Nda::FncValues&, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "infinity", {}, [](NdaState *state, const Nda::FncValues&, NdaVariant &ret) -> bool {
         retNumber(state, ret, std::numeric_limits<double>::infinity());
         return true;
     });
 
-    state->bindFnc("math", "nan", {}, [state](const Nda::FncValues&, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "nan", {}, [](NdaState *state, const Nda::FncValues&, NdaVariant &ret) -> bool {
         ret.fromDoubleNan(state->numberType());
         return true;
     });
@@ -118,7 +118,7 @@ void add_AdaMath_symbols(NdaState *state)
     bindUnary(state, "cosh", std::cosh);
     bindUnary(state, "tanh", std::tanh);
 
-    state->bindFnc("math", "min", {{"x", "number", Nda::InMode}, {"y", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "min", {{"x", "number", Nda::InMode}, {"y", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         double x;
         double y;
         if (!argNumber(args, "x", x) || !argNumber(args, "y", y))
@@ -128,7 +128,7 @@ void add_AdaMath_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("math", "max", {{"x", "number", Nda::InMode}, {"y", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "max", {{"x", "number", Nda::InMode}, {"y", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         double x;
         double y;
         if (!argNumber(args, "x", x) || !argNumber(args, "y", y))
@@ -138,7 +138,7 @@ void add_AdaMath_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("math", "clamp", {{"x", "number", Nda::InMode}, {"lo", "number", Nda::InMode}, {"hi", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "clamp", {{"x", "number", Nda::InMode}, {"lo", "number", Nda::InMode}, {"hi", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         double x;
         double lo;
         double hi;
@@ -155,7 +155,7 @@ void add_AdaMath_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("math", "sign", {{"x", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "sign", {{"x", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         double x;
         if (!argNumber(args, "x", x))
             return false;
@@ -164,7 +164,7 @@ void add_AdaMath_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("math", "radians", {{"degrees", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "radians", {{"degrees", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         double degrees;
         if (!argNumber(args, "degrees", degrees))
             return false;
@@ -173,7 +173,7 @@ void add_AdaMath_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("math", "degrees", {{"radians", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "degrees", {{"radians", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         double radians;
         if (!argNumber(args, "radians", radians))
             return false;
@@ -182,7 +182,7 @@ void add_AdaMath_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("math", "isNan", {{"x", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "isNan", {{"x", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         double x;
         if (!argNumber(args, "x", x))
             return false;
@@ -191,7 +191,7 @@ void add_AdaMath_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("math", "isFinite", {{"x", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "isFinite", {{"x", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         double x;
         if (!argNumber(args, "x", x))
             return false;
@@ -200,7 +200,7 @@ void add_AdaMath_symbols(NdaState *state)
         return true;
     });
 
-    state->bindFnc("math", "isInf", {{"x", "number", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("math", "isInf", {{"x", "number", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         double x;
         if (!argNumber(args, "x", x))
             return false;
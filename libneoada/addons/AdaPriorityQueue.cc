@@ -0,0 +1,132 @@
+#include "AdaPriorityQueue.h"
+#include "../state.h"
+#include <cassert>
+
+#define CHECK_INSTANCE_CALL if (args.find("this") == args.end()) return false
+
+namespace Nda {
+
+void add_AdaPriorityQueue_symbols(NdaState *state)
+{
+    assert(state);
+
+    // ------------------ PriorityQueue.Length() ------------------------------------------------
+    state->bindFnc("priorityqueue","length",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::PriorityQueue)
+            return false;
+
+        ret.fromNatural(state->typeByName("natural"),self.queueSize());
+        return true;
+    });
+
+    // ------------------ PriorityQueue.IsEmpty() -----------------------------------------------
+    state->bindFnc("priorityqueue","isEmpty",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::PriorityQueue)
+            return false;
+
+        ret.fromBool(state->typeByName("boolean"),self.queueSize() == 0);
+        return true;
+    });
+
+    // ------------------ PriorityQueue.Clear() -------------------------------------------------
+    state->bindPrc("priorityqueue","clear",{}, [](NdaState *, const Nda::FncValues& args) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::PriorityQueue)
+            return false;
+
+        self.clearQueue();
+        return true;
+    });
+
+    // ------------------ PriorityQueue.Push(v) -------------------------------------------------
+    state->bindPrc("priorityqueue","push",{{"v", "any", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self    = args.at("this");
+        auto element = args.at("v");
+
+        if (self.type() != Nda::PriorityQueue)
+            return false;
+
+        self.pushToQueue(element, element); // the value is its own key
+        return true;
+    });
+
+    // ------------------ PriorityQueue.Push(v, priority) ---------------------------------------
+    state->bindPrc("priorityqueue","push",{{"v", "any", Nda::InMode}, {"priority", "any", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self     = args.at("this");
+        auto element  = args.at("v");
+        auto priority = args.at("priority");
+
+        if (self.type() != Nda::PriorityQueue)
+            return false;
+
+        self.pushToQueue(element, priority);
+        return true;
+    });
+
+    // ------------------ PriorityQueue.Pop() ---------------------------------------------------
+    state->bindFnc("priorityqueue","pop",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::PriorityQueue)
+            return false;
+
+        if (!self.popFromQueue(ret)) {
+            state->raiseException("constrainterror");
+            return false;
+        }
+        return true;
+    });
+
+    // ------------------ PriorityQueue.Peek() --------------------------------------------------
+    state->bindFnc("priorityqueue","peek",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::PriorityQueue)
+            return false;
+
+        if (!self.peekQueue(ret)) {
+            state->raiseException("constrainterror");
+            return false;
+        }
+        return true;
+    });
+
+    // ------------------ PriorityQueue.ToList() ------------------------------------------------
+    state->bindFnc("priorityqueue","toList",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::PriorityQueue)
+            return false;
+
+        ret.reset();
+        ret.initType(state->listType());
+        for (const auto &element : self.queueItems()) // in pop order
+            ret.appendToList(element);
+        return true;
+    });
+}
+
+}
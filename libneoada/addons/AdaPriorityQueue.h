@@ -0,0 +1,12 @@
+#ifndef NEOADA_ADDON_ADAPRIORITYQUEUE_H
+#define NEOADA_ADDON_ADAPRIORITYQUEUE_H
+
+class NdaState;
+
+namespace Nda {
+
+void add_AdaPriorityQueue_symbols(NdaState *state);
+
+}
+
+#endif // ADAPRIORITYQUEUE_H
@@ -41,7 +41,7 @@ void add_AdaRegexp_symbols(NdaState *state)
 
     state->registerType("Regexp", "dict");
 
-    state->bindFnc("regexp", "match", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("regexp", "match", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         try {
             retBool(state, ret, std::regex_match(args.at("text").toString(), makeRegex(args.at("pattern").toString())));
             return true;
@@ -50,7 +50,7 @@ void add_AdaRegexp_symbols(NdaState *state)
         }
     });
 
-    state->bindFnc("regexp", "contains", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("regexp", "contains", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         try {
             retBool(state, ret, std::regex_search(args.at("text").toString(), makeRegex(args.at("pattern").toString())));
             return true;
@@ -59,7 +59,7 @@ void add_AdaRegexp_symbols(NdaState *state)
         }
     });
 
-    state->bindFnc("regexp", "firstMatch", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("regexp", "firstMatch", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         try {
             const std::string text = args.at("text").toString();
             std::smatch match;
@@ -73,7 +73,7 @@ void add_AdaRegexp_symbols(NdaState *state)
         }
     });
 
-    state->bindFnc("regexp", "captures", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("regexp", "captures", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         try {
             ret = listValue(state);
             const std::string text = args.at("text").toString();
@@ -88,7 +88,7 @@ void add_AdaRegexp_symbols(NdaState *state)
         }
     });
 
-    state->bindFnc("regexp", "replace", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}, {"replacement", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("regexp", "replace", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}, {"replacement", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         try {
             ret.fromString(state->stringType(), std::regex_replace(args.at("text").toString(), makeRegex(args.at("pattern").toString()), args.at("replacement").toString()));
             return true;
@@ -97,7 +97,7 @@ void add_AdaRegexp_symbols(NdaState *state)
         }
     });
 
-    state->bindFnc("regexp", "split", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("regexp", "split", {{"text", "string", Nda::InMode}, {"pattern", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         try {
             ret = listValue(state);
             const std::string text = args.at("text").toString();
@@ -0,0 +1,152 @@
+#include "AdaSet.h"
+#include "../state.h"
+#include <cassert>
+
+#define CHECK_INSTANCE_CALL if (args.find("this") == args.end()) return false
+
+namespace Nda {
+
+void add_AdaSet_symbols(NdaState *state)
+{
+    assert(state);
+
+    // ------------------ Set.Length() ----------------------------------------------------------
+    state->bindFnc("set","length",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::Set)
+            return false;
+
+        ret.fromNatural(state->typeByName("natural"),self.setSize());
+        return true;
+    });
+
+    // ------------------ Set.Clear() -----------------------------------------------------------
+    state->bindPrc("set","clear",{}, [](NdaState *, const Nda::FncValues& args) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::Set)
+            return false;
+
+        self.clearSet();
+        return true;
+    });
+
+    // ------------------ Set.Add() -------------------------------------------------------------
+    state->bindPrc("set","add",{{"v", "any", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self    = args.at("this");
+        auto element = args.at("v");
+
+        if (self.type() != Nda::Set)
+            return false;
+
+        if (!self.insertIntoSet(element)) { // lists, dicts, records... have no stable hash
+            state->raiseException("constrainterror");
+            return false;
+        }
+        return true;
+    });
+
+    // ------------------ Set.Remove() ----------------------------------------------------------
+    state->bindPrc("set","remove",{{"v", "any", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self    = args.at("this");
+        auto element = args.at("v");
+
+        if (self.type() != Nda::Set)
+            return false;
+
+        self.removeFromSet(element); // removing a missing element is not an error
+        return true;
+    });
+
+    // ------------------ Set.Contains() --------------------------------------------------------
+    state->bindFnc("set","contains",{{"v", "any", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self    = args.at("this");
+        auto element = args.at("v");
+
+        if (self.type() != Nda::Set)
+            return false;
+
+        ret.fromBool(state->typeByName("boolean"),self.containsInSet(element));
+        return true;
+    });
+
+    // ------------------ Set.Union() -----------------------------------------------------------
+    state->bindFnc("set","union",{{"other", "any", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self  = args.at("this");
+        auto other = args.at("other");
+
+        if (self.type() != Nda::Set)
+            return false;
+
+        bool done;
+        ret = self.setUnion(other, &done);
+        return done;
+    });
+
+    // ------------------ Set.Intersection() ----------------------------------------------------
+    state->bindFnc("set","intersection",{{"other", "any", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self  = args.at("this");
+        auto other = args.at("other");
+
+        if (self.type() != Nda::Set)
+            return false;
+
+        bool done;
+        ret = self.setIntersection(other, &done);
+        return done;
+    });
+
+    // ------------------ Set.Difference() ------------------------------------------------------
+    state->bindFnc("set","difference",{{"other", "any", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self  = args.at("this");
+        auto other = args.at("other");
+
+        if (self.type() != Nda::Set)
+            return false;
+
+        bool done;
+        ret = self.setDifference(other, &done);
+        return done;
+    });
+
+    // ------------------ Set.ToList() ----------------------------------------------------------
+    state->bindFnc("set","toList",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::Set)
+            return false;
+
+        ret.reset();
+        ret.initType(state->listType());
+        for (const auto &element : self.setItems()) // sorted
+            ret.appendToList(element);
+        return true;
+    });
+}
+
+}
@@ -0,0 +1,12 @@
+#ifndef NEOADA_ADDON_ADASET_H
+#define NEOADA_ADDON_ADASET_H
+
+class NdaState;
+
+namespace Nda {
+
+void add_AdaSet_symbols(NdaState *state);
+
+}
+
+#endif // ADASET_H
@@ -1,12 +1,12 @@
 #include "AdaString.h"
 #include "AdaTextEncoding.h"
 #include "../state.h"
+#include "../private/numberformat.h"
 #include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cctype>
 #include <cstdlib>
-#include <iostream>
 #include <iomanip>
 #include <locale>
 #include <sstream>
@@ -45,14 +45,7 @@ std::string lowerAscii(std::string s)
 
 bool parseNumber(const std::string &text, double &value)
 {
-    const std::string s = trimmed(text);
-    if (s.empty())
-        return false;
-
-    char *end = nullptr;
-    errno = 0;
-    value = std::strtod(s.c_str(), &end);
-    return true; // errno == 0 && end && *end == '\0';
+    return NdaNumberFormat::parseDouble(trimmed(text), value);
 }
 
 bool parseNatural(const std::string &text, int64_t &value)
@@ -195,7 +188,7 @@ void add_AdaString_symbols(NdaState *state)
     assert(state);
 
     // ------------------ String.Format() ---------------------------------------------------------
-    state->bindFnc("string", "format", {{"value", "any", Nda::InMode}, {"format", "string", Nda::InMode}}, [state](const Nda::FncValues &args, NdaVariant &ret) -> bool {
+    state->bindFnc("string", "format", {{"value", "any", Nda::InMode}, {"format", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues &args, NdaVariant &ret) -> bool {
         std::string formatted;
         if (!formatValue(args.at("value"), args.at("format").toString(), formatted)) {
             state->raiseException("constrainterror");
@@ -207,7 +200,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.Length() ---------------------------------------------------------
-    state->bindFnc("string","length",{}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","length",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -220,7 +213,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.Append() ---------------------------------------------------------
-    state->bindPrc("string","append",{{"s", "any", Nda::InMode}}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("string","append",{{"s", "any", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -230,13 +223,11 @@ void add_AdaString_symbols(NdaState *state)
         if (self.type() != Nda::String)
             return false;
 
-        bool done;
-        self.assign(self.concat(element,&done));
-        return done;
+        return self.appendToString(element);
     });
 
     // ------------------ String.ToUpper() ---------------------------------------------------------
-    state->bindFnc("string","toUpper",{}, [](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","toUpper",{}, [](NdaState *, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -252,7 +243,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.ToLower() ---------------------------------------------------------
-    state->bindFnc("string","toLower",{}, [](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","toLower",{}, [](NdaState *, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -268,7 +259,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.Upper() ---------------------------------------------------------
-    state->bindPrc("string","upper",{}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("string","upper",{}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -284,7 +275,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.Upper() ---------------------------------------------------------
-    state->bindPrc("string","lower",{}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("string","lower",{}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -300,7 +291,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.Contains() ---------------------------------------------------------
-    state->bindFnc("string","contains",{{"s", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","contains",{{"s", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -315,7 +306,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.IndexOf() ---------------------------------------------------------
-    state->bindFnc("string","indexOf",{{"s", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","indexOf",{{"s", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -332,7 +323,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.Upper() ---------------------------------------------------------
-    state->bindPrc("string","insert",{{"i", "natural", Nda::InMode},{"s", "string", Nda::InMode}}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("string","insert",{{"i", "natural", Nda::InMode},{"s", "string", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -348,7 +339,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.Trim() ---------------------------------------------------------
-    state->bindPrc("string","trim",{}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("string","trim",{}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -364,7 +355,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.Trimmed() ---------------------------------------------------------
-    state->bindFnc("string","trimmed",{}, [](const Nda::FncValues& args,  NdaVariant &ret) -> bool {
+    state->bindFnc("string","trimmed",{}, [](NdaState *, const Nda::FncValues& args,  NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -381,7 +372,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.Chop() ---------------------------------------------------------
-    state->bindPrc("string","chop",{{"i", "natural", Nda::InMode}}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("string","chop",{{"i", "natural", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -399,7 +390,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.Chopped() ---------------------------------------------------------
-    state->bindFnc("string","chopped",{{"i", "natural", Nda::InMode}}, [](const Nda::FncValues& args,  NdaVariant &ret) -> bool {
+    state->bindFnc("string","chopped",{{"i", "natural", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args,  NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -409,15 +400,14 @@ void add_AdaString_symbols(NdaState *state)
         if (self.type() != Nda::String)
             return false;
 
-        std::string s = self.toString();
-        s = count >= s.length() ? "" : s.substr(0,s.length()-count);
-        ret.fromString(self.runtimeType(),s);
+        int64_t length = self.lengthOperator();
+        ret = self.midString(0, count >= length ? 0 : length - count);
 
         return true;
     });
 
     // ------------------ String.Slice() ---------------------------------------------------------
-    state->bindPrc("string","slice",{{"pos", "natural", Nda::InMode},{"n", "natural", Nda::InMode}}, [](const Nda::FncValues& args) -> bool {
+    state->bindPrc("string","slice",{{"pos", "natural", Nda::InMode},{"n", "natural", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -436,7 +426,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.Sliced() ---------------------------------------------------------
-    state->bindFnc("string","sliced",{{"pos", "natural", Nda::InMode},{"n", "natural", Nda::InMode}}, [](const Nda::FncValues& args,  NdaVariant &ret) -> bool {
+    state->bindFnc("string","sliced",{{"pos", "natural", Nda::InMode},{"n", "natural", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args,  NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -447,15 +437,13 @@ void add_AdaString_symbols(NdaState *state)
         if (self.type() != Nda::String)
             return false;
 
-        std::string s = self.toString();
-        s = pos >= s.length() ? "" : s.substr(pos,count);
-        ret.fromString(self.runtimeType(),s);
+        ret = self.midString(pos, count);
 
         return true;
     });
 
     // ------------------ String.FromBytes() ---------------------------------------------------------
-    state->bindFnc("string","fromBytes",{{"data", "bytes", Nda::InMode},{"encoding", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","fromBytes",{{"data", "bytes", Nda::InMode},{"encoding", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         std::string text;
         if (!decodeTextBytes(args.at("data"), args.at("encoding").toString(), text))
@@ -467,18 +455,15 @@ void add_AdaString_symbols(NdaState *state)
 
 
     // ------------------ String.ToNumber() ---------------------------------------------------------
-    state->bindFnc("string","toNumber",{}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","toNumber",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
         auto self = args.at("this");
-        std::cout << "TO NUMBER1 " << self.runtimeType()->name.lowerValue << std::endl;
         if (self.type() != Nda::String)
             return false;
 
         double value = 0.0;
-
-        std::cout << "TO NUMBER2 " << self.toString() << " " << parseNumber(self.toString(), value) << std::endl;
         if (!parseNumber(self.toString(), value))
             return false;
 
@@ -487,7 +472,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.ToNatural() ---------------------------------------------------------
-    state->bindFnc("string","toNatural",{}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","toNatural",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -504,7 +489,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.ToBool() ---------------------------------------------------------
-    state->bindFnc("string","toBool",{}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","toBool",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -521,7 +506,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.IsNumber() ---------------------------------------------------------
-    state->bindFnc("string","isNumber",{}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","isNumber",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -535,7 +520,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.IsNatural() ---------------------------------------------------------
-    state->bindFnc("string","isNatural",{}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","isNatural",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -549,7 +534,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.IsBool() ---------------------------------------------------------
-    state->bindFnc("string","isBool",{}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","isBool",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -563,7 +548,7 @@ void add_AdaString_symbols(NdaState *state)
     });
 
     // ------------------ String.ToBytes() ---------------------------------------------------------
-    state->bindFnc("string","toBytes",{{"encoding", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("string","toBytes",{{"encoding", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
 
         CHECK_INSTANCE_CALL;
 
@@ -573,6 +558,66 @@ void add_AdaString_symbols(NdaState *state)
 
         return encodeTextBytes(state, self.toString(), args.at("encoding").toString(), ret);
     });
+
+    /*
+        StringBuilder: a String, but "append" never creates a new string while the builder
+        isn't shared -> building large strings is amortized O(1) per append.
+
+            declare sb : StringBuilder;
+            sb.append("Hello");
+            declare s : String := sb.toString();
+    */
+    state->registerType("StringBuilder", "string");
+
+    // ------------------ StringBuilder.Append() --------------------------------------------------
+    state->bindPrc("stringbuilder","append",{{"s", "any", Nda::InMode}}, [](NdaState *, const Nda::FncValues& args) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::String)
+            return false;
+
+        return self.appendToString(args.at("s"));
+    });
+
+    // ------------------ StringBuilder.Length() --------------------------------------------------
+    state->bindFnc("stringbuilder","length",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::String)
+            return false;
+
+        ret.fromNatural(state->naturalType(),self.lengthOperator());
+        return true;
+    });
+
+    // ------------------ StringBuilder.Clear() ---------------------------------------------------
+    state->bindPrc("stringbuilder","clear",{}, [](NdaState *, const Nda::FncValues& args) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::String)
+            return false;
+
+        return self.setString("");
+    });
+
+    // ------------------ StringBuilder.ToString() ------------------------------------------------
+    state->bindFnc("stringbuilder","toString",{}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
+
+        CHECK_INSTANCE_CALL;
+
+        auto self = args.at("this");
+        if (self.type() != Nda::String)
+            return false;
+
+        ret.fromString(state->stringType(), self.toString());
+        return true;
+    });
 }
 
 }
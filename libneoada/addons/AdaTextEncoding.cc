@@ -321,11 +321,11 @@ void add_AdaTextEncoding_symbols(NdaState *state)
 {
     state->registerType("Encoding", "dict");
 
-    state->bindFnc("encoding", "encode", {{"text", "string", Nda::InMode}, {"encoding", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("encoding", "encode", {{"text", "string", Nda::InMode}, {"encoding", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         return encodeTextBytes(state, args.at("text").toString(), args.at("encoding").toString(), ret);
     });
 
-    state->bindFnc("encoding", "decode", {{"data", "bytes", Nda::InMode}, {"encoding", "string", Nda::InMode}}, [state](const Nda::FncValues& args, NdaVariant &ret) -> bool {
+    state->bindFnc("encoding", "decode", {{"data", "bytes", Nda::InMode}, {"encoding", "string", Nda::InMode}}, [](NdaState *state, const Nda::FncValues& args, NdaVariant &ret) -> bool {
         std::string text;
         if (!decodeTextBytes(args.at("data"), args.at("encoding").toString(), text))
             return false;
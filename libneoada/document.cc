@@ -0,0 +1,257 @@
+#include <assert.h>
+
+#include "document.h"
+#include "exception.h"
+#include "interpreter.h"
+#include "lexer.h"
+#include "state.h"
+
+namespace {
+
+// garbage of replaced statements (ASTs, Runnables) is dropped, when it exceeds the live part
+const size_t MinGarbage = 64 * 1024;
+
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaDocument::NdaDocument()
+    : mReparsed(0)
+    , mAstMemory(0)
+    , mLiveAstMemory(0)
+    , mInterpreter(new NdaInterpreter(nullptr))
+    , mProgram(nullptr)
+    , mPrepareAll(true)
+    , mLiveArenaMemory(0)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaDocument::~NdaDocument()
+{
+    for (auto *interpreter : mRetired)
+        delete interpreter;
+    delete mInterpreter;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaDocument::update(const std::string &text)
+{
+    mReparsed = 0;
+    if (text == mText)
+        return;
+
+    if (mStatements.empty() || mAstMemory > 2 * mLiveAstMemory + MinGarbage) {
+        parseAll(text);
+        return;
+    }
+
+    // changed range: previous text [prefix, oldSize - suffix), new text [prefix, newSize - suffix)
+    const size_t oldSize = mText.size();
+    const size_t newSize = text.size();
+    size_t prefix = 0;
+    while (prefix < oldSize && prefix < newSize && mText[prefix] == text[prefix])
+        prefix++;
+    size_t suffix = 0;
+    while (suffix < oldSize - prefix && suffix < newSize - prefix && mText[oldSize - 1 - suffix] == text[newSize - 1 - suffix])
+        suffix++;
+
+    // statements touched by the change: [first, last)
+    const size_t count = mStatements.size();
+    size_t first = 0;
+    while (first < count && mStatements[first].end.offset <= prefix)
+        first++;
+    size_t last = first;
+    while (last < count && offsetOf(last) < oldSize - suffix)
+        last++;
+
+    try {
+        // the range has to end behind a ";" again, otherwise it takes in the next statement
+        while (!parseRange(text, first, last)) {
+            assert(last < count);
+            last++;
+        }
+    } catch (NdaException &) {
+        parseAll(text); // the piece alone may be wrong (e.g. a deleted ";"): errors of the whole text
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaDocument::parseAll(const std::string &text)
+{
+    NdaLexer  lexer;
+    NdaParser parser(lexer);
+    std::vector<NdaParser::StatementEnd> ends;
+
+    SharedAST ast = std::make_shared<NdaParser::AST>(parser.parse(text.data(), text.size(), 1, 1, ends));
+
+    std::vector<Statement> statements;
+    append(statements, ast, ends, 0);
+
+    mStatements.swap(statements);
+    mText          = text;
+    mReparsed      = (int)mStatements.size();
+    mAstMemory     = ast->memoryUsage();
+    mLiveAstMemory = mAstMemory;
+    mProgram       = nullptr;
+    mPrepareAll    = true; // the previous Runnables are garbage
+}
+
+//-------------------------------------------------------------------------------------------------
+// false: the new statements don't end where the range ends
+bool NdaDocument::parseRange(const std::string &text, size_t first, size_t last)
+{
+    const size_t count = mStatements.size();
+    const size_t begin = offsetOf(first);
+    const size_t end   = text.size() - (last < count ? mText.size() - offsetOf(last) : 0);
+    assert(begin <= end);
+
+    NdaLexer  lexer;
+    NdaParser parser(lexer);
+    std::vector<NdaParser::StatementEnd> ends;
+
+    const Position from = beginOf(first);
+    SharedAST ast = std::make_shared<NdaParser::AST>(parser.parse(text.data() + begin, end - begin, from.line, from.column, ends));
+
+    if (last < count && (ends.empty() ? end != begin : ends.back().offset != end - begin))
+        return false;
+
+    std::vector<Statement> statements;
+    append(statements, ast, ends, begin);
+
+    // the statements behind the range keep their text, but not their place
+    const Position oldEnd = beginOf(last);
+    const Position newEnd = ends.empty() ? from : Position{ends.back().line, ends.back().column};
+    const bool     moved  = oldEnd.line != newEnd.line || oldEnd.column != newEnd.column;
+    for (size_t i = last; i < count; i++) {
+        Statement &statement = mStatements[i];
+        statement.end.offset = statement.end.offset - mText.size() + text.size();
+        if (!moved)
+            continue;
+        move(statement.end.line, statement.end.column, oldEnd, newEnd);
+        move(statement.node, oldEnd, newEnd);
+        if (statement.runnable)
+            move(statement.runnable, oldEnd, newEnd);
+    }
+
+    if (first != last || !statements.empty())
+        mProgram = nullptr;
+    mStatements.erase(mStatements.begin() + first, mStatements.begin() + last);
+    mStatements.insert(mStatements.begin() + first, statements.begin(), statements.end());
+
+    mText       = text;
+    mReparsed   = (int)statements.size();
+    mAstMemory += ast->memoryUsage();
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaDocument::append(std::vector<Statement> &statements, SharedAST ast,
+                         const std::vector<NdaParser::StatementEnd> &ends, size_t base)
+{
+    const NdaParser::ASTNodeList &nodes = ast->root()->children;
+    assert(nodes.size() == ends.size());
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        NdaParser::StatementEnd end = ends[i];
+        end.offset += base;
+        statements.push_back(Statement{end, nodes[i], ast, nullptr});
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaDocument::Position NdaDocument::beginOf(size_t index) const
+{
+    if (index == 0)
+        return Position{1, 1};
+    return Position{mStatements[index-1].end.line, mStatements[index-1].end.column};
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t NdaDocument::offsetOf(size_t index) const
+{
+    return index == 0 ? 0 : mStatements[index-1].end.offset;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaDocument::execute(NdaState *state)
+{
+    assert(state);
+
+    // Runnables of another state (atoms) or too much garbage in the arena: all statements again
+    const size_t arenaMemory = mInterpreter->mArena.memoryUsage();
+    if (mPrepareAll || mInterpreter->state() != state || arenaMemory > 2 * mLiveArenaMemory + MinGarbage) {
+        retire();
+        mInterpreter->beginProgram(state);
+        for (auto &statement : mStatements)
+            statement.runnable = nullptr;
+        mProgram    = nullptr;
+        mPrepareAll = false;
+    } else {
+        mInterpreter->restoreCaches(); // before new literals are cached next to the released ones
+    }
+
+    if (!mProgram) {
+        const bool prepareAll = mInterpreter->mRunnable == nullptr;
+
+        std::vector<Nda::Runnable*> runnables;
+        runnables.reserve(mStatements.size());
+        for (auto &statement : mStatements) {
+            if (!statement.runnable) {
+                Nda::Runnable *runnable = mInterpreter->createRunnable(statement.node);
+                mInterpreter->prepare(statement.node, runnable);
+                statement.runnable = runnable;
+            }
+            runnables.push_back(statement.runnable);
+        }
+        mProgram = mInterpreter->compose(runnables);
+
+        if (prepareAll)
+            mLiveArenaMemory = mInterpreter->mArena.memoryUsage();
+    }
+
+    return mInterpreter->execute(mProgram);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaDocument::retire()
+{
+    // the ones of destroyed states and the ones with all subprograms replaced are garbage
+    for (size_t i = 0; i < mRetired.size(); ) {
+        if (mRetired[i]->boundSubprograms() || mRetired[i]->running()) {
+            i++;
+            continue;
+        }
+        delete mRetired[i];
+        mRetired.erase(mRetired.begin() + i);
+    }
+
+    if (mInterpreter->state() && mInterpreter->boundSubprograms()) {
+        mRetired.push_back(mInterpreter);
+        mInterpreter = new NdaInterpreter(nullptr);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaDocument::move(NdaParser::ASTNodePtr node, const Position &from, const Position &to)
+{
+    move(node->line, node->column, from, to);
+    for (const auto &child : node->children)
+        move(child, from, to);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaDocument::move(Nda::Runnable *node, const Position &from, const Position &to)
+{
+    move(node->line, node->column, from, to);
+    for (int i = 0; i < node->childrenCount; i++)
+        move(node->children[i], from, to);
+}
+
+//-------------------------------------------------------------------------------------------------
+// positions behind the end of a changed range: lines shift, the columns just on its last line
+void NdaDocument::move(int &line, int &column, const Position &from, const Position &to)
+{
+    if (line == from.line)
+        column += to.column - from.column;
+    line += to.line - from.line;
+}
@@ -0,0 +1,86 @@
+#ifndef LIB_NEOADA_DOCUMENT_H
+#define LIB_NEOADA_DOCUMENT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parser.h"
+#include "variant.h"
+
+class NdaState;
+class NdaInterpreter;
+namespace Nda { struct Runnable; }
+
+/*
+    NdaDocument: a script that is edited and run again and again (NeoAdaEdit, live diagnostics).
+
+    The text is kept as a list of top-level statements, each ending behind its ";". update()
+    compares the new text with the previous one and parses just the statements the change
+    touches; the ASTs and Runnables of the others are kept, the ones behind the change are moved
+    to their new lines. Anything the piece alone can't decide (e.g. a deleted ";") is parsed in
+    full, which also yields the error positions of a full parse.
+
+    The Runnables belong to the state the document ran on last: another state (e.g. after
+    NdaRuntime::reset()) prepares all statements again from the kept ASTs.
+*/
+
+class NdaDocument
+{
+public:
+    NdaDocument();
+    ~NdaDocument();
+
+    // throws NdaException on syntax errors; the document keeps the previous text then
+    void               update(const std::string &text);
+    NdaVariant         execute(NdaState *state);
+
+    inline const std::string &text() const { return mText;     }
+    inline int         statementCount() const { return (int)mStatements.size(); }
+    inline int         reparsedCount() const  { return mReparsed; }   // statements parsed by the last update()
+
+private:
+    NdaDocument(const NdaDocument&) = delete;
+    NdaDocument &operator=(const NdaDocument&) = delete;
+
+    using SharedAST = std::shared_ptr<NdaParser::AST>;
+
+    struct Statement {
+        NdaParser::StatementEnd end;       // begin: the end of the previous statement
+        NdaParser::ASTNodePtr   node;
+        SharedAST               ast;       // shared by the statements of one parse
+        Nda::Runnable          *runnable;  // nullptr: not yet prepared
+    };
+
+    struct Position {
+        int line;
+        int column;
+    };
+
+    void     parseAll(const std::string &text);
+    bool     parseRange(const std::string &text, size_t first, size_t last);
+    void     append(std::vector<Statement> &statements, SharedAST ast,
+                    const std::vector<NdaParser::StatementEnd> &ends, size_t base);
+    Position beginOf(size_t index) const;
+    size_t   offsetOf(size_t index) const;
+    void     retire();
+
+    static void move(NdaParser::ASTNodePtr node, const Position &from, const Position &to);
+    static void move(Nda::Runnable *node, const Position &from, const Position &to);
+    static void move(int &line, int &column, const Position &from, const Position &to);
+
+    std::string             mText;
+    std::vector<Statement>  mStatements;
+    int                     mReparsed;
+
+    size_t                  mAstMemory;     // ASTs parsed since the last full parse
+    size_t                  mLiveAstMemory; // size of the last full parse
+
+    NdaInterpreter         *mInterpreter;   // owns the Runnables
+    std::vector<NdaInterpreter*> mRetired;  // previous Runnables, still bound as subprograms of a state
+    Nda::Runnable          *mProgram;       // nullptr: statements changed since the last execute()
+    bool                    mPrepareAll;
+    size_t                  mLiveArenaMemory;
+};
+
+#endif // LIB_NEOADA_DOCUMENT_H
@@ -45,6 +45,9 @@ std::string NdaException::messageByCode() const
     case Nada::Error::InvalidToken:           return "Invalid token";
     case Nada::Error::InvalidRangeOrIterable: return "Invalid Range or Iterable";
     case Nada::Error::UnexpectedClosure:      return "Unexpected closure";
+    case Nada::Error::InvalidProgramImage:    return "Invalid or incompatible precompiled program";
+    case Nada::Error::InvalidExpression:      return "Expression is not compiled for this state";
+    case Nada::Error::InvalidPackage:         return "Invalid package file";
     case Nada::Error::AssignmentError:        return "Incompatible datatype";
     case Nada::Error::IllegalComparison:      return "Illegal comparison";
     case Nada::Error::DivisionByZero:         return "Division by zero";
@@ -58,6 +61,7 @@ std::string NdaException::messageByCode() const
     case Nada::Error::InvalidJump:            return "Invalid jump";
     case Nada::Error::InvalidContainerType:   return "Invalid container type";
     case Nada::Error::InvalidAccessValue:     return "Invalid access value";
+    case Nada::Error::UnhandledException:     return "Unhandled exception";
 
     }
     return "";
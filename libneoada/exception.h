@@ -27,6 +27,13 @@ enum Error {
     InvalidRangeOrIterable,
     UnexpectedClosure,
 
+    // Precompiled program (Nda::ProgramImage, NeoAda::Expression)
+    InvalidProgramImage,
+    InvalidExpression,
+
+    // User packages (NdaRuntime::setPackagePath)
+    InvalidPackage,
+
     // Runtime Exceptions
     // ----------------------------------------------
     UnknownSymbol,
@@ -42,6 +49,7 @@ enum Error {
     InvalidContainerType,
     InvalidAccessValue,
     InvalidNumericValue,
+    UnhandledException,    // NeoAda::evaluate, evaluateBatch: raised by the script
 };
 }
 
@@ -6,41 +6,250 @@
 #include "exception.h"
 
 #include "private/runnable.h"
+#include "private/programimage.h"
 
 //-------------------------------------------------------------------------------------------------
 NdaInterpreter::NdaInterpreter(NdaState *state)
-    : mState(state)
+    : mExecState(RunState)
+    , mState(nullptr)
     , mRunnable(nullptr)
+    , mCachesReleased(false)
+    , mRunning(0)
     , mHasVolatileAccessTarget(false)
+    , mHasArrayAccessTarget(false)
+    , mArrayAccessIndex(0)
 {
+    setState(state);
 }
 
 //-------------------------------------------------------------------------------------------------
 NdaInterpreter::~NdaInterpreter()
 {
-    if (mRunnable)
-        delete mRunnable;
+    setState(nullptr);
 }
 
 //-------------------------------------------------------------------------------------------------
-NdaVariant NdaInterpreter::execute(const NdaParser::ASTNodePtr &node, NdaState *state)
+void NdaInterpreter::setState(NdaState *state)
 {
-    assert(node);
+    if (state == mState)
+        return;
+
+    if (mState)
+        mState->detach(this);
+    mState = state;
+    if (mState)
+        mState->attach(this);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaInterpreter::boundSubprograms() const
+{
+    return mState && mState->mFunctions.boundEntries(this) > 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaInterpreter::execute(const NdaParser::AST &ast, NdaState *state)
+{
+    assert(ast);
     if (!state && !mState)
         return NdaVariant();
 
-    if (mRunnable)
-        delete mRunnable;
+    execute(load(ast,state),state);
+
+    // lets keep "mRunnable" here -> later invoke!!
+
+    return (state ? state : mState)->ret();
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::Runnable *NdaInterpreter::load(const NdaParser::AST &ast, NdaState *state)
+{
+    assert(ast);
+    if (!beginProgram(state))
+        return nullptr;
+
+    mRunnable = prepare(ast);
+    return mRunnable;
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::Runnable *NdaInterpreter::loadDefinitions(const NdaParser::AST &ast, NdaState *state)
+{
+    assert(ast);
+    if (!beginProgram(state))
+        return nullptr;
+
+    std::vector<Nda::Runnable*> statements;
+    for (const auto &node : ast.root()->children) {
+        switch (node->type) {
+        case NdaParser::ASTNodeType::WithAddon:
+        case NdaParser::ASTNodeType::Package:
+        case NdaParser::ASTNodeType::Procedure:
+        case NdaParser::ASTNodeType::Function:
+            break;
+        default:
+            continue; // declarations and statements would touch the globals of the running program
+        }
+
+        Nda::Runnable *statement = createRunnable(node);
+        prepare(node, statement);
+        statements.push_back(statement);
+    }
+
+    return compose(statements);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaInterpreter::beginProgram(NdaState *state)
+{
+    if (!state && !mState)
+        return false;
+
+    mArena.clear(); // the previous program, in one go
+    mRunnable = nullptr;
+    mCachesReleased = false;
+
+    if (state)
+        setState(state); // names are interned into the state's AtomTable
 
     mExecState = RunState;
     mHasVolatileAccessTarget = false;
+    mHasArrayAccessTarget    = false;
+    return true;
+}
 
-    mRunnable = prepare(node);
-    execute(mRunnable,state);
+//-------------------------------------------------------------------------------------------------
+std::string NdaInterpreter::saveProgram(const Nda::Runnable *program, const std::string &source) const
+{
+    return Nda::ProgramImage::write(program, source, callTable());
+}
 
-    // lets keep "mRunnable" here -> later invoke!!
+//-------------------------------------------------------------------------------------------------
+Nda::Runnable *NdaInterpreter::loadProgram(const std::string &image, NdaState *state)
+{
+    if (!beginProgram(state))
+        return nullptr;
 
-    return (state ? state : mState)->ret();
+    Nda::Runnable *program = Nda::ProgramImage::read(image, mArena, mState->atoms(), callTable());
+    if (!program) {
+        mArena.clear(); // partially read
+        return nullptr;
+    }
+
+    cacheLiterals(program);
+
+    mRunnable = program;
+    return mRunnable;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::releaseCaches()
+{
+    if (!mRunnable || mCachesReleased)
+        return;
+
+    releaseCaches(mRunnable);
+    mArena.releaseVariants();
+    mCachesReleased = true; // rebuilt by the next execute()
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::markAtoms(std::vector<bool> &used) const
+{
+    for (Nda::Atom atom : mArena.atoms()) {
+        if (atom < (Nda::Atom)used.size())
+            used[atom] = true;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::restoreCaches()
+{
+    if (!mCachesReleased)
+        return;
+
+    cacheLiterals(mRunnable);
+    mCachesReleased = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::releaseCaches(Nda::Runnable *node)
+{
+    node->symbolIndex    = -1;
+    node->symbolScope    = -1;
+    node->symbolIsGlobal = false;
+    node->typeCache      = nullptr;
+
+    for (int i = 0; i < node->childrenCount; i++)
+        releaseCaches(node->children[i]);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::cacheLiterals(Nda::Runnable *node)
+{
+    cacheLiteral(node);
+    for (int i = 0; i < node->childrenCount; i++)
+        cacheLiterals(node->children[i]);
+}
+
+//-------------------------------------------------------------------------------------------------
+// index = position in a ProgramImage: append only, bump Nda::ProgramImage::FormatVersion on changes
+const std::vector<Nda::RunnableCall> &NdaInterpreter::callTable()
+{
+    static const std::vector<Nda::RunnableCall> calls = {
+        &NdaInterpreter::runProgramm,
+        &NdaInterpreter::runLoadAddon,
+        &NdaInterpreter::runCreateType,
+        &NdaInterpreter::runDefineInstanceProcedure,
+        &NdaInterpreter::runDefineSingleProcedure,
+        &NdaInterpreter::runDefineInstanceFunction,
+        &NdaInterpreter::runDefineSingleFunction,
+        &NdaInterpreter::runLoopBlock,
+        &NdaInterpreter::runSingleBlock,
+        &NdaInterpreter::runSubStatement,
+        &NdaInterpreter::runDeclarationGroup,
+        &NdaInterpreter::runVolatileDeclaration,
+        &NdaInterpreter::runDeclaration,
+        &NdaInterpreter::runIfStatement,
+        &NdaInterpreter::runCaseStatement,
+        &NdaInterpreter::runWhileLoop,
+        &NdaInterpreter::runForLoopRange,
+        &NdaInterpreter::runForLoopAttributeRange,
+        &NdaInterpreter::runForLoopIterable,
+        &NdaInterpreter::runReturn,
+        &NdaInterpreter::runRaise,
+        &NdaInterpreter::runExceptionHandlers,
+        &NdaInterpreter::runBreak,
+        &NdaInterpreter::runContinue,
+        &NdaInterpreter::runFunctionCall,
+        &NdaInterpreter::runStaticMethodCall,
+        &NdaInterpreter::runInstanceMethodCall,
+        &NdaInterpreter::runAssignment,
+        &NdaInterpreter::runAppendAssignment,
+        &NdaInterpreter::runBinaryEqual,
+        &NdaInterpreter::runBinaryNotEqual,
+        &NdaInterpreter::runBinaryGtThen,
+        &NdaInterpreter::runBinaryLtThen,
+        &NdaInterpreter::runBinaryEqGtThen,
+        &NdaInterpreter::runBinaryEqLtThen,
+        &NdaInterpreter::runBinaryConcat,
+        &NdaInterpreter::runBinaryMod,
+        &NdaInterpreter::runBinaryPlus,
+        &NdaInterpreter::runBinaryMinus,
+        &NdaInterpreter::runBinaryMultiply,
+        &NdaInterpreter::runBinaryPower,
+        &NdaInterpreter::runBinaryDivide,
+        &NdaInterpreter::runBinaryAnd,
+        &NdaInterpreter::runBinaryOr,
+        &NdaInterpreter::runBinaryXor,
+        &NdaInterpreter::runUnaryMinus,
+        &NdaInterpreter::runLengthOperator,
+        &NdaInterpreter::runAccessOperator,
+        &NdaInterpreter::runFieldAccess,
+        &NdaInterpreter::runAttribute,
+        &NdaInterpreter::runPackage,
+    };
+    return calls;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -51,23 +260,90 @@ NdaVariant NdaInterpreter::execute(Nda::Runnable *node, NdaState *state)
         return NdaVariant();
 
     if (state)
-        mState = state;
+        setState(state);
+
+    restoreCaches();
 
     mExecState = RunState;
     mHasVolatileAccessTarget = false;
+    mHasArrayAccessTarget    = false;
     assert(node->call);
 
+    RunningScope running(this);
     (this->*(node->call))(node);
 
     return mState->ret();
 }
 
 //-------------------------------------------------------------------------------------------------
-Nda::Runnable *NdaInterpreter::prepare(const NdaParser::ASTNodePtr &node)
+NdaVariant NdaInterpreter::evaluate(Nda::Runnable *program)
 {
-    assert(node);
+    assert(program);
+    if (!mState)
+        return NdaVariant();
+
+    NdaState *state = mState;
+    state->clearUnhandledException(); // of the previous evaluation
+    size_t frames, scopes;
+    state->scopeDepth(frames, scopes);
+    state->pushScope(NadaSymbolTable::ConditionalScope);
+
+    NdaVariant ret;
+    try {
+        ret = execute(program);
+        ret.dereference(); // before its scope is left
+    } catch (...) {
+        state->ret().reset();
+        state->unwind(frames, scopes);
+        throw;
+    }
+
+    state->ret() = ret;
+    state->unwind(frames, scopes);
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::Runnable *NdaInterpreter::prepare(const NdaParser::AST &ast)
+{
+    assert(ast);
+
+    Nda::Runnable *ret = createRunnable(ast.root());
+    prepare(ast.root(), ret);
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::Runnable *NdaInterpreter::createRunnable(const NdaParser::ASTNodePtr &node)
+{
+    // identifiers, keywords and operators get an atom, literals keep their text in the arena
+    const bool isLiteral = node->type == NdaParser::ASTNodeType::Literal || node->type == NdaParser::ASTNodeType::Number;
+    const Nda::AtomString value = mArena.value(mState->atoms(), isLiteral, node->value.displayValue, node->value.lowerValue);
+
+    return mArena.create(node->line,node->column, (int)node->children.size(), value);
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::Runnable *NdaInterpreter::compose(const std::vector<Nda::Runnable*> &statements)
+{
+    // like the root of prepare(AST); the statements stay where they are in the arena
+    const Nda::AtomString value = mArena.value(mState->atoms(), false, "", "");
+
+    Nda::Runnable *program = mArena.create(1, 1, (int)statements.size(), value);
+    program->type = Nda::CallType;
+    program->call = &NdaInterpreter::runProgramm;
+    for (size_t i = 0; i < statements.size(); i++) {
+        program->children[i] = statements[i];
+        program->children[i]->parent = program;
+    }
 
-    Nda::Runnable *ret = new Nda::Runnable(node->line,node->column, (int)node->children.size(), node->value);
+    mRunnable = program;
+    return program;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::prepare(const NdaParser::ASTNodePtr &node, Nda::Runnable *ret)
+{
     ret->type = Nda::CallType;
 
     switch (node->type) {
@@ -77,6 +353,9 @@ Nda::Runnable *NdaInterpreter::prepare(const NdaParser::ASTNodePtr &node)
     case NdaParser::ASTNodeType::WithAddon:
         ret->call = &NdaInterpreter::runLoadAddon;
         break;
+    case NdaParser::ASTNodeType::Package:
+        ret->call = &NdaInterpreter::runPackage;
+        break;
     case NdaParser::ASTNodeType::TypeDefinition:
         ret->call = &NdaInterpreter::runCreateType;
         break;
@@ -145,8 +424,10 @@ Nda::Runnable *NdaInterpreter::prepare(const NdaParser::ASTNodePtr &node)
         assert(node->children.size() == 2); // range + body
         if (node->children[0]->type == NdaParser::ASTNodeType::Range)
             ret->call = &NdaInterpreter::runForLoopRange;
+        else if (node->children[0]->type == NdaParser::ASTNodeType::Attribute && node->children[0]->value.lowerValue == "range")
+            ret->call = &NdaInterpreter::runForLoopAttributeRange;
         else
-            assert(0);
+            ret->call = &NdaInterpreter::runForLoopIterable;
         break;
     case NdaParser::ASTNodeType::Return:
         ret->call = &NdaInterpreter::runReturn;
@@ -176,7 +457,7 @@ Nda::Runnable *NdaInterpreter::prepare(const NdaParser::ASTNodePtr &node)
         ret->call = &NdaInterpreter::runInstanceMethodCall;
         break;
     case NdaParser::ASTNodeType::Assignment:
-        ret->call = &NdaInterpreter::runAssignment;
+        ret->call = isAppendAssignment(node) ? &NdaInterpreter::runAppendAssignment : &NdaInterpreter::runAssignment;
         break;
     case NdaParser::ASTNodeType::Literal:
         ret->type = Nda::NcStringLiteral;
@@ -189,9 +470,11 @@ Nda::Runnable *NdaInterpreter::prepare(const NdaParser::ASTNodePtr &node)
         break;
     case NdaParser::ASTNodeType::BooleanLiteral:
         ret->type = Nda::NcBoolLiteral;
+        cacheLiteral(ret);
         break;
     case NdaParser::ASTNodeType::Number:
         ret->type = Nda::NcNumberLiteral;
+        cacheLiteral(ret);
         break;
     case NdaParser::ASTNodeType::BinaryOperator:
 
@@ -245,6 +528,15 @@ Nda::Runnable *NdaInterpreter::prepare(const NdaParser::ASTNodePtr &node)
     case NdaParser::ASTNodeType::AccessOperator:
         ret->call = &NdaInterpreter::runAccessOperator;
         break;
+    case NdaParser::ASTNodeType::FieldAccess:
+        ret->call = &NdaInterpreter::runFieldAccess;
+        break;
+    case NdaParser::ASTNodeType::Attribute:
+        ret->call = &NdaInterpreter::runAttribute;
+        break;
+    case NdaParser::ASTNodeType::RecordField:
+        ret->type = Nda::CallNOP;
+        break;
     case NdaParser::ASTNodeType::Range:
         ret->type = Nda::CallNOP;
         break;
@@ -265,16 +557,134 @@ Nda::Runnable *NdaInterpreter::prepare(const NdaParser::ASTNodePtr &node)
         break;
     }
 
+    // siblings next to each other in the arena, then their subtrees
     for (int i=0; i<ret->childrenCount; i++) {
-        ret->children[i] = prepare(node->children[i]);
+        ret->children[i] = createRunnable(node->children[i]);
+        ret->children[i]->parent = ret;
     }
-    return ret;
+    for (int i=0; i<ret->childrenCount; i++)
+        prepare(node->children[i], ret->children[i]);
+
+    if (ret->call == &NdaInterpreter::runForLoopAttributeRange)
+        hoistIndexChecks(node, ret);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::cacheLiteral(Nda::Runnable *node)
+{
+    NdaVariant value;
+    switch (node->type) {
+    case Nda::NcBoolLiteral:
+        value.fromBool(mState->booleanType(),node->value.lowerValue == "true");
+        node->variantCache = mArena.createVariant(value, node->variantCache);
+        break;
+    case Nda::NcNumberLiteral:
+        if (numberLiteral(node->value.lowerValue, value)) // invalid literals raise when executed
+            node->variantCache = mArena.createVariant(value, node->variantCache);
+        break;
+    default:
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+/*
+    for i in A'Range loop
+        S := S + A[i];
+    end loop;
+
+    "i" runs through the bounds of the array type of "A", so "A[i]" doesn't need an index check
+    as long as the body can't change "i" and doesn't declare another "i" or "A". The body must
+    not call anything: the symbols are dynamically scoped, a called subprogram (or callback) may
+    assign "i". The check is only skipped, if "A" still has the type the loop was started with
+    (see runAccessOperator).
+*/
+void NdaInterpreter::hoistIndexChecks(const NdaParser::ASTNodePtr &loopNode, Nda::Runnable *loop)
+{
+    const auto &prefix = loopNode->children[0]->children[0];
+    if (prefix->type != NdaParser::ASTNodeType::Identifier)
+        return;
+
+    const std::string &loopVar   = loopNode->value.lowerValue;
+    const std::string &arrayName = prefix->value.lowerValue;
+
+    if (!isLoopInvariant(loopNode->children[1], loopVar, arrayName))
+        return;
+
+    std::vector<Nda::Runnable*> pending = { loop->children[1] };
+    while (!pending.empty()) {
+        Nda::Runnable *r = pending.back();
+        pending.pop_back();
+
+        if (r->call == &NdaInterpreter::runAccessOperator && r->value.lowerValue == "[" &&
+            r->children[0]->type == Nda::NcIdentifier && r->children[0]->value.lowerValue == arrayName &&
+            r->children[1]->type == Nda::NcIdentifier && r->children[1]->value.lowerValue == loopVar)
+            r->rangeLoop = loop;
+
+        for (int i = 0; i < r->childrenCount; i++)
+            pending.push_back(r->children[i]);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaInterpreter::isLoopInvariant(const NdaParser::ASTNodePtr &node, const std::string &loopVar, const std::string &arrayName)
+{
+    switch (node->type) {
+    case NdaParser::ASTNodeType::Assignment:
+        if (node->children[0]->type == NdaParser::ASTNodeType::Identifier &&
+            node->children[0]->value.lowerValue == loopVar)
+            return false;
+        break;
+    case NdaParser::ASTNodeType::Declaration:
+    case NdaParser::ASTNodeType::VolatileDeclaration:
+    case NdaParser::ASTNodeType::ForLoop:
+        if (node->value.lowerValue == loopVar || node->value.lowerValue == arrayName)
+            return false;
+        break;
+    case NdaParser::ASTNodeType::FunctionCall:
+    case NdaParser::ASTNodeType::StaticMethodCall:
+    case NdaParser::ASTNodeType::InstanceMethodCall:
+    case NdaParser::ASTNodeType::Procedure:
+    case NdaParser::ASTNodeType::Function:
+        return false;
+    default:
+        break;
+    }
+
+    for (const auto &child : node->children) {
+        if (!isLoopInvariant(child, loopVar, arrayName))
+            return false;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaInterpreter::isAppendAssignment(const NdaParser::ASTNodePtr &node)
+{
+    if (node->children.size() != 2)
+        return false;
+
+    const auto &target = node->children[0];
+    const auto &value  = node->children[1];
+
+    return target->type == NdaParser::ASTNodeType::Identifier &&
+           value->type  == NdaParser::ASTNodeType::BinaryOperator &&
+           value->value.lowerValue == "&" &&
+           value->children.size() == 2 &&
+           value->children[0]->type == NdaParser::ASTNodeType::Identifier &&
+           value->children[0]->value.lowerValue == target->value.lowerValue;
 }
 
 //-------------------------------------------------------------------------------------------------
 Nada::Error NdaInterpreter::invokeFnc(const std::string &typeName, const std::string &fncName, NdaVariants &args)
 {
-    auto *fncPtr = mState->functionPtr(typeName,fncName,args);
+    mExecState = RunState; // a call of the host, the last program may have ended with "return"
+    return invokeFnc(mState->functionPtr(typeName,fncName,args), args);
+}
+
+//-------------------------------------------------------------------------------------------------
+Nada::Error NdaInterpreter::invokeFnc(const Nda::FunctionEntry *fncPtr, NdaVariants &args)
+{
     if (!fncPtr)
         return Nada::Error::UnknownFunctionCall;
 
@@ -291,17 +701,9 @@ Nada::Error NdaInterpreter::invokeFnc(const std::string &typeName, const std::st
                 Push to stack   : declare x : Natural := 42;
         */
 
-        for (int i = 0; i< (int)fnc.parameters.size(); i++) {
-            mState->define(fnc.parameters[i].name, fnc.parameters[i].type);
-            // TODO: if !define -> runtime error!
-            NdaVariant &valueRef = mState->valueRef(fnc.parameters[i].name);
-            if (fnc.parameters[i].mode == Nda::OutMode) {
-                valueRef.fromReference(mState->typeByName("reference"),&args[i]);
-            } else {
-                valueRef.assign(args[i]);
-            }
-        }
+        pushParameters(fnc, args);
 
+        RunningScope running(fnc.program); // kept, if a callback replaces the body meanwhile
         run(fnc.callBlock);
 
         if (mExecState == ReturnState)
@@ -313,8 +715,8 @@ Nada::Error NdaInterpreter::invokeFnc(const std::string &typeName, const std::st
     } else {
         auto parameters = fnc.fncValues(args);
         const bool ok = fnc.nativeFncCallback
-                ? fnc.nativeFncCallback(parameters, mState->ret())
-                : fnc.nativePrcCallback(parameters);
+                ? fnc.nativeFncCallback(mState, parameters, mState->ret())
+                : fnc.nativePrcCallback(mState, parameters);
         if (!ok) {
             if (mState->unhandledException().empty())
                 mState->setUnhandledException("programerror");
@@ -326,6 +728,58 @@ Nada::Error NdaInterpreter::invokeFnc(const std::string &typeName, const std::st
     return Nada::Error::NoError;
 }
 
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::pushParameters(const Nda::FunctionEntry &fnc, NdaVariants &args)
+{
+    for (int i = 0; i< (int)fnc.parameters.size(); i++) {
+        mState->define(fnc.parameterNames[i], fnc.parameterTypes[i]);
+        // TODO: if !define -> runtime error!
+        NdaVariant &valueRef = mState->valueRef(fnc.parameterNames[i]);
+        if (fnc.parameters[i].mode == Nda::OutMode) {
+            valueRef.fromReference(mState->referenceType(),&args[i]);
+        } else {
+            valueRef.assign(args[i]);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+/*
+    Array elements are unboxed: A[i] as an argument is a copy. runAccessOperator() leaves the
+    array and the index in mArrayAccessTarget, the copy is stored back after the call, if the
+    parameter is "out" (a List element is a reference and written through).
+*/
+void NdaInterpreter::runArgument(Nda::Runnable *node, NdaVariants &values, ArrayArguments &arrayArguments)
+{
+    mHasArrayAccessTarget = false;
+    run(node);
+    if (mHasArrayAccessTarget) {
+        mHasArrayAccessTarget = false;
+        arrayArguments.push_back(ArrayArgument{(int)values.size(), mArrayAccessTarget, mArrayAccessIndex});
+        mArrayAccessTarget.reset();
+    }
+    values.push_back(mState->ret());
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::writeArrayArguments(const Nda::FunctionEntry *fnc, const ArrayArguments &arrayArguments, const NdaVariants &values)
+{
+    if (!fnc || mExecState == ExceptionState)
+        return;
+
+    for (const auto &argument : arrayArguments) {
+        if (fnc->parameters[argument.value].mode != Nda::OutMode)
+            continue;
+        NdaVariant target = argument.target;
+        if (!target.writeArrayElement(argument.index, values[argument.value])) {
+            mState->setUnhandledException("programerror");
+            mState->ret().reset();
+            mExecState = ExceptionState;
+            return;
+        }
+    }
+}
+
 //-------------------------------------------------------------------------------------------------
 bool NdaInterpreter::validateFunctionReturn(const Nda::FunctionEntry &fnc)
 {
@@ -334,7 +788,7 @@ bool NdaInterpreter::validateFunctionReturn(const Nda::FunctionEntry &fnc)
         return true;
     }
 
-    const auto *returnType = mState->typeByName(fnc.returnType);
+    const auto *returnType = mState->typeByAtom(fnc.returnTypeAtom);
     if (!returnType) {
         mState->setUnhandledException("programerror");
         mState->ret().reset();
@@ -372,7 +826,7 @@ void NdaInterpreter::run(Nda::Runnable *node)
     case Nda::NcIdentifier: {
 
         if (node->symbolIndex < 0) {
-            if (!mState->find(node->value.lowerValue,node->symbolIndex, node->symbolScope, node->symbolIsGlobal)) {
+            if (!mState->find(node->value.atom,node->symbolIndex, node->symbolScope, node->symbolIsGlobal)) {
                 throw NdaException(Nada::Error::UnknownSymbol,node->line,node->column, node->value.displayValue);
             }
         }
@@ -381,7 +835,7 @@ void NdaInterpreter::run(Nda::Runnable *node)
         auto *value = symbol ? symbol->value : nullptr;
 
         if (symbol && symbol->isVolatile && value)
-            mState->readVolatile(symbol->name.lowerValue, *value);
+            mState->readVolatile(mState->atoms().name(symbol->atom), *value);
 
         // auto *value = mState->valuePtr(node->value.lowerValue);
         if (value)
@@ -491,13 +945,13 @@ void NdaInterpreter::runDeclaration(Nda::Runnable *node)
 {
     assert(node->childrenCount >= 1);
 
-    if (!mState->define(node->value.lowerValue, node->children[0]->value.lowerValue, false)) {
+    if (!mState->define(node->value.atom, node->children[0]->value.atom, false)) {
         mState->ret().reset();
         throw NdaException(Nada::Error::DeclarationError,node->line,node->column, node->value.displayValue);
     }
 
     if (node->childrenCount == 2) { // declaration with assignment
-        auto &value = mState->valueRef(node->value.lowerValue);
+        auto &value = mState->valueRef(node->value.atom);
         NdaVariant initialValue;
 
         mState->ret().reset();
@@ -519,13 +973,13 @@ void NdaInterpreter::runVolatileDeclaration( Nda::Runnable *node)
 {
     assert(node->childrenCount >= 1);
 
-    if (!mState->define(node->value.lowerValue, node->children[0]->value.lowerValue, true)) {
+    if (!mState->define(node->value.atom, node->children[0]->value.atom, true)) {
         mState->ret().reset();
         throw NdaException(Nada::Error::DeclarationError,node->line,node->column, node->value.displayValue);
     }
 
     if (node->childrenCount == 2) { // declaration with assignment
-        auto &value = mState->valueRef(node->value.lowerValue);
+        auto &value = mState->valueRef(node->value.atom);
         NdaVariant initialValue;
 
         mState->ret().reset();
@@ -548,6 +1002,7 @@ void NdaInterpreter::runAssignment(Nda::Runnable *node)
     assert(node->childrenCount == 2);
 
     mHasVolatileAccessTarget = false;
+    mHasArrayAccessTarget    = false;
     run(node->children[0]);
     if (mExecState == ExceptionState)
         return;
@@ -562,6 +1017,15 @@ void NdaInterpreter::runAssignment(Nda::Runnable *node)
     const NdaVariant volatileAccessIndex = mVolatileAccessIndex;
     mHasVolatileAccessTarget = false;
 
+    const bool hasArrayAccessTarget = mHasArrayAccessTarget;
+    NdaVariant arrayAccessTarget;
+    int64_t    arrayAccessIndex = 0;
+    if (hasArrayAccessTarget) {
+        arrayAccessTarget = mArrayAccessTarget;
+        arrayAccessIndex  = mArrayAccessIndex;
+        mHasArrayAccessTarget = false;
+    }
+
     Nda::Symbol *volatileSymbol = nullptr;
     if (!hasVolatileAccessTarget && node->children[0]->type == Nda::NcIdentifier) {
         volatileSymbol = mState->symbolPtr(node->children[0]->symbolIndex,
@@ -576,7 +1040,7 @@ void NdaInterpreter::runAssignment(Nda::Runnable *node)
         return;
 
     if (volatileSymbol || hasVolatileAccessTarget) {
-        NdaVariant newValue(targetValue.runtimeType());
+        NdaVariant newValue(hasArrayAccessTarget ? arrayAccessTarget.runtimeType()->elementType : targetValue.runtimeType());
         if (!newValue.assign(mState->ret())) {
             mState->setUnhandledException("programerror");
             mState->ret().reset();
@@ -586,7 +1050,7 @@ void NdaInterpreter::runAssignment(Nda::Runnable *node)
 
         const bool writeAccepted = hasVolatileAccessTarget
             ? mState->writeVolatile(volatileAccessSymbol, volatileAccessIndex, newValue)
-            : mState->writeVolatile(volatileSymbol->name.lowerValue, newValue);
+            : mState->writeVolatile(mState->atoms().name(volatileSymbol->atom), newValue);
 
         if (!writeAccepted) {
             mState->setUnhandledException("programerror");
@@ -595,7 +1059,19 @@ void NdaInterpreter::runAssignment(Nda::Runnable *node)
             return;
         }
 
-        targetValue.assign(newValue);
+        if (hasArrayAccessTarget)
+            arrayAccessTarget.writeArrayElement(arrayAccessIndex, newValue);
+        else
+            targetValue.assign(newValue);
+        return;
+    }
+
+    if (hasArrayAccessTarget) {
+        if (!arrayAccessTarget.writeArrayElement(arrayAccessIndex, mState->ret())) {
+            mState->setUnhandledException("programerror");
+            mState->ret().reset();
+            mExecState = ExceptionState;
+        }
         return;
     }
 
@@ -607,24 +1083,65 @@ void NdaInterpreter::runAssignment(Nda::Runnable *node)
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+/*
+    s := s & part;
+
+    Appends "part" directly to the string of "s": no temporary string and, as long as the
+    SharedString isn't shared, no copy of the already built string.
+*/
+void NdaInterpreter::runAppendAssignment(Nda::Runnable *node)
+{
+    assert(node->childrenCount == 2);
+    assert(node->children[1]->childrenCount == 2);
+
+    mHasVolatileAccessTarget = false;
+    run(node->children[0]);
+    if (mExecState == ExceptionState)
+        return;
+
+    if (mState->ret().myType() != Nda::Reference)
+        throw NdaException(Nada::Error::InvalidAssignment,node->line,node->column, node->value.displayValue);
+
+    auto targetValue = mState->ret();
+
+    Nda::Symbol *symbol = mState->symbolPtr(node->children[0]->symbolIndex,
+                                            node->children[0]->symbolScope,
+                                            node->children[0]->symbolIsGlobal);
+    if ((symbol && symbol->isVolatile) || (targetValue.type() != Nda::String)) {
+        runAssignment(node);
+        return;
+    }
+
+    run(node->children[1]->children[1]);
+    if (mExecState == ExceptionState)
+        return;
+
+    if (!targetValue.appendToString(mState->ret()))
+        throw NdaException(Nada::Error::OperatorTypeError,node->children[1]->line,node->children[1]->column, node->children[1]->value.displayValue);
+}
+
 //-------------------------------------------------------------------------------------------------
 void NdaInterpreter::runFunctionCall(Nda::Runnable *node)
 {
     NdaVariants values;
+    ArrayArguments arrayArguments;
     values.reserve(node->childrenCount);
     for (int i=0; i<node->childrenCount; i++) {
-        run(node->children[i]);
+        runArgument(node->children[i], values, arrayArguments);
         if (mExecState == ExceptionState)
             return;
-        values.push_back(mState->ret());
     }
     const std::string &name = node->value.lowerValue;
 
-    auto error = invokeFnc("",name,values);
-    if (error == Nada::Error::NoError)
+    auto *fncPtr = mState->functionPtr(Nda::NoAtom,node->value.atom,values);
+    auto error = invokeFnc(fncPtr,values);
+    if (error == Nada::Error::NoError) {
+        writeArrayArguments(fncPtr, arrayArguments, values);
         return;
+    }
 
-    const auto *targetType = mState->typeByName(name);
+    const auto *targetType = mState->typeByAtom(node->value.atom);
     if (targetType && targetType->instantiable && values.size() == 1) {
         NdaVariant casted;
         casted.initType(targetType);
@@ -657,19 +1174,18 @@ void NdaInterpreter::runFunctionCall(Nda::Runnable *node)
 void NdaInterpreter::runStaticMethodCall(Nda::Runnable *node)
 {
     NdaVariants values;
+    ArrayArguments arrayArguments;
     values.reserve(node->childrenCount > 0 ? node->childrenCount - 1 : 0);
     for (int i=0; i<node->childrenCount; i++) {
         if (node->children[i]->type == Nda::NcMethodContext)
             continue;
-        run(node->children[i]);
-        values.push_back(mState->ret());
+        runArgument(node->children[i], values, arrayArguments);
     }
 
-    std::string typeName = node->children[0]->value.lowerValue;
-    auto *fncPtr = mState->functionPtr(typeName, node->value.lowerValue,values);
+    auto *fncPtr = mState->functionPtr(node->children[0]->value.atom, node->value.atom,values);
     if (!fncPtr) {
         mState->ret().reset();
-        throw NdaException(Nada::Error::UnknownSymbol,node->line,node->column, typeName + ":" + node->value.lowerValue);
+        throw NdaException(Nada::Error::UnknownSymbol,node->line,node->column, node->children[0]->value.lowerValue + ":" + node->value.lowerValue);
     }
 
     auto &fnc = *fncPtr;
@@ -684,17 +1200,9 @@ void NdaInterpreter::runStaticMethodCall(Nda::Runnable *node)
 
                 Push to stack   : declare x : Natural := 42;
         */
-        for (int i = 0; i< (int)fnc.parameters.size(); i++) {
-            mState->define(fnc.parameters[i].name, fnc.parameters[i].type);
-            // TODO: if !define -> runtime error!
-            NdaVariant &valueRef = mState->valueRef(fnc.parameters[i].name);
-            if (fnc.parameters[i].mode == Nda::OutMode) {
-                valueRef.fromReference(mState->typeByName("reference"),&values[i]);
-            } else {
-                valueRef.assign(values[i]);
-            }
-        }
+        pushParameters(fnc, values);
 
+        RunningScope running(fnc.program);
         run(fnc.callBlock);
 
         if (mExecState == ReturnState)
@@ -707,8 +1215,8 @@ void NdaInterpreter::runStaticMethodCall(Nda::Runnable *node)
         auto parameters = fnc.fncValues(values);
 
         const bool ok = fnc.nativeFncCallback
-                ? fnc.nativeFncCallback(parameters, mState->ret())
-                : fnc.nativePrcCallback(parameters);
+                ? fnc.nativeFncCallback(mState, parameters, mState->ret())
+                : fnc.nativePrcCallback(mState, parameters);
         if (!ok) {
             if (mState->unhandledException().empty())
                 mState->setUnhandledException("programerror");
@@ -716,6 +1224,8 @@ void NdaInterpreter::runStaticMethodCall(Nda::Runnable *node)
             mExecState = ExceptionState;
         }
     }
+
+    writeArrayArguments(fncPtr, arrayArguments, values);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -734,19 +1244,18 @@ void NdaInterpreter::runInstanceMethodCall(Nda::Runnable *node)
         throw NdaException(Nada::Error::UnknownSymbol,node->line,node->column, node->value.lowerValue);
 
     NdaVariants values;
+    ArrayArguments arrayArguments;
     values.reserve(node->childrenCount > 0 ? node->childrenCount - 1 : 0);
     for (int i=1; i<node->childrenCount; i++) {
-        run(node->children[i]);
+        runArgument(node->children[i], values, arrayArguments);
         if (mExecState == ExceptionState)
             return;
-        values.push_back(mState->ret());
     }
 
-    std::string typeName = runtimeType->name.lowerValue;
-    auto *fncPtr = mState->functionPtr(typeName, node->value.lowerValue,values);
+    auto *fncPtr = mState->functionPtr(runtimeType->atom, node->value.atom,values);
     if (!fncPtr) {
         mState->ret().reset();
-        throw NdaException(Nada::Error::UnknownSymbol,node->line,node->column, typeName + ":" + node->value.lowerValue);
+        throw NdaException(Nada::Error::UnknownSymbol,node->line,node->column, runtimeType->name.lowerValue + ":" + node->value.lowerValue);
     }
 
     auto &fnc = *fncPtr;
@@ -761,22 +1270,14 @@ void NdaInterpreter::runInstanceMethodCall(Nda::Runnable *node)
 
                 Push to stack   : declare x : Natural := 42;
         */
-        for (int i = 0; i< (int)fnc.parameters.size(); i++) {
-            mState->define(fnc.parameters[i].name, fnc.parameters[i].type);
-            // TODO: if !define -> runtime error!
-            NdaVariant &valueRef = mState->valueRef(fnc.parameters[i].name);
-            if (fnc.parameters[i].mode == Nda::OutMode) {
-                valueRef.fromReference(mState->typeByName("reference"),&values[i]);
-            } else {
-                valueRef.assign(values[i]);
-            }
-        }
+        pushParameters(fnc, values);
 
-        mState->define("this", runtimeType);
+        mState->define(Nda::ThisAtom, runtimeType);
         // TODO: if !define -> runtime error!
-        NdaVariant &valueRef = mState->valueRef("this");
+        NdaVariant &valueRef = mState->valueRef(Nda::ThisAtom);
         valueRef.assign(thisValue);
 
+        RunningScope running(fnc.program);
         run(fnc.callBlock);
 
         if (mExecState == ReturnState)
@@ -792,8 +1293,8 @@ void NdaInterpreter::runInstanceMethodCall(Nda::Runnable *node)
         parameters["this"] = thisValue;
 
         const bool ok = fnc.nativeFncCallback
-                ? fnc.nativeFncCallback(parameters, mState->ret())
-                : fnc.nativePrcCallback(parameters);
+                ? fnc.nativeFncCallback(mState, parameters, mState->ret())
+                : fnc.nativePrcCallback(mState, parameters);
         if (!ok) {
             if (mState->unhandledException().empty())
                 mState->setUnhandledException("programerror");
@@ -802,6 +1303,7 @@ void NdaInterpreter::runInstanceMethodCall(Nda::Runnable *node)
         }
     }
 
+    writeArrayArguments(fncPtr, arrayArguments, values);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -840,7 +1342,7 @@ void NdaInterpreter::runExceptionHandlers(Nda::Runnable *node)
     const std::string exceptionName = mState->unhandledException();
     for (int i=0; i<node->childrenCount; i++) {
         auto *handler = node->children[i];
-        if (handler->value.lowerValue != exceptionName && handler->value.lowerValue != "others")
+        if (handler->value.lowerValue != exceptionName && handler->value.atom != Nda::OthersAtom)
             continue;
 
         mState->clearUnhandledException();
@@ -917,7 +1419,7 @@ void NdaInterpreter::runCaseStatement(Nda::Runnable *node)
         auto *whenNode = node->children[i];
         assert(whenNode->childrenCount >= 1);
 
-        bool matches = whenNode->value.lowerValue == "others";
+        bool matches = whenNode->value.atom == Nda::OthersAtom;
         Nda::Runnable *blockNode = whenNode->children[whenNode->childrenCount - 1];
 
         if (!matches) {
@@ -969,10 +1471,6 @@ void NdaInterpreter::runWhileLoop(Nda::Runnable *node)
 void NdaInterpreter::runForLoopRange(Nda::Runnable *node)
 {
     assert(node->childrenCount == 2);
-
-    std::string varName = node->value.displayValue;
-    assert(varName.length() > 0);
-
     assert(node->children[0]->childrenCount == 2); // from .. to
 
     int64_t from,to;
@@ -986,6 +1484,91 @@ void NdaInterpreter::runForLoopRange(Nda::Runnable *node)
     from = rangeStart.toInt64();
     to   = rangeEnd.toInt64();
 
+    runForLoopBody(node, from, to);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::runForLoopAttributeRange(Nda::Runnable *node)
+{
+    assert(node->childrenCount == 2);
+    assert(node->children[0]->childrenCount == 1);
+
+    run(node->children[0]->children[0]);
+    if (mExecState == ExceptionState)
+        return;
+
+    int64_t from, to;
+    if (!attributeRange(mState->ret(), from, to))
+        throw NdaException(Nada::Error::InvalidContainerType,node->line,node->column, node->children[0]->value.displayValue);
+
+    // bounds of this type are the loop range -> see hoistIndexChecks()
+    // restored on every exit, an exception included: recursion
+    struct TypeCacheScope {
+        Nda::Runnable          *node;
+        const Nda::RuntimeType *outerType;
+        ~TypeCacheScope() { node->typeCache = outerType; }
+    } typeCacheScope{node, node->typeCache};
+    node->typeCache = mState->ret().type() == Nda::Array ? mState->ret().runtimeType() : nullptr;
+
+    runForLoopBody(node, from, to);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::runForLoopIterable(Nda::Runnable *node)
+{
+    assert(node->childrenCount == 2);
+
+    run(node->children[0]);
+    if (mExecState == ExceptionState)
+        return;
+
+    // variables stay references -> modifications are detected, anything else is iterated as a
+    // COW snapshot: a reference into a temporary or a container element may not outlive the body
+    NdaVariant iterable = mState->ret();
+    if (node->children[0]->type != Nda::NcIdentifier)
+        iterable.dereference();
+    if (iterable.type() != Nda::Dict)
+        throw NdaException(Nada::Error::InvalidContainerType,node->line,node->column, node->value.displayValue);
+
+    std::string varName = node->value.displayValue;
+    assert(varName.length() > 0);
+
+    mState->pushScope(NadaSymbolTable::LoopScope);
+    mState->define(varName,"Any");
+    auto &valueRef = mState->valueRef(varName);
+
+    // keys are borrowed from the dict, only the loop variable holds a copy
+    bool unmodified = iterable.forEachDictItem([&](const NdaVariant &key, const NdaVariant &) -> bool {
+        valueRef = key; // copies the type as well: keys of one dict may differ in type
+        run(node->children[1]);
+
+        if (mExecState == BreakState) {
+            mExecState = RunState;
+            return false;
+        }
+        if (mExecState == ReturnState || mExecState == ExceptionState)
+            return false;
+        if (mExecState == ContinueState)
+            mExecState = RunState;
+        return true;
+    });
+
+    if (!unmodified) {
+        mState->setUnhandledException("programerror"); // dict changed while iterating
+        mState->ret().reset();
+        mExecState = ExceptionState;
+    }
+
+    mState->ret().dereference();
+    mState->popScope();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::runForLoopBody(Nda::Runnable *node, int64_t from, int64_t to)
+{
+    std::string varName = node->value.displayValue;
+    assert(varName.length() > 0);
+
     mState->pushScope(NadaSymbolTable::LoopScope);
     mState->define(varName,"Natural");
     auto &valueRef = mState->valueRef(varName);
@@ -1262,6 +1845,14 @@ void NdaInterpreter::runBinaryPower(Nda::Runnable *node)
         return;
     auto right = mState->ret();
 
+    if (left.type() == Nda::BigNatural) {
+        bool done;
+        mState->ret() = left.power(right, &done);
+        if (!done)
+            throw NdaException(Nada::Error::OperatorTypeError,node->line,node->column, node->value.displayValue);
+        return;
+    }
+
     bool leftIsInt;
     bool rightIsInt;
     auto base = left.toInt64(&leftIsInt);
@@ -1417,7 +2008,7 @@ void NdaInterpreter::runAccessOperator(Nda::Runnable *node)
     bool isDictAccess = node->value.lowerValue == "{";
 
     if (isListAccess) {
-        if ((mState->ret().type() != Nda::List) && (mState->ret().type() != Nda::Bytes))
+        if ((mState->ret().type() != Nda::List) && (mState->ret().type() != Nda::Bytes) && (mState->ret().type() != Nda::Array))
             throw NdaException(Nada::Error::InvalidContainerType,node->line,node->column, node->value.displayValue);
     } else {
         assert(isDictAccess);
@@ -1442,10 +2033,63 @@ void NdaInterpreter::runAccessOperator(Nda::Runnable *node)
         node->parent->childrenCount > 0 &&
         node->parent->children[0] == node;
 
+    const bool isCallArgument = node->parent &&
+        (node->parent->call == &NdaInterpreter::runFunctionCall ||
+         node->parent->call == &NdaInterpreter::runStaticMethodCall ||
+         (node->parent->call == &NdaInterpreter::runInstanceMethodCall && node->parent->children[0] != node));
+
     run(node->children[1]);
     if (mExecState == ExceptionState)
         return;
 
+    if (targetObj.type() == Nda::Array) {
+        const Nda::RuntimeType *arrayType = targetObj.runtimeType();
+        bool done = true;
+        int64_t index = mState->ret().toInt64(&done);
+
+        const bool checked = !node->rangeLoop || node->rangeLoop->typeCache != arrayType;
+        if (checked && (!done || index < arrayType->first || index > arrayType->last)) {
+            mState->setUnhandledException("constrainterror");
+            mState->ret().reset();
+            mExecState = ExceptionState;
+            return;
+        }
+
+        if (volatileSymbol) {
+            mHasVolatileAccessTarget = true;
+            mVolatileAccessSymbol = mState->atoms().name(volatileSymbol->atom);
+            mVolatileAccessIndex = mState->ret();
+        }
+
+        if (isCallArgument && !volatileSymbol) { // stored by writeArrayArguments() for "out"
+            mHasArrayAccessTarget = true;
+            mArrayAccessTarget    = targetObj;
+            mArrayAccessIndex     = index;
+            mState->ret() = targetObj.readArrayElement(index);
+            return;
+        }
+
+        if (isAssignmentTarget) { // the element is stored by runAssignment
+            mHasArrayAccessTarget = true;
+            mArrayAccessTarget    = targetObj;
+            mArrayAccessIndex     = index;
+            mArrayElement         = targetObj.readArrayElement(index);
+            mState->ret().fromReference(mState->referenceType(), &mArrayElement);
+            return;
+        }
+
+        if (volatileSymbol) {
+            NdaVariant element = targetObj.readArrayElement(index);
+            mState->readVolatile(mState->atoms().name(volatileSymbol->atom), mVolatileAccessIndex, element);
+            targetObj.writeArrayElement(index, element);
+            mState->ret() = element;
+            return;
+        }
+
+        mState->ret() = targetObj.readArrayElement(index); // elements are unboxed -> value, no reference
+        return;
+    }
+
     if ((targetObj.type() == Nda::List) || (targetObj.type() == Nda::Bytes)) {
         NdaVariant accessIndex = mState->ret();
         bool done = false;
@@ -1476,20 +2120,20 @@ void NdaInterpreter::runAccessOperator(Nda::Runnable *node)
             auto &targetValue = targetObj.writeListAccess((int)index);
             if (volatileSymbol) {
                 mHasVolatileAccessTarget = true;
-                mVolatileAccessSymbol = volatileSymbol->name.lowerValue;
+                mVolatileAccessSymbol = mState->atoms().name(volatileSymbol->atom);
                 mVolatileAccessIndex = accessIndex;
                 if (!isAssignmentTarget)
-                    mState->readVolatile(volatileSymbol->name.lowerValue, accessIndex, targetValue);
+                    mState->readVolatile(mState->atoms().name(volatileSymbol->atom), accessIndex, targetValue);
             }
             mState->ret().fromReference(mState->referenceType(), &targetValue);
         } else {
             auto &targetValue = targetObj.writeBytesAccess((int)index);
             if (volatileSymbol) {
                 mHasVolatileAccessTarget = true;
-                mVolatileAccessSymbol = volatileSymbol->name.lowerValue;
+                mVolatileAccessSymbol = mState->atoms().name(volatileSymbol->atom);
                 mVolatileAccessIndex = accessIndex;
                 if (!isAssignmentTarget)
-                    mState->readVolatile(volatileSymbol->name.lowerValue, accessIndex, targetValue);
+                    mState->readVolatile(mState->atoms().name(volatileSymbol->atom), accessIndex, targetValue);
             }
             mState->ret().fromReference(mState->referenceType(), &targetValue);
         }
@@ -1501,25 +2145,145 @@ void NdaInterpreter::runAccessOperator(Nda::Runnable *node)
             targetValue.initType(mState->typeByName("any"));
         if (volatileSymbol) {
             mHasVolatileAccessTarget = true;
-            mVolatileAccessSymbol = volatileSymbol->name.lowerValue;
+            mVolatileAccessSymbol = mState->atoms().name(volatileSymbol->atom);
             mVolatileAccessIndex = accessIndex;
             if (!isAssignmentTarget)
-                mState->readVolatile(volatileSymbol->name.lowerValue, accessIndex, targetValue);
+                mState->readVolatile(mState->atoms().name(volatileSymbol->atom), accessIndex, targetValue);
         }
         mState->ret().fromReference(mState->referenceType(), &targetValue);
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+/*
+    point.x
+
+    The field name is resolved once per node and record type: symbolIndex caches the slot
+    of the field in the SharedRecord, typeCache the record type it was resolved for.
+*/
+void NdaInterpreter::runFieldAccess(Nda::Runnable *node)
+{
+    assert(node->childrenCount == 1);
+
+    run(node->children[0]);
+    if (mExecState == ExceptionState)
+        return;
+
+    if (mState->ret().type() != Nda::Record)
+        throw NdaException(Nada::Error::InvalidContainerType,node->line,node->column, node->value.displayValue);
+
+    auto targetObj = mState->ret();
+    const Nda::RuntimeType *recordType = targetObj.runtimeType();
+    if (node->typeCache != recordType) {
+        node->symbolIndex = recordType->fieldIndex(node->value.lowerValue);
+        node->typeCache   = recordType;
+    }
+
+    if (node->symbolIndex < 0)
+        throw NdaException(Nada::Error::UnknownSymbol,node->line,node->column, node->value.displayValue);
+
+    if (targetObj.myType() != Nda::Reference) { // temporary, e.g. "DateTime:now().year"
+        mState->ret() = targetObj.readFieldAccess(node->symbolIndex);
+        return;
+    }
+
+    mState->ret().fromReference(mState->referenceType(), &targetObj.writeFieldAccess(node->symbolIndex));
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::runAttribute(Nda::Runnable *node)
+{
+    assert(node->childrenCount == 1);
+
+    run(node->children[0]);
+    if (mExecState == ExceptionState)
+        return;
+
+    int64_t first, last;
+    if (!attributeRange(mState->ret(), first, last))
+        throw NdaException(Nada::Error::InvalidContainerType,node->line,node->column, node->value.displayValue);
+
+    const std::string &attribute = node->value.lowerValue;
+    if (attribute == "first")
+        mState->ret().fromNatural(mState->naturalType(), first);
+    else if (attribute == "last")
+        mState->ret().fromNatural(mState->naturalType(), last);
+    else if (attribute == "length")
+        mState->ret().fromNatural(mState->naturalType(), last - first + 1);
+    else if (attribute == "range") // only "for i in A'Range"
+        throw NdaException(Nada::Error::InvalidRangeOrIterable,node->line,node->column, node->value.displayValue);
+    else
+        throw NdaException(Nada::Error::UnknownSymbol,node->line,node->column, node->value.displayValue);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaInterpreter::attributeRange(const NdaVariant &value, int64_t &first, int64_t &last)
+{
+    switch (value.type()) {
+    case Nda::Array:
+        first = value.runtimeType()->first;
+        last  = value.runtimeType()->last;
+        return true;
+    case Nda::List:
+    case Nda::Bytes:
+    case Nda::String:
+        first = 0;
+        last  = value.lengthOperator() - 1;
+        return true;
+    default:
+        return false;
+    }
+}
+
 //-------------------------------------------------------------------------------------------------
 void NdaInterpreter::runLoadAddon( Nda::Runnable *node)
 {
     mState->requestAddon(node->value.lowerValue);
 }
 
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::runPackage(Nda::Runnable *node)
+{
+    // subprograms are bound as static methods of the package, see NdaParser::parsePackage()
+    for (int i=0; i<node->childrenCount; i++)
+        run(node->children[i]);
+}
+
 //-------------------------------------------------------------------------------------------------
 void NdaInterpreter::runCreateType(Nda::Runnable *node)
 {
-    assert(node->childrenCount == 1);
+    assert(node->childrenCount >= 1);
+
+    if (node->children[0]->value.lowerValue == "record") {
+        std::vector<std::pair<std::string,std::string>> fields;
+        for (int i=1; i<node->childrenCount; i++)
+            fields.push_back({node->children[i]->value.displayValue, node->children[i]->children[0]->value.lowerValue});
+        if (!mState->registerRecord(node->value.displayValue, fields)) {
+            mState->ret().reset();
+            throw NdaException(Nada::Error::DeclarationError,node->line,node->column, node->value.displayValue);
+        }
+        return;
+    }
+
+    if (node->children[0]->value.lowerValue == "array") {
+        assert(node->childrenCount == 3);
+        int64_t bounds[2];
+        for (int i=0; i<2; i++) {
+            run(node->children[1]->children[i]);
+            if (mExecState == ExceptionState)
+                return;
+            bool done;
+            bounds[i] = mState->ret().toInt64(&done);
+            if (!done) {
+                mState->ret().reset();
+                throw NdaException(Nada::Error::DeclarationError,node->line,node->column, node->value.displayValue);
+            }
+        }
+        mState->ret().reset();
+        if (!mState->registerArray(node->value.displayValue, bounds[0], bounds[1], node->children[2]->value.lowerValue))
+            throw NdaException(Nada::Error::DeclarationError,node->line,node->column, node->value.displayValue);
+        return;
+    }
 
     if (!mState->registerType(node->value.lowerValue, node->children[0]->value.lowerValue)) {
         mState->ret().reset();
@@ -1550,7 +2314,7 @@ void NdaInterpreter::runDefineInstanceProcedure( Nda::Runnable *node)
         fncParameters.push_back({p->value.lowerValue,p->children[0]->value.lowerValue,mode});
     }
 
-    mState->bind(typeName,name,fncParameters,block);
+    mState->bind(typeName,name,fncParameters,block,this);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1577,7 +2341,7 @@ void NdaInterpreter::runDefineSingleProcedure(Nda::Runnable *node)
         fncParameters.push_back({p->value.lowerValue,p->children[0]->value.lowerValue,mode});
     }
 
-    mState->bind("",name,fncParameters,block);
+    mState->bind("",name,fncParameters,block,this);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1595,7 +2359,7 @@ void NdaInterpreter::runDefineInstanceFunction(Nda::Runnable *node)
     Nda::FncParameters fncParameters;
     for (int i=0; i<parameters->childrenCount; i++) {
         assert(parameters->children[i]->childrenCount >= 1);
-        auto *p = parameters->children[i]->children[0];
+        auto *p = parameters->children[i];
 
         Nda::ParameterMode mode = Nda::InMode;
         if (p->childrenCount == 2) {
@@ -1606,7 +2370,7 @@ void NdaInterpreter::runDefineInstanceFunction(Nda::Runnable *node)
         fncParameters.push_back({p->value.lowerValue,p->children[0]->value.lowerValue,mode});
     }
 
-    mState->bind(typeName,name,fncParameters,block,returntype->value.lowerValue);
+    mState->bind(typeName,name,fncParameters,block,this,returntype->value.lowerValue);
 
 
 }
@@ -1636,7 +2400,7 @@ void NdaInterpreter::runDefineSingleFunction(Nda::Runnable *node)
         fncParameters.push_back({p->value.lowerValue,p->children[0]->value.lowerValue,mode});
     }
 
-    mState->bind("",name,fncParameters,block,returntype->value.lowerValue);
+    mState->bind("",name,fncParameters,block,this,returntype->value.lowerValue);
 
 }
 
@@ -1662,48 +2426,31 @@ void NdaInterpreter::runLoopAbort(Nda::Runnable *node, ExecState nextState)
 }
 
 //-------------------------------------------------------------------------------------------------
-void NdaInterpreter::evalNumber(Nda::Runnable *node)
+bool NdaInterpreter::numberLiteral(const std::string &literal, NdaVariant &value) const
 {
-    if (node->variantCache) {
-        mState->ret() = *node->variantCache;
-        return;
-    }
-
-    auto &ret = mState->ret();
-    auto identType = NdaVariant::numericType(node->value.lowerValue); // _B -> _b
-
-    bool done = false;
-    switch(identType) {
-    case Nda::Number:
-        done = ret.fromNumberLiteral(mState->typeByName("number")   ,node->value.lowerValue);
-        break;
-    case Nda::Natural:
-        done = ret.fromNaturalLiteral(mState->typeByName("natural") ,node->value.lowerValue);
-        break;
-    case Nda::Supernatural:
-        done = ret.fromSNaturalLiteral(mState->typeByName("supernatural") ,node->value.lowerValue);
-        break;
-    case Nda::Byte:
-        done = ret.fromByteLiteral(mState->typeByName("byte") ,node->value.lowerValue);
-        break;
-    default: break;
+    switch(NdaVariant::numericType(literal)) { // _B -> _b
+    case Nda::Number:       return value.fromNumberLiteral(mState->numberType(), literal);
+    case Nda::Natural:      return value.fromNaturalLiteral(mState->naturalType(), literal);
+    case Nda::Supernatural: return value.fromSNaturalLiteral(mState->typeByAtom(Nda::SupernaturalAtom), literal);
+    case Nda::BigNatural:   return value.fromBigNaturalLiteral(mState->bigNaturalType(), literal);
+    case Nda::Byte:         return value.fromByteLiteral(mState->typeByAtom(Nda::ByteAtom), literal);
+    default:                return false;
     }
+}
 
-    if (!done)
+//-------------------------------------------------------------------------------------------------
+void NdaInterpreter::evalNumber(Nda::Runnable *node)
+{
+    if (!node->variantCache) // rejected by numberLiteral() in prepare()
         throw NdaException(Nada::Error::InvalidNumericValue,node->line,node->column, node->value.displayValue);
 
-    node->variantCache = new NdaVariant(ret);
+    mState->ret() = *node->variantCache;
 }
 
 //-------------------------------------------------------------------------------------------------
 void NdaInterpreter::evalBoolean(Nda::Runnable *node)
 {
-    if (node->variantCache) {
-        mState->ret() = *node->variantCache;
-    } else {
-        mState->ret().fromBool(mState->booleanType(),node->value.lowerValue == "true");
-        node->variantCache = new NdaVariant(mState->ret());
-    }
+    mState->ret() = *node->variantCache;
 }
 
 //-------------------------------------------------------------------------------------------------
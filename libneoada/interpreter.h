@@ -7,6 +7,9 @@
 #include "private/runnable.h"
 #include "exception.h"
 
+namespace Nda { class ColumnEvaluator; }
+class NdaDocument;
+
 /*
     NadaInterpreter: main NeoAda Engine.
 
@@ -19,14 +22,40 @@ public:
     NdaInterpreter(NdaState *state);
     ~NdaInterpreter();
 
-    NdaVariant execute(const NdaParser::ASTNodePtr &node, NdaState *state = nullptr);
+    NdaVariant execute(const NdaParser::AST &ast, NdaState *state = nullptr);
     NdaVariant execute(Nda::Runnable *node, NdaState *state = nullptr);
 
-    Nda::Runnable *prepare(const NdaParser::ASTNodePtr &node);
+    // runs a reusable program (NeoAda::compile) in a scope of its own: its declarations are
+    // released afterwards, also when it throws. The result is dereferenced, an exception raised
+    // by the program is left in NdaState::unhandledException().
+    NdaVariant evaluate(Nda::Runnable *program);
+
+    // lowers the AST into a new program (replaces the previous one); the AST is not referenced afterwards
+    Nda::Runnable *load(const NdaParser::AST &ast, NdaState *state = nullptr);
+    Nda::Runnable *prepare(const NdaParser::AST &ast); // owned by the interpreter, valid until the next load()/execute(AST)
+
+    // hot reload (NdaRuntime::reloadFunctions): a program of just the "with" clauses, packages,
+    // functions and procedures of the AST, the other statements are left out
+    Nda::Runnable *loadDefinitions(const NdaParser::AST &ast, NdaState *state = nullptr);
+
+    // precompiled programs (Nda::ProgramImage): loadProgram() replaces the previous program like load()
+    std::string    saveProgram(const Nda::Runnable *program, const std::string &source) const;
+    Nda::Runnable *loadProgram(const std::string &image, NdaState *state = nullptr); // nullptr: invalid or incompatible image
 
     Nada::Error invokeFnc(const std::string &typeName, const std::string &fncName, NdaVariants &args);
 
+    inline NdaState *state() const { return mState; } // nullptr: the state was destroyed
+
+    // functions/procedures of the program are bound in the state: it calls into the tree later on
+    bool        boundSubprograms() const;
+    // the program or a body of it is running (e.g. a native callback reloads functions)
+    inline bool running() const { return mRunning > 0; }
+
 private:
+    friend class NdaState;
+    friend class Nda::ColumnEvaluator; // matches the dispatch targets
+    friend class NdaDocument;          // prepares statement by statement
+
     enum ExecState {
         RunState,
         ReturnState,
@@ -35,8 +64,36 @@ private:
         ExceptionState
     };
 
+    void setState(NdaState *state);
+    bool beginProgram(NdaState *state);
+    void releaseCaches();                           // NdaState::reset(): symbols and types are gone
+    void markAtoms(std::vector<bool> &used) const;  // NdaState::reset(): the names of the program
+    void restoreCaches();
+    void releaseCaches(Nda::Runnable *node);
+    void cacheLiterals(Nda::Runnable *node);
+    Nda::Runnable *createRunnable(const NdaParser::ASTNodePtr &node);
+    Nda::Runnable *compose(const std::vector<Nda::Runnable*> &statements); // new program of prepared statements
+    void prepare(const NdaParser::ASTNodePtr &node, Nda::Runnable *ret);
+    void cacheLiteral(Nda::Runnable *node);
+    static const std::vector<Nda::RunnableCall> &callTable();
+    bool numberLiteral(const std::string &literal, NdaVariant &value) const;
     void run(Nda::Runnable *node);
+    Nada::Error invokeFnc(const Nda::FunctionEntry *fncPtr, NdaVariants &args);
+    void pushParameters(const Nda::FunctionEntry &fnc, NdaVariants &args);
+
+    struct ArrayArgument {                        // f(A[i]): values[value] is the copy of A[i]
+        int        value;
+        NdaVariant target;
+        int64_t    index;
+    };
+    using ArrayArguments = std::vector<ArrayArgument>;
+    void runArgument(Nda::Runnable *node, NdaVariants &values, ArrayArguments &arrayArguments);
+    void writeArrayArguments(const Nda::FunctionEntry *fnc, const ArrayArguments &arrayArguments, const NdaVariants &values);
     bool validateFunctionReturn(const Nda::FunctionEntry &fnc);
+    static bool isAppendAssignment(const NdaParser::ASTNodePtr &node);
+    static void hoistIndexChecks(const NdaParser::ASTNodePtr &loopNode, Nda::Runnable *loop);
+    static bool isLoopInvariant(const NdaParser::ASTNodePtr &node, const std::string &loopVar, const std::string &arrayName);
+    static bool attributeRange(const NdaVariant &value, int64_t &first, int64_t &last);
     void runProgramm(Nda::Runnable *node);
     void runLoopBlock(Nda::Runnable *node);
     void runSingleBlock(Nda::Runnable *node);
@@ -44,6 +101,7 @@ private:
     void runDeclaration(Nda::Runnable *node);
     void runVolatileDeclaration(Nda::Runnable *node);
     void runAssignment(Nda::Runnable *node);
+    void runAppendAssignment(Nda::Runnable *node); // s := s & x
     void runFunctionCall(Nda::Runnable *node);
     void runStaticMethodCall(Nda::Runnable *node);
     void runInstanceMethodCall(Nda::Runnable *node);
@@ -56,6 +114,9 @@ private:
     void runCaseStatement(Nda::Runnable *node);
     void runWhileLoop(Nda::Runnable *node);
     void runForLoopRange(Nda::Runnable *node);
+    void runForLoopAttributeRange(Nda::Runnable *node); // for i in A'Range
+    void runForLoopIterable(Nda::Runnable *node);       // for k in aDict
+    void runForLoopBody(Nda::Runnable *node, int64_t from, int64_t to);
     void runSubStatement(Nda::Runnable *node);
 
     void runBinaryEqual(Nda::Runnable *node);      // "="
@@ -78,8 +139,11 @@ private:
     void runUnaryMinus(Nda::Runnable *node);       // -x
     void runLengthOperator(Nda::Runnable *node);   // #x
     void runAccessOperator(Nda::Runnable *node);   // x[]
+    void runFieldAccess(Nda::Runnable *node);      // x.field
+    void runAttribute(Nda::Runnable *node);        // x'First
 
     void runLoadAddon(Nda::Runnable *node);
+    void runPackage(Nda::Runnable *node);
     void runCreateType(Nda::Runnable *node);
     void runDefineInstanceProcedure(Nda::Runnable *node);
     void runDefineSingleProcedure(Nda::Runnable *node);
@@ -95,11 +159,25 @@ private:
     ExecState       mExecState;
     std::string     mActiveException;
     NdaState       *mState;
+    Nda::RunnableArena mArena;  // owns mRunnable
     Nda::Runnable  *mRunnable;
+    bool            mCachesReleased;
+    int             mRunning;
+
+    struct RunningScope {                         // program: owner of the running tree
+        explicit RunningScope(NdaInterpreter *program) : program(program) { program->mRunning++; }
+        ~RunningScope() { program->mRunning--; }
+        NdaInterpreter *program;
+    };
 
     bool            mHasVolatileAccessTarget;
     std::string     mVolatileAccessSymbol;
     NdaVariant      mVolatileAccessIndex;
+
+    bool            mHasArrayAccessTarget;         // A[i] := x, f(A[i]) -> element is written back
+    NdaVariant      mArrayAccessTarget;
+    int64_t         mArrayAccessIndex;
+    NdaVariant      mArrayElement;
 };
 
 #endif // INTERPRETER_H
@@ -1,78 +1,218 @@
 #include "lexer.h"
 #include <assert.h>
-#include <unordered_set>
+#include <cstring>
 
 #include "exception.h"
 #include "private/utils.h"
 
+namespace {
+
+enum CharClass : unsigned char {
+    Space      = 1 << 0,
+    IdentStart = 1 << 1,
+    IdentPart  = 1 << 2,
+    Digit      = 1 << 3,
+};
+
+struct CharClassTable {
+    unsigned char classes[256];
+    char          lower[256];
+
+    CharClassTable() {
+        for (int c = 0; c < 256; c++) {
+            classes[c] = 0;
+            lower[c]   = (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : char(c);
+        }
+        for (unsigned char c : {' ', '\t', '\n', '\v', '\f', '\r'})
+            classes[c] |= Space;
+        for (int c = 'a'; c <= 'z'; c++) {
+            classes[c]           |= IdentStart | IdentPart;
+            classes[c - 'a' + 'A'] |= IdentStart | IdentPart;
+        }
+        for (int c = '0'; c <= '9'; c++)
+            classes[c] |= Digit | IdentPart;
+        classes[(unsigned char)'_'] |= IdentStart | IdentPart;
+    }
+
+    inline bool is(char c, CharClass cls) const { return classes[(unsigned char)c] & cls; }
+};
+
+const CharClassTable sChars;
+
+// Reserved words and boolean literals are recognized by a perfect hash over length, first,
+// second and last character (collision free for this set, checked when the table is built).
+struct ReservedWordTable {
+    enum { Size = 128, MinLength = 2, MaxLength = 9 };
+
+    struct Entry {
+        std::string         word;
+        NdaLexer::TokenType type;
+    };
+
+    Entry entries[Size];
+
+    static inline unsigned hash(const char *w, size_t len) {
+        return (2 * len + 7 * (unsigned char)sChars.lower[(unsigned char)w[0]]
+                        + 3 * (unsigned char)sChars.lower[(unsigned char)w[1]]
+                        + 5 * (unsigned char)sChars.lower[(unsigned char)w[len-1]]) & (Size - 1);
+    }
+
+    ReservedWordTable() {
+        static const char *const reservedWords[] = {
+            "with", "package", "type", "record", "array", "of",
+            "declare", "volatile",
+            "if", "then", "else", "elsif", "case", "end",
+            "while", "loop", "break", "continue", "when",
+            "for", "in", "out", "reverse",
+            "procedure", "function", "return", "raise", "exception", "others", "is", "begin", "not", "and", "or", "mod", "rem", "xor"
+        };
+        static const char *const booleanLiterals[] = { "true", "false" };
+
+        for (const char *w : reservedWords)
+            add(w, NdaLexer::TokenType::Keyword);
+        for (const char *w : booleanLiterals)
+            add(w, NdaLexer::TokenType::BooleanLiteral);
+    }
+
+    void add(const char *w, NdaLexer::TokenType type) {
+        size_t len = strlen(w);
+        assert(len >= MinLength && len <= MaxLength);
+        Entry &e = entries[hash(w, len)];
+        assert(e.word.empty()); // hash is no longer perfect
+        e.word = w;
+        e.type = type;
+    }
+
+    const Entry *find(const char *w, size_t len) const {
+        if (len < MinLength || len > MaxLength)
+            return nullptr;
+        const Entry &e = entries[hash(w, len)];
+        if (e.word.size() != len)
+            return nullptr;
+        for (size_t i = 0; i < len; i++)
+            if (sChars.lower[(unsigned char)w[i]] != e.word[i])
+                return nullptr;
+        return &e;
+    }
+};
+
+}
+
 //-------------------------------------------------------------------------------------------------
 NdaLexer::NdaLexer(int lookAhead)
-    : mPos(-1)
+    : mScript("")
+    , mLength(0)
+    , mPos(-1)
     , mReadAhead(lookAhead)
+    , mTokenCount(0)
     , mTokenIdx(-1)
 {
     assert(mReadAhead >= 0);
+    mTokens.resize(mReadAhead + 2);
 }
 
 //-------------------------------------------------------------------------------------------------
-void NdaLexer::setScript(const std::string &script)
+void NdaLexer::setScript(std::string script)
 {
+    mOwnedScript = std::move(script);
+    mScript      = mOwnedScript.c_str();
+    mLength      = mOwnedScript.size();
+    reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaLexer::setScript(const char *script, size_t length, int line, int column)
+{
+    mOwnedScript.clear();
     mScript = script;
-    mPos    = -1;
+    mLength = length;
+    reset(line, column);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaLexer::reset(int line, int column)
+{
+    mPos = -1;
 
-    mTokens.clear();
-    mTokenIdx = -1;
+    mTokenCount = 0;
+    mTokenIdx   = -1;
 
-    mRow    = 1;
-    mColumn = 1;
+    mRow    = line;
+    mColumn = column;
 }
 
 //-------------------------------------------------------------------------------------------------
 bool NdaLexer::nextToken()
 {
     while (parseNext()) {
-        int availableTokens = (mTokens.size()-1) - mTokenIdx;
+        int availableTokens = (mTokenCount-1) - mTokenIdx;
         if (availableTokens > mReadAhead)
             break;
     }
-    if (mTokenIdx >= (int)mTokens.size())
+    if (mTokenIdx >= mTokenCount)
         return false;
 
-    auto ret =  ++mTokenIdx < (int)mTokens.size();
+    auto ret =  ++mTokenIdx < mTokenCount;
     return ret;
 }
 
+//-------------------------------------------------------------------------------------------------
+NdaLexer::Token &NdaLexer::pushToken(Nda::StringView v, TokenType t)
+{
+    Token &token = mTokens[mTokenCount++ % mTokens.size()];
+    token.value  = v;
+    token.type   = t;
+    token.row    = mRow;
+    token.column = mColumn - (int)v.size();
+    return token;
+}
+
+//-------------------------------------------------------------------------------------------------
+const NdaLexer::Token *NdaLexer::tokenAt(int relativeIndex) const
+{
+    int absoluteIndex = mTokenIdx + relativeIndex;
+    if ((absoluteIndex < 0) || (absoluteIndex >= mTokenCount))
+        return nullptr;
+
+    // already dropped from the ring buffer
+    assert(absoluteIndex >= mTokenCount - (int)mTokens.size());
+    if (absoluteIndex < mTokenCount - (int)mTokens.size())
+        return nullptr;
+
+    return &mTokens[absoluteIndex % mTokens.size()];
+}
+
 //-------------------------------------------------------------------------------------------------
 bool NdaLexer::token(std::string &token, TokenType &t) const
 {
-    if (mTokens.empty() || (mTokenIdx >= (int)mTokens.size()))
+    auto *tk = tokenAt(0);
+    if (!tk)
         return false;
 
-    token = mTokens[mTokenIdx].value;
-    t     = mTokens[mTokenIdx].type;
+    token = tk->value;
+    t     = tk->type;
 
     return true;
 }
 
 //-------------------------------------------------------------------------------------------------
-std::string NdaLexer::token(int relativeIndex) const
+Nda::StringView NdaLexer::token(int relativeIndex) const
 {
-    int absoluteIndex = mTokenIdx + relativeIndex;
-    if (mTokens.empty() || (absoluteIndex < 0) || (absoluteIndex >= (int)mTokens.size()))
-        return std::string();
+    auto *tk = tokenAt(relativeIndex);
+    if (!tk)
+        return Nda::StringView();
 
-    // std::cout << "TOKEN " << mTokens[absoluteIndex].value << " " << positionToText(relativeIndex) << std::endl;
-    return mTokens[absoluteIndex].value;
+    return tk->value;
 }
 
 //-------------------------------------------------------------------------------------------------
 NdaLexer::TokenType NdaLexer::tokenType(int relativeIndex) const
 {
-    int absoluteIndex = mTokenIdx + relativeIndex;
-    if (mTokens.empty() || (absoluteIndex < 0) || (absoluteIndex >= (int)mTokens.size()))
+    auto *tk = tokenAt(relativeIndex);
+    if (!tk)
         return NdaLexer::TokenType::Unknown;
 
-    return mTokens[absoluteIndex].type;
+    return tk->type;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -81,12 +221,12 @@ bool NdaLexer::tokenPosition(int &row, int &column, int relativeIndex) const
     row    = 0;
     column = 0;
 
-    int absoluteIndex = mTokenIdx + relativeIndex;
-    if (mTokens.empty() || (absoluteIndex < 0) || (absoluteIndex >= (int)mTokens.size()))
+    auto *tk = tokenAt(relativeIndex);
+    if (!tk)
         return false;
 
-    row    = mTokens[absoluteIndex].row;
-    column = mTokens[absoluteIndex].column;
+    row    = tk->row;
+    column = tk->column;
 
     return true;
 }
@@ -104,19 +244,19 @@ std::string NdaLexer::positionToText(int relativeIndex) const
 //-------------------------------------------------------------------------------------------------
 bool NdaLexer::tokenIsValid() const
 {
-    return mTokenIdx >= 0 && mTokenIdx < (int)mTokens.size();
+    return mTokenIdx >= 0 && mTokenIdx < mTokenCount;
 }
 
 //-------------------------------------------------------------------------------------------------
 int NdaLexer::line() const
 {
-    return tokenIsValid() ? mTokens[mTokenIdx].row : mRow;
+    return tokenIsValid() ? tokenAt(0)->row : mRow;
 }
 
 //-------------------------------------------------------------------------------------------------
 int NdaLexer::column() const
 {
-    return tokenIsValid() ? mTokens[mTokenIdx].column : mColumn;
+    return tokenIsValid() ? tokenAt(0)->column : mColumn;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -151,49 +291,29 @@ bool NdaLexer::parseNext()
                 shiftToNext();
             }
 
-            std::string token      = mScript.substr(start, mPos - start);
-            std::string lowerToken = Nda::toLower(token);
+            Nda::StringView token(mScript + start, mPos - start);
             shiftToNext(-1); // 1 Character zuviel eingelesen..
 
-            static const std::unordered_set<std::string> reservedWords = {
-                "with", "type",
-                "declare", "volatile",
-                "if", "then", "else", "elsif", "case", "end",
-                "while", "loop", "break", "continue", "when",
-                "for", "in", "out", "reverse",
-                "procedure", "function", "return", "raise", "exception", "others", "is", "begin", "not", "and", "or", "mod", "rem", "xor"
-            };
-
-            static const std::unordered_set<std::string> booleanLiteral = {
-                "true", "false"
-            };
-
             // Prüfe, ob das Token ein reserviertes Wort ist
-            if (reservedWords.count(lowerToken)) {
-                mTokens.push_back(Token(lowerToken,TokenType::Keyword, mRow, mColumn));
-                return true;
-            } else if (booleanLiteral.count(lowerToken)) {
-                mTokens.push_back(Token(lowerToken,TokenType::BooleanLiteral, mRow,mColumn));
-                return true;
-            }else {
-                mTokens.push_back(Token(token,TokenType::Identifier, mRow,mColumn));
-                return true;
-            }
-            continue;
+            TokenType type;
+            if (auto *word = reservedWord(token.data(), token.size(), type))
+                pushToken(Nda::StringView(*word), type);
+            else
+                pushToken(token, TokenType::Identifier);
+            return true;
         }
 
         // Strings erkennen
         if (currentChar() == '"') {
             size_t start = mPos;  // Startposition des Strings
             shiftToNext();
-            std::string stringLiteral;
-            bool isValid = true;
+            bool hasEscapes = false;
 
             while (!atEnd()) {
                 if (currentChar() == '"') {
                     if (nextChar() == '"') {
                         // Doppelte Anführungszeichen innerhalb des Strings ("" -> ")
-                        stringLiteral += '"';
+                        hasEscapes = true;
                         shiftToNext(2); // Überspringe beide Anführungszeichen
                     } else {
                         // Abschluss des Strings
@@ -201,7 +321,6 @@ bool NdaLexer::parseNext()
                     }
                 } else {
                     // Normaler String-Inhalt
-                    stringLiteral += currentChar();
                     shiftToNext();
                 }
             }
@@ -211,16 +330,27 @@ bool NdaLexer::parseNext()
                     throw NdaException(Nada::Error::UnexpectedEof, mRow, mColumn);
                 else
                     throw NdaException(Nada::Error::InvalidStringLiteral, mRow, mColumn);
-
-                // std::cerr << "Invalid string literal: " << mScript.substr(start, mPos + 1 - start) << "\n";
-                isValid = false;
             }
 
-            if (isValid) {
-                mTokens.push_back(Token(stringLiteral,TokenType::String, mRow, mColumn));
+            Nda::StringView raw(mScript + start + 1, mPos - start - 1);
+            if (!hasEscapes) {
+                pushToken(raw, TokenType::String);
                 return true;
             }
-            continue;
+
+            // escaped quotes: the token owns the unescaped text
+            std::string stringLiteral;
+            stringLiteral.reserve(raw.size());
+            for (size_t i = 0; i < raw.size(); i++) {
+                stringLiteral += raw[i];
+                if (raw[i] == '"')
+                    i++;
+            }
+
+            Token &tk  = pushToken(Nda::StringView(mScript, stringLiteral.size()), TokenType::String);
+            tk.storage = std::move(stringLiteral);
+            tk.value   = Nda::StringView(tk.storage);
+            return true;
         }
 
         // Zahlen erkennen
@@ -252,7 +382,7 @@ bool NdaLexer::parseNext()
                 if (atEnd())
                     throw NdaException(Nada::Error::UnexpectedEof, mRow, mColumn);
                 if (currentChar() != '#')
-                    throw NdaException(Nada::Error::InvalidBasedLiteral, mRow, mColumn, mScript.substr(start, mPos - start));
+                    throw NdaException(Nada::Error::InvalidBasedLiteral, mRow, mColumn, std::string(mScript + start, mPos - start));
                 shiftToNext(); // Überspringe abschließendes "#"
             } else {
                 // Schritt 3: Dezimalpunkt verarbeiten
@@ -274,45 +404,43 @@ bool NdaLexer::parseNext()
                     throw NdaException(Nada::Error::UnexpectedEof, mRow, mColumn);
 
                 if (!isDigit(currentChar()))
-                    // std::cerr << "Invalid exponent: " << mScript.substr(start, mPos - start) << "\n";
-                    throw NdaException(Nada::Error::InvalidExponent, mRow, mColumn, mScript.substr(start, mPos - start));
+                    // std::cerr << "Invalid exponent: " << std::string(mScript + start, mPos - start) << "\n";
+                    throw NdaException(Nada::Error::InvalidExponent, mRow, mColumn, std::string(mScript + start, mPos - start));
                 while (!atEnd() && (isDigit(currentChar()) || currentChar() == '_')) {
                     shiftToNext();
                 }
             }
 
             // Token zurückgeben
-            mTokens.push_back(Token(mScript.substr(start, mPos - start),TokenType::Number, mRow, mColumn));
+            pushToken(Nda::StringView(mScript + start, mPos - start), TokenType::Number);
             shiftToNext(-1);
             return true;
         }
 
         // Mehrstellige Operatoren zuerst prüfen
-        static const std::unordered_set<std::string> twoCharOperators = { ":=", "=>", "**", "<>", "<=", ">=", ".." };
-
-        if (nextChar() != '\0') {
-            std::string twoCharOp = mScript.substr(mPos, 2);
-            if (twoCharOperators.count(twoCharOp)) {
-                mTokens.push_back(Token(twoCharOp,TokenType::Operator, mRow, mColumn));
-                shiftToNext();
-                return true;
-            }
+        char c = currentChar();
+        char n = nextChar();
+        if ((c == ':' && n == '=') || (c == '=' && n == '>') || (c == '*' && n == '*') ||
+            (c == '<' && (n == '>' || n == '=')) || (c == '>' && n == '=') || (c == '.' && n == '.')) {
+            pushToken(Nda::StringView(mScript + mPos, 2), TokenType::Operator);
+            shiftToNext();
+            return true;
         }
 
         // Einfache einstellige Operatoren prüfen
-        static const std::unordered_set<char> singleCharOperators = { '+', '-', '*', '/', '<', '>', '=', '&', '#' };
-        if (singleCharOperators.count(currentChar())) {
-            mTokens.push_back(Token(std::string(1, currentChar()),TokenType::Operator, mRow, mColumn));
+        switch (c) {
+        case '+': case '-': case '*': case '/': case '<': case '>': case '=': case '&': case '#':
+            pushToken(Nda::StringView(mScript + mPos, 1), TokenType::Operator);
             return true;
-        }
 
         // Einzelzeichen-Tokens (Operatoren, Separatoren, etc.)
         // Separatoren
-        if (currentChar() == ';' || currentChar() == ',' || currentChar() == '.' || currentChar() == ':' ||
-            currentChar() == '(' || currentChar() == ')' ||
-            currentChar() == '[' || currentChar() == ']' ||
-            currentChar() == '{' || currentChar() == '}') {
-            mTokens.push_back(Token(std::string(1, currentChar()),TokenType::Separator, mRow, mColumn));
+        case ';': case ',': case '.': case ':':
+        case '(': case ')':
+        case '[': case ']':
+        case '{': case '}':
+        case '\'': // attribute: A'Range
+            pushToken(Nda::StringView(mScript + mPos, 1), TokenType::Separator);
             return true;
         }
 
@@ -326,23 +454,36 @@ bool NdaLexer::parseNext()
 }
 
 //-------------------------------------------------------------------------------------------------
-bool NdaLexer::isWhitespace(char c) const {
-    return std::isspace(c);
+bool NdaLexer::isWhitespace(char c) {
+    return sChars.is(c, Space);
 }
 
 //-------------------------------------------------------------------------------------------------
-bool NdaLexer::isIdentifierStart(char c) const {
-    return std::isalpha(c) || c == '_'; // Buchstaben oder Unterstrich
+bool NdaLexer::isIdentifierStart(char c) {
+    return sChars.is(c, IdentStart); // Buchstaben oder Unterstrich
 }
 
 //-------------------------------------------------------------------------------------------------
-bool NdaLexer::isIdentifierPart(char c) const {
-    return std::isalnum(c) || c == '_'; // Buchstaben, Ziffern oder Unterstrich
+bool NdaLexer::isIdentifierPart(char c) {
+    return sChars.is(c, IdentPart); // Buchstaben, Ziffern oder Unterstrich
 }
 
 //-------------------------------------------------------------------------------------------------
-bool NdaLexer::isDigit(char c) const {
-    return std::isdigit(c);
+bool NdaLexer::isDigit(char c) {
+    return sChars.is(c, Digit);
+}
+
+//-------------------------------------------------------------------------------------------------
+const std::string *NdaLexer::reservedWord(const char *word, size_t length, TokenType &type)
+{
+    static const ReservedWordTable table;
+
+    auto *entry = table.find(word, length);
+    if (!entry)
+        return nullptr;
+
+    type = entry->type;
+    return &entry->word;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -361,7 +502,7 @@ bool NdaLexer::shiftToNext(int step)
         return false;
     mPos += step;
 
-    if (mPos >= 0 && mPos < mScript.length() && mScript[mPos] == '\n') {
+    if (mPos >= 0 && mPos < mLength && mScript[mPos] == '\n') {
         mRow += step > 0 ? +1 : -1;
         mColumn = 0;
     } else if (!atEnd())
@@ -373,11 +514,11 @@ bool NdaLexer::shiftToNext(int step)
 //-------------------------------------------------------------------------------------------------
 bool NdaLexer::atEnd() const
 {
-    return mPos >= mScript.length();
+    return mPos >= mLength;
 }
 
 //-------------------------------------------------------------------------------------------------
-const char &NdaLexer::currentChar() const
+char NdaLexer::currentChar() const
 {
     assert(!atEnd());
     return mScript[mPos];
@@ -386,5 +527,5 @@ const char &NdaLexer::currentChar() const
 //-------------------------------------------------------------------------------------------------
 char NdaLexer::nextChar() const
 {
-    return (mPos + 1 < mScript.size()) ? mScript[mPos + 1] : '\0';
+    return (mPos + 1 < mLength) ? mScript[mPos + 1] : '\0';
 }
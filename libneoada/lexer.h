@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "private/stringview.h"
+
 class NdaException;
 class NdaLexer {
 public:
@@ -21,11 +23,14 @@ public:
     NdaLexer(int lookAhead = 2);
 
     // Hauptmethode: Skript analysieren und für jedes Token den Callback aufrufen
-    void setScript(const std::string& script);
+    void setScript(std::string script);                 // lexer keeps its own copy
+    void setScript(const char *script, size_t length,   // borrowed: must outlive the lexer/tokens
+                   int line = 1, int column = 1);       // position of script[0] in a larger text
     bool nextToken();
     bool token(std::string& token, NdaLexer::TokenType &t) const;
 
-    std::string          token(int relativeIndex = 0) const;
+    // views are valid until the token leaves the look-ahead window (nextToken())
+    Nda::StringView      token(int relativeIndex = 0) const;
     NdaLexer::TokenType tokenType(int relativeIndex = 0) const;
     bool                 tokenPosition(int &row, int &column, int relativeIndex = 0) const;
     std::string          positionToText(int relativeIndex = 0) const;
@@ -37,36 +42,46 @@ public:
 
 private:
     bool parseNext();
+    void reset(int line = 1, int column = 1);
 
     // Hilfsmethoden für das Parsen
-    bool isWhitespace(char c) const;
-    bool isIdentifierStart(char c) const;
-    bool isIdentifierPart(char c) const;
-    bool isDigit(char c) const;
+    static bool isWhitespace(char c);
+    static bool isIdentifierStart(char c);
+    static bool isIdentifierPart(char c);
+    static bool isDigit(char c);
     bool isNumericSuffix(char c) const;
 
+    // Keyword/BooleanLiteral: canonical lowercase spelling; nullptr for identifiers
+    static const std::string *reservedWord(const char *word, size_t length, TokenType &type);
+
     // character-cursor
     bool        shiftToNext(int step = 1);
 
-    const char &currentChar() const;
+    char        currentChar() const;
     char        nextChar() const;
 
-    std::string mScript;
+    std::string mOwnedScript;
+    const char *mScript;
+    size_t      mLength;
     size_t      mPos;
     int         mReadAhead;
     int         mRow;
     int         mColumn;
 
     struct Token {
-        std::string value;
-        TokenType   type;
-        int         row;
-        int         column;
-
-        Token(const std::string &v, TokenType t, int r, int c) : value(v), type(t), row(r), column(c - value.length()) {};
+        Nda::StringView value;
+        TokenType       type;
+        int             row;
+        int             column;
+        std::string     storage; // only for string literals with escaped quotes
     };
 
+    // ring buffer: only the look-ahead window (plus the current token) is kept
+    Token       &pushToken(Nda::StringView v, TokenType t);
+    const Token *tokenAt(int relativeIndex) const;
+
     std::vector<Token> mTokens;
+    int                mTokenCount; // tokens produced so far
     int                mTokenIdx;
 };
 
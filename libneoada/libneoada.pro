@@ -2,20 +2,34 @@
 INCLUDEPATH += $$NEOADA_PATH
 INCLUDEPATH += $$NEOADA_PATH/../
 CONFIG += c++11
+# DEFINES += NEOADA_NO_POOL   # bypass the object pools (sanitizers, valgrind)
 QT     += core 
 
 # Input
 HEADERS += \
     $$NEOADA_PATH/private/type.h \
     $$NEOADA_PATH/private/utils.h \
+    $$NEOADA_PATH/private/stringview.h \
+    $$NEOADA_PATH/private/atomtable.h \
+    $$NEOADA_PATH/private/builtins.h \
     $$NEOADA_PATH/private/symboltable.h \
     $$NEOADA_PATH/private/functiontable.h \
     $$NEOADA_PATH/private/shareddata.h \
+    $$NEOADA_PATH/private/pool.h \
+    $$NEOADA_PATH/private/cyclecollector.h \
     $$NEOADA_PATH/private/sharedstring.h \
     $$NEOADA_PATH/private/sharedlist.h \
     $$NEOADA_PATH/private/sharedbytes.h \
     $$NEOADA_PATH/private/shareddict.h \
+    $$NEOADA_PATH/private/sharedrecord.h \
+    $$NEOADA_PATH/private/sharedarray.h \
+    $$NEOADA_PATH/private/sharedset.h \
+    $$NEOADA_PATH/private/shareddeque.h \
+    $$NEOADA_PATH/private/sharedpriorityqueue.h \
+    $$NEOADA_PATH/private/bignatural.h \
+    $$NEOADA_PATH/private/sharedbignatural.h \
     $$NEOADA_PATH/private/numericparser.h \
+    $$NEOADA_PATH/private/numberformat.h \
     $$NEOADA_PATH/lexer.h \
     $$NEOADA_PATH/parser.h \
     $$NEOADA_PATH/interpreter.h \
@@ -24,8 +38,12 @@ HEADERS += \
     $$NEOADA_PATH/neoadaapi.h \
     $$NEOADA_PATH/exception.h \
     $$NEOADA_PATH/runtime.h \
+    $$NEOADA_PATH/document.h \
     $$NEOADA_PATH/addons/AdaList.h \
     $$NEOADA_PATH/addons/AdaDict.h \
+    $$NEOADA_PATH/addons/AdaSet.h \
+    $$NEOADA_PATH/addons/AdaDeque.h \
+    $$NEOADA_PATH/addons/AdaPriorityQueue.h \
     $$NEOADA_PATH/addons/AdaBytes.h \
     $$NEOADA_PATH/addons/AdaString.h \
     $$NEOADA_PATH/addons/AdaMath.h \
@@ -34,20 +52,36 @@ HEADERS += \
     $$NEOADA_PATH/addons/AdaDateTime.h \
     $$NEOADA_PATH/addons/AdaRegexp.h \
     $$NEOADA_PATH/addons/AdaJson.h \
+    $$NEOADA_PATH/private/arena.h \
     $$NEOADA_PATH/private/runnable.h \
+    $$NEOADA_PATH/private/programimage.h \
+    $$NEOADA_PATH/private/columnevaluator.h \
+    $$NEOADA_PATH/private/packagecache.h \
     $$NEOADA_PATH/value.h
 
 SOURCES += \
     $$NEOADA_PATH/private/type.cc \
     $$NEOADA_PATH/private/utils.cc \
+    $$NEOADA_PATH/private/atomtable.cc \
+    $$NEOADA_PATH/private/builtins.cc \
     $$NEOADA_PATH/private/symboltable.cc \
     $$NEOADA_PATH/private/functiontable.cc \
     $$NEOADA_PATH/private/shareddata.cc \
+    $$NEOADA_PATH/private/pool.cc \
+    $$NEOADA_PATH/private/cyclecollector.cc \
     $$NEOADA_PATH/private/sharedstring.cc \
     $$NEOADA_PATH/private/sharedlist.cc \
     $$NEOADA_PATH/private/sharedbytes.cc \
     $$NEOADA_PATH/private/shareddict.cc \
+    $$NEOADA_PATH/private/sharedrecord.cc \
+    $$NEOADA_PATH/private/sharedarray.cc \
+    $$NEOADA_PATH/private/sharedset.cc \
+    $$NEOADA_PATH/private/shareddeque.cc \
+    $$NEOADA_PATH/private/sharedpriorityqueue.cc \
+    $$NEOADA_PATH/private/bignatural.cc \
+    $$NEOADA_PATH/private/sharedbignatural.cc \
     $$NEOADA_PATH/private/numericparser.cc \
+    $$NEOADA_PATH/private/numberformat.cc \
     $$NEOADA_PATH/lexer.cc \
     $$NEOADA_PATH/parser.cc \
     $$NEOADA_PATH/interpreter.cc \
@@ -56,8 +90,12 @@ SOURCES += \
     $$NEOADA_PATH/neoadaapi.cc \
     $$NEOADA_PATH/exception.cc \
     $$NEOADA_PATH/runtime.cc \
+    $$NEOADA_PATH/document.cc \
     $$NEOADA_PATH/addons/AdaList.cc \
     $$NEOADA_PATH/addons/AdaDict.cc \
+    $$NEOADA_PATH/addons/AdaSet.cc \
+    $$NEOADA_PATH/addons/AdaDeque.cc \
+    $$NEOADA_PATH/addons/AdaPriorityQueue.cc \
     $$NEOADA_PATH/addons/AdaBytes.cc \
     $$NEOADA_PATH/addons/AdaString.cc \
     $$NEOADA_PATH/addons/AdaMath.cc \
@@ -66,7 +104,11 @@ SOURCES += \
     $$NEOADA_PATH/addons/AdaDateTime.cc \
     $$NEOADA_PATH/addons/AdaRegexp.cc \
     $$NEOADA_PATH/addons/AdaJson.cc \
+    $$NEOADA_PATH/private/arena.cc \
     $$NEOADA_PATH/private/runnable.cc \
+    $$NEOADA_PATH/private/programimage.cc \
+    $$NEOADA_PATH/private/columnevaluator.cc \
+    $$NEOADA_PATH/private/packagecache.cc \
     $$NEOADA_PATH/value.cc
 
 DISTFILES += \
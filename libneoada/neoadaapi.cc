@@ -1,36 +1,332 @@
 
 #include <iostream>
+#include <list>
+#include <unordered_map>
 #include "neoadaapi.h"
 #include "lexer.h"
 #include "parser.h"
 #include "interpreter.h"
 #include "exception.h"
+#include "private/columnevaluator.h"
+#include "private/utils.h"
+
+namespace Nda
+{
+
+struct CompiledExpression
+{
+    CompiledExpression(NdaState *state, const std::string &src) : interpreter(state), program(nullptr), source(src) {}
+
+    NdaInterpreter interpreter; // owns the program, attached to the state
+    Nda::Runnable *program;
+    std::string    source;
+};
+
+}
+
+namespace
+{
+
+using CompiledExpressionPtr = std::shared_ptr<Nda::CompiledExpression>;
+
+//-------------------------------------------------------------------------------------------------
+class ExpressionCache
+{
+public:
+    ExpressionCache() : mCapacity(64) {}
+
+    CompiledExpressionPtr find(const std::string &key) {
+        auto it = mIndex.find(key);
+        if (it == mIndex.end())
+            return nullptr;
+        mEntries.splice(mEntries.begin(), mEntries, it->second); // most recently used
+        return it->second->second;
+    }
+
+    void insert(const std::string &key, const CompiledExpressionPtr &expression) {
+        if (mCapacity == 0)
+            return;
+        auto it = mIndex.find(key);
+        if (it != mIndex.end()) {
+            mEntries.erase(it->second);
+            mIndex.erase(it);
+        }
+        mEntries.emplace_front(key, expression);
+        mIndex[key] = mEntries.begin();
+        trim();
+    }
+
+    void setCapacity(size_t capacity) {
+        mCapacity = capacity;
+        trim();
+    }
+
+    inline size_t size() const { return mEntries.size(); }
+
+private:
+    void trim() {
+        while (mEntries.size() > mCapacity) {
+            mIndex.erase(mEntries.back().first);
+            mEntries.pop_back();
+        }
+    }
+
+    using Entry = std::pair<std::string, CompiledExpressionPtr>;
+
+    size_t                                                        mCapacity;
+    std::list<Entry>                                              mEntries;
+    std::unordered_map<std::string, std::list<Entry>::iterator>   mIndex;
+};
+
+// per thread, like the state itself
+thread_local ExpressionCache tCache;
+
+//-------------------------------------------------------------------------------------------------
+std::string cacheKey(const std::string &source, const NdaState &state)
+{
+    // prepared trees refer to the atoms of their state
+    const NdaState *address = &state;
+    std::string key = source;
+    key.append(reinterpret_cast<const char*>(&address), sizeof(address));
+    return key;
+}
+
+//-------------------------------------------------------------------------------------------------
+CompiledExpressionPtr prepare(const std::string &source, NdaState &state)
+{
+    const std::string key = cacheKey(source, state);
+
+    auto ret = tCache.find(key);
+    if (ret && ret->interpreter.state() == &state) // else: another state at the same address
+        return ret;
+
+    NdaLexer  lexer;
+    NdaParser parser(lexer);
+    auto ast = parser.parse(source); // throws
+
+    ret = std::make_shared<Nda::CompiledExpression>(&state, source);
+    ret->program = ret->interpreter.load(ast); // the AST is released right after lowering
+    tCache.insert(key, ret);
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+// binds the columns as variables of the state and runs the program once per row
+bool evaluateRows(Nda::CompiledExpression &compiled, NdaState &state, const std::vector<NeoAda::Column> &columns,
+                  size_t rows, NeoAda::ResultColumn &result)
+{
+    using NeoAda::Column;
+    static const char *const typeNames[] = { "Number", "Natural", "Boolean", "String" };
+
+    std::vector<NdaVariant*> values;
+    for (const auto &column : columns) {
+        const std::string name = Nda::toLower(column.name);
+        Nda::Symbol *symbol;
+        if (!state.find(name, &symbol)) {
+            if (!state.define(name, typeNames[column.type]) || !state.find(name, &symbol))
+                throw NdaException(Nada::Error::DeclarationError, 0, 0, column.name);
+        }
+        values.push_back(symbol->value);
+    }
+
+    result = NeoAda::ResultColumn();
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t c = 0; c < columns.size(); c++) {
+            const Column &column = columns[c];
+            switch (column.type) {
+            case Column::Number:
+                values[c]->fromNumber(state.numberType(), static_cast<const double*>(column.values)[row]);
+                break;
+            case Column::Natural:
+                values[c]->fromNatural(state.naturalType(), static_cast<const int64_t*>(column.values)[row]);
+                break;
+            case Column::Boolean:
+                values[c]->fromBool(state.booleanType(), static_cast<const bool*>(column.values)[row]);
+                break;
+            case Column::String: {
+                const int64_t *offsets = static_cast<const int64_t*>(column.values) + row;
+                values[c]->fromString(state.stringType(), std::string(column.chars + offsets[0], (size_t)(offsets[1] - offsets[0])));
+            } break;
+            }
+        }
+
+        NdaVariant ret = compiled.interpreter.evaluate(compiled.program);
+        if (state.hasUnhandledException()) // ret is no result of the row
+            throw NdaException(Nada::Error::UnhandledException, 0, 0, "row " + std::to_string(row) + ": " + state.unhandledException());
+
+        // the first row decides the type of the result column
+        Column::Type type;
+        switch (ret.type()) {
+        case Nda::Number:  type = Column::Number;  break;
+        case Nda::Natural: type = Column::Natural; break;
+        case Nda::Boolean: type = Column::Boolean; break;
+        case Nda::String:  type = Column::String;  break;
+        default:
+            throw NdaException(Nada::Error::AssignmentError, 0, 0, "row " + std::to_string(row));
+        }
+        if (row == 0) {
+            result.type = type;
+            if (type == Column::String)
+                result.offsets.push_back(0);
+        } else if (type != result.type) {
+            throw NdaException(Nada::Error::AssignmentError, 0, 0, "row " + std::to_string(row));
+        }
+
+        switch (type) {
+        case Column::Number:  result.numbers.push_back(ret.toDouble());      break;
+        case Column::Natural: result.naturals.push_back(ret.toInt64());      break;
+        case Column::Boolean: result.booleans.push_back(ret.toBool() ? 1 : 0); break;
+        case Column::String:
+            result.chars += ret.toString();
+            result.offsets.push_back((int64_t)result.chars.size());
+            break;
+        }
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void report(const NdaException &ex, NeoAda::Exception *exception)
+{
+    if (exception)
+        *exception = ex;
+    else
+        std::cerr << ex.what() << std::endl;
+}
+
+}
 
 namespace NeoAda
 {
 
 //-------------------------------------------------------------------------------------------------
-NdaVariant evaluate(const std::string &shortScript, NdaState &state, Exception *exception)
+bool Expression::isValid() const
 {
-    NdaLexer       lexer;
-    NdaParser      parser(lexer);
-    NdaInterpreter interpreter(&state);
+    return d && d->program && d->interpreter.state();
+}
 
+//-------------------------------------------------------------------------------------------------
+const std::string &Expression::source() const
+{
+    static const std::string empty;
+    return d ? d->source : empty;
+}
+
+//-------------------------------------------------------------------------------------------------
+Expression compile(const std::string &shortScript, NdaState &state, Exception *exception)
+{
+    Expression ret;
+    try {
+        ret.d = prepare(shortScript, state);
+    } catch (NdaException &ex) {
+        report(ex, exception);
+    }
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant evaluate(const Expression &expression, NdaState &state, Exception *exception)
+{
+    if (!expression.isValid() || expression.d->interpreter.state() != &state) {
+        report(NdaException(Nada::Error::InvalidExpression, 0, 0, expression.source()), exception);
+        return NdaVariant();
+    }
+
+    try {
+        NdaVariant ret = expression.d->interpreter.evaluate(expression.d->program);
+        if (!state.hasUnhandledException())
+            return ret;
+        report(NdaException(Nada::Error::UnhandledException, 0, 0, state.unhandledException()), exception);
+    } catch (NdaException &ex) {
+        report(ex, exception);
+    }
+
+    return NdaVariant();
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant evaluate(const std::string &shortScript, NdaState &state, Exception *exception)
+{
     state.reset();
     try {
-        auto ast = parser.parse(shortScript);
-        auto ret = interpreter.execute(ast);
+        auto compiled = prepare(shortScript, state);
+        auto ret = compiled->interpreter.execute(compiled->program);
         ret.dereference();
         return ret;
     } catch (NdaException &ex) {
-        if (exception)
-            *exception = ex;
-        else
-            std::cerr << ex.what() << std::endl;
+        report(ex, exception);
     }
 
     return NdaVariant();
 }
 
+//-------------------------------------------------------------------------------------------------
+Column::Column(const std::string &name, const double *values)
+    : name(name), type(Number), values(values), chars(nullptr)
+{
+}
+
+Column::Column(const std::string &name, const int64_t *values)
+    : name(name), type(Natural), values(values), chars(nullptr)
+{
+}
+
+Column::Column(const std::string &name, const bool *values)
+    : name(name), type(Boolean), values(values), chars(nullptr)
+{
+}
+
+Column::Column(const std::string &name, const char *chars, const int64_t *offsets)
+    : name(name), type(String), values(offsets), chars(chars)
+{
 }
 
+//-------------------------------------------------------------------------------------------------
+size_t ResultColumn::size() const
+{
+    switch (type) {
+    case Column::Number:  return numbers.size();
+    case Column::Natural: return naturals.size();
+    case Column::Boolean: return booleans.size();
+    case Column::String:  return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool evaluateBatch(const Expression &expression, NdaState &state, const std::vector<Column> &columns, size_t rows,
+                   ResultColumn &result, Exception *exception)
+{
+    result = ResultColumn();
+    if (!expression.isValid() || expression.d->interpreter.state() != &state) {
+        report(NdaException(Nada::Error::InvalidExpression, 0, 0, expression.source()), exception);
+        return false;
+    }
+
+    try {
+        Nda::ColumnEvaluator columnEvaluator(expression.d->interpreter, state);
+        if (columnEvaluator.compile(expression.d->program, columns) && columnEvaluator.run(rows, result))
+            return true;
+
+        return evaluateRows(*expression.d, state, columns, rows, result);
+    } catch (NdaException &ex) {
+        report(ex, exception);
+    }
+
+    result = ResultColumn();
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+void setCacheCapacity(size_t capacity)
+{
+    tCache.setCapacity(capacity);
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t cacheSize()
+{
+    return tCache.size();
+}
+
+}
@@ -1,15 +1,98 @@
 #ifndef NEOADAAPI_H
 #define NEOADAAPI_H
 
+#include <cstdint>
+#include <memory>
+#include <vector>
 #include "state.h"
 #include "variant.h"
 
 class NdaException;
+namespace Nda { struct CompiledExpression; }
+
 namespace NeoAda
 {
 using Exception = NdaException;
 
-NdaVariant evaluate(const std::string &shortScript, NdaState &state, Exception *exception = nullptr);
+struct Column;
+struct ResultColumn;
+
+/*
+    Expression
+
+    Prepared script, bound to the state it was compiled for. Evaluating it again only runs the
+    prepared tree: no lexer, parser or reset of the state. The host updates its bindings in the
+    state (NdaState::define/valueRef) between two evaluations; declarations of the script are
+    local to one evaluation.
+
+    compile() and evaluate(shortScript) share an LRU cache of prepared scripts per thread, keyed
+    on the source text and the state.
+*/
+class Expression
+{
+public:
+    Expression() = default;
+
+    bool               isValid() const;    // false: compile error, or the state was destroyed
+    const std::string &source() const;
+
+private:
+    friend Expression compile(const std::string &, NdaState &, Exception *);
+    friend NdaVariant evaluate(const Expression &, NdaState &, Exception *);
+    friend bool evaluateBatch(const Expression &, NdaState &, const std::vector<Column> &, size_t, ResultColumn &, Exception *);
+
+    std::shared_ptr<Nda::CompiledExpression> d;
+};
+
+Expression compile(const std::string &shortScript, NdaState &state, Exception *exception = nullptr);
+NdaVariant evaluate(const Expression &expression, NdaState &state, Exception *exception = nullptr);
+
+NdaVariant evaluate(const std::string &shortScript, NdaState &state, Exception *exception = nullptr); // resets the state
+
+/*
+    Column
+
+    Borrowed host data of a batch evaluation, one value per row. Strings are stored back to back:
+    row i is chars[offsets[i] .. offsets[i+1]), so there are rows + 1 offsets.
+*/
+struct Column
+{
+    enum Type { Number, Natural, Boolean, String };
+
+    Column(const std::string &name, const double *values);
+    Column(const std::string &name, const int64_t *values);
+    Column(const std::string &name, const bool *values);
+    Column(const std::string &name, const char *chars, const int64_t *offsets);
+
+    std::string  name;    // variable name in the expression
+    Type         type;
+    const void  *values;  // double, int64_t, bool or the string offsets
+    const char  *chars;
+};
+
+struct ResultColumn
+{
+    Column::Type         type = Column::Boolean;
+    std::vector<double>  numbers;
+    std::vector<int64_t> naturals;
+    std::vector<uint8_t> booleans;
+    std::string          chars;    // strings like Column
+    std::vector<int64_t> offsets;
+
+    size_t size() const;
+};
+
+/*
+    Evaluates the expression for every row of the columns. "return <expression>;" made of
+    literals, columns, variables of the state and the arithmetic, comparison and boolean operators
+    runs column at a time; everything else (and rows the vector loops can't reproduce exactly,
+    like overflows or a division by zero) runs row by row with the columns bound as variables.
+*/
+bool       evaluateBatch(const Expression &expression, NdaState &state, const std::vector<Column> &columns, size_t rows,
+                         ResultColumn &result, Exception *exception = nullptr);
+
+void       setCacheCapacity(size_t capacity); // prepared scripts, 0: no cache
+size_t     cacheSize();
 }
 
 
@@ -2,28 +2,79 @@
 #include "parser.h"
 #include "exception.h"
 #include "variant.h"
+#include "private/arena.h"
 #include <cassert>
+#include <new>
 #include <unordered_set>
 
+//-------------------------------------------------------------------------------------------------
+struct NdaParser::AST::Storage {
+    Nda::BumpArena        memory;
+    std::vector<ASTNode*> nodes;  // not trivially destructible (value)
+
+    ~Storage() {
+        for (auto *node : nodes)
+            node->~ASTNode();
+    }
+};
+
 //-------------------------------------------------------------------------------------------------
 NdaParser::NdaParser(NdaLexer &lexer)
     : mLexer(lexer)
+    , mCurrentNode(nullptr)
+    , mStorage(nullptr)
 {
 }
 
 //-------------------------------------------------------------------------------------------------
-NdaParser::ASTNodePtr NdaParser::parse(const std::string &script) {
+NdaParser::~NdaParser()
+{
+    delete mStorage;
+}
 
-    mLexer.setScript(script);
+//-------------------------------------------------------------------------------------------------
+NdaParser::AST NdaParser::parse(const std::string &script) {
+    return parseProgram(script.data(), script.size(), 1, 1, nullptr);
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaParser::AST NdaParser::parse(const char *script, size_t length, int line, int column,
+                                std::vector<StatementEnd> &statementEnds)
+{
+    statementEnds.clear();
+    return parseProgram(script, length, line, column, &statementEnds);
+}
 
-    auto programNode = std::make_shared<ASTNode>(ASTNodeType::Program, mLexer.line(), mLexer.column());
+//-------------------------------------------------------------------------------------------------
+NdaParser::AST NdaParser::parseProgram(const char *script, size_t length, int line, int column,
+                                       std::vector<StatementEnd> *statementEnds)
+{
+    delete mStorage; // left over from a failed parse
+    mStorage = new AST::Storage();
+
+    mLexer.setScript(script, length, line, column); // borrowed for the duration of the parse
+
+    auto programNode = createNode(ASTNodeType::Program, mLexer.line(), mLexer.column());
     while (mLexer.nextToken()) {
         auto declarationNode = parseStatement();
-        if (declarationNode)
-            ASTNode::addChild(programNode,declarationNode);
+        if (!declarationNode)
+            continue;
+        addChild(programNode,declarationNode);
+
+        if (statementEnds) {
+            // current token: the ";" of the statement, a view into the script; the lexer
+            // continues behind it with column + 1 (see NdaLexer::pushToken())
+            const Nda::StringView separator = mLexer.token();
+            statementEnds->push_back(StatementEnd{(size_t)(separator.data() + separator.size() - script),
+                                                  mLexer.line(), mLexer.column() + 1});
+        }
     }
 
-    return programNode;
+    AST ret;
+    ret.mStorage = mStorage;
+    ret.mRoot    = programNode;
+    mStorage = nullptr;
+    return ret;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -57,6 +108,8 @@ NdaParser::ASTNodePtr NdaParser::parseStatement()
         return parseSeparator(parseProcedureOrFunction());
     } else if (mLexer.tokenType() == NdaLexer::TokenType::Keyword && mLexer.token() == "with") {
         return parseSeparator(parseWith());
+    } else if (mLexer.tokenType() == NdaLexer::TokenType::Keyword && mLexer.token() == "package") {
+        return parseSeparator(parsePackage());
     } else if (mLexer.tokenType() == NdaLexer::TokenType::Keyword && mLexer.token() == "type") {
         return parseSeparator(parseType());
     } else if (mLexer.tokenType() == NdaLexer::TokenType::Identifier) {
@@ -70,43 +123,43 @@ NdaParser::ASTNodePtr NdaParser::parseStatement()
 }
 
 //-------------------------------------------------------------------------------------------------
-NdaParser::ASTNodePtr cloneAstNode(const NdaParser::ASTNodePtr &node)
+NdaParser::ASTNodePtr NdaParser::cloneNode(const NdaParser::ASTNodePtr &node)
 {
-    auto copy = std::make_shared<NdaParser::ASTNode>(node->type, node->line, node->column, node->value.displayValue);
+    auto copy = createNode(node->type, node->line, node->column, node->value.displayValue);
     for (const auto &child : node->children)
-        NdaParser::ASTNode::addChild(copy,cloneAstNode(child));
+        addChild(copy,cloneNode(child));
     return copy;
 }
 
-NdaParser::ASTNodePtr makeDeclarationNode(NdaParser::ASTNodeType declarationType,
-                                          const std::string &name,
-                                          const std::string &typeName,
-                                          const NdaParser::ASTNodePtr &expressionNode,
-                                          int line,
-                                          int column)
+NdaParser::ASTNodePtr NdaParser::makeDeclarationNode(NdaParser::ASTNodeType declarationType,
+                                                     const std::string &name,
+                                                     const std::string &typeName,
+                                                     const NdaParser::ASTNodePtr &expressionNode,
+                                                     int line,
+                                                     int column)
 {
-    auto declarationNode = std::make_shared<NdaParser::ASTNode>(declarationType,line,column,name);
-    auto typeNode = std::make_shared<NdaParser::ASTNode>(NdaParser::ASTNodeType::Identifier,line,column,typeName);
-    NdaParser::ASTNode::addChild(declarationNode,typeNode);
+    auto declarationNode = createNode(declarationType,line,column,name);
+    auto typeNode = createNode(NdaParser::ASTNodeType::Identifier,line,column,typeName);
+    addChild(declarationNode,typeNode);
     if (expressionNode)
-        NdaParser::ASTNode::addChild(declarationNode,cloneAstNode(expressionNode));
+        addChild(declarationNode,cloneNode(expressionNode));
     return declarationNode;
 }
 
 
-NdaParser::ASTNodePtr makeFormalParameterNode(const std::string &name,
-                                              const std::string &typeName,
-                                              const std::string &mode,
-                                              int line,
-                                              int column)
+NdaParser::ASTNodePtr NdaParser::makeFormalParameterNode(const std::string &name,
+                                                         const std::string &typeName,
+                                                         const std::string &mode,
+                                                         int line,
+                                                         int column)
 {
-    auto parameterNode = std::make_shared<NdaParser::ASTNode>(NdaParser::ASTNodeType::FormalParameter,line,column,name);
-    auto parameterType = std::make_shared<NdaParser::ASTNode>(NdaParser::ASTNodeType::Identifier,line,column,typeName);
-    NdaParser::ASTNode::addChild(parameterNode,parameterType);
+    auto parameterNode = createNode(NdaParser::ASTNodeType::FormalParameter,line,column,name);
+    auto parameterType = createNode(NdaParser::ASTNodeType::Identifier,line,column,typeName);
+    addChild(parameterNode,parameterType);
 
     if (!mode.empty()) {
-        auto parameterMode = std::make_shared<NdaParser::ASTNode>(NdaParser::ASTNodeType::FormalParameterMode,line,column,mode);
-        NdaParser::ASTNode::addChild(parameterNode,parameterMode);
+        auto parameterMode = createNode(NdaParser::ASTNodeType::FormalParameterMode,line,column,mode);
+        addChild(parameterNode,parameterMode);
     }
 
     return parameterNode;
@@ -169,7 +222,7 @@ NdaParser::ASTNodePtr NdaParser::parseDeclaration()
         throw NdaException(Nada::Error::IdentifierExpected,mLexer.line(), mLexer.column(),mLexer.token());
 
     std::string typeName = mLexer.token();
-    ASTNodePtr expressionNode;
+    ASTNodePtr expressionNode = nullptr;
 
     if (mLexer.token(1) == ":=") {
         mLexer.nextToken();       // jump to   ":="
@@ -184,9 +237,9 @@ NdaParser::ASTNodePtr NdaParser::parseDeclaration()
     if (names.size() == 1)
         return makeDeclarationNode(declarationType,names[0],typeName,expressionNode,line,column);
 
-    auto groupNode = std::make_shared<ASTNode>(ASTNodeType::DeclarationGroup,line,column);
+    auto groupNode = createNode(ASTNodeType::DeclarationGroup,line,column);
     for (const auto &name : names)
-        ASTNode::addChild(groupNode,makeDeclarationNode(declarationType,name,typeName,expressionNode,line,column));
+        addChild(groupNode,makeDeclarationNode(declarationType,name,typeName,expressionNode,line,column));
     return groupNode;
 }
 
@@ -221,7 +274,7 @@ NdaParser::ASTNodePtr NdaParser::parseLocalDeclaration()
         throw NdaException(Nada::Error::IdentifierExpected,mLexer.line(), mLexer.column(),mLexer.token());
 
     std::string typeName = mLexer.token();
-    ASTNodePtr expressionNode;
+    ASTNodePtr expressionNode = nullptr;
 
     if (mLexer.token(1) == ":=") {
         mLexer.nextToken();
@@ -236,9 +289,9 @@ NdaParser::ASTNodePtr NdaParser::parseLocalDeclaration()
     if (names.size() == 1)
         return makeDeclarationNode(ASTNodeType::Declaration,names[0],typeName,expressionNode,line,column);
 
-    auto groupNode = std::make_shared<ASTNode>(ASTNodeType::DeclarationGroup,line,column);
+    auto groupNode = createNode(ASTNodeType::DeclarationGroup,line,column);
     for (const auto &name : names)
-        ASTNode::addChild(groupNode,makeDeclarationNode(ASTNodeType::Declaration,name,typeName,expressionNode,line,column));
+        addChild(groupNode,makeDeclarationNode(ASTNodeType::Declaration,name,typeName,expressionNode,line,column));
     return groupNode;
 }
 
@@ -263,10 +316,63 @@ NdaParser::ASTNodePtr NdaParser::parseWith()
             throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
     }
 
-    auto withNode = std::make_shared<ASTNode>(ASTNodeType::WithAddon,mLexer.line(), mLexer.column(), addonName);
+    auto withNode = createNode(ASTNodeType::WithAddon,mLexer.line(), mLexer.column(), addonName);
     return withNode;
 }
 
+//-------------------------------------------------------------------------------------------------
+NdaParser::ASTNodePtr NdaParser::parsePackage()
+
+//    package Utils is
+//        function Twice(x : Natural) return Natural is ... end Twice;   -> Utils:Twice(x)
+//    end Utils;
+
+{
+    if (!mLexer.nextToken())
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column());
+    if (mLexer.tokenType() != NdaLexer::TokenType::Identifier)
+        throw NdaException(Nada::Error::IdentifierExpected,mLexer.line(), mLexer.column(),mLexer.token());
+
+    auto packageNode = createNode(ASTNodeType::Package, mLexer.line(), mLexer.column(), mLexer.token());
+
+    if (!mLexer.nextToken())
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column());
+    if (mLexer.token() != "is")
+        throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
+
+    while (true) {
+        if (!mLexer.nextToken())
+            throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column());
+
+        if (mLexer.tokenType() != NdaLexer::TokenType::Keyword)
+            throw NdaException(Nada::Error::InvalidStatement,mLexer.line(), mLexer.column(),mLexer.token());
+
+        if (mLexer.token() == "end")
+            break;
+
+        if (mLexer.token() == "procedure" || mLexer.token() == "function") {
+            auto subprogramNode = parseSeparator(parseProcedureOrFunction());
+            if (subprogramNode->children[0]->type != ASTNodeType::MethodContext) // static method of the package
+                prependChild(subprogramNode,createNode(ASTNodeType::MethodContext, subprogramNode->line, subprogramNode->column,
+                                                       packageNode->value.displayValue));
+            addChild(packageNode,subprogramNode);
+        } else if (mLexer.token() == "type") {
+            addChild(packageNode,parseSeparator(parseType()));
+        } else
+            throw NdaException(Nada::Error::InvalidStatement,mLexer.line(), mLexer.column(),mLexer.token());
+    }
+
+    if (mLexer.token(1) != ";") {
+        if (!mLexer.nextToken())
+            throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+
+        if (Nda::toLower(mLexer.token()) != packageNode->value.lowerValue)
+            throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
+    }
+
+    return packageNode;
+}
+
 //-------------------------------------------------------------------------------------------------
 NdaParser::ASTNodePtr NdaParser::parseType()
 {
@@ -295,15 +401,25 @@ NdaParser::ASTNodePtr NdaParser::parseType()
     if (!mLexer.nextToken())
         throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
 
+    if (mLexer.tokenType() == NdaLexer::TokenType::Keyword && mLexer.token() == "record") {
+        auto typeNode = createNode(ASTNodeType::TypeDefinition,mLexer.line(), mLexer.column(), typeName);
+        return parseRecordDefinition(typeNode);
+    }
+
+    if (mLexer.tokenType() == NdaLexer::TokenType::Keyword && mLexer.token() == "array") {
+        auto typeNode = createNode(ASTNodeType::TypeDefinition,mLexer.line(), mLexer.column(), typeName);
+        return parseArrayDefinition(typeNode);
+    }
+
     if (mLexer.tokenType() != NdaLexer::TokenType::Identifier)
         throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
 
 
     baseName = mLexer.token();
 
-    auto typeNode = std::make_shared<ASTNode>(ASTNodeType::TypeDefinition,mLexer.line(), mLexer.column(), typeName);
-    auto baseNode = std::make_shared<ASTNode>(ASTNodeType::Identifier,mLexer.line(), mLexer.column(), baseName);
-    ASTNode::addChild(typeNode,baseNode);
+    auto typeNode = createNode(ASTNodeType::TypeDefinition,mLexer.line(), mLexer.column(), typeName);
+    auto baseNode = createNode(ASTNodeType::Identifier,mLexer.line(), mLexer.column(), baseName);
+    addChild(typeNode,baseNode);
 
     /*
     while (mLexer.token(1) != ";") {
@@ -326,29 +442,136 @@ NdaParser::ASTNodePtr NdaParser::parseType()
 }
 
 //-------------------------------------------------------------------------------------------------
-NdaParser::ASTNodePtr NdaParser::parseIdentifier()
+NdaParser::ASTNodePtr NdaParser::parseRecordDefinition(ASTNodePtr &typeNode)
 {
-    auto identifierNode = std::make_shared<ASTNode>(ASTNodeType::Identifier,mLexer.line(), mLexer.column(), mLexer.token());
+    // type Point is record
+    //    X, Y : Number;
+    // end record;
 
-    if (handleIdentifierCall(identifierNode)) {
+    assert(mLexer.token() == "record");
+    addChild(typeNode,createNode(ASTNodeType::Identifier,mLexer.line(), mLexer.column(), "record"));
+
+    if (!mLexer.nextToken())
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+
+    while (mLexer.token() != "end") {
+        std::vector<std::pair<std::string,int>> names; // name, column
+        int line = mLexer.line();
         while (true) {
-            if (handleIdentifierCall(identifierNode)) {
-            }
-            else if (handleIdentifierAccess(identifierNode)) {
-            }
-            else {
+            if (mLexer.tokenType() != NdaLexer::TokenType::Identifier)
+                throw NdaException(Nada::Error::IdentifierExpected,mLexer.line(), mLexer.column(),mLexer.token());
+            names.push_back({mLexer.token(), mLexer.column()});
+            if (!mLexer.nextToken())
+                throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+            if (mLexer.token() != ",")
                 break;
-            }
+            if (!mLexer.nextToken())
+                throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
         }
-        return identifierNode;
+
+        if (mLexer.token() != ":")
+            throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
+        if (!mLexer.nextToken())
+            throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+        if (mLexer.tokenType() != NdaLexer::TokenType::Identifier)
+            throw NdaException(Nada::Error::IdentifierExpected,mLexer.line(), mLexer.column(),mLexer.token());
+
+        for (const auto &name : names) {
+            auto fieldNode = createNode(ASTNodeType::RecordField,line,name.second,name.first);
+            addChild(fieldNode,createNode(ASTNodeType::Identifier,mLexer.line(), mLexer.column(), mLexer.token()));
+            addChild(typeNode,fieldNode);
+        }
+
+        parseSeparator(typeNode);
+        if (!mLexer.nextToken())
+            throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
     }
 
-    handleIdentifierAccess(identifierNode);
+    if (!mLexer.nextToken())
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+    if (mLexer.token() != "record")
+        throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
+
+    return typeNode;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaParser::ASTNodePtr NdaParser::parseArrayDefinition(ASTNodePtr &typeNode)
+{
+    // type Vector is array (1 .. 3) of Number;
+    // -> TypeDefinition(Identifier("array"), Range(from, to), Identifier(elementType))
+
+    assert(mLexer.token() == "array");
+    addChild(typeNode,createNode(ASTNodeType::Identifier,mLexer.line(), mLexer.column(), "array"));
+
+    if (!mLexer.nextToken())
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+    if (mLexer.token() != "(")
+        throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
+    if (!mLexer.nextToken())
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+
+    auto rangeNode = createNode(ASTNodeType::Range, mLexer.line(), mLexer.column());
+    addChild(rangeNode,parseExpression());
+
+    if (!mLexer.nextToken())
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+    if (mLexer.token() != "..")
+        throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
+    if (!mLexer.nextToken())
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+
+    addChild(rangeNode,parseExpression());
+    addChild(typeNode,rangeNode);
+
+    if (!mLexer.nextToken())
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+    if (mLexer.token() != ")")
+        throw NdaException(Nada::Error::UnexpectedClosure,mLexer.line(), mLexer.column(),mLexer.token());
+
+    if (!mLexer.nextToken())
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+    if (mLexer.token() != "of")
+        throw NdaException(Nada::Error::KeywordExpected,mLexer.line(), mLexer.column(),"of");
+
+    if (!mLexer.nextToken())
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+    if (mLexer.tokenType() != NdaLexer::TokenType::Identifier)
+        throw NdaException(Nada::Error::IdentifierExpected,mLexer.line(), mLexer.column(),mLexer.token());
+
+    addChild(typeNode,createNode(ASTNodeType::Identifier,mLexer.line(), mLexer.column(), mLexer.token()));
+
+    return typeNode;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaParser::ASTNodePtr NdaParser::parseIdentifier()
+{
+    auto identifierNode = createNode(ASTNodeType::Identifier,mLexer.line(), mLexer.column(), mLexer.token());
+
+    while (true) {
+        if (handleIdentifierCall(identifierNode)) {
+        }
+        else if (handleIdentifierAccess(identifierNode)) {
+        }
+        else {
+            break;
+        }
+    }
+
+    switch (identifierNode->type) {
+    case ASTNodeType::FunctionCall:
+    case ASTNodeType::StaticMethodCall:
+    case ASTNodeType::InstanceMethodCall:
+        return identifierNode;
+    default:
+        break;
+    }
 
     mLexer.nextToken();
 
     if (mLexer.token() == ":=") {
-        auto assignmentNode = std::make_shared<ASTNode>(ASTNodeType::Assignment,mLexer.line(), mLexer.column(), mLexer.token());
+        auto assignmentNode = createNode(ASTNodeType::Assignment,mLexer.line(), mLexer.column(), mLexer.token());
 
         if (!mLexer.nextToken())
             throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
@@ -357,8 +580,8 @@ NdaParser::ASTNodePtr NdaParser::parseIdentifier()
         if (!expressionNode)
             return NdaParser::ASTNodePtr();
 
-        ASTNode::addChild(assignmentNode,identifierNode);
-        ASTNode::addChild(assignmentNode,expressionNode);
+        addChild(assignmentNode,identifierNode);
+        addChild(assignmentNode,expressionNode);
 
         return assignmentNode;
 
@@ -376,7 +599,7 @@ NdaParser::ASTNodePtr NdaParser::parseProcedureOrFunction()
 {
     bool isFunction = mLexer.token() == "function";
 
-    auto procedureNode = std::make_shared<ASTNode>(isFunction ? ASTNodeType::Function :
+    auto procedureNode = createNode(isFunction ? ASTNodeType::Function :
                                                                 ASTNodeType::Procedure,
                                                     mLexer.line(), mLexer.column(),
                                                     mLexer.token());
@@ -390,8 +613,8 @@ NdaParser::ASTNodePtr NdaParser::parseProcedureOrFunction()
     bool isMethod = mLexer.token(1) == ":";
 
     if (isMethod) {
-        auto typeNode = std::make_shared<ASTNode>(ASTNodeType::MethodContext, mLexer.line(), mLexer.column(), mLexer.token());
-        ASTNode::addChild(procedureNode,typeNode);
+        auto typeNode = createNode(ASTNodeType::MethodContext, mLexer.line(), mLexer.column(), mLexer.token());
+        addChild(procedureNode,typeNode);
         mLexer.nextToken();      // to ":"
         if (!mLexer.nextToken()) // to method-name
             throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column());
@@ -402,7 +625,7 @@ NdaParser::ASTNodePtr NdaParser::parseProcedureOrFunction()
         throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column());
 
     auto parameterNode = parseFormalParameterList();
-    ASTNode::addChild(procedureNode,parameterNode);
+    addChild(procedureNode,parameterNode);
 
     if (isFunction) {
         // function Add(a : in Natural; b : in Natural) return Natural is
@@ -414,8 +637,8 @@ NdaParser::ASTNodePtr NdaParser::parseProcedureOrFunction()
         if (mLexer.tokenType() != NdaLexer::TokenType::Identifier)
             throw NdaException(Nada::Error::IdentifierExpected,mLexer.line(), mLexer.column(),mLexer.token());
 
-        auto returnNode = std::make_shared<ASTNode>(ASTNodeType::ReturnType, mLexer.line(), mLexer.column(), mLexer.token());
-        ASTNode::addChild(procedureNode,returnNode);
+        auto returnNode = createNode(ASTNodeType::ReturnType, mLexer.line(), mLexer.column(), mLexer.token());
+        addChild(procedureNode,returnNode);
 
         mLexer.nextToken();
     }
@@ -441,9 +664,9 @@ NdaParser::ASTNodePtr NdaParser::parseProcedureOrFunction()
 
     auto blockNode = parseBlockEnd("exception");
     for (auto it = localDeclarations.rbegin(); it != localDeclarations.rend(); ++it)
-        ASTNode::prependChild(blockNode,*it);
+        prependChild(blockNode,*it);
     if (mLexer.token() == "exception")
-        ASTNode::addChild(blockNode,parseExceptionHandlers());
+        addChild(blockNode,parseExceptionHandlers());
 
     if (mLexer.token(1) != ";") {
         if (mLexer.tokenType(1) != NdaLexer::TokenType::Identifier)
@@ -456,7 +679,7 @@ NdaParser::ASTNodePtr NdaParser::parseProcedureOrFunction()
             throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
     }
 
-    ASTNode::addChild(procedureNode,blockNode);
+    addChild(procedureNode,blockNode);
 
     return procedureNode;
 }
@@ -464,7 +687,7 @@ NdaParser::ASTNodePtr NdaParser::parseProcedureOrFunction()
 //-------------------------------------------------------------------------------------------------
 NdaParser::ASTNodePtr NdaParser::parseWhileLoop()
 {
-    auto whileNode = std::make_shared<ASTNode>(ASTNodeType::WhileLoop, mLexer.line(), mLexer.column());
+    auto whileNode = createNode(ASTNodeType::WhileLoop, mLexer.line(), mLexer.column());
     if (!mLexer.nextToken())
         throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
 
@@ -473,7 +696,7 @@ NdaParser::ASTNodePtr NdaParser::parseWhileLoop()
     if (!condition) // hmm assert?
         throw NdaException(Nada::Error::UnexpectedStructure,mLexer.line(), mLexer.column(),mLexer.token());
 
-    ASTNode::addChild(whileNode,condition);
+    addChild(whileNode,condition);
 
     mLexer.nextToken();
     if (mLexer.token() != "loop")
@@ -481,13 +704,13 @@ NdaParser::ASTNodePtr NdaParser::parseWhileLoop()
     mLexer.nextToken();
 
     // 3. Parse den Block (Statements zwischen 'loop' und 'end loop')
-    auto blockNode = std::make_shared<ASTNode>(ASTNodeType::Block, mLexer.line(), mLexer.column());
-    ASTNode::addChild(whileNode,blockNode);
+    auto blockNode = createNode(ASTNodeType::Block, mLexer.line(), mLexer.column());
+    addChild(whileNode,blockNode);
 
     while (mLexer.token() != "end") {
         auto nextStatement = parseStatement();
         if (nextStatement)
-            ASTNode::addChild(blockNode,nextStatement);
+            addChild(blockNode,nextStatement);
         mLexer.nextToken();
     }
     mLexer.nextToken(); // Überspringe end 'loop'
@@ -498,7 +721,7 @@ NdaParser::ASTNodePtr NdaParser::parseWhileLoop()
 //-------------------------------------------------------------------------------------------------
 NdaParser::ASTNodePtr NdaParser::parseForLoop()
 {
-    auto forNode = std::make_shared<ASTNode>(ASTNodeType::ForLoop, mLexer.line(), mLexer.column());
+    auto forNode = createNode(ASTNodeType::ForLoop, mLexer.line(), mLexer.column());
 
     // consume "for"
     if (!mLexer.nextToken())
@@ -542,8 +765,8 @@ NdaParser::ASTNodePtr NdaParser::parseForLoop()
     // "loop" consumed by "parseSeparator()"
 
     forNode->value = loopVar;
-    ASTNode::addChild(forNode,iterableOrRangeNode);
-    ASTNode::addChild(forNode,bodyNode);
+    addChild(forNode,iterableOrRangeNode);
+    addChild(forNode,bodyNode);
 
     return forNode;
 }
@@ -571,15 +794,15 @@ NdaParser::ASTNodePtr NdaParser::parseIfStatement()
     mLexer.nextToken(); // Consume "then"
 
     // Erstelle den IfStatement-Knoten
-    auto ifNode = std::make_shared<ASTNode>(ASTNodeType::IfStatement, mLexer.line(), mLexer.column());
-    ASTNode::addChild(ifNode,conditionNode);
+    auto ifNode = createNode(ASTNodeType::IfStatement, mLexer.line(), mLexer.column());
+    addChild(ifNode,conditionNode);
 
     // 2. Parse den "then"-Block
     auto thenBlock = parseBlockEnd("elsif", "else");
     if (!thenBlock)
         throw NdaException(Nada::Error::UnexpectedStructure,mLexer.line(), mLexer.column());
 
-    ASTNode::addChild(ifNode,thenBlock);
+    addChild(ifNode,thenBlock);
 
     // 3. Optional: Parse "elsif"-Blöcke
     while (mLexer.token() == "elsif") {
@@ -598,10 +821,10 @@ NdaParser::ASTNodePtr NdaParser::parseIfStatement()
         if (!elsifBlock)
             throw NdaException(Nada::Error::UnexpectedStructure,mLexer.line(), mLexer.column());
 
-        auto elsifNode = std::make_shared<ASTNode>(ASTNodeType::Elsif, mLexer.line(), mLexer.column());
-        ASTNode::addChild(elsifNode,elsifCondition);
-        ASTNode::addChild(elsifNode,elsifBlock);
-        ASTNode::addChild(ifNode,elsifNode);
+        auto elsifNode = createNode(ASTNodeType::Elsif, mLexer.line(), mLexer.column());
+        addChild(elsifNode,elsifCondition);
+        addChild(elsifNode,elsifBlock);
+        addChild(ifNode,elsifNode);
     }
 
     // 4. Optional: Parse "else"-Block
@@ -612,9 +835,9 @@ NdaParser::ASTNodePtr NdaParser::parseIfStatement()
         if (!elseBlock)
             throw NdaException(Nada::Error::UnexpectedStructure,mLexer.line(), mLexer.column());
 
-        auto elseNode = std::make_shared<ASTNode>(ASTNodeType::Else, mLexer.line(), mLexer.column());
-        ASTNode::addChild(elseNode,elseBlock);
-        ASTNode::addChild(ifNode,elseNode);
+        auto elseNode = createNode(ASTNodeType::Else, mLexer.line(), mLexer.column());
+        addChild(elseNode,elseBlock);
+        addChild(ifNode,elseNode);
     }
 
     // 5. Erwarte "end if"
@@ -651,8 +874,8 @@ NdaParser::ASTNodePtr NdaParser::parseCaseStatement()
     if (!mLexer.nextToken())
         throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
 
-    auto caseNode = std::make_shared<ASTNode>(ASTNodeType::CaseStatement, mLexer.line(), mLexer.column());
-    ASTNode::addChild(caseNode,expressionNode);
+    auto caseNode = createNode(ASTNodeType::CaseStatement, mLexer.line(), mLexer.column());
+    addChild(caseNode,expressionNode);
 
     std::unordered_set<std::string> staticChoices;
     bool hasOthers = false;
@@ -661,7 +884,7 @@ NdaParser::ASTNodePtr NdaParser::parseCaseStatement()
         if (!mLexer.nextToken())
             throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
 
-        auto whenNode = std::make_shared<ASTNode>(ASTNodeType::CaseWhen, mLexer.line(), mLexer.column(), mLexer.token());
+        auto whenNode = createNode(ASTNodeType::CaseWhen, mLexer.line(), mLexer.column(), mLexer.token());
 
         bool isOthers = mLexer.token() == "others";
         if (!isOthers) {
@@ -676,7 +899,7 @@ NdaParser::ASTNodePtr NdaParser::parseCaseStatement()
                 staticChoices.insert(staticChoice);
             }
 
-            ASTNode::addChild(whenNode,choiceNode);
+            addChild(whenNode,choiceNode);
             if (!mLexer.nextToken())
                 throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
         } else {
@@ -696,8 +919,8 @@ NdaParser::ASTNodePtr NdaParser::parseCaseStatement()
         auto blockNode = parseBlockEnd("when");
         if (isOthers && mLexer.token() == "when")
             throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
-        ASTNode::addChild(whenNode,blockNode);
-        ASTNode::addChild(caseNode,whenNode);
+        addChild(whenNode,blockNode);
+        addChild(caseNode,whenNode);
     }
 
     if (mLexer.token() != "end")
@@ -723,7 +946,7 @@ NdaParser::ASTNodePtr NdaParser::parseBlockStatement()
 
     auto blockNode = parseBlockEnd("exception");
     if (mLexer.token() == "exception")
-        ASTNode::addChild(blockNode,parseExceptionHandlers());
+        addChild(blockNode,parseExceptionHandlers());
 
     if (mLexer.token() != "end")
         throw NdaException(Nada::Error::KeywordExpected,mLexer.line(), mLexer.column(),"end");
@@ -734,7 +957,7 @@ NdaParser::ASTNodePtr NdaParser::parseBlockStatement()
 //-------------------------------------------------------------------------------------------------
 NdaParser::ASTNodePtr NdaParser::parseReturn()
 {
-    auto returnNode = std::make_shared<ASTNode>(ASTNodeType::Return, mLexer.line(), mLexer.column());
+    auto returnNode = createNode(ASTNodeType::Return, mLexer.line(), mLexer.column());
 
     if (mLexer.token(1) != ";") { // optional expression present?
 
@@ -746,7 +969,7 @@ NdaParser::ASTNodePtr NdaParser::parseReturn()
         if (!expression) // assert?
             throw NdaException(Nada::Error::UnexpectedStructure,mLexer.line(), mLexer.column());
 
-        ASTNode::addChild(returnNode,expression);
+        addChild(returnNode,expression);
     }
 
     return returnNode;
@@ -755,7 +978,7 @@ NdaParser::ASTNodePtr NdaParser::parseReturn()
 //-------------------------------------------------------------------------------------------------
 NdaParser::ASTNodePtr NdaParser::parseRaise()
 {
-    auto raiseNode = std::make_shared<ASTNode>(ASTNodeType::Raise, mLexer.line(), mLexer.column());
+    auto raiseNode = createNode(ASTNodeType::Raise, mLexer.line(), mLexer.column());
 
     if (mLexer.token(1) == ";")
         return raiseNode;
@@ -766,8 +989,8 @@ NdaParser::ASTNodePtr NdaParser::parseRaise()
     if (mLexer.tokenType() != NdaLexer::TokenType::Identifier)
         throw NdaException(Nada::Error::IdentifierExpected,mLexer.line(), mLexer.column(),mLexer.token());
 
-    auto identifierNode = std::make_shared<ASTNode>(ASTNodeType::Identifier, mLexer.line(), mLexer.column(), mLexer.token());
-    ASTNode::addChild(raiseNode,identifierNode);
+    auto identifierNode = createNode(ASTNodeType::Identifier, mLexer.line(), mLexer.column(), mLexer.token());
+    addChild(raiseNode,identifierNode);
 
     return raiseNode;
 }
@@ -775,7 +998,7 @@ NdaParser::ASTNodePtr NdaParser::parseRaise()
 //-------------------------------------------------------------------------------------------------
 NdaParser::ASTNodePtr NdaParser::parseExceptionHandlers()
 {
-    auto exceptionNode = std::make_shared<ASTNode>(ASTNodeType::Exception, mLexer.line(), mLexer.column());
+    auto exceptionNode = createNode(ASTNodeType::Exception, mLexer.line(), mLexer.column());
 
     if (mLexer.token() != "exception")
         throw NdaException(Nada::Error::KeywordExpected,mLexer.line(), mLexer.column(),"exception");
@@ -790,7 +1013,7 @@ NdaParser::ASTNodePtr NdaParser::parseExceptionHandlers()
         if (mLexer.tokenType() != NdaLexer::TokenType::Identifier && mLexer.token() != "others")
             throw NdaException(Nada::Error::IdentifierExpected,mLexer.line(), mLexer.column(),mLexer.token());
 
-        auto handlerNode = std::make_shared<ASTNode>(ASTNodeType::ExceptionHandler, mLexer.line(), mLexer.column(), mLexer.token());
+        auto handlerNode = createNode(ASTNodeType::ExceptionHandler, mLexer.line(), mLexer.column(), mLexer.token());
 
         if (!mLexer.nextToken())
             throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
@@ -802,8 +1025,8 @@ NdaParser::ASTNodePtr NdaParser::parseExceptionHandlers()
             throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
 
         auto blockNode = parseBlockEnd("when");
-        ASTNode::addChild(handlerNode,blockNode);
-        ASTNode::addChild(exceptionNode,handlerNode);
+        addChild(handlerNode,blockNode);
+        addChild(exceptionNode,handlerNode);
     }
 
     if (mLexer.token() != "end")
@@ -816,7 +1039,7 @@ NdaParser::ASTNodePtr NdaParser::parseExceptionHandlers()
 NdaParser::ASTNodePtr NdaParser::parseBreak()
 //             break [when expression]
 {
-    auto breakNode = std::make_shared<ASTNode>(ASTNodeType::Break, mLexer.line(), mLexer.column());
+    auto breakNode = createNode(ASTNodeType::Break, mLexer.line(), mLexer.column());
     if (mLexer.token(1) != "when")
         return breakNode;
 
@@ -829,14 +1052,14 @@ NdaParser::ASTNodePtr NdaParser::parseBreak()
     if (!expression) // assert?
         throw NdaException(Nada::Error::UnexpectedStructure,mLexer.line(), mLexer.column());
 
-    ASTNode::addChild(breakNode,expression);
+    addChild(breakNode,expression);
     return breakNode;
 }
 
 //-------------------------------------------------------------------------------------------------
 NdaParser::ASTNodePtr NdaParser::parseContinue()
 {
-    auto contNode = std::make_shared<ASTNode>(ASTNodeType::Continue, mLexer.line(), mLexer.column());
+    auto contNode = createNode(ASTNodeType::Continue, mLexer.line(), mLexer.column());
 
     if (mLexer.token(1) != "when")
         return contNode;
@@ -850,7 +1073,7 @@ NdaParser::ASTNodePtr NdaParser::parseContinue()
     if (!expression) // assert?
         throw NdaException(Nada::Error::UnexpectedStructure,mLexer.line(), mLexer.column());
 
-    ASTNode::addChild(contNode,expression);
+    addChild(contNode,expression);
 
     return contNode;
 }
@@ -858,7 +1081,7 @@ NdaParser::ASTNodePtr NdaParser::parseContinue()
 //-------------------------------------------------------------------------------------------------
 NdaParser::ASTNodePtr NdaParser::parseBlockEnd(const std::string &endToken1, const std::string &endToken2)
 {
-    auto blockNode = std::make_shared<ASTNode>(ASTNodeType::Block, mLexer.line(), mLexer.column());
+    auto blockNode = createNode(ASTNodeType::Block, mLexer.line(), mLexer.column());
 
     while (mLexer.token() != "end" && mLexer.token() != endToken1 && (endToken2.empty() || mLexer.token() != endToken2)) {
         auto statementNode = parseStatement();
@@ -868,7 +1091,7 @@ NdaParser::ASTNodePtr NdaParser::parseBlockEnd(const std::string &endToken1, con
         if (mLexer.token() != ";")
             throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
 
-        ASTNode::addChild(blockNode,statementNode);
+        addChild(blockNode,statementNode);
         if (!mLexer.nextToken())
             throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
     }
@@ -876,7 +1099,7 @@ NdaParser::ASTNodePtr NdaParser::parseBlockEnd(const std::string &endToken1, con
 }
 
 //-------------------------------------------------------------------------------------------------
-NdaParser::ASTNodePtr NdaParser::parseSeparator(const std::shared_ptr<ASTNode> &currentNode)
+NdaParser::ASTNodePtr NdaParser::parseSeparator(const ASTNodePtr &currentNode)
 {
     if (!currentNode)
         return currentNode;
@@ -893,7 +1116,7 @@ NdaParser::ASTNodePtr NdaParser::parseSeparator(const std::shared_ptr<ASTNode> &
 //-------------------------------------------------------------------------------------------------
 NdaParser::ASTNodePtr NdaParser::parseFormalParameterList()
 {
-    auto parametersNode = std::make_shared<ASTNode>(ASTNodeType::FormalParameters, mLexer.line(), mLexer.column());
+    auto parametersNode = createNode(ASTNodeType::FormalParameters, mLexer.line(), mLexer.column());
 
     if (mLexer.token() != "(")
         return parametersNode;
@@ -937,7 +1160,7 @@ NdaParser::ASTNodePtr NdaParser::parseFormalParameterList()
         std::string paramType = mLexer.token();
 
         for (const auto &paramName : paramNames)
-            ASTNode::addChild(parametersNode,makeFormalParameterNode(paramName,paramType,paramMode,line,column));
+            addChild(parametersNode,makeFormalParameterNode(paramName,paramType,paramMode,line,column));
 
         mLexer.nextToken();     // Consume parameterType
 
@@ -955,6 +1178,7 @@ std::string NdaParser::nodeTypeToString(ASTNodeType type)
     switch (type) {
     case ASTNodeType::Program:      return "Program";
     case ASTNodeType::WithAddon:    return "WithAddon";
+    case ASTNodeType::Package:      return "Package";
     case ASTNodeType::Procedure:    return "Procedure";
     case ASTNodeType::Function:     return "Function";
     case ASTNodeType::FormalParameters:  return "Parameters";
@@ -963,6 +1187,7 @@ std::string NdaParser::nodeTypeToString(ASTNodeType type)
     case ASTNodeType::Declaration:       return "Declaration";
     case ASTNodeType::DeclarationGroup:  return "DeclarationGroup";
     case ASTNodeType::TypeDefinition:    return "TypeDefinition";
+    case ASTNodeType::RecordField:       return "RecordField";
     case ASTNodeType::VolatileDeclaration:  return "Volatile";
     case ASTNodeType::Assignment:     return "Assignment";
     case ASTNodeType::Expression:     return "Expression";
@@ -977,6 +1202,8 @@ std::string NdaParser::nodeTypeToString(ASTNodeType type)
     case ASTNodeType::FunctionCall:   return "FunctionCall";
     case ASTNodeType::StaticMethodCall:   return "StaticMethodCall";
     case ASTNodeType::InstanceMethodCall: return "InstanceMethodCall";
+    case ASTNodeType::FieldAccess:        return "FieldAccess";
+    case ASTNodeType::Attribute:          return "Attribute";
     case ASTNodeType::IfStatement:  return "If";
     case ASTNodeType::CaseStatement: return "Case";
     case ASTNodeType::CaseWhen:      return "CaseWhen";
@@ -1002,11 +1229,6 @@ std::string NdaParser::nodeTypeToString(ASTNodeType type)
 //                                             ASTNode
 //-------------------------------------------------------------------------------------------------
 
-//-------------------------------------------------------------------------------------------------
-NdaParser::ASTNode::~ASTNode()
-{
-}
-
 std::string NdaParser::ASTNode::serialize(int depth) const
 {
     std::string indent(depth * 2, ' '); // Einrückung
@@ -1018,17 +1240,93 @@ std::string NdaParser::ASTNode::serialize(int depth) const
 }
 
 //-------------------------------------------------------------------------------------------------
-void NdaParser::ASTNode::addChild(std::shared_ptr<ASTNode> parent, std::shared_ptr<ASTNode> child)
+NdaParser::AST::AST()
+    : mStorage(nullptr), mRoot(nullptr)
 {
-    parent->children.push_back(child);
-    child->parent = parent.get();
 }
 
 //-------------------------------------------------------------------------------------------------
-void NdaParser::ASTNode::prependChild(std::shared_ptr<ASTNode> parent, std::shared_ptr<ASTNode> child)
+NdaParser::AST::AST(AST &&other)
+    : mStorage(other.mStorage), mRoot(other.mRoot)
 {
-    parent->children.insert(parent->children.begin(),child);
-    child->parent = parent.get();
+    other.mStorage = nullptr;
+    other.mRoot    = nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaParser::AST &NdaParser::AST::operator=(AST &&other)
+{
+    if (this != &other) {
+        delete mStorage;
+        mStorage = other.mStorage;
+        mRoot    = other.mRoot;
+        other.mStorage = nullptr;
+        other.mRoot    = nullptr;
+    }
+    return *this;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaParser::AST::~AST()
+{
+    delete mStorage;
+}
+
+//-------------------------------------------------------------------------------------------------
+int NdaParser::AST::nodeCount() const
+{
+    return mStorage ? (int)mStorage->nodes.size() : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t NdaParser::AST::memoryUsage() const
+{
+    return mStorage ? mStorage->memory.memoryUsage() : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaParser::ASTNodePtr NdaParser::createNode(ASTNodeType type, int line, int column, const std::string &value)
+{
+    assert(mStorage);
+    auto *node = ::new (mStorage->memory.allocate(sizeof(ASTNode))) ASTNode(type, line, column, value);
+    mStorage->nodes.push_back(node);
+    return node;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaParser::reserveChild(ASTNodeList &list)
+{
+    if (list.mSize < list.mCapacity)
+        return;
+
+    // the old array stays in the arena until the AST is released
+    size_t capacity = list.mCapacity ? 2 * list.mCapacity : 4;
+    auto **data = static_cast<ASTNode**>(mStorage->memory.allocate(capacity * sizeof(ASTNode*)));
+    for (size_t i = 0; i < list.mSize; i++)
+        data[i] = list.mData[i];
+
+    list.mData     = data;
+    list.mCapacity = capacity;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaParser::addChild(const ASTNodePtr &parent, const ASTNodePtr &child)
+{
+    reserveChild(parent->children);
+    parent->children.mData[parent->children.mSize++] = child;
+    child->parent = parent;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaParser::prependChild(const ASTNodePtr &parent, const ASTNodePtr &child)
+{
+    auto &list = parent->children;
+    reserveChild(list);
+    for (size_t i = list.mSize; i > 0; i--)
+        list.mData[i] = list.mData[i-1];
+    list.mData[0] = child;
+    list.mSize++;
+    child->parent = parent;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1038,11 +1336,11 @@ NdaParser::ASTNodePtr NdaParser::parseExpression()
 
     while (mLexer.token(1) == "and" || mLexer.token(1) == "or" || mLexer.token(1) == "xor") {
         mLexer.nextToken();
-        auto operatorNode = std::make_shared<ASTNode>(ASTNodeType::BinaryOperator, mLexer.line(), mLexer.column(), mLexer.token());
-        ASTNode::addChild(operatorNode,left);
+        auto operatorNode = createNode(ASTNodeType::BinaryOperator, mLexer.line(), mLexer.column(), mLexer.token());
+        addChild(operatorNode,left);
         mLexer.nextToken(); // Hole den Operator
         auto right = parseSimpleExpression();
-        ASTNode::addChild(operatorNode,right);
+        addChild(operatorNode,right);
         left = operatorNode;
     }
 
@@ -1068,8 +1366,8 @@ NdaParser::ASTNodePtr NdaParser::parseSimpleExpression()
 
     if (hasUnaryOperator) {
         auto term = left;
-        left = std::make_shared<ASTNode>(ASTNodeType::UnaryOperator, mLexer.line(), mLexer.column(),unaryOperator);
-        ASTNode::addChild(left,term);
+        left = createNode(ASTNodeType::UnaryOperator, mLexer.line(), mLexer.column(),unaryOperator);
+        addChild(left,term);
     }
 
     while (mLexer.token(1) == "="  || mLexer.token(1) == "<>" ||
@@ -1078,11 +1376,11 @@ NdaParser::ASTNodePtr NdaParser::parseSimpleExpression()
            mLexer.token(1) == "<=" || mLexer.token(1) == ">=")
     {
         mLexer.nextToken();
-        auto operatorNode = std::make_shared<ASTNode>(ASTNodeType::BinaryOperator, mLexer.line(), mLexer.column(), mLexer.token());
-        ASTNode::addChild(operatorNode,left);
+        auto operatorNode = createNode(ASTNodeType::BinaryOperator, mLexer.line(), mLexer.column(), mLexer.token());
+        addChild(operatorNode,left);
         mLexer.nextToken(); // Hole den Operator
         auto right = parseTerm();
-        ASTNode::addChild(operatorNode,right);
+        addChild(operatorNode,right);
         left = operatorNode;
     }
 
@@ -1096,11 +1394,11 @@ NdaParser::ASTNodePtr NdaParser::parseTerm()
 
     while (mLexer.token(1) == "*" || mLexer.token(1) == "/" || mLexer.token(1) == "mod" || mLexer.token(1) == "rem") {
         mLexer.nextToken();
-        auto operatorNode = std::make_shared<ASTNode>(ASTNodeType::BinaryOperator, mLexer.line(), mLexer.column(), mLexer.token());
-        ASTNode::addChild(operatorNode,left);
+        auto operatorNode = createNode(ASTNodeType::BinaryOperator, mLexer.line(), mLexer.column(), mLexer.token());
+        addChild(operatorNode,left);
         mLexer.nextToken(); // Hole den Operator
         auto right = parseFactor();
-        ASTNode::addChild(operatorNode,right);
+        addChild(operatorNode,right);
         left = operatorNode;
     }
 
@@ -1113,11 +1411,11 @@ NdaParser::ASTNodePtr NdaParser::parseFactor()
     auto left = parsePrimary();
     if (mLexer.token(1) == "**") {
         mLexer.nextToken();
-        auto operatorNode = std::make_shared<ASTNode>(ASTNodeType::BinaryOperator, mLexer.line(), mLexer.column(), mLexer.token());
-        ASTNode::addChild(operatorNode,left);
+        auto operatorNode = createNode(ASTNodeType::BinaryOperator, mLexer.line(), mLexer.column(), mLexer.token());
+        addChild(operatorNode,left);
         mLexer.nextToken(); // Hole den Potenzierungsoperator
         auto right = parsePrimary();
-        ASTNode::addChild(operatorNode,right);
+        addChild(operatorNode,right);
         return operatorNode;
     }
 
@@ -1146,13 +1444,13 @@ NdaParser::ASTNodePtr NdaParser::parsePrimary()
     auto node = NdaParser::ASTNodePtr();
 
     if (tokenType == NdaLexer::TokenType::Number) {
-        node = std::make_shared<ASTNode>(ASTNodeType::Number, mLexer.line(), mLexer.column(), token);
+        node = createNode(ASTNodeType::Number, mLexer.line(), mLexer.column(), token);
     } else if (tokenType == NdaLexer::TokenType::BooleanLiteral) {
-        node = std::make_shared<ASTNode>(ASTNodeType::BooleanLiteral, mLexer.line(), mLexer.column(), token);
+        node = createNode(ASTNodeType::BooleanLiteral, mLexer.line(), mLexer.column(), token);
     }else if (tokenType == NdaLexer::TokenType::String) {
-        node = std::make_shared<ASTNode>(ASTNodeType::Literal, mLexer.line(), mLexer.column(), token);
+        node = createNode(ASTNodeType::Literal, mLexer.line(), mLexer.column(), token);
     } else if (tokenType == NdaLexer::TokenType::Identifier) {
-        node = std::make_shared<ASTNode>(ASTNodeType::Identifier, mLexer.line(), mLexer.column(), token);
+        node = createNode(ASTNodeType::Identifier, mLexer.line(), mLexer.column(), token);
 
         if (!handleIdentifierCall(node))   // call()  ?
             handleIdentifierAccess(node);  // array[] ?
@@ -1165,9 +1463,9 @@ NdaParser::ASTNodePtr NdaParser::parsePrimary()
         if (!mLexer.nextToken()) // Überspringe '('
             throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
 
-        node = std::make_shared<ASTNode>(ASTNodeType::Expression, mLexer.line(), mLexer.column());
+        node = createNode(ASTNodeType::Expression, mLexer.line(), mLexer.column());
         auto expression = parseExpression();
-        ASTNode::addChild(node,expression);
+        addChild(node,expression);
 
         if (!mLexer.nextToken())
             throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
@@ -1181,8 +1479,8 @@ NdaParser::ASTNodePtr NdaParser::parsePrimary()
     if (hasUnaryOperator) {
         // hmm: runtime error? Bool or Strings can't have unary operators!
         auto term = node;
-        node = std::make_shared<ASTNode>(ASTNodeType::UnaryOperator, mLexer.line(), mLexer.column(),unaryOperator);
-        ASTNode::addChild(node,term);
+        node = createNode(ASTNodeType::UnaryOperator, mLexer.line(), mLexer.column(),unaryOperator);
+        addChild(node,term);
     }
     return node;
 }
@@ -1212,6 +1510,8 @@ NdaParser::ASTNodePtr NdaParser::parsePrimary()
         }
         else if (handleIdentifierAccess(node)) {
         }
+        else if (handleIdentifierAttribute(node)) {
+        }
         else {
             break;
         }
@@ -1219,8 +1519,8 @@ NdaParser::ASTNodePtr NdaParser::parsePrimary()
 
     if (hasUnaryOperator) {
         auto term = node;
-        node = std::make_shared<ASTNode>(ASTNodeType::UnaryOperator, mLexer.line(), mLexer.column(), unaryOperator);
-        ASTNode::addChild(node, term);
+        node = createNode(ASTNodeType::UnaryOperator, mLexer.line(), mLexer.column(), unaryOperator);
+        addChild(node, term);
     }
 
     return node;
@@ -1235,19 +1535,19 @@ NdaParser::ASTNodePtr NdaParser::parseAtom()
     if (!mLexer.token(token, tokenType))
         throw NdaException(Nada::Error::UnexpectedEof, mLexer.line(), mLexer.column(), mLexer.token());
 
-    ASTNodePtr node;
+    ASTNodePtr node = nullptr;
 
     if (tokenType == NdaLexer::TokenType::Number) {
-        node = std::make_shared<ASTNode>(ASTNodeType::Number, mLexer.line(), mLexer.column(), token);
+        node = createNode(ASTNodeType::Number, mLexer.line(), mLexer.column(), token);
     }
     else if (tokenType == NdaLexer::TokenType::BooleanLiteral) {
-        node = std::make_shared<ASTNode>(ASTNodeType::BooleanLiteral, mLexer.line(), mLexer.column(), token);
+        node = createNode(ASTNodeType::BooleanLiteral, mLexer.line(), mLexer.column(), token);
     }
     else if (tokenType == NdaLexer::TokenType::String) {
-        node = std::make_shared<ASTNode>(ASTNodeType::Literal, mLexer.line(), mLexer.column(), token);
+        node = createNode(ASTNodeType::Literal, mLexer.line(), mLexer.column(), token);
     }
     else if (tokenType == NdaLexer::TokenType::Identifier) {
-        node = std::make_shared<ASTNode>(ASTNodeType::Identifier, mLexer.line(), mLexer.column(), token);
+        node = createNode(ASTNodeType::Identifier, mLexer.line(), mLexer.column(), token);
     }
     else if (token == "[") {
         node = parseListLiteral();
@@ -1267,8 +1567,8 @@ NdaParser::ASTNodePtr NdaParser::parseAtom()
         if (mLexer.token() != ")")
             throw NdaException(Nada::Error::UnexpectedClosure, mLexer.line(), mLexer.column(), mLexer.token());
 
-        node = std::make_shared<ASTNode>(ASTNodeType::Expression, mLexer.line(), mLexer.column());
-        ASTNode::addChild(node, expression);
+        node = createNode(ASTNodeType::Expression, mLexer.line(), mLexer.column());
+        addChild(node, expression);
     }
     else {
         throw NdaException(Nada::Error::InvalidToken, mLexer.line(), mLexer.column(), token);
@@ -1279,7 +1579,7 @@ NdaParser::ASTNodePtr NdaParser::parseAtom()
 
 
 //-------------------------------------------------------------------------------------------------
-NdaParser::ASTNodePtr NdaParser::parseFunctionCall(std::shared_ptr<ASTNode> &funcNode)
+NdaParser::ASTNodePtr NdaParser::parseFunctionCall(ASTNodePtr &funcNode)
 {
     mLexer.nextToken(); // jump to "("
 
@@ -1289,7 +1589,7 @@ NdaParser::ASTNodePtr NdaParser::parseFunctionCall(std::shared_ptr<ASTNode> &fun
     if (mLexer.token() != ")") {
         while (true) {
             auto argument = parseExpression();
-            ASTNode::addChild(funcNode,argument);
+            addChild(funcNode,argument);
             mLexer.nextToken() ;
             if (mLexer.token() == ",") {
                 mLexer.nextToken(); // jump over ","
@@ -1307,7 +1607,7 @@ NdaParser::ASTNodePtr NdaParser::parseFunctionCall(std::shared_ptr<ASTNode> &fun
 }
 
 //-------------------------------------------------------------------------------------------------
-NdaParser::ASTNodePtr NdaParser::parseMethodCall(std::shared_ptr<ASTNode> &funcNode)
+NdaParser::ASTNodePtr NdaParser::parseMethodCall(ASTNodePtr &funcNode)
 {
     mLexer.nextToken(); // jump to ":" or "."
     if (!mLexer.nextToken())    // Überspringe ':' oder '.'
@@ -1324,7 +1624,7 @@ NdaParser::ASTNodePtr NdaParser::parseMethodCall(std::shared_ptr<ASTNode> &funcN
 
     parseFunctionCall(funcNode);
     funcNode->value = instanceName;
-    ASTNode::prependChild(funcNode,std::make_shared<ASTNode>(ASTNodeType::MethodContext, mLexer.line(), mLexer.column(), contextName.displayValue));
+    prependChild(funcNode,createNode(ASTNodeType::MethodContext, mLexer.line(), mLexer.column(), contextName.displayValue));
 
     return funcNode;
 }
@@ -1339,9 +1639,9 @@ NdaParser::ASTNodePtr NdaParser::parseIterableOrRange()
             mLexer.nextToken(); // step to   ".."
             mLexer.nextToken(); // step over ".."
             auto end = parseExpression();
-            auto rangeNode = std::make_shared<ASTNode>(ASTNodeType::Range, mLexer.line(), mLexer.column());
-            rangeNode->children.push_back(start);
-            rangeNode->children.push_back(end);
+            auto rangeNode = createNode(ASTNodeType::Range, mLexer.line(), mLexer.column());
+            addChild(rangeNode,start);
+            addChild(rangeNode,end);
             return rangeNode;
         }
         return start; // Es ist eine Iterable (z.B. anArray)
@@ -1376,11 +1676,14 @@ bool NdaParser::handleIdentifierCall(ASTNodePtr &identNode)
         if (mLexer.tokenType() != NdaLexer::TokenType::Identifier)
             throw NdaException(Nada::Error::IdentifierExpected,mLexer.line(), mLexer.column(),mLexer.token());
 
-        if (mLexer.token(1) != "(")
-            throw NdaException(Nada::Error::InvalidToken,mLexer.line(), mLexer.column(),mLexer.token());
+        if (mLexer.token(1) != "(") { // record.field
+            identNode = createNode(ASTNodeType::FieldAccess, mLexer.line(), mLexer.column(), mLexer.token());
+            addChild(identNode, receiverNode);
+            return true;
+        }
 
-        identNode = std::make_shared<ASTNode>(ASTNodeType::InstanceMethodCall, mLexer.line(), mLexer.column(), mLexer.token());
-        ASTNode::addChild(identNode, receiverNode);
+        identNode = createNode(ASTNodeType::InstanceMethodCall, mLexer.line(), mLexer.column(), mLexer.token());
+        addChild(identNode, receiverNode);
         parseFunctionCall(identNode);
         return true;
     }
@@ -1397,8 +1700,8 @@ bool NdaParser::handleIdentifierAccess(ASTNodePtr &identNode)
     if (!isListAccess && !isDictAccess)
         return false;
 
-    auto accessNode = std::make_shared<ASTNode>(ASTNodeType::AccessOperator, mLexer.line(), mLexer.column(), isListAccess ? "[" : "{");
-    ASTNode::addChild(accessNode,identNode);
+    auto accessNode = createNode(ASTNodeType::AccessOperator, mLexer.line(), mLexer.column(), isListAccess ? "[" : "{");
+    addChild(accessNode,identNode);
 
     if (!mLexer.nextToken())    // jump to "["
         throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
@@ -1407,7 +1710,7 @@ bool NdaParser::handleIdentifierAccess(ASTNodePtr &identNode)
         throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
 
     auto index = parseExpression(); // [parse-this]
-    ASTNode::addChild(accessNode,index);
+    addChild(accessNode,index);
 
     if (!mLexer.nextToken())    // jump to "]"
         throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
@@ -1420,12 +1723,33 @@ bool NdaParser::handleIdentifierAccess(ASTNodePtr &identNode)
     return true;
 }
 
+//-------------------------------------------------------------------------------------------------
+bool NdaParser::handleIdentifierAttribute(ASTNodePtr &identNode)
+{
+    if (mLexer.token(1) != "'")
+        return false;
+
+    mLexer.nextToken(); // jump to "'"
+
+    if (!mLexer.nextToken())    // skip "'"
+        throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
+
+    if (mLexer.tokenType() != NdaLexer::TokenType::Identifier)
+        throw NdaException(Nada::Error::IdentifierExpected,mLexer.line(), mLexer.column(),mLexer.token());
+
+    auto attributeNode = createNode(ASTNodeType::Attribute, mLexer.line(), mLexer.column(), mLexer.token());
+    addChild(attributeNode, identNode);
+
+    identNode = attributeNode;
+    return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 NdaParser::ASTNodePtr NdaParser::parseListLiteral()
 {
     assert(mLexer.token() == "[");
 
-    auto ret = std::make_shared<ASTNode>(ASTNodeType::ListLiteral, mLexer.line(), mLexer.column());
+    auto ret = createNode(ASTNodeType::ListLiteral, mLexer.line(), mLexer.column());
 
     if (!mLexer.nextToken())    // Überspringe '['
         throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
@@ -1435,7 +1759,7 @@ NdaParser::ASTNodePtr NdaParser::parseListLiteral()
         auto element = parseExpression();
 
         if (element)
-            ASTNode::addChild(ret,element);
+            addChild(ret,element);
 
         if (!mLexer.nextToken())    // Überspringe '['
             throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
@@ -1455,7 +1779,7 @@ NdaParser::ASTNodePtr NdaParser::parseDictLiteral()
 {
     assert(mLexer.token() == "{");
 
-    auto ret = std::make_shared<ASTNode>(ASTNodeType::DictLiteral, mLexer.line(), mLexer.column());
+    auto ret = createNode(ASTNodeType::DictLiteral, mLexer.line(), mLexer.column());
 
     if (!mLexer.nextToken())    // Überspringe '{'
         throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
@@ -1465,7 +1789,7 @@ NdaParser::ASTNodePtr NdaParser::parseDictLiteral()
         auto keyElement = parseExpression();
 
         if (keyElement)
-            ASTNode::addChild(ret,keyElement);
+            addChild(ret,keyElement);
 
         if (!mLexer.nextToken())    // jump to ":"
             throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
@@ -1479,7 +1803,7 @@ NdaParser::ASTNodePtr NdaParser::parseDictLiteral()
         auto valueElement = parseExpression();
 
         if (valueElement)
-            ASTNode::addChild(ret,valueElement);
+            addChild(ret,valueElement);
 
         if (!mLexer.nextToken())    // jump over ":"
             throw NdaException(Nada::Error::UnexpectedEof,mLexer.line(), mLexer.column(),mLexer.token());
@@ -2,7 +2,6 @@
 #define LIB_NEOADA_PARSER_
 
 #include <vector>
-#include <memory>
 #include "lexer.h"
 #include "private/utils.h"
 
@@ -13,6 +12,7 @@ public:
     enum class ASTNodeType {
         Program,
         WithAddon,
+        Package,             // package Utils is <subprograms, types> end Utils; -> Utils:Name(...)
         Procedure,
         FormalParameters,    // procedure/function declaration: call(FormalParameters)
         FormalParameter,     // procedure/function declaration: call(FormalParameter, FormalParameter, FormalParameter)
@@ -21,6 +21,7 @@ public:
         Declaration,
         DeclarationGroup,
         TypeDefinition,
+        RecordField,         // type Point is record x : Number; ... -> TypeDefinition(Identifier("record"), RecordField, ...)
         MethodContext,
         VolatileDeclaration,
         Assignment,
@@ -33,6 +34,8 @@ public:
         Identifier,
         BooleanLiteral,
         AccessOperator,  // list/dict []
+        FieldAccess,     // record.field
+        Attribute,       // A'First, A'Last, A'Length, A'Range
         UnaryOperator,
         BinaryOperator,  // Für "+" "-" "*" "/"
         FunctionCall,
@@ -57,36 +60,99 @@ public:
         Range,
     };
 
-    struct ASTNode {        
+    struct ASTNode;
+    using ASTNodePtr = ASTNode*; // owned by the AST returned from parse()
+
+    // children of an ASTNode: array in the AST's arena, grown by NdaParser::addChild()
+    class ASTNodeList {
+    public:
+        ASTNodeList() : mData(nullptr), mSize(0), mCapacity(0) {}
+
+        inline size_t            size() const  { return mSize;      }
+        inline bool              empty() const { return mSize == 0; }
+        inline ASTNode          *operator[](size_t i) const { return mData[i]; }
+        inline ASTNode          *front() const { return mData[0]; }
+        inline ASTNode          *back() const  { return mData[mSize-1]; }
+        inline ASTNode *const   *begin() const { return mData; }
+        inline ASTNode *const   *end() const   { return mData + mSize; }
+
+    private:
+        friend class NdaParser;
+        ASTNode **mData;
+        size_t    mSize;
+        size_t    mCapacity;
+    };
+
+    struct ASTNode {
         ASTNodeType       type;
         Nda::LowerString  value; // Der Wert (z. B. Literal, Operator, Identifier)
-        std::vector<std::shared_ptr<ASTNode>> children; // Unterknoten
-        ASTNode                              *parent;
+        ASTNodeList       children; // Unterknoten
+        ASTNode          *parent;
 
-        int                                   line;
-        int                                   column;
+        int               line;
+        int               column;
 
         ASTNode(ASTNodeType type, int l, int c, const std::string& value = "")
-            : type(type), value(value), line(l), column(c) {}
-        ~ASTNode();
+            : type(type), value(value), parent(nullptr), line(l), column(c) {}
 
         std::string serialize(int depth = 0) const;
-        static void addChild(std::shared_ptr<ASTNode> parent, std::shared_ptr<ASTNode> child);
-        static void prependChild(std::shared_ptr<ASTNode> parent, std::shared_ptr<ASTNode> child);
     };
 
-    using ASTNodePtr = std::shared_ptr<ASTNode>;
+    /*
+        AST: result of parse(). The nodes and their children arrays are bump allocated into one
+        arena (Nda::BumpArena) and released together with the AST; the interpreter lowers the tree
+        into Runnables and does not reference it afterwards (see NdaInterpreter::load()).
+    */
+    class AST {
+    public:
+        AST();
+        AST(AST &&other);
+        AST &operator=(AST &&other);
+        ~AST();
+
+        inline ASTNode *root() const                 { return mRoot; }
+        inline ASTNode *operator->() const           { return mRoot; }
+        inline explicit operator bool() const        { return mRoot != nullptr; }
+
+        int             nodeCount() const;
+        size_t          memoryUsage() const;
+
+    private:
+        AST(const AST&) = delete;
+        AST &operator=(const AST&) = delete;
+
+        friend class NdaParser;
+        struct Storage;
+        Storage *mStorage;
+        ASTNode *mRoot;
+    };
+
+    // where a top-level statement ends: offset behind its ";" and the lexer position there
+    struct StatementEnd {
+        size_t offset;
+        int    line;
+        int    column;
+    };
 
     NdaParser(NdaLexer &lexer);
+    ~NdaParser();
 
-    NdaParser::ASTNodePtr parse(const std::string &script);
+    NdaParser::AST        parse(const std::string &script);
+    // piece of a larger text (NdaDocument): the lexer starts at line/column
+    NdaParser::AST        parse(const char *script, size_t length, int line, int column,
+                                std::vector<StatementEnd> &statementEnds);
 
 private:
+    NdaParser::AST        parseProgram(const char *script, size_t length, int line, int column,
+                                       std::vector<StatementEnd> *statementEnds);
     NdaParser::ASTNodePtr parseStatement();
     NdaParser::ASTNodePtr parseDeclaration();
     NdaParser::ASTNodePtr parseLocalDeclaration();
     NdaParser::ASTNodePtr parseWith();
+    NdaParser::ASTNodePtr parsePackage();
     NdaParser::ASTNodePtr parseType();
+    NdaParser::ASTNodePtr parseRecordDefinition(NdaParser::ASTNodePtr &typeNode);
+    NdaParser::ASTNodePtr parseArrayDefinition(NdaParser::ASTNodePtr &typeNode);
     NdaParser::ASTNodePtr parseIdentifier();  // "call()" or "var :="
     NdaParser::ASTNodePtr parseProcedureOrFunction();
     NdaParser::ASTNodePtr parseWhileLoop();
@@ -119,14 +185,27 @@ private:
     NdaParser::ASTNodePtr parseFunctionCall(NdaParser::ASTNodePtr &funcNode);        // a()
     NdaParser::ASTNodePtr parseMethodCall(NdaParser::ASTNodePtr &funcNode);          // type:a()
     NdaParser::ASTNodePtr parseIterableOrRange();    // for x in [IterableOrRange]
-    bool                   handleIdentifierCall(NdaParser::ASTNodePtr &identNode);    // is function or procedure or method-call
+    bool                   handleIdentifierCall(NdaParser::ASTNodePtr &identNode);    // is function or procedure or method-call or record field
     bool                   handleIdentifierAccess(NdaParser::ASTNodePtr &identNode);  // is array/dict access operator
+    bool                   handleIdentifierAttribute(NdaParser::ASTNodePtr &identNode); // is attribute A'Range
     NdaParser::ASTNodePtr parseListLiteral();         // is function or procedure or method-call
     NdaParser::ASTNodePtr parseDictLiteral();
     static std::string nodeTypeToString(ASTNodeType type);
 
+    // node construction, allocated in mStorage
+    NdaParser::ASTNodePtr createNode(ASTNodeType type, int line, int column, const std::string &value = "");
+    NdaParser::ASTNodePtr cloneNode(const NdaParser::ASTNodePtr &node);
+    NdaParser::ASTNodePtr makeDeclarationNode(ASTNodeType declarationType, const std::string &name, const std::string &typeName,
+                                              const NdaParser::ASTNodePtr &expressionNode, int line, int column);
+    NdaParser::ASTNodePtr makeFormalParameterNode(const std::string &name, const std::string &typeName, const std::string &mode,
+                                                  int line, int column);
+    void                  addChild(const NdaParser::ASTNodePtr &parent, const NdaParser::ASTNodePtr &child);
+    void                  prependChild(const NdaParser::ASTNodePtr &parent, const NdaParser::ASTNodePtr &child);
+    void                  reserveChild(ASTNodeList &list);
+
     NdaLexer               &mLexer;
     NdaParser::ASTNodePtr mCurrentNode;
+    AST::Storage          *mStorage; // tree under construction, moved into the returned AST
 };
 
 
@@ -0,0 +1,53 @@
+#include <new>
+#include "arena.h"
+
+namespace {
+const size_t ArenaChunkSize = 64 * 1024;
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::BumpArena::BumpArena()
+    : mPos(nullptr), mEnd(nullptr)
+    , mMemoryUsage(0)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::BumpArena::~BumpArena()
+{
+    clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+void *Nda::BumpArena::allocate(size_t size)
+{
+    size = aligned(size);
+    mMemoryUsage += size;
+
+#ifdef NEOADA_NO_POOL
+    mChunks.push_back(static_cast<char*>(::operator new(size)));
+    return mChunks.back();
+#else
+    if (size > (size_t)(mEnd - mPos)) {
+        const size_t chunkSize = size > ArenaChunkSize ? size : ArenaChunkSize;
+        mChunks.push_back(static_cast<char*>(::operator new(chunkSize)));
+        mPos = mChunks.back();
+        mEnd = mPos + chunkSize;
+    }
+
+    void *ret = mPos;
+    mPos += size;
+    return ret;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+void Nda::BumpArena::clear()
+{
+    for (auto *chunk : mChunks)
+        ::operator delete(chunk);
+    mChunks.clear();
+
+    mPos = mEnd  = nullptr;
+    mMemoryUsage = 0;
+}
@@ -0,0 +1,48 @@
+#ifndef LIB_NEOADA_ARENA_H
+#define LIB_NEOADA_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+#include "pool.h" // NEOADA_NO_POOL
+
+/*
+    BumpArena
+
+    Bump allocator for data that is released all at once: allocate() hands out consecutive,
+    max_align_t aligned blocks of large chunks, clear() (or the destructor) gives back the chunks.
+    No destructors are run, owners destroy non trivial objects themselves.
+    Used by Nda::RunnableArena (prepared programs) and NdaParser::AST (parse trees).
+
+    With NEOADA_NO_POOL every block is allocated on its own, so sanitizers see each object.
+*/
+
+namespace Nda {
+
+class BumpArena
+{
+public:
+    BumpArena();
+    ~BumpArena();
+
+    void       *allocate(size_t size);
+    void        clear();
+
+    inline size_t memoryUsage() const { return mMemoryUsage; }
+
+    static const size_t Alignment = alignof(std::max_align_t);
+    static inline size_t aligned(size_t size) { return (size + Alignment - 1) & ~(Alignment - 1); }
+
+private:
+    BumpArena(const BumpArena&) = delete;
+    BumpArena &operator=(const BumpArena&) = delete;
+
+    std::vector<char*> mChunks;
+    char              *mPos;
+    char              *mEnd;
+    size_t             mMemoryUsage;
+};
+
+}
+
+#endif // LIB_NEOADA_ARENA_H
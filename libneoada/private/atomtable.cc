@@ -0,0 +1,87 @@
+#include <cassert>
+#include "atomtable.h"
+
+//-------------------------------------------------------------------------------------------------
+Nda::AtomTable::AtomTable(const AtomTable *base)
+    : mBase(base)
+    , mBaseSize(base ? base->size() : 0)
+{
+    if (mBase)
+        return; // the well-known atoms are the ones of the base
+
+    // same order as Nda::WellKnownAtom
+    static const char *const wellKnown[] = {
+        "", "any", "number", "natural", "supernatural", "bignatural", "boolean", "byte",
+        "string", "list", "bytes", "dict", "reference", "this", "others"
+    };
+    static_assert(sizeof(wellKnown)/sizeof(wellKnown[0]) == WellKnownAtomCount, "WellKnownAtom mismatch");
+
+    for (const char *n : wellKnown) {
+        auto it = mAtoms.emplace(n, (Atom)mNames.size()).first;
+        mNames.push_back(&it->first);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::Atom Nda::AtomTable::intern(const std::string &lowerName)
+{
+    if (mBase) {
+        const Atom atom = mBase->find(lowerName);
+        if (atom != NoAtom || lowerName.empty())
+            return atom;
+    }
+
+    auto it = mAtoms.find(lowerName);
+    if (it != mAtoms.end())
+        return it->second;
+
+    Atom atom;
+    if (mFreeAtoms.empty()) {
+        atom = size();
+        mNames.push_back(nullptr);
+    } else {
+        atom = mFreeAtoms.back();
+        mFreeAtoms.pop_back();
+    }
+
+    it = mAtoms.emplace(lowerName, atom).first;
+    mNames[atom - mBaseSize] = &it->first;
+    return atom;
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::Atom Nda::AtomTable::find(const std::string &lowerName) const
+{
+    if (mBase) {
+        const Atom atom = mBase->find(lowerName);
+        if (atom != NoAtom)
+            return atom;
+    }
+
+    auto it = mAtoms.find(lowerName);
+    return it != mAtoms.end() ? it->second : NoAtom;
+}
+
+//-------------------------------------------------------------------------------------------------
+const std::string &Nda::AtomTable::name(Atom atom) const
+{
+    assert(atom >= 0 && atom < size());
+    if (atom < mBaseSize)
+        return mBase->name(atom);
+    assert(mNames[atom - mBaseSize]);
+    return *mNames[atom - mBaseSize];
+}
+
+//-------------------------------------------------------------------------------------------------
+void Nda::AtomTable::release(const std::vector<bool> &used)
+{
+    const Atom first = mBase ? mBaseSize : (Atom)WellKnownAtomCount;
+    for (Atom atom = first; atom < size(); atom++) {
+        const std::string *&name = mNames[atom - mBaseSize];
+        if (!name || (atom < (Atom)used.size() && used[atom]))
+            continue;
+        mAtoms.erase(*name);
+        name = nullptr;
+        mFreeAtoms.push_back(atom);
+    }
+}
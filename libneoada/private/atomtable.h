@@ -0,0 +1,79 @@
+#ifndef LIB_NEOADA_ATOMTABLE_H
+#define LIB_NEOADA_ATOMTABLE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+    AtomTable
+
+    Per-state intern table for identifiers and type names. Every distinct lowercase name gets
+    a small integer (atom) when the interpreter prepares the AST, so symbol, function and type
+    lookups at runtime compare integers instead of strings.
+
+    Atoms stay valid as long as a program of the state refers to them: NdaState::reset() releases
+    the names no loaded program uses (release()), their numbers are reused by the next names.
+    The names of the builtin types and keywords used by the runtime are interned by the
+    constructor and have fixed values, see WellKnownAtom.
+
+    The table of a state extends the (immutable) one of Nda::Builtins: all names of the builtin
+    types and functions have the same atoms in every state, below base size.
+
+    The text of literals is owned by the program (Nda::RunnableArena), not by the table.
+*/
+
+namespace Nda {
+
+using Atom = int;
+
+enum WellKnownAtom : Atom {
+    NoAtom = 0,          // empty name / never interned
+    AnyAtom,
+    NumberAtom,
+    NaturalAtom,
+    SupernaturalAtom,
+    BigNaturalAtom,
+    BooleanAtom,
+    ByteAtom,
+    StringAtom,
+    ListAtom,
+    BytesAtom,
+    DictAtom,
+    ReferenceAtom,
+    ThisAtom,
+    OthersAtom,
+    WellKnownAtomCount
+};
+
+struct AtomString {
+    Atom               atom;         // NoAtom for literals
+    const std::string &displayValue; // name in the AtomTable or text in the RunnableArena
+    const std::string &lowerValue;
+};
+
+class AtomTable
+{
+public:
+    explicit AtomTable(const AtomTable *base = nullptr);
+
+    Atom               intern(const std::string &lowerName);
+    Atom               find(const std::string &lowerName) const; // NoAtom: never interned -> unknown everywhere
+    const std::string &name(Atom atom) const;
+
+    // NdaState::reset(): drops the atoms not marked in used (indexed by atom), never the base ones
+    void               release(const std::vector<bool> &used);
+
+    inline int         size() const { return mBaseSize + (int)mNames.size(); }
+
+private:
+    const AtomTable                      *mBase;
+    int                                   mBaseSize;
+    std::unordered_map<std::string, Atom> mAtoms;
+    std::vector<const std::string*>       mNames;     // atom -> key in mAtoms (node based, stable), nullptr: released
+    std::vector<Atom>                     mFreeAtoms; // released, reused by intern()
+};
+
+}
+
+#endif // LIB_NEOADA_ATOMTABLE_H
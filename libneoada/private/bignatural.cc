@@ -0,0 +1,559 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include "bignatural.h"
+
+namespace NdaBigNatural {
+
+static const uint64_t Base    = uint64_t(1) << 32;
+static const uint32_t Chunk   = 1000000000;     // 10^9: decimal digits per uint32_t
+static const size_t   ChunkDigits = 9;
+static const size_t   ConversionThreshold = KaratsubaThreshold * 2; // digits converted chunk by chunk
+
+//-------------------------------------------------------------------------------------------------
+static void trim(Digits &value)
+{
+    while (!value.empty() && value.back() == 0)
+        value.pop_back();
+}
+
+//-------------------------------------------------------------------------------------------------
+static void addShifted(Digits &target, const Digits &value, size_t shift) // target += value * Base^shift
+{
+    if (value.empty())
+        return;
+    if (target.size() < value.size() + shift)
+        target.resize(value.size() + shift, 0);
+
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < value.size(); i++) {
+        uint64_t sum = (uint64_t)target[i + shift] + value[i] + carry;
+        target[i + shift] = (uint32_t)sum;
+        carry = sum >> 32;
+    }
+    for (i += shift; carry; i++) {
+        if (i == target.size())
+            target.push_back(0);
+        uint64_t sum = (uint64_t)target[i] + carry;
+        target[i] = (uint32_t)sum;
+        carry = sum >> 32;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+static void multiplySmallAdd(Digits &value, uint32_t factor, uint32_t summand) // value = value * factor + summand
+{
+    uint64_t carry = summand;
+    for (auto &d : value) {
+        uint64_t p = (uint64_t)d * factor + carry;
+        d = (uint32_t)p;
+        carry = p >> 32;
+    }
+    if (carry)
+        value.push_back((uint32_t)carry);
+}
+
+//-------------------------------------------------------------------------------------------------
+static uint32_t divideSmall(Digits &value, uint32_t divisor) // in place, returns the remainder
+{
+    assert(divisor);
+    uint64_t remainder = 0;
+    for (size_t i = value.size(); i-- > 0;) {
+        uint64_t current = (remainder << 32) | value[i];
+        value[i]  = (uint32_t)(current / divisor);
+        remainder = current % divisor;
+    }
+    trim(value);
+    return (uint32_t)remainder;
+}
+
+//-------------------------------------------------------------------------------------------------
+static Digits schoolbook(const Digits &a, const Digits &b)
+{
+    Digits ret(a.size() + b.size(), 0);
+    for (size_t i = 0; i < a.size(); i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < b.size(); j++) {
+            uint64_t t = (uint64_t)a[i] * b[j] + ret[i + j] + carry;
+            ret[i + j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        ret[i + b.size()] = (uint32_t)carry;
+    }
+    trim(ret);
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+static void split(const Digits &value, size_t at, Digits &low, Digits &high)
+{
+    size_t n = std::min(at, value.size());
+    low.assign(value.begin(), value.begin() + n);
+    high.assign(value.begin() + n, value.end());
+    trim(low);
+}
+
+//-------------------------------------------------------------------------------------------------
+static Digits karatsuba(const Digits &a, const Digits &b)
+{
+    // a = a1 * Base^half + a0, b = b1 * Base^half + b0
+    // a * b = z2 * Base^(2 half) + (z1 - z2 - z0) * Base^half + z0, z1 = (a0 + a1) * (b0 + b1)
+
+    const Digits &big   = a.size() >= b.size() ? a : b;
+    const Digits &small = a.size() >= b.size() ? b : a;
+    size_t half = big.size() / 2;
+
+    Digits big0, big1;
+    split(big, half, big0, big1);
+
+    Digits ret;
+    if (small.size() <= half) { // unbalanced: only split the bigger one
+        ret = multiply(big0, small);
+        addShifted(ret, multiply(big1, small), half);
+        return ret;
+    }
+
+    Digits small0, small1;
+    split(small, half, small0, small1);
+
+    Digits z0 = multiply(big0, small0);
+    Digits z2 = multiply(big1, small1);
+    Digits z1 = multiply(add(big0, big1), add(small0, small1));
+    bool ok = subtract(z1, z0, z1) && subtract(z1, z2, z1);
+    assert(ok);
+    (void)ok;
+
+    ret = z0;
+    addShifted(ret, z1, half);
+    addShifted(ret, z2, 2 * half);
+    trim(ret);
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+Digits fromUInt64(uint64_t value)
+{
+    Digits ret;
+    while (value) {
+        ret.push_back((uint32_t)value);
+        value >>= 32;
+    }
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+Digits fromDouble(double value)
+{
+    assert(value >= 0 && value == std::floor(value) && !std::isinf(value));
+
+    Digits ret;
+    while (value > 0) {
+        double high = std::floor(value / (double)Base); // exact: divided by a power of two
+        ret.push_back((uint32_t)(value - high * (double)Base));
+        value = high;
+    }
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool toUInt64(const Digits &value, uint64_t &ret)
+{
+    if (value.size() > 2)
+        return false;
+    ret = 0;
+    for (size_t i = value.size(); i-- > 0;)
+        ret = (ret << 32) | value[i];
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+double toDouble(const Digits &value)
+{
+    double ret = 0;
+    for (size_t i = value.size(); i-- > 0;)
+        ret = ret * (double)Base + value[i];
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+int compare(const Digits &a, const Digits &b)
+{
+    if (a.size() != b.size())
+        return a.size() < b.size() ? -1 : 1;
+    for (size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+Digits add(const Digits &a, const Digits &b)
+{
+    Digits ret = a.size() >= b.size() ? a : b;
+    addShifted(ret, a.size() >= b.size() ? b : a, 0);
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool subtract(const Digits &a, const Digits &b, Digits &ret)
+{
+    if (compare(a, b) < 0)
+        return false;
+
+    Digits result(a);
+    int64_t borrow = 0;
+    for (size_t i = 0; i < result.size(); i++) {
+        int64_t t = (int64_t)result[i] - borrow - (i < b.size() ? (int64_t)b[i] : 0);
+        borrow = t < 0 ? 1 : 0;
+        result[i] = (uint32_t)(t + (borrow ? (int64_t)Base : 0));
+        if (!borrow && i >= b.size())
+            break;
+    }
+    trim(result);
+    ret.swap(result);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+Digits multiply(const Digits &a, const Digits &b)
+{
+    if (a.empty() || b.empty())
+        return Digits();
+    if (std::min(a.size(), b.size()) < KaratsubaThreshold)
+        return schoolbook(a, b);
+    return karatsuba(a, b);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool divide(const Digits &a, const Digits &b, Digits &quotient, Digits &remainder)
+{
+    if (b.empty())
+        return false;
+
+    if (compare(a, b) < 0) {
+        remainder = a;
+        quotient.clear();
+        return true;
+    }
+
+    if (b.size() == 1) {
+        Digits q(a);
+        uint32_t r = divideSmall(q, b[0]);
+        quotient.swap(q);
+        remainder = fromUInt64(r);
+        return true;
+    }
+
+    // Knuth, TAOCP Vol. 2, 4.3.1, Algorithm D
+
+    int shift = 0;
+    for (uint32_t top = b.back(); !(top & 0x80000000u); top <<= 1)
+        shift++;
+
+    const size_t n = b.size();
+    const size_t m = a.size() - n;
+
+    Digits vn(n), un(a.size() + 1);
+    for (size_t i = n - 1; i > 0; i--)
+        vn[i] = (b[i] << shift) | (shift ? (uint32_t)((uint64_t)b[i - 1] >> (32 - shift)) : 0);
+    vn[0] = b[0] << shift;
+
+    un[a.size()] = shift ? (uint32_t)((uint64_t)a.back() >> (32 - shift)) : 0;
+    for (size_t i = a.size() - 1; i > 0; i--)
+        un[i] = (a[i] << shift) | (shift ? (uint32_t)((uint64_t)a[i - 1] >> (32 - shift)) : 0);
+    un[0] = a[0] << shift;
+
+    Digits q(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0;) {
+        uint64_t numerator = ((uint64_t)un[j + n] << 32) | un[j + n - 1];
+        uint64_t qhat = numerator / vn[n - 1];
+        uint64_t rhat = numerator % vn[n - 1];
+
+        while (qhat >= Base || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat >= Base)
+                break;
+        }
+
+        // un[j .. j+n] -= qhat * vn
+        int64_t borrow = 0;
+        int64_t t;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t p = qhat * vn[i];
+            t = (int64_t)un[i + j] - borrow - (int64_t)(p & 0xFFFFFFFFu);
+            un[i + j] = (uint32_t)t;
+            borrow = (int64_t)(p >> 32) - (t >> 32);
+        }
+        t = (int64_t)un[j + n] - borrow;
+        un[j + n] = (uint32_t)t;
+
+        if (t < 0) { // qhat was one too big: add back
+            qhat--;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t sum = (uint64_t)un[i + j] + vn[i] + carry;
+                un[i + j] = (uint32_t)sum;
+                carry = sum >> 32;
+            }
+            un[j + n] += (uint32_t)carry;
+        }
+        q[j] = (uint32_t)qhat;
+    }
+
+    Digits r(n);
+    for (size_t i = 0; i < n; i++)
+        r[i] = (un[i] >> shift) | (shift ? (uint32_t)((uint64_t)un[i + 1] << (32 - shift)) : 0);
+
+    trim(q);
+    trim(r);
+    quotient.swap(q);
+    remainder.swap(r);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool power(const Digits &base, uint64_t exponent, Digits &ret)
+{
+    bool trivial = base.empty() || (base.size() == 1 && base[0] == 1); // 0^n, 1^n
+    if (!trivial && exponent > MaxPowerDigits / base.size())
+        return false;
+
+    ret = fromUInt64(1);
+    if (trivial && exponent > 0) {
+        ret = base;
+        return true;
+    }
+
+    Digits square = base;
+    while (exponent) {
+        if (exponent & 1)
+            ret = multiply(ret, square);
+        exponent >>= 1;
+        if (exponent)
+            square = multiply(square, square);
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+static Digits shifted(const Digits &value, size_t digits) // value * Base^digits
+{
+    Digits ret(digits, 0);
+    ret.insert(ret.end(), value.begin(), value.end());
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+static Digits truncated(const Digits &value, size_t digits) // value / Base^digits
+{
+    if (value.size() <= digits)
+        return Digits();
+    return Digits(value.begin() + digits, value.end());
+}
+
+//-------------------------------------------------------------------------------------------------
+static Digits reciprocal(const Digits &p)
+{
+    // Base^(2 s) / p, s = p.size(), a few units off: Newton's iteration on the upper half of p,
+    // x' = x + x * (Base^(2 s) - p * x) / Base^(2 s)
+    const size_t s = p.size();
+    Digits unit(2 * s + 1, 0);
+    unit[2 * s] = 1;
+
+    if (s <= KaratsubaThreshold) {
+        Digits q, r;
+        divide(unit, p, q, r);
+        return q;
+    }
+
+    const size_t h = (s + 1) / 2 + 2; // relative error of the start below Base^-(h - 1)
+    Digits x = shifted(reciprocal(Digits(p.end() - h, p.end())), s - h);
+
+    Digits px = multiply(p, x);
+    Digits e;
+    if (subtract(unit, px, e))
+        return add(x, truncated(multiply(x, e), 2 * s));
+
+    subtract(px, unit, e);
+    subtract(x, truncated(multiply(x, e), 2 * s), x);
+    return x;
+}
+
+//-------------------------------------------------------------------------------------------------
+/*
+    Powers of ten for the decimal conversions: 10^(9 * 2^level), built by squaring and shared by
+    all splits of one conversion, with their reciprocals for the divisions of toString().
+*/
+class TenPowers
+{
+public:
+    const Digits &value(size_t level)
+    {
+        while (mValues.size() <= level)
+            mValues.push_back(mValues.empty() ? fromUInt64(Chunk) : multiply(mValues.back(), mValues.back()));
+        return mValues[level];
+    }
+
+    // x < Base^(2 s) for the s digits of the power: quotient and remainder with two multiplications
+    void divide(const Digits &x, size_t level, Digits &quotient, Digits &remainder)
+    {
+        const Digits &p = value(level);
+        while (mReciprocals.size() <= level)
+            mReciprocals.push_back(reciprocal(value(mReciprocals.size())));
+        assert(x.size() <= 2 * p.size());
+
+        const Digits one = fromUInt64(1);
+        Digits q  = truncated(multiply(x, mReciprocals[level]), 2 * p.size());
+        Digits qp = multiply(q, p);
+        while (compare(qp, x) > 0) { // the reciprocal was a bit too big
+            subtract(q, one, q);
+            subtract(qp, p, qp);
+        }
+        subtract(x, qp, remainder);
+        while (compare(remainder, p) >= 0) { // ... or too small
+            subtract(remainder, p, remainder);
+            q = add(q, one);
+        }
+        quotient.swap(q);
+    }
+
+private:
+    std::vector<Digits> mValues;
+    std::vector<Digits> mReciprocals;
+};
+
+//-------------------------------------------------------------------------------------------------
+static Digits parseChunks(const char *decimal, size_t length)
+{
+    Digits ret;
+    size_t pos = 0;
+    size_t first = length % ChunkDigits ? length % ChunkDigits : ChunkDigits;
+    while (pos < length) {
+        size_t count = pos == 0 ? first : ChunkDigits;
+        uint32_t chunk = 0;
+        uint32_t scale = 1;
+        for (size_t i = 0; i < count; i++) {
+            chunk = chunk * 10 + (uint32_t)(decimal[pos + i] - '0');
+            scale *= 10;
+        }
+        multiplySmallAdd(ret, scale, chunk);
+        pos += count;
+    }
+    trim(ret);
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+static Digits parse(const char *decimal, size_t length, TenPowers &powers)
+{
+    // high * 10^(9 * 2^k) + low, the power of ten is shared by all splits on the same level
+    if (length <= ChunkDigits * ConversionThreshold)
+        return parseChunks(decimal, length);
+
+    size_t level = 0;
+    size_t lowDigits = ChunkDigits;
+    while (lowDigits * 2 < length) {
+        lowDigits *= 2;
+        level++;
+    }
+
+    Digits high = parse(decimal, length - lowDigits, powers);
+    Digits low  = parse(decimal + length - lowDigits, lowDigits, powers);
+    Digits ret  = multiply(high, powers.value(level));
+    addShifted(ret, low, 0);
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool fromString(const std::string &decimal, Digits &ret)
+{
+    if (decimal.empty())
+        return false;
+    for (char c : decimal) {
+        if (c < '0' || c > '9')
+            return false;
+    }
+
+    TenPowers powers;
+    ret = parse(decimal.data(), decimal.size(), powers);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+static void formatChunks(const Digits &value, size_t width, std::string &ret)
+{
+    // nine decimal digits per pass over the number, instead of one
+    std::vector<uint32_t> chunks;
+    Digits rest(value);
+    while (!rest.empty())
+        chunks.push_back(divideSmall(rest, Chunk));
+    if (chunks.empty())
+        chunks.push_back(0);
+
+    std::string part = std::to_string(chunks.back());
+    const size_t digits = part.size() + (chunks.size() - 1) * ChunkDigits;
+    if (digits < width)
+        ret.append(width - digits, '0');
+    ret += part;
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        part = std::to_string(chunks[i]);
+        ret.append(ChunkDigits - part.size(), '0');
+        ret += part;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+static void format(const Digits &value, size_t width, TenPowers &powers, std::string &ret)
+{
+    // value = high * 10^(9 * 2^k) + low: low gets all its 9 * 2^k digits, zeros included
+    if (value.size() <= ConversionThreshold) {
+        formatChunks(value, width, ret);
+        return;
+    }
+
+    size_t level = 0;
+    while (2 * powers.value(level).size() < value.size())
+        level++;
+
+    Digits high, low;
+    powers.divide(value, level, high, low);
+    assert(!high.empty());
+
+    const size_t lowDigits = ChunkDigits << level;
+    format(high, width > lowDigits ? width - lowDigits : 0, powers, ret);
+    format(low, lowDigits, powers, ret);
+}
+
+//-------------------------------------------------------------------------------------------------
+std::string toString(const Digits &value)
+{
+    std::string ret;
+    ret.reserve(value.size() * 10 + 1); // 9.64 decimal digits per digit
+    TenPowers powers;
+    format(value, 0, powers, ret);
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t hash(const Digits &value)
+{
+    uint64_t small;
+    if (toUInt64(value, small)) { // same as an equal Natural or Supernatural
+        if (small <= (uint64_t)INT64_MAX)
+            return std::hash<int64_t>()((int64_t)small);
+        return std::hash<uint64_t>()(small);
+    }
+
+    uint64_t h = 14695981039346656037ULL; // FNV-1a
+    for (uint32_t d : value) {
+        h ^= d;
+        h *= 1099511628211ULL;
+    }
+    return (size_t)h;
+}
+
+}
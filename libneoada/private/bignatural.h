@@ -0,0 +1,43 @@
+#ifndef LIB_NEOADA_BIGNATURAL_H
+#define LIB_NEOADA_BIGNATURAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+    Arbitrary-precision natural numbers (BigNatural)
+
+    Digits are base 2^32, least significant first, without leading zeros: zero is empty.
+    Multiplication switches from schoolbook to Karatsuba above KaratsubaThreshold digits,
+    decimal parsing splits the literal and combines the halves with these multiplications.
+    toString() splits the other way round: by the same powers of ten, divided through their
+    reciprocals (Newton's iteration), so both conversions cost a few multiplications per level.
+*/
+
+namespace NdaBigNatural {
+
+using Digits = std::vector<uint32_t>;
+
+static const size_t KaratsubaThreshold = 32;
+static const size_t MaxPowerDigits     = size_t(1) << 25;   // 128 MiB
+
+Digits      fromUInt64(uint64_t value);
+Digits      fromDouble(double value);                          // integral, finite, >= 0
+bool        toUInt64(const Digits &value, uint64_t &ret);      // false: doesn't fit
+double      toDouble(const Digits &value);                     // may be inf
+
+int         compare(const Digits &a, const Digits &b);         // -1, 0, 1
+Digits      add(const Digits &a, const Digits &b);
+bool        subtract(const Digits &a, const Digits &b, Digits &ret);    // false: a < b
+Digits      multiply(const Digits &a, const Digits &b);
+bool        divide(const Digits &a, const Digits &b, Digits &quotient, Digits &remainder); // false: b == 0
+bool        power(const Digits &base, uint64_t exponent, Digits &ret); // false: more than MaxPowerDigits
+
+bool        fromString(const std::string &decimal, Digits &ret); // digits only
+std::string toString(const Digits &value);
+size_t      hash(const Digits &value);
+}
+
+#endif // LIB_NEOADA_BIGNATURAL_H
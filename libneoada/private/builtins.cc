@@ -0,0 +1,84 @@
+#include <cassert>
+
+#include "builtins.h"
+#include "../state.h"
+
+#include "../addons/AdaList.h"
+#include "../addons/AdaSet.h"
+#include "../addons/AdaDeque.h"
+#include "../addons/AdaPriorityQueue.h"
+#include "../addons/AdaBytes.h"
+#include "../addons/AdaString.h"
+#include "../addons/AdaMath.h"
+#include "../addons/AdaTextEncoding.h"
+#include "../addons/AdaIoFile.h"
+#include "../addons/AdaDateTime.h"
+#include "../addons/AdaRegexp.h"
+#include "../addons/AdaJson.h"
+
+//-------------------------------------------------------------------------------------------------
+const Nda::Builtins &Nda::Builtins::instance()
+{
+    static const Builtins builtins;
+    return builtins;
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::Builtins::Builtins()
+    : mState(new NdaState(nullptr)) // registers the core
+{
+    for (const auto &type : mState->mTypes)
+        mTypes[type.first] = TypeEntry{&type.second, Core};
+
+    add(AdaString,        add_AdaString_symbols);
+    add(AdaList,          add_AdaList_symbols);
+    add(AdaSet,           add_AdaSet_symbols);
+    add(AdaDeque,         add_AdaDeque_symbols);
+    add(AdaPriorityQueue, add_AdaPriorityQueue_symbols);
+    add(AdaBytes,         add_AdaBytes_symbols);
+    add(AdaMath,          add_AdaMath_symbols);
+    add(AdaTextEncoding,  add_AdaTextEncoding_symbols);
+    add(AdaIoFile,        add_AdaIoFile_symbols);
+    add(AdaDateTime,      add_AdaDateTime_symbols);
+    add(AdaRegexp,        add_AdaRegexp_symbols);
+    add(AdaJson,          add_AdaJson_symbols);
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::Builtins::~Builtins()
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+void Nda::Builtins::add(Addon addon, void (*addSymbols)(NdaState *))
+{
+    mState->mFunctions.setAddon(addon);
+    addSymbols(mState.get());
+
+    // the types are node based: their addresses are kept
+    for (const auto &type : mState->mTypes) {
+        if (mTypes.find(type.first) == mTypes.end())
+            mTypes[type.first] = TypeEntry{&type.second, addon};
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::AtomTable &Nda::Builtins::atoms() const
+{
+    return mState->mAtoms;
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::FunctionTable &Nda::Builtins::functions() const
+{
+    return mState->mFunctions;
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::RuntimeType *Nda::Builtins::type(Atom atom, uint64_t addons) const
+{
+    auto it = mTypes.find(atom);
+    if (it == mTypes.end() || !(addons & mask(it->second.addon)))
+        return nullptr;
+    return it->second.type;
+}
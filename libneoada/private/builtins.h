@@ -0,0 +1,82 @@
+#ifndef LIB_NEOADA_BUILTINS_H
+#define LIB_NEOADA_BUILTINS_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "atomtable.h"
+
+class NdaState;
+
+/*
+    Builtins
+
+    The standard types, "typeof" and the addons ("with Ada.String;", ...) are registered once per
+    process, into one state of their own, and shared immutable by all states afterwards: a state
+    extends the atom table (same atoms for the builtin names everywhere), finds the types and
+    functions of the addons enabled by its "with" clauses, and keeps just its own definitions.
+    So a new NdaState (NdaRuntime::reset()) or a "with" costs no registration.
+
+    The callbacks get the state of the call (Nda::StateFncCallback), no addon keeps data per state.
+    Thread safe, built on first use.
+*/
+
+namespace Nda {
+
+class FunctionTable;
+struct RuntimeType;
+
+class Builtins
+{
+public:
+    enum Addon {
+        Core,            // standard types, typeof
+        AdaString,
+        AdaList,
+        AdaSet,
+        AdaDeque,
+        AdaPriorityQueue,
+        AdaBytes,
+        AdaMath,
+        AdaTextEncoding,
+        AdaIoFile,
+        AdaDateTime,
+        AdaRegexp,
+        AdaJson,
+        AddonCount
+    };
+
+    static const Builtins &instance();
+    static inline uint64_t mask(Addon addon) { return 1ull << addon; }
+
+    ~Builtins();
+
+    const AtomTable         &atoms() const;
+    const FunctionTable     &functions() const;
+    const NdaState          &state() const { return *mState; }
+
+    // nullptr: no builtin type or its addon not in addons
+    const RuntimeType       *type(Atom atom, uint64_t addons) const;
+
+private:
+    Builtins();
+    Builtins(const Builtins&) = delete;
+    Builtins &operator=(const Builtins&) = delete;
+
+    void add(Addon addon, void (*addSymbols)(NdaState *state));
+
+    struct TypeEntry {
+        const RuntimeType *type;
+        Addon              addon;
+    };
+
+    std::unique_ptr<NdaState>          mState;
+    std::unordered_map<Atom, TypeEntry> mTypes;
+};
+
+static_assert(Builtins::AddonCount <= 64, "Builtins: addon mask");
+
+}
+
+#endif // LIB_NEOADA_BUILTINS_H
@@ -0,0 +1,508 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#include "columnevaluator.h"
+#include "../interpreter.h"
+#include "../state.h"
+#include "../variant.h"
+
+using NeoAda::Column;
+
+namespace {
+
+//-------------------------------------------------------------------------------------------------
+template <typename T, typename R, typename F>
+inline void binaryLoop(const T *a, const T *b, R *out, size_t count, F f)
+{
+    for (size_t i = 0; i < count; i++)
+        out[i] = f(a[i], b[i]);
+}
+
+//-------------------------------------------------------------------------------------------------
+enum Relation { RelEqual, RelNotEqual, RelLess, RelGreater, RelLessEqual, RelGreaterEqual }; // order of ColumnEvaluator::Op
+
+template <typename T, typename C>
+inline void compareLoop(Relation relation, const T *a, const T *b, uint8_t *out, size_t count, C cmp)
+{
+    switch (relation) {
+    case RelEqual:        binaryLoop(a, b, out, count, [&cmp](const T &x, const T &y) -> uint8_t { return cmp(x, y) == 0; }); break;
+    case RelNotEqual:     binaryLoop(a, b, out, count, [&cmp](const T &x, const T &y) -> uint8_t { return cmp(x, y) != 0; }); break;
+    case RelLess:         binaryLoop(a, b, out, count, [&cmp](const T &x, const T &y) -> uint8_t { return cmp(x, y) < 0; }); break;
+    case RelGreater:      binaryLoop(a, b, out, count, [&cmp](const T &x, const T &y) -> uint8_t { return cmp(x, y) > 0; }); break;
+    case RelLessEqual:    binaryLoop(a, b, out, count, [&cmp](const T &x, const T &y) -> uint8_t { return cmp(x, y) <= 0; }); break;
+    case RelGreaterEqual: binaryLoop(a, b, out, count, [&cmp](const T &x, const T &y) -> uint8_t { return cmp(x, y) >= 0; }); break;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// like NdaVariant::spaceship for two strings
+template <typename S>
+inline int compareStrings(const S &a, const S &b)
+{
+    int cmp = (a.size && b.size) ? std::memcmp(a.data, b.data, std::min(a.size, b.size)) : 0;
+    if (cmp != 0)
+        return cmp < 0 ? -1 : +1;
+    return a.size < b.size ? -1 : (a.size > b.size ? +1 : 0);
+}
+
+}
+
+const size_t Nda::ColumnEvaluator::ChunkSize;
+
+//-------------------------------------------------------------------------------------------------
+Nda::ColumnEvaluator::ColumnEvaluator(NdaInterpreter &interpreter, NdaState &state)
+    : mInterpreter(interpreter)
+    , mState(state)
+    , mColumns(nullptr)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+bool Nda::ColumnEvaluator::compile(Runnable *program, const std::vector<Column> &columns)
+{
+    mSteps.clear();
+    mColumns = &columns;
+
+    // just "return <expression>;"
+    if (!program || program->call != &NdaInterpreter::runProgramm || program->childrenCount != 1)
+        return false;
+
+    Runnable *ret = program->children[0];
+    if (ret->call != &NdaInterpreter::runReturn || ret->childrenCount != 1)
+        return false;
+
+    mInterpreter.restoreCaches(); // literal values after a reset of the state
+    return lower(ret->children[0]) >= 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+int Nda::ColumnEvaluator::lower(Runnable *node)
+{
+    switch (node->type) {
+    case NcIdentifier:
+        return identifier(node);
+    case NcNumberLiteral:
+    case NcBoolLiteral:
+        return node->variantCache ? constant(*node->variantCache) : -1;
+    case NcStringLiteral: {
+        NdaVariant value;
+        value.fromString(mState.stringType(), node->value.displayValue);
+        return constant(value);
+    }
+    case CallType:
+        break;
+    default:
+        return -1;
+    }
+
+    if (node->call == &NdaInterpreter::runSubStatement) // "(x)", unary "+"
+        return node->childrenCount == 1 ? lower(node->children[0]) : -1;
+
+    if (node->call == &NdaInterpreter::runUnaryMinus) {
+        int operand = node->childrenCount == 1 ? lower(node->children[0]) : -1;
+        if (operand < 0)
+            return -1;
+        Column::Type type = mSteps[operand].type;
+        if (type != Column::Number && type != Column::Natural)
+            return -1;
+        return add(Negate, type, operand);
+    }
+
+    static const struct { RunnableCall call; Op op; } operators[] = {
+        { &NdaInterpreter::runBinaryPlus,      Add          },
+        { &NdaInterpreter::runBinaryMinus,     Subtract     },
+        { &NdaInterpreter::runBinaryMultiply,  Multiply     },
+        { &NdaInterpreter::runBinaryDivide,    Divide       },
+        { &NdaInterpreter::runBinaryMod,       Modulo       },
+        { &NdaInterpreter::runBinaryEqual,     Equal        },
+        { &NdaInterpreter::runBinaryNotEqual,  NotEqual     },
+        { &NdaInterpreter::runBinaryLtThen,    Less         },
+        { &NdaInterpreter::runBinaryGtThen,    Greater      },
+        { &NdaInterpreter::runBinaryEqLtThen,  LessEqual    },
+        { &NdaInterpreter::runBinaryEqGtThen,  GreaterEqual },
+        { &NdaInterpreter::runBinaryAnd,       And          },
+        { &NdaInterpreter::runBinaryOr,        Or           },
+        { &NdaInterpreter::runBinaryXor,       Xor          },
+    };
+
+    for (const auto &o : operators) {
+        if (node->call != o.call)
+            continue;
+        if (node->childrenCount != 2)
+            return -1;
+        int left = lower(node->children[0]);
+        if (left < 0)
+            return -1;
+        int right = lower(node->children[1]);
+        if (right < 0)
+            return -1;
+        return binary(o.op, left, right);
+    }
+
+    return -1; // function calls, "&", "**", containers, ...
+}
+
+//-------------------------------------------------------------------------------------------------
+int Nda::ColumnEvaluator::identifier(Runnable *node)
+{
+    for (const auto &column : *mColumns) {
+        if (column.name.size() == node->value.lowerValue.size() &&
+            std::equal(column.name.begin(), column.name.end(), node->value.lowerValue.begin(),
+                       [](char a, char b) { return std::tolower((unsigned char)a) == b; })) {
+            int ret = add(ColumnLeaf, column.type);
+            mSteps[ret].column = &column;
+            return ret;
+        }
+    }
+
+    // variables of the state are constant for the whole batch
+    Symbol *symbol = nullptr;
+    if (!mState.find(node->value.atom, &symbol) || !symbol || !symbol->value || symbol->isVolatile)
+        return -1;
+    return constant(*symbol->value);
+}
+
+//-------------------------------------------------------------------------------------------------
+int Nda::ColumnEvaluator::constant(const NdaVariant &value)
+{
+    int ret;
+    switch (value.type()) {
+    case Nda::Number:
+        ret = add(ConstantLeaf, Column::Number);
+        mSteps[ret].numbers.assign(ChunkSize, value.toDouble());
+        break;
+    case Nda::Natural:
+        ret = add(ConstantLeaf, Column::Natural);
+        mSteps[ret].naturals.assign(ChunkSize, value.toInt64());
+        break;
+    case Nda::Boolean:
+        ret = add(ConstantLeaf, Column::Boolean);
+        mSteps[ret].booleans.assign(ChunkSize, value.toBool() ? 1 : 0);
+        break;
+    case Nda::String: {
+        ret = add(ConstantLeaf, Column::String);
+        Step &step = mSteps[ret];
+        step.constant = value.toString();
+        step.strings.assign(ChunkSize, StringRef{nullptr, step.constant.size()});
+    } break;
+    default:
+        return -1; // Supernatural, Byte, containers, ...
+    }
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+int Nda::ColumnEvaluator::binary(Op op, int left, int right)
+{
+    const Column::Type l = mSteps[left].type;
+    const Column::Type r = mSteps[right].type;
+    const bool numeric = (l == Column::Number || l == Column::Natural) && (r == Column::Number || r == Column::Natural);
+
+    switch (op) {
+    case Add:
+    case Subtract:
+    case Multiply:
+    case Divide:
+        if (!numeric)
+            return -1;
+        if (l == Column::Natural && r == Column::Natural)
+            return add(op, Column::Natural, left, right);
+        return add(op, Column::Number, this->numeric(left, Column::Number), this->numeric(right, Column::Number));
+    case Modulo:
+        if (l != Column::Natural || r != Column::Natural) // Number: rejected by NdaVariant::modulo
+            return -1;
+        return add(op, Column::Natural, left, right);
+    case Equal:
+    case NotEqual:
+    case Less:
+    case Greater:
+    case LessEqual:
+    case GreaterEqual:
+        if (numeric && l != r) // NdaVariant::spaceship: as doubles
+            return add(op, Column::Boolean, this->numeric(left, Column::Number), this->numeric(right, Column::Number));
+        if (l != r)
+            return -1;
+        return add(op, Column::Boolean, left, right);
+    case And:
+    case Or:
+    case Xor:
+        if (l != Column::Boolean || r != Column::Boolean)
+            return -1;
+        return add(op, Column::Boolean, left, right);
+    default:
+        break;
+    }
+
+    assert(0);
+    return -1;
+}
+
+//-------------------------------------------------------------------------------------------------
+int Nda::ColumnEvaluator::numeric(int step, Column::Type type)
+{
+    if (mSteps[step].type == type)
+        return step;
+    assert(type == Column::Number && mSteps[step].type == Column::Natural);
+    return add(ToNumber, Column::Number, step);
+}
+
+//-------------------------------------------------------------------------------------------------
+int Nda::ColumnEvaluator::add(Op op, Column::Type type, int left, int right)
+{
+    Step step;
+    step.op     = op;
+    step.type   = type;
+    step.left   = left;
+    step.right  = right;
+    step.column = nullptr;
+    step.num    = nullptr;
+    step.nat    = nullptr;
+    step.boo    = nullptr;
+    step.str    = nullptr;
+
+    mSteps.push_back(std::move(step));
+    return (int)mSteps.size() - 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool Nda::ColumnEvaluator::run(size_t rows, NeoAda::ResultColumn &result)
+{
+    assert(!mSteps.empty());
+
+    // buffers and fixed pointers
+    for (auto &step : mSteps) {
+        switch (step.op) {
+        case ColumnLeaf:
+            if (step.type == Column::Boolean)
+                step.booleans.resize(ChunkSize);
+            else if (step.type == Column::String)
+                step.strings.resize(ChunkSize);
+            break;
+        case ConstantLeaf:
+            for (auto &s : step.strings)
+                s.data = step.constant.data();
+            break;
+        default:
+            switch (step.type) {
+            case Column::Number:  step.numbers.resize(ChunkSize);  break;
+            case Column::Natural: step.naturals.resize(ChunkSize); break;
+            case Column::Boolean: step.booleans.resize(ChunkSize); break;
+            case Column::String:  step.strings.resize(ChunkSize);  break;
+            }
+            break;
+        }
+        step.num = step.numbers.data();
+        step.nat = step.naturals.data();
+        step.boo = step.booleans.data();
+        step.str = step.strings.data();
+    }
+
+    result = NeoAda::ResultColumn();
+    result.type = mSteps.back().type;
+    if (result.type == Column::String)
+        result.offsets.push_back(0);
+
+    for (size_t begin = 0; begin < rows; begin += ChunkSize) {
+        const size_t count = std::min(ChunkSize, rows - begin);
+        if (!runChunk(begin, count))
+            return false;
+        append(mSteps.back(), count, result);
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool Nda::ColumnEvaluator::runChunk(size_t begin, size_t count)
+{
+    for (auto &step : mSteps) {
+        switch (step.op) {
+        case ColumnLeaf: {
+            const Column &column = *step.column;
+            switch (column.type) {
+            case Column::Number:
+                step.num = static_cast<const double*>(column.values) + begin;
+                break;
+            case Column::Natural:
+                step.nat = static_cast<const int64_t*>(column.values) + begin;
+                break;
+            case Column::Boolean: {
+                const bool *values = static_cast<const bool*>(column.values) + begin;
+                for (size_t i = 0; i < count; i++)
+                    step.booleans[i] = values[i] ? 1 : 0;
+            } break;
+            case Column::String: {
+                const int64_t *offsets = static_cast<const int64_t*>(column.values) + begin;
+                for (size_t i = 0; i < count; i++)
+                    step.strings[i] = StringRef{column.chars + offsets[i], (size_t)(offsets[i + 1] - offsets[i])};
+            } break;
+            }
+        } break;
+        case ConstantLeaf:
+            break;
+        case ToNumber: {
+            const int64_t *in = mSteps[step.left].nat;
+            for (size_t i = 0; i < count; i++)
+                step.numbers[i] = (double)in[i];
+        } break;
+        case Negate:
+            if (step.type == Column::Number) {
+                const double *in = mSteps[step.left].num;
+                for (size_t i = 0; i < count; i++)
+                    step.numbers[i] = -in[i];
+            } else {
+                const int64_t *in = mSteps[step.left].nat;
+                for (size_t i = 0; i < count; i++)
+                    step.naturals[i] = (int64_t)(0 - (uint64_t)in[i]);
+            }
+            break;
+        case Add:
+        case Subtract:
+        case Multiply:
+        case Divide:
+        case Modulo:
+            if (!runArithmetic(step, count))
+                return false;
+            break;
+        case Equal:
+        case NotEqual:
+        case Less:
+        case Greater:
+        case LessEqual:
+        case GreaterEqual:
+            runComparison(step, count);
+            break;
+        case And:
+            binaryLoop(mSteps[step.left].boo, mSteps[step.right].boo, step.booleans.data(), count,
+                       [](uint8_t a, uint8_t b) -> uint8_t { return a && b; });
+            break;
+        case Or:
+            binaryLoop(mSteps[step.left].boo, mSteps[step.right].boo, step.booleans.data(), count,
+                       [](uint8_t a, uint8_t b) -> uint8_t { return a || b; });
+            break;
+        case Xor:
+            binaryLoop(mSteps[step.left].boo, mSteps[step.right].boo, step.booleans.data(), count,
+                       [](uint8_t a, uint8_t b) -> uint8_t { return (a != 0) != (b != 0); });
+            break;
+        }
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool Nda::ColumnEvaluator::runArithmetic(Step &step, size_t count)
+{
+    const Step &left  = mSteps[step.left];
+    const Step &right = mSteps[step.right];
+
+    if (step.type == Column::Number) {
+        const double *a = left.num, *b = right.num;
+        double *out = step.numbers.data();
+        switch (step.op) {
+        case Add:      binaryLoop(a, b, out, count, [](double x, double y) { return x + y; }); break;
+        case Subtract: binaryLoop(a, b, out, count, [](double x, double y) { return x - y; }); break;
+        case Multiply: binaryLoop(a, b, out, count, [](double x, double y) { return x * y; }); break;
+        case Divide:
+            for (size_t i = 0; i < count; i++) {
+                if (b[i] == 0)
+                    return false; // ConstraintError
+                out[i] = a[i] / b[i];
+            }
+            break;
+        default:
+            assert(0);
+            return false;
+        }
+        return true;
+    }
+
+    // Natural: wraps like NdaVariant::add/multiply, the other checks as in NdaVariant
+    const int64_t *a = left.nat, *b = right.nat;
+    int64_t *out = step.naturals.data();
+    switch (step.op) {
+    case Add:
+        binaryLoop(a, b, out, count, [](int64_t x, int64_t y) { return (int64_t)((uint64_t)x + (uint64_t)y); });
+        break;
+    case Multiply:
+        binaryLoop(a, b, out, count, [](int64_t x, int64_t y) { return (int64_t)((uint64_t)x * (uint64_t)y); });
+        break;
+    case Subtract:
+        for (size_t i = 0; i < count; i++) {
+            if ((b[i] > 0 && a[i] < std::numeric_limits<int64_t>::min() + b[i]) ||
+                (b[i] < 0 && a[i] > std::numeric_limits<int64_t>::max() + b[i]))
+                return false;
+            out[i] = a[i] - b[i];
+        }
+        break;
+    case Divide:
+    case Modulo:
+        for (size_t i = 0; i < count; i++) {
+            if (b[i] == 0 || (b[i] == -1 && a[i] == std::numeric_limits<int64_t>::min()))
+                return false;
+            out[i] = step.op == Divide ? a[i] / b[i] : a[i] % b[i];
+        }
+        break;
+    default:
+        assert(0);
+        return false;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void Nda::ColumnEvaluator::runComparison(Step &step, size_t count)
+{
+    const Step &left  = mSteps[step.left];
+    const Step &right = mSteps[step.right];
+    uint8_t *out = step.booleans.data();
+    const Relation relation = (Relation)(step.op - Equal);
+
+    switch (left.type) {
+    case Column::Number: {
+        // NaN: every relation but "<>" is false, as the direct comparison of doubles
+        const double *a = left.num, *b = right.num;
+        switch (relation) {
+        case RelEqual:        binaryLoop(a, b, out, count, [](double x, double y) -> uint8_t { return x == y; }); break;
+        case RelNotEqual:     binaryLoop(a, b, out, count, [](double x, double y) -> uint8_t { return !(x == y); }); break;
+        case RelLess:         binaryLoop(a, b, out, count, [](double x, double y) -> uint8_t { return x < y; }); break;
+        case RelGreater:      binaryLoop(a, b, out, count, [](double x, double y) -> uint8_t { return x > y; }); break;
+        case RelLessEqual:    binaryLoop(a, b, out, count, [](double x, double y) -> uint8_t { return x <= y; }); break;
+        case RelGreaterEqual: binaryLoop(a, b, out, count, [](double x, double y) -> uint8_t { return x >= y; }); break;
+        }
+    } break;
+    case Column::Natural:
+        compareLoop(relation, left.nat, right.nat, out, count,
+                    [](int64_t x, int64_t y) { return x < y ? -1 : (x > y ? 1 : 0); });
+        break;
+    case Column::Boolean:
+        compareLoop(relation, left.boo, right.boo, out, count,
+                    [](uint8_t x, uint8_t y) { return (int)x - (int)y; });
+        break;
+    case Column::String:
+        compareLoop(relation, left.str, right.str, out, count, compareStrings<StringRef>);
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void Nda::ColumnEvaluator::append(const Step &step, size_t count, NeoAda::ResultColumn &result)
+{
+    switch (step.type) {
+    case Column::Number:
+        result.numbers.insert(result.numbers.end(), step.num, step.num + count);
+        break;
+    case Column::Natural:
+        result.naturals.insert(result.naturals.end(), step.nat, step.nat + count);
+        break;
+    case Column::Boolean:
+        result.booleans.insert(result.booleans.end(), step.boo, step.boo + count);
+        break;
+    case Column::String:
+        for (size_t i = 0; i < count; i++) {
+            result.chars.append(step.str[i].data, step.str[i].size);
+            result.offsets.push_back((int64_t)result.chars.size());
+        }
+        break;
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef LIB_NEOADA_COLUMNEVALUATOR_H
+#define LIB_NEOADA_COLUMNEVALUATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../neoadaapi.h"
+#include "runnable.h"
+
+class NdaState;
+class NdaInterpreter;
+
+/*
+    ColumnEvaluator
+
+    Column at a time evaluation of "return <expression>;" for NeoAda::evaluateBatch. The Runnable
+    tree of the expression is lowered into a list of typed steps, children first. Each step runs
+    one loop over a chunk of rows, specialized for its operator and operand types; Natural
+    operands of Number operations get a conversion step, like NdaVariant::doubleAddition & co.
+
+    compile() rejects what the loops don't cover. run() gives up, if a row would take another
+    path in NdaVariant (overflow, division by zero): the caller evaluates row by row then, which
+    yields the exact results and errors.
+*/
+
+namespace Nda {
+
+class ColumnEvaluator
+{
+public:
+    ColumnEvaluator(NdaInterpreter &interpreter, NdaState &state);
+
+    bool compile(Runnable *program, const std::vector<NeoAda::Column> &columns);
+    bool run(size_t rows, NeoAda::ResultColumn &result);
+
+    static const size_t ChunkSize = 1024;
+
+private:
+    struct StringRef {
+        const char *data;
+        size_t      size;
+    };
+
+    enum Op {
+        ColumnLeaf, ConstantLeaf, ToNumber,
+        Add, Subtract, Multiply, Divide, Modulo, Negate,
+        Equal, NotEqual, Less, Greater, LessEqual, GreaterEqual,
+        And, Or, Xor
+    };
+
+    struct Step {
+        Op                     op;
+        NeoAda::Column::Type   type;
+        int                    left;
+        int                    right;
+        const NeoAda::Column  *column;
+
+        std::string            constant;  // ConstantLeaf: String
+
+        std::vector<double>    numbers;   // results of the current chunk
+        std::vector<int64_t>   naturals;
+        std::vector<uint8_t>   booleans;
+        std::vector<StringRef> strings;
+
+        const double          *num;       // -> results or column data
+        const int64_t         *nat;
+        const uint8_t         *boo;
+        const StringRef       *str;
+    };
+
+    int  lower(Runnable *node);
+    int  identifier(Runnable *node);
+    int  constant(const NdaVariant &value);
+    int  binary(Op op, int left, int right);
+    int  numeric(int step, NeoAda::Column::Type type);
+    int  add(Op op, NeoAda::Column::Type type, int left = -1, int right = -1);
+
+    bool runChunk(size_t begin, size_t count);
+    bool runArithmetic(Step &step, size_t count);
+    void runComparison(Step &step, size_t count);
+    void append(const Step &step, size_t count, NeoAda::ResultColumn &result);
+
+    NdaInterpreter                       &mInterpreter;
+    NdaState                             &mState;
+    const std::vector<NeoAda::Column>    *mColumns;
+    std::vector<Step>                     mSteps;
+};
+
+}
+
+#endif // LIB_NEOADA_COLUMNEVALUATOR_H
@@ -0,0 +1,328 @@
+#include "cyclecollector.h"
+#include "shareddata.h"
+#include "../variant.h"
+#include <cassert>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace Nda {
+
+// root buffer of one thread; other threads remove the candidates they free
+struct CandidateSet {
+    std::mutex                      mutex;
+    std::unordered_set<SharedData*> candidates;
+};
+
+namespace {
+
+enum Color : unsigned char {
+    Black = 0, // in use
+    Gray,      // possible member of a cycle
+    White      // garbage
+};
+
+// the sets of exited threads are reused, never freed: a late removeCandidate() finds them empty
+std::mutex &setsMutex()
+{
+    static std::mutex *m = new std::mutex;
+    return *m;
+}
+
+std::vector<CandidateSet*> &freeSets()
+{
+    static std::vector<CandidateSet*> *sets = new std::vector<CandidateSet*>;
+    return *sets;
+}
+
+struct CollectorState {
+    bool                            tracking;
+    bool                            collecting;
+    CandidateSet                   *set;
+    CycleStats                      stats;
+
+    CollectorState() : tracking(false), collecting(false), set(nullptr)
+    {
+        std::lock_guard<std::mutex> lock(setsMutex());
+        if (freeSets().empty()) {
+            set = new CandidateSet;
+        } else {
+            set = freeSets().back();
+            freeSets().pop_back();
+        }
+    }
+
+    ~CollectorState();
+};
+
+thread_local CollectorState sCollector;
+
+}
+
+/*
+    Friend of SharedData: the trial deletion works directly on the reference counters.
+    All graph walks are iterative -> deeply nested containers don't exhaust the stack.
+*/
+class CycleCollectorPrivate
+{
+public:
+    static int  &refs(SharedData *d)          { return d->mReferences; }
+    static unsigned char &color(SharedData *d) { return d->mColor; }
+
+    //---------------------------------------------------------------------------------------------
+    static void clear(CandidateSet *set)
+    {
+        std::lock_guard<std::mutex> lock(set->mutex);
+        for (auto *c : set->candidates)
+            c->mCandidates = nullptr;
+        set->candidates.clear();
+    }
+
+    //---------------------------------------------------------------------------------------------
+    static bool markGray(SharedData *root, size_t maxVisited, size_t &visited)
+    {
+        // false: more than maxVisited objects (0: no limit), the walk is undone
+        std::vector<SharedData*> stack {root};
+        std::vector<SharedData*> children;
+        std::vector<SharedData*> walked;  // children subtracted
+        std::vector<SharedData*> grayed;
+        color(root) = Gray;
+        grayed.push_back(root);
+        while (!stack.empty()) {
+            if (maxVisited && visited >= maxVisited) {
+                for (auto *w : walked) {
+                    children.clear();
+                    w->containerChildren(children);
+                    for (auto *t : children)
+                        refs(t)++;
+                }
+                for (auto *g : grayed)
+                    color(g) = Black;
+                return false;
+            }
+
+            SharedData *s = stack.back();
+            stack.pop_back();
+            walked.push_back(s);
+            visited++;
+            children.clear();
+            s->containerChildren(children);
+            for (auto *t : children) {
+                refs(t)--;
+                if (color(t) != Gray) {
+                    color(t) = Gray;
+                    grayed.push_back(t);
+                    stack.push_back(t);
+                }
+            }
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    static void scanBlack(SharedData *root)
+    {
+        std::vector<SharedData*> stack {root};
+        std::vector<SharedData*> children;
+        color(root) = Black;
+        while (!stack.empty()) {
+            SharedData *s = stack.back();
+            stack.pop_back();
+            children.clear();
+            s->containerChildren(children);
+            for (auto *t : children) {
+                refs(t)++;
+                if (color(t) != Black) {
+                    color(t) = Black;
+                    stack.push_back(t);
+                }
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    static void scan(SharedData *root)
+    {
+        std::vector<SharedData*> stack {root};
+        std::vector<SharedData*> children;
+        while (!stack.empty()) {
+            SharedData *s = stack.back();
+            stack.pop_back();
+            if (color(s) != Gray)
+                continue;
+            if (refs(s) > 0) {
+                scanBlack(s);
+                continue;
+            }
+            color(s) = White;
+            children.clear();
+            s->containerChildren(children);
+            for (auto *t : children)
+                stack.push_back(t);
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    static void collectWhite(SharedData *root, std::vector<SharedData*> &garbage)
+    {
+        std::vector<SharedData*> stack {root};
+        std::vector<SharedData*> children;
+        while (!stack.empty()) {
+            SharedData *s = stack.back();
+            stack.pop_back();
+            if (color(s) != White)
+                continue;
+            color(s) = Black;
+            garbage.push_back(s);
+            children.clear();
+            s->containerChildren(children);
+            for (auto *t : children)
+                stack.push_back(t);
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    static void freeGarbage(const std::vector<SharedData*> &garbage)
+    {
+        std::vector<SharedData*> children;
+
+        // restore the references between the garbage objects (and to the survivors)
+        for (auto *g : garbage) {
+            children.clear();
+            g->containerChildren(children);
+            for (auto *t : children)
+                refs(t)++;
+        }
+
+        // keep all garbage alive until every cycle is cut
+        for (auto *g : garbage)
+            refs(g)++;
+
+        for (auto *g : garbage) {
+            sCollector.stats.collectedObjects++;
+            sCollector.stats.collectedBytes += g->memoryUsage();
+            g->clearChildren();
+        }
+
+        for (auto *g : garbage) {
+            assert(refs(g) == 1);
+            g->releaseRef();
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+CollectorState::~CollectorState()
+{
+    CycleCollectorPrivate::clear(set); // the objects may be freed by other threads later on
+    std::lock_guard<std::mutex> lock(setsMutex());
+    freeSets().push_back(set);
+}
+
+//-------------------------------------------------------------------------------------------------
+void CycleCollector::setTracking(bool enabled)
+{
+    sCollector.tracking = enabled;
+    if (enabled)
+        return;
+
+    CycleCollectorPrivate::clear(sCollector.set);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool CycleCollector::isTracking()
+{
+    return sCollector.tracking && !sCollector.collecting;
+}
+
+//-------------------------------------------------------------------------------------------------
+CycleStats CycleCollector::collect(size_t maxVisited)
+{
+    if (sCollector.collecting)
+        return stats();
+
+    std::vector<SharedData*> candidates;
+    {
+        std::lock_guard<std::mutex> lock(sCollector.set->mutex);
+        candidates.assign(sCollector.set->candidates.begin(), sCollector.set->candidates.end());
+    }
+
+    sCollector.collecting = true;
+    sCollector.stats.runs++;
+
+    // the roots are taken while the walk stays below maxVisited, the first one in any case;
+    // the others stay candidates (freed garbage removes itself)
+    std::vector<SharedData*> roots;
+    size_t visited = 0;
+    for (auto *c : candidates) {
+        if (CycleCollectorPrivate::color(c) != Gray && // else reached from an earlier root
+            !CycleCollectorPrivate::markGray(c, roots.empty() ? 0 : maxVisited, visited))
+            break;
+        removeCandidate(c);
+        roots.push_back(c);
+    }
+    sCollector.stats.scanned += roots.size();
+    sCollector.stats.visited += visited;
+
+    for (auto *r : roots)
+        CycleCollectorPrivate::scan(r);
+
+    std::vector<SharedData*> garbage;
+    for (auto *r : roots)
+        CycleCollectorPrivate::collectWhite(r, garbage);
+
+    CycleCollectorPrivate::freeGarbage(garbage);
+
+    sCollector.collecting = false;
+    return stats();
+}
+
+//-------------------------------------------------------------------------------------------------
+CycleStats CycleCollector::stats()
+{
+    CycleStats ret = sCollector.stats;
+    std::lock_guard<std::mutex> lock(sCollector.set->mutex);
+    ret.candidates = sCollector.set->candidates.size();
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+void CycleCollector::addCandidate(SharedData *data)
+{
+    assert(data && data->mIsContainer);
+    std::lock_guard<std::mutex> lock(sCollector.set->mutex);
+    sCollector.set->candidates.insert(data);
+    data->mCandidates = sCollector.set;
+}
+
+//-------------------------------------------------------------------------------------------------
+void CycleCollector::removeCandidate(SharedData *data)
+{
+    // the set of the thread that added it, not necessarily this one
+    CandidateSet *set = data->mCandidates;
+    if (!set)
+        return;
+
+    std::lock_guard<std::mutex> lock(set->mutex);
+    if (data->mCandidates == set) { // not dropped by an exiting thread meanwhile
+        set->candidates.erase(data);
+        data->mCandidates = nullptr;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+SharedData *CycleCollector::containerOf(const NdaVariant &value)
+{
+    switch (value.myType()) {
+    case Nda::List:
+    case Nda::Dict:
+    case Nda::Record:
+    case Nda::Deque:
+    case Nda::PriorityQueue:
+        return static_cast<SharedData*>(value.mValue.uPtr);
+    default:
+        return nullptr;
+    }
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef LIB_NEOADA_CYCLECOLLECTOR_H
+#define LIB_NEOADA_CYCLECOLLECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+class NdaVariant;
+
+/*
+    NdaCycleCollector
+
+    Reference counting can't free cycles like
+
+        declare d : Dict := {"a": 1};
+        d{"self"} := d;
+
+    If tracking is enabled, every List/Dict/Record that loses a reference but stays alive is recorded
+    as a candidate. collect() runs a trial deletion over these candidates: references inside the
+    candidate subgraphs are subtracted; everything that ends with no outside reference is garbage
+    and freed. The work per call is bounded by the objects visited: candidates are taken until
+    the walk reaches maxVisited, the remaining ones wait for the next call.
+
+    Tracking and candidates are per thread (as the object pools). An object freed by another thread
+    leaves the candidates of the thread that recorded it (SharedData::mCandidates).
+*/
+
+namespace Nda {
+
+class SharedData;
+struct CandidateSet;
+
+struct CycleStats {
+    uint64_t runs;
+    uint64_t candidates;       // waiting for the next run
+    uint64_t scanned;          // candidates processed
+    uint64_t visited;          // objects walked by the trial deletion
+    uint64_t collectedObjects;
+    uint64_t collectedBytes;
+
+    CycleStats() : runs(0), candidates(0), scanned(0), visited(0), collectedObjects(0), collectedBytes(0) {}
+};
+
+class CycleCollector
+{
+public:
+    static void        setTracking(bool enabled);
+    static bool        isTracking();
+
+    static CycleStats  collect(size_t maxVisited = 0); // 0: no limit
+    static CycleStats  stats();
+
+    static void        addCandidate(SharedData *data);
+    static void        removeCandidate(SharedData *data);
+
+    static SharedData *containerOf(const NdaVariant &value); // List/Dict/Record or nullptr
+};
+
+}
+
+#endif // LIB_NEOADA_CYCLECOLLECTOR_H
@@ -1,5 +1,6 @@
 #include "functiontable.h"
 #include "utils.h"
+#include <algorithm>
 #include <cassert>
 #include <exception>
 
@@ -7,83 +8,62 @@ namespace Nda {
 
 
 //-------------------------------------------------------------------------------------------------
-FunctionTable::FunctionTable() {}
+FunctionTable::FunctionTable(AtomTable &atoms, const FunctionTable *builtins)
+    : mAtoms(atoms)
+    , mBuiltins(builtins)
+    , mBuiltinAtoms(builtins ? builtins->mAtoms.size() : 0)
+    , mAddons(0)
+    , mAddon(-1)
+{}
 
 //-------------------------------------------------------------------------------------------------
 void FunctionTable::clear()
 {
     mFunctions.clear();
+    mBoundEntries.clear();
 }
 
 //-------------------------------------------------------------------------------------------------
-bool FunctionTable::bindFnc(const std::string &name, const Nda::FncParameters &parameters, Nda::FncCallback cb)
+bool FunctionTable::bindFnc(Atom type, Atom name, const Nda::FncParameters &parameters, Nda::StateFncCallback cb)
 {
-    std::string lowerName = Nda::toLower(name);
-
-    Nda::OverloadedFunction &variants = mFunctions[lowerName];
-    variants.functionName = lowerName;
-
-    // TODO: check if already there..
-    variants.overloadsByArgCount[(int)parameters.size()].push_back(Nda::FunctionEntry{"",parameters,NdaParser::ASTNodePtr(), nullptr, std::move(cb), nullptr});
-
-    return true;
+    return add(type, name, Nda::FunctionEntry("",parameters,nullptr,nullptr, std::move(cb), nullptr));
 }
 
 //-------------------------------------------------------------------------------------------------
-bool FunctionTable::bindPrc(const std::string &name, const Nda::FncParameters &parameters, Nda::PrcCallback cb)
+bool FunctionTable::bindPrc(Atom type, Atom name, const Nda::FncParameters &parameters, Nda::StatePrcCallback cb)
 {
-
-    std::string lowerName = Nda::toLower(name);
-
-    Nda::OverloadedFunction &variants = mFunctions[lowerName];
-    variants.functionName = lowerName;
-
-    // TODO: check if already there..
-    variants.overloadsByArgCount[(int)parameters.size()].push_back(Nda::FunctionEntry{"",parameters,NdaParser::ASTNodePtr(), nullptr, nullptr, std::move(cb)});
-
-    return true;
+    return add(type, name, Nda::FunctionEntry("",parameters,nullptr,nullptr, nullptr, std::move(cb)));
 }
 
 //-------------------------------------------------------------------------------------------------
-bool FunctionTable::bind(const std::string &name, const Nda::FncParameters &parameters, const NdaParser::ASTNodePtr &block, const std::string &returnType)
+bool FunctionTable::bind(Atom type, Atom name, const FncParameters &parameters,Runnable *block, NdaInterpreter *program, const std::string &returnType)
 {
-    std::string lowerName = Nda::toLower(name);
-
-    Nda::OverloadedFunction &variants = mFunctions[lowerName];
-    variants.functionName = lowerName;
-
-    // TODO: check if already there..
-    variants.overloadsByArgCount[(int)parameters.size()].push_back(Nda::FunctionEntry{Nda::toLower(returnType),parameters,block, nullptr, nullptr, nullptr});
-
-    return true;
+    return add(type, name, Nda::FunctionEntry(Nda::toLower(returnType),parameters, block, program, nullptr, nullptr));
 }
 
 //-------------------------------------------------------------------------------------------------
-bool FunctionTable::bind(const std::string &name, const FncParameters &parameters,Runnable *block, const std::string &returnType)
+bool FunctionTable::contains(Atom type, Atom name, const NdaVariants &parameters) const
 {
-    std::string lowerName = Nda::toLower(name);
-
-    Nda::OverloadedFunction &variants = mFunctions[lowerName];
-    variants.functionName = lowerName;
-
-    // TODO: check if already there..
-    variants.overloadsByArgCount[(int)parameters.size()].push_back(Nda::FunctionEntry{Nda::toLower(returnType),parameters,nullptr, block, nullptr, nullptr});
-
-    return true;
-
+    return symbolPtr(type, name, parameters) != nullptr;
 }
 
 //-------------------------------------------------------------------------------------------------
-bool FunctionTable::contains(const std::string &name, const NdaVariants &parameters)
+const Nda::FunctionEntry *FunctionTable::symbolPtr(Atom type, Atom name, const NdaVariants &parameters) const
 {
-    return symbolPtr(name, parameters) != nullptr;
+    // the builtins first: they were bound before anything of the state, see add()
+    if (name < mBuiltinAtoms) {
+        const auto *entry = mBuiltins->find(type, name, parameters, mAddons);
+        if (entry)
+            return entry;
+    }
+
+    return find(type, name, parameters, ~0ull);
 }
 
 //-------------------------------------------------------------------------------------------------
-Nda::FunctionEntry *FunctionTable::symbolPtr(const std::string &name, const NdaVariants &parameters)
+const Nda::FunctionEntry *FunctionTable::find(Atom type, Atom name, const NdaVariants &parameters, uint64_t addons) const
 {
-    std::string lowerName = Nda::toLower(name);
-    auto functionIt = mFunctions.find(lowerName);
+    auto functionIt = mFunctions.find(key(type, name));
     if (functionIt == mFunctions.end())
         return nullptr;
 
@@ -91,8 +71,8 @@ Nda::FunctionEntry *FunctionTable::symbolPtr(const std::string &name, const NdaV
     if (overloadIt == functionIt->second.overloadsByArgCount.end())
         return nullptr;
 
-    for (auto &variant : overloadIt->second) {
-        if (matches(variant, parameters))
+    for (const auto &variant : overloadIt->second) {
+        if (visible(variant, addons) && matches(variant, parameters))
             return &variant;
     }
 
@@ -100,9 +80,9 @@ Nda::FunctionEntry *FunctionTable::symbolPtr(const std::string &name, const NdaV
 }
 
 //-------------------------------------------------------------------------------------------------
-Nda::FunctionEntry &FunctionTable::symbol(const std::string &name, const NdaVariants &parameters)
+const Nda::FunctionEntry &FunctionTable::symbol(Atom type, Atom name, const NdaVariants &parameters) const
 {
-    auto *entry = symbolPtr(name, parameters);
+    auto *entry = symbolPtr(type, name, parameters);
     if (entry)
         return *entry;
 
@@ -114,11 +94,64 @@ Nda::FunctionEntry &FunctionTable::symbol(const std::string &name, const NdaVari
 std::vector<std::string> FunctionTable::symbolNames() const
 {
     std::vector<std::string>  ret;
+    if (mBuiltins) {
+        for (auto& it: mBuiltins->mFunctions) {
+            for (auto &overloads : it.second.overloadsByArgCount) {
+                if (std::any_of(overloads.second.begin(), overloads.second.end(), [this](const FunctionEntry &entry) { return visible(entry, mAddons); })) {
+                    ret.push_back(it.second.functionName);
+                    break;
+                }
+            }
+        }
+    }
     for (auto& it: mFunctions)
-        ret.push_back(it.first);
+        ret.push_back(it.second.functionName);
     return ret;
 }
 
+//-------------------------------------------------------------------------------------------------
+int FunctionTable::boundEntries(const NdaInterpreter *program) const
+{
+    auto it = mBoundEntries.find(program);
+    return it != mBoundEntries.end() ? it->second : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool FunctionTable::add(Atom type, Atom name, FunctionEntry &&entry)
+{
+    assert(name != Nda::NoAtom);
+
+    entry.addon = mAddon;
+    entry.returnTypeAtom = entry.returnType.empty() ? Nda::NoAtom : mAtoms.intern(entry.returnType);
+    for (const auto &parameter : entry.parameters) {
+        entry.parameterNames.push_back(mAtoms.intern(Nda::toLower(parameter.name)));
+        entry.parameterTypes.push_back(mAtoms.intern(Nda::toLower(parameter.type)));
+    }
+
+    Nda::OverloadedFunction &variants = mFunctions[key(type, name)];
+    variants.functionName = type == Nda::NoAtom ? mAtoms.name(name) : mAtoms.name(type) + ":" + mAtoms.name(name);
+
+    std::vector<FunctionEntry> &overloads = variants.overloadsByArgCount[(int)entry.parameters.size()];
+
+    // NeoAda code defined again (hot reload, a script run again): the new body replaces the old
+    // one in place, entries referenced by running calls stay valid
+    if (entry.callBlock) {
+        mBoundEntries[entry.program]++;
+        for (auto &overload : overloads) {
+            if (overload.callBlock && overload.parameterTypes == entry.parameterTypes) {
+                auto it = mBoundEntries.find(overload.program);
+                if (--it->second == 0)
+                    mBoundEntries.erase(it);
+                overload = std::move(entry);
+                return true;
+            }
+        }
+    }
+
+    overloads.push_back(std::move(entry));
+    return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 bool FunctionTable::matches(const Nda::FunctionEntry &entry, const NdaVariants &parameters) const
 {
@@ -126,38 +159,38 @@ bool FunctionTable::matches(const Nda::FunctionEntry &entry, const NdaVariants &
         return false;
 
     for (int i=0; i<(int)parameters.size(); i++) {
-        if (!parameterMatches(entry.parameters[i].type, parameters[i]))
+        if (!parameterMatches(entry.parameterTypes[i], parameters[i]))
             return false;
     }
     return true;
 }
 
 //-------------------------------------------------------------------------------------------------
-bool FunctionTable::parameterMatches(const std::string &typeName, const NdaVariant &value) const
+bool FunctionTable::parameterMatches(Atom typeName, const NdaVariant &value) const
 {
-    std::string lowerType = Nda::toLower(typeName);
-    if (lowerType == "any")
+    if (typeName == Nda::AnyAtom)
         return true;
 
     auto *runtimeType = value.runtimeType();
-    if (runtimeType && runtimeType->name.lowerValue == lowerType)
+    if (runtimeType && runtimeType->atom == typeName)
         return true;
 
-    if (lowerType == "number") {
+    if (typeName == Nda::NumberAtom) {
         bool ok;
         value.toDouble(&ok);
         return ok;
     }
 
     switch (value.type()) {
-    case Nda::Natural:      return lowerType == "natural";
-    case Nda::Supernatural: return lowerType == "supernatural";
-    case Nda::Boolean:      return lowerType == "boolean";
-    case Nda::Byte:         return lowerType == "byte";
-    case Nda::String:       return lowerType == "string";
-    case Nda::List:         return lowerType == "list";
-    case Nda::Bytes:        return lowerType == "bytes";
-    case Nda::Dict:         return lowerType == "dict";
+    case Nda::Natural:      return typeName == Nda::NaturalAtom;
+    case Nda::Supernatural: return typeName == Nda::SupernaturalAtom;
+    case Nda::BigNatural:   return typeName == Nda::BigNaturalAtom;
+    case Nda::Boolean:      return typeName == Nda::BooleanAtom;
+    case Nda::Byte:         return typeName == Nda::ByteAtom;
+    case Nda::String:       return typeName == Nda::StringAtom;
+    case Nda::List:         return typeName == Nda::ListAtom;
+    case Nda::Bytes:        return typeName == Nda::BytesAtom;
+    case Nda::Dict:         return typeName == Nda::DictAtom;
     default:                return false;
     }
 }
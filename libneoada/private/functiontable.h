@@ -1,6 +1,7 @@
 #ifndef FUNCTIONTABLE_H
 #define FUNCTIONTABLE_H
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <unordered_map>
@@ -10,6 +11,10 @@
 #include "parser.h"
 
 #include "private/runnable.h"
+#include "private/atomtable.h"
+
+class NdaState;
+class NdaInterpreter;
 
 namespace Nda {
 
@@ -33,14 +38,28 @@ using FncValues     = std::unordered_map<std::string, NdaVariant>;
 using FncCallback   = std::function<bool (const FncValues&, NdaVariant &ret)>;
 using PrcCallback   = std::function<bool (const FncValues&)>;
 
+// what the table calls: gets the state of the call, so one callback serves all states (Nda::Builtins)
+using StateFncCallback = std::function<bool (NdaState *state, const FncValues&, NdaVariant &ret)>;
+using StatePrcCallback = std::function<bool (NdaState *state, const FncValues&)>;
+
 struct FunctionEntry {
+    FunctionEntry(const std::string &rt, const FncParameters &p, Nda::Runnable *block, NdaInterpreter *program, StateFncCallback fnc, StatePrcCallback prc)
+        : returnType(rt), parameters(p), callBlock(block), program(program), nativeFncCallback(std::move(fnc)), nativePrcCallback(std::move(prc))
+        , returnTypeAtom(NoAtom), addon(-1) {}
+
     std::string        returnType;
     FncParameters      parameters;
 
-    std::shared_ptr<NdaParser::ASTNode> block;          // NeoAda-Code
-    Nda::Runnable                  *callBlock;
-    FncCallback                     nativeFncCallback;   // c++ Built-in
-    PrcCallback                     nativePrcCallback;   // c++ Built-in
+    Nda::Runnable                  *callBlock;           // NeoAda-Code
+    NdaInterpreter                 *program;             // owns callBlock
+    StateFncCallback                nativeFncCallback;   // c++ Built-in
+    StatePrcCallback                nativePrcCallback;   // c++ Built-in
+
+    // interned by FunctionTable::bind*(), see Nda::AtomTable
+    Nda::Atom                       returnTypeAtom;      // NoAtom: procedure
+    std::vector<Nda::Atom>          parameterNames;
+    std::vector<Nda::Atom>          parameterTypes;
+    int                             addon;               // Nda::Builtins::Addon, -1: bound to the state
 
     FncValues     fncValues(const NdaVariants &values) const;
 };
@@ -53,29 +72,48 @@ struct OverloadedFunction {
 class FunctionTable
 {
 public:
-    FunctionTable();
+    FunctionTable(Nda::AtomTable &atoms, const FunctionTable *builtins = nullptr);
 
     void clear();
 
-    // Init/Setup
-    bool              bindFnc(const std::string &name, const Nda::FncParameters &parameters, Nda::FncCallback cb); // c++ function  callback
-    bool              bindPrc(const std::string &name, const Nda::FncParameters &parameters, Nda::PrcCallback cb); // c++ procedure callback
+    // the shared table of Nda::Builtins: just the entries of the addons in the mask are found
+    inline void       setAddons(uint64_t addons) { mAddons = addons; }
+    inline uint64_t   addons() const             { return mAddons; }
+    inline void       setAddon(int addon)        { mAddon = addon;   } // Nda::Builtins: addon of the entries bound next
 
-    bool              bind(const std::string &name, const Nda::FncParameters &parameters, const NdaParser::ASTNodePtr &block, const std::string &returnType = "");
-    bool              bind(const std::string &name, const Nda::FncParameters &parameters, Nda::Runnable *block, const std::string &returnType = "");
+    // Init/Setup; type == NoAtom: global function/procedure, otherwise method of type
+    bool              bindFnc(Nda::Atom type, Nda::Atom name, const Nda::FncParameters &parameters, Nda::StateFncCallback cb); // c++ function  callback
+    bool              bindPrc(Nda::Atom type, Nda::Atom name, const Nda::FncParameters &parameters, Nda::StatePrcCallback cb); // c++ procedure callback
+
+    bool              bind(Nda::Atom type, Nda::Atom name, const Nda::FncParameters &parameters, Nda::Runnable *block, NdaInterpreter *program, const std::string &returnType = "");
 
 
     // Runtime
-    bool               contains(const std::string &name, const NdaVariants &parameters);
-    Nda::FunctionEntry *symbolPtr(const std::string &name, const NdaVariants &parameters);
-    Nda::FunctionEntry &symbol(const std::string &name, const NdaVariants &parameters);
+    bool                     contains(Nda::Atom type, Nda::Atom name, const NdaVariants &parameters) const;
+    const Nda::FunctionEntry *symbolPtr(Nda::Atom type, Nda::Atom name, const NdaVariants &parameters) const;
+    const Nda::FunctionEntry &symbol(Nda::Atom type, Nda::Atom name, const NdaVariants &parameters) const;
     std::vector<std::string> symbolNames() const;
 
+    // entries with a body of program: NdaRuntime frees a replaced program, when none is left
+    int                      boundEntries(const NdaInterpreter *program) const;
+
 private:
+    static inline uint64_t key(Nda::Atom type, Nda::Atom name) { return ((uint64_t)(uint32_t)type << 32) | (uint32_t)name; }
+
+    bool add(Nda::Atom type, Nda::Atom name, Nda::FunctionEntry &&entry);
+    const Nda::FunctionEntry *find(Nda::Atom type, Nda::Atom name, const NdaVariants &parameters, uint64_t addons) const;
+    static inline bool visible(const Nda::FunctionEntry &entry, uint64_t addons) { return entry.addon < 0 || (addons >> entry.addon) & 1; }
     bool matches(const Nda::FunctionEntry &entry, const NdaVariants &parameters) const;
-    bool parameterMatches(const std::string &typeName, const NdaVariant &value) const;
+    bool parameterMatches(Nda::Atom typeName, const NdaVariant &value) const;
+
+    Nda::AtomTable                                       &mAtoms;
+    std::unordered_map<uint64_t, Nda::OverloadedFunction> mFunctions;
+    std::unordered_map<const NdaInterpreter*, int>        mBoundEntries; // by program, never dereferenced
 
-    std::unordered_map<std::string, Nda::OverloadedFunction> mFunctions;
+    const FunctionTable                                  *mBuiltins;
+    Nda::Atom                                             mBuiltinAtoms; // names from here on are never builtins
+    uint64_t                                              mAddons;
+    int                                                   mAddon;
 };
 
 }
@@ -0,0 +1,409 @@
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <locale>
+#include <sstream>
+#include "numberformat.h"
+
+namespace NdaNumberFormat {
+
+//-------------------------------------------------------------------------------------------------
+//                          Grisu2, Florian Loitsch: "Printing Floating-Point
+//                          Numbers Quickly and Accurately with Integers" (2010)
+//-------------------------------------------------------------------------------------------------
+
+namespace {
+
+const int      SignificandSize = 52;
+const int      ExponentBias    = 0x3FF + SignificandSize;
+const int      MinExponent     = -ExponentBias;
+const uint64_t ExponentMask    = 0x7FF0000000000000ULL;
+const uint64_t SignificandMask = 0x000FFFFFFFFFFFFFULL;
+const uint64_t HiddenBit       = 0x0010000000000000ULL;
+
+const uint64_t Pow10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+    1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+    1000000000000000000ULL, 10000000000000000000ULL
+};
+
+// f * 2^e
+struct DiyFp {
+    DiyFp(uint64_t f = 0, int e = 0) : f(f), e(e) {}
+
+    explicit DiyFp(double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        int biasedExponent = (int)((bits & ExponentMask) >> SignificandSize);
+        uint64_t significand = bits & SignificandMask;
+        if (biasedExponent != 0) {
+            f = significand + HiddenBit;
+            e = biasedExponent - ExponentBias;
+        } else { // denormal
+            f = significand;
+            e = MinExponent + 1;
+        }
+    }
+
+    DiyFp operator-(const DiyFp &other) const { return DiyFp(f - other.f, e); }
+
+    DiyFp operator*(const DiyFp &other) const
+    {
+        const uint64_t mask32 = 0xFFFFFFFFULL;
+        uint64_t a = f >> 32, b = f & mask32;
+        uint64_t c = other.f >> 32, d = other.f & mask32;
+        uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+        uint64_t tmp = (bd >> 32) + (ad & mask32) + (bc & mask32);
+        tmp += 1U << 31; // round
+        return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + other.e + 64);
+    }
+
+    DiyFp normalize() const
+    {
+        DiyFp ret = *this;
+        while (!(ret.f & (uint64_t(1) << 63))) {
+            ret.f <<= 1;
+            ret.e--;
+        }
+        return ret;
+    }
+
+    // neighbours half way to the previous and next double
+    void normalizedBoundaries(DiyFp &minus, DiyFp &plus) const
+    {
+        DiyFp p((f << 1) + 1, e - 1);
+        while (!(p.f & (HiddenBit << 1))) {
+            p.f <<= 1;
+            p.e--;
+        }
+        p.f <<= 64 - SignificandSize - 2;
+        p.e  -= 64 - SignificandSize - 2;
+
+        DiyFp m = (f == HiddenBit) ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
+        m.f <<= m.e - p.e;
+        m.e = p.e;
+
+        minus = m;
+        plus  = p;
+    }
+
+    uint64_t f;
+    int      e;
+};
+
+// 10^-348, 10^-340, ..., 10^340
+DiyFp cachedPower(int e, int &k)
+{
+    static const uint64_t powersF[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+    0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+    0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+    0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+    0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+    0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+    0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+    0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+    0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+    0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+    0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+    0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+    0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+    0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+    0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+    0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+    0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+    0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+    0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+    0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+    0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+    0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+    };
+    static const int16_t powersE[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+    };
+
+    double dk = (-61 - e) * 0.30102999566398114 + 347; // ceil(log10(2^(-61 - e))), always positive
+    int ik = (int)dk;
+    if (dk - ik > 0.0)
+        ik++;
+
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    k = -(-348 + (int)(index << 3));
+    return DiyFp(powersF[index], powersE[index]);
+}
+
+int decimalDigits(uint32_t n)
+{
+    int count = 1;
+    while (n >= 10) {
+        n /= 10;
+        count++;
+    }
+    return count;
+}
+
+void grisuRound(char *buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+    while (rest < distance && delta - rest >= tenKappa &&
+           (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance)) {
+        buffer[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+void digitGen(const DiyFp &w, const DiyFp &mp, uint64_t delta, char *buffer, int &length, int &k)
+{
+    const DiyFp one(uint64_t(1) << -mp.e, mp.e);
+    const DiyFp distance = mp - w;
+    uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+    int kappa = decimalDigits(p1);
+    length = 0;
+
+    while (kappa > 0) {
+        uint32_t divisor = (uint32_t)Pow10[kappa - 1];
+        uint32_t d = p1 / divisor;
+        p1 %= divisor;
+        if (d || length)
+            buffer[length++] = (char)('0' + d);
+        kappa--;
+        uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta) {
+            k += kappa;
+            grisuRound(buffer, length, delta, rest, Pow10[kappa] << -one.e, distance.f);
+            return;
+        }
+    }
+
+    for (;;) { // kappa <= 0
+        p2    *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> -one.e);
+        if (d || length)
+            buffer[length++] = (char)('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            k += kappa;
+            int index = -kappa;
+            grisuRound(buffer, length, delta, p2, one.f, distance.f * (index < 20 ? Pow10[index] : 0));
+            return;
+        }
+    }
+}
+
+// value = digits * 10^k, value > 0
+void grisu2(double value, char *digits, int &length, int &k)
+{
+    const DiyFp v(value);
+    DiyFp minus, plus;
+    v.normalizedBoundaries(minus, plus);
+
+    const DiyFp cached = cachedPower(plus.e, k);
+    const DiyFp w  = v.normalize() * cached;
+    DiyFp       wp = plus * cached;
+    DiyFp       wm = minus * cached;
+    wm.f++;
+    wp.f--;
+    digitGen(w, wp, wp.f - wm.f, digits, length, k);
+}
+
+size_t appendExponent(char *buffer, int exponent)
+{
+    size_t pos = 0;
+    buffer[pos++] = 'e';
+    buffer[pos++] = exponent < 0 ? '-' : '+';
+    if (exponent < 0)
+        exponent = -exponent;
+    char reversed[4];
+    int count = 0;
+    do {
+        reversed[count++] = (char)('0' + exponent % 10);
+        exponent /= 10;
+    } while (exponent);
+    while (count)
+        buffer[pos++] = reversed[--count];
+    return pos;
+}
+
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t formatDouble(double value, char *buffer)
+{
+    if (std::isnan(value)) {
+        std::memcpy(buffer, "nan", 3);
+        return 3;
+    }
+
+    size_t pos = 0;
+    if (std::signbit(value)) {
+        buffer[pos++] = '-';
+        value = -value;
+    }
+
+    if (std::isinf(value)) {
+        std::memcpy(buffer + pos, "inf", 3);
+        return pos + 3;
+    }
+
+    if (value == 0.0) {
+        std::memcpy(buffer + pos, "0.0", 3);
+        return pos + 3;
+    }
+
+    char digits[20];
+    int  length, k;
+    grisu2(value, digits, length, k);
+
+    const int point = length + k; // 10^(point-1) <= value < 10^point
+
+    if (point > 0 && point <= 16) {           // 1234.5, 1200.0
+        if (length <= point) {
+            std::memcpy(buffer + pos, digits, length);
+            pos += length;
+            std::memset(buffer + pos, '0', point - length);
+            pos += point - length;
+            std::memcpy(buffer + pos, ".0", 2);
+            return pos + 2;
+        }
+        std::memcpy(buffer + pos, digits, point);
+        pos += point;
+        buffer[pos++] = '.';
+        std::memcpy(buffer + pos, digits + point, length - point);
+        return pos + length - point;
+    }
+
+    if (point <= 0 && point > -4) {          // 0.00012
+        std::memcpy(buffer + pos, "0.", 2);
+        pos += 2;
+        std::memset(buffer + pos, '0', -point);
+        pos += -point;
+        std::memcpy(buffer + pos, digits, length);
+        return pos + length;
+    }
+
+    buffer[pos++] = digits[0];                // 1.5e+16, 2e-07
+    if (length > 1) {
+        buffer[pos++] = '.';
+        std::memcpy(buffer + pos, digits + 1, length - 1);
+        pos += length - 1;
+    }
+    return pos + appendExponent(buffer + pos, point - 1);
+}
+
+//-------------------------------------------------------------------------------------------------
+std::string formatDouble(double value)
+{
+    char buffer[MaxDoubleLength];
+    return std::string(buffer, formatDouble(value, buffer));
+}
+
+//-------------------------------------------------------------------------------------------------
+bool parseDouble(const char *begin, const char *end, double &value)
+{
+    static const double exactPow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char *pos = begin;
+    bool negative = false;
+    if (pos < end && (*pos == '+' || *pos == '-'))
+        negative = *pos++ == '-';
+
+    uint64_t mantissa  = 0;
+    int      digits    = 0;  // significant digits in mantissa
+    int      exponent  = 0;
+    bool     hasDigits = false;
+    bool     exact     = true;
+
+    for (; pos < end && *pos >= '0' && *pos <= '9'; pos++) {
+        hasDigits = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(*pos - '0');
+            if (mantissa)
+                digits++;
+        } else {
+            exponent++;
+            exact = exact && *pos == '0';
+        }
+    }
+
+    if (pos < end && *pos == '.') {
+        for (pos++; pos < end && *pos >= '0' && *pos <= '9'; pos++) {
+            hasDigits = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(*pos - '0');
+                if (mantissa)
+                    digits++;
+                exponent--;
+            } else {
+                exact = exact && *pos == '0';
+            }
+        }
+    }
+
+    if (!hasDigits)
+        return false;
+
+    if (pos < end && (*pos == 'e' || *pos == 'E')) {
+        pos++;
+        bool negativeExponent = false;
+        if (pos < end && (*pos == '+' || *pos == '-'))
+            negativeExponent = *pos++ == '-';
+        if (pos == end || *pos < '0' || *pos > '9')
+            return false;
+        int explicitExponent = 0;
+        for (; pos < end && *pos >= '0' && *pos <= '9'; pos++) {
+            if (explicitExponent < 100000)
+                explicitExponent = explicitExponent * 10 + (*pos - '0');
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    if (pos != end)
+        return false;
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    // Clinger: mantissa and 10^|exponent| are exact doubles -> one correctly rounded operation
+    if (exact && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        double result = (double)mantissa;
+        result = exponent < 0 ? result / exactPow10[-exponent] : result * exactPow10[exponent];
+        value = negative ? -result : result;
+        return true;
+    }
+#endif
+
+    std::istringstream in(std::string(begin, end));
+    in.imbue(std::locale::classic());
+    in >> value;
+    return !in.fail();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool parseDouble(const std::string &text, double &value)
+{
+    return parseDouble(text.data(), text.data() + text.size(), value);
+}
+
+}
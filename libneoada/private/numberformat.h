@@ -0,0 +1,31 @@
+#ifndef LIB_NEOADA_NUMBERFORMAT_H
+#define LIB_NEOADA_NUMBERFORMAT_H
+
+#include <cstddef>
+#include <string>
+
+/*
+    Number <-> text conversions, shared by NdaVariant::toString(), number literals, Ada.Json
+    and Ada.String.
+
+    formatDouble() prints a text that parses back to the same double (Grisu2). It is the
+    shortest one for all but a few values: 1.0, 0.1, 1234.5, 1e+16, 2.5e-7, nan, inf.
+    Both functions ignore the C locale.
+
+    parseDouble() accepts [+-] digits [. digits] [(e|E) [+-] digits] and nothing else.
+    Up to 19 significant digits with small exponents are converted exactly without any
+    string routine, everything else falls back to the standard library.
+*/
+
+namespace NdaNumberFormat {
+
+static const size_t MaxDoubleLength = 32;
+
+size_t      formatDouble(double value, char *buffer);   // buffer: MaxDoubleLength, not terminated
+std::string formatDouble(double value);
+
+bool        parseDouble(const char *begin, const char *end, double &value);
+bool        parseDouble(const std::string &text, double &value);
+}
+
+#endif // LIB_NEOADA_NUMBERFORMAT_H
@@ -0,0 +1,84 @@
+#include <mutex>
+#include <unordered_map>
+
+#include "packagecache.h"
+#include "programimage.h"
+#include "../exception.h"
+#include "../parser.h"
+
+namespace {
+
+struct Entry {
+    uint64_t                 sourceHash;
+    Nda::PackageCache::Image image;
+};
+
+std::mutex &cacheMutex()
+{
+    static std::mutex m;
+    return m;
+}
+
+std::unordered_map<std::string, Entry> &cacheEntries()
+{
+    static std::unordered_map<std::string, Entry> entries;
+    return entries;
+}
+
+//-------------------------------------------------------------------------------------------------
+// "with" clauses and exactly one "package <name> is ... end <name>;"
+void validate(const NdaParser::AST &ast, const std::string &name, const std::string &fileName)
+{
+    int packages = 0;
+    for (const auto &node : ast.root()->children) {
+        if (node->type == NdaParser::ASTNodeType::Package && node->value.lowerValue == name)
+            packages++;
+        else if (node->type != NdaParser::ASTNodeType::WithAddon)
+            throw NdaException(Nada::Error::InvalidPackage, node->line, node->column, fileName);
+    }
+
+    if (packages != 1)
+        throw NdaException(Nada::Error::InvalidPackage, 0, 0, fileName);
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::PackageCache::Image compile(const std::string &name, const std::string &fileName, const std::string &source)
+{
+    return std::make_shared<const std::string>(Nda::ProgramImage::compile(source, [&](const NdaParser::AST &ast) {
+        validate(ast, name, fileName);
+    }));
+}
+
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::PackageCache::Image Nda::PackageCache::image(const std::string &name, const std::string &fileName, const std::string &source)
+{
+    const uint64_t sourceHash = Nda::ProgramImage::sourceHash(source);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        auto it = cacheEntries().find(fileName);
+        if (it != cacheEntries().end() && it->second.sourceHash == sourceHash)
+            return it->second.image;
+    }
+
+    Image image = compile(name, fileName, source); // unlocked, other runtimes keep loading
+
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    cacheEntries()[fileName] = Entry{sourceHash, image};
+    return image;
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t Nda::PackageCache::size()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    return cacheEntries().size();
+}
+
+//-------------------------------------------------------------------------------------------------
+void Nda::PackageCache::clear()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    cacheEntries().clear();
+}
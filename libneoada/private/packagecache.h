@@ -0,0 +1,35 @@
+#ifndef LIB_NEOADA_PACKAGECACHE_H
+#define LIB_NEOADA_PACKAGECACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/*
+    PackageCache
+
+    Process wide cache of user packages ("with Utils;" -> utils.ada, see NdaRuntime::setPackagePath).
+    A package file is parsed and prepared once and kept as Nda::ProgramImage; every runtime that
+    "with"s it loads its own Runnable tree from the image (runtime caches of the tree belong to one
+    NdaState). Entries are keyed by file name and replaced, when the source of the file changed.
+
+    Thread safe, the images are immutable.
+*/
+
+namespace Nda {
+
+class PackageCache
+{
+public:
+    using Image = std::shared_ptr<const std::string>;
+
+    // throws NdaException: syntax errors, InvalidPackage if the file declares not just "package <name>"
+    static Image  image(const std::string &name, const std::string &fileName, const std::string &source);
+
+    static size_t size();
+    static void   clear();
+};
+
+}
+
+#endif // LIB_NEOADA_PACKAGECACHE_H
@@ -0,0 +1,271 @@
+#include "pool.h"
+#include <cassert>
+#include <map>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+namespace Nda {
+
+namespace {
+
+const size_t SizeClassStep = 16;
+const size_t SizeClasses   = Pool::MaxBlockSize / SizeClassStep;
+const size_t ChunkSize     = 64 * 1024;
+
+struct FreeBlock {
+    FreeBlock *next;
+};
+
+#ifndef NEOADA_NO_POOL
+/*
+    The blocks of exited threads: a thread hands its free-lists over on exit and takes them
+    on its next refill, before a new chunk is requested. Chunks whose blocks are all back
+    in these lists are given back to the global allocator.
+
+    Never destroyed: static variants may be freed after all other statics.
+*/
+struct Orphans {
+    std::mutex                mutex;
+    FreeBlock                *freeLists[SizeClasses];
+    std::map<char*, size_t>   chunks; // start -> bytes, all chunks of all threads
+
+    Orphans() {
+        for (auto &list : freeLists)
+            list = nullptr;
+    }
+
+    // locked
+    void push(size_t sizeClass, FreeBlock *block) {
+        block->next = freeLists[sizeClass];
+        freeLists[sizeClass] = block;
+    }
+    FreeBlock *newChunk(size_t sizeClass, AllocationStats &stats);
+    void releaseFreeChunks(size_t sizeClass);
+};
+
+Orphans &orphans()
+{
+    static Orphans *orphans = new Orphans;
+    return *orphans;
+}
+#endif
+
+/*
+    Trivially destructible on purpose: variants may be destroyed after the thread-locals
+    (static NdaVariants) or on another thread. The free-lists are handed over by ThreadExit,
+    blocks freed on this thread after that go to the Orphans directly.
+*/
+struct ThreadPool {
+    FreeBlock          *freeLists[SizeClasses];
+    AllocationStats     stats;
+    bool                registered; // ThreadExit constructed
+    bool                released;   // ThreadExit destroyed
+
+    void refill(size_t sizeClass);
+    void release();
+};
+
+thread_local ThreadPool sPool;
+
+#ifndef NEOADA_NO_POOL
+struct ThreadExit {
+    ~ThreadExit() { sPool.release(); }
+};
+
+thread_local ThreadExit sThreadExit;
+
+//-------------------------------------------------------------------------------------------------
+FreeBlock *Orphans::newChunk(size_t sizeClass, AllocationStats &stats)
+{
+    const size_t blockSize = (sizeClass + 1) * SizeClassStep;
+    const size_t count     = ChunkSize / blockSize;
+
+    char *chunk = static_cast<char*>(::operator new(blockSize * count));
+    chunks[chunk] = blockSize * count;
+    stats.chunks++;
+    stats.chunkBytes += blockSize * count;
+
+    FreeBlock *list = nullptr;
+    for (size_t i = 0; i < count; i++) {
+        auto *block = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+        block->next = list;
+        list = block;
+    }
+    return list;
+}
+
+//-------------------------------------------------------------------------------------------------
+void Orphans::releaseFreeChunks(size_t sizeClass)
+{
+    if (!freeLists[sizeClass])
+        return;
+
+    const size_t blockSize = (sizeClass + 1) * SizeClassStep;
+
+    // free blocks per chunk: a chunk holds blocks of one size class only
+    std::unordered_map<char*, size_t> freeBlocks;
+    for (FreeBlock *block = freeLists[sizeClass]; block; block = block->next) {
+        auto it = chunks.upper_bound(reinterpret_cast<char*>(block));
+        assert(it != chunks.begin());
+        --it;
+        freeBlocks[it->first]++;
+    }
+
+    bool released = false;
+    for (auto &chunk : freeBlocks) {
+        if (chunk.second == chunks[chunk.first] / blockSize)
+            released = true;
+        else
+            chunk.second = 0; // keep
+    }
+    if (!released)
+        return;
+
+    FreeBlock *keep = nullptr;
+    FreeBlock *block = freeLists[sizeClass];
+    while (block) {
+        FreeBlock *next = block->next;
+        auto it = chunks.upper_bound(reinterpret_cast<char*>(block));
+        --it;
+        if (freeBlocks[it->first] == 0) {
+            block->next = keep;
+            keep = block;
+        }
+        block = next;
+    }
+    freeLists[sizeClass] = keep;
+
+    for (const auto &chunk : freeBlocks) {
+        if (chunk.second == 0)
+            continue;
+        chunks.erase(chunk.first);
+        ::operator delete(chunk.first);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void ThreadPool::refill(size_t sizeClass)
+{
+    if (!registered) {
+        registered = true;
+        (void)&sThreadExit; // constructs it -> release() on thread exit
+    }
+
+    auto &global = orphans();
+    std::lock_guard<std::mutex> lock(global.mutex);
+
+    if (global.freeLists[sizeClass]) {
+        freeLists[sizeClass] = global.freeLists[sizeClass];
+        global.freeLists[sizeClass] = nullptr;
+        return;
+    }
+
+    freeLists[sizeClass] = global.newChunk(sizeClass, stats);
+}
+
+//-------------------------------------------------------------------------------------------------
+void ThreadPool::release()
+{
+    auto &global = orphans();
+    std::lock_guard<std::mutex> lock(global.mutex);
+
+    for (size_t sizeClass = 0; sizeClass < SizeClasses; sizeClass++) {
+        while (FreeBlock *block = freeLists[sizeClass]) {
+            freeLists[sizeClass] = block->next;
+            global.push(sizeClass, block);
+        }
+        global.releaseFreeChunks(sizeClass);
+    }
+    released = true;
+}
+#endif
+
+inline size_t sizeClassOf(size_t size)
+{
+    return (size - 1) / SizeClassStep;
+}
+
+}
+
+//-------------------------------------------------------------------------------------------------
+void *Pool::allocate(size_t size)
+{
+    sPool.stats.allocations++;
+
+#ifdef NEOADA_NO_POOL
+    return ::operator new(size);
+#else
+    if (size == 0 || size > MaxBlockSize)
+        return ::operator new(size);
+
+    const size_t sizeClass = sizeClassOf(size);
+    if (sPool.released) { // thread exit: static destructors
+        auto &global = orphans();
+        std::lock_guard<std::mutex> lock(global.mutex);
+        if (!global.freeLists[sizeClass])
+            global.freeLists[sizeClass] = global.newChunk(sizeClass, sPool.stats);
+        FreeBlock *block = global.freeLists[sizeClass];
+        global.freeLists[sizeClass] = block->next;
+        return block;
+    }
+
+    if (sPool.freeLists[sizeClass])
+        sPool.stats.reused++;
+    else
+        sPool.refill(sizeClass);
+
+    FreeBlock *block = sPool.freeLists[sizeClass];
+    sPool.freeLists[sizeClass] = block->next;
+    return block;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+void Pool::deallocate(void *block, size_t size)
+{
+    if (!block)
+        return;
+
+    sPool.stats.deallocations++;
+
+#ifdef NEOADA_NO_POOL
+    (void)size;
+    ::operator delete(block);
+#else
+    if (size == 0 || size > MaxBlockSize) {
+        ::operator delete(block);
+        return;
+    }
+
+    const size_t sizeClass = sizeClassOf(size);
+    auto *freeBlock = static_cast<FreeBlock*>(block);
+    if (sPool.released) {
+        auto &global = orphans();
+        std::lock_guard<std::mutex> lock(global.mutex);
+        global.push(sizeClass, freeBlock);
+        return;
+    }
+
+    freeBlock->next = sPool.freeLists[sizeClass];
+    sPool.freeLists[sizeClass] = freeBlock;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+AllocationStats Pool::stats()
+{
+    return sPool.stats;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool Pool::enabled()
+{
+#ifdef NEOADA_NO_POOL
+    return false;
+#else
+    return true;
+#endif
+}
+
+}
@@ -0,0 +1,64 @@
+#ifndef LIB_NEOADA_POOL_H
+#define LIB_NEOADA_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+    NdaPool
+
+    Size-class free-lists for the small, short living objects of the interpreter:
+    SharedString/-List/-Bytes/-Dict, Nda::Symbol and heap allocated NdaVariants.
+
+    Freed blocks are kept in a free-list of their size class (16 byte steps, up to MaxBlockSize)
+    and reused by the next allocation of the same class. Larger requests go to the global
+    allocator. The free-lists are per thread, so no locking is needed. On thread exit they are
+    handed to a locked global list, that the next refill of any thread takes first; chunks
+    that are free completely are given back to the global allocator then.
+
+    Define NEOADA_NO_POOL (or build with AddressSanitizer) to bypass the pool: every block
+    is new'd/deleted directly, so sanitizers and valgrind see each allocation.
+*/
+
+#if !defined(NEOADA_NO_POOL) && defined(__SANITIZE_ADDRESS__)
+#define NEOADA_NO_POOL
+#endif
+#if !defined(NEOADA_NO_POOL) && defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define NEOADA_NO_POOL
+#endif
+#endif
+
+namespace Nda {
+
+struct AllocationStats {
+    uint64_t allocations;    // all requests
+    uint64_t deallocations;
+    uint64_t reused;         // served from a free-list
+    uint64_t chunks;         // blocks of memory requested from the global allocator
+    uint64_t chunkBytes;
+
+    AllocationStats() : allocations(0), deallocations(0), reused(0), chunks(0), chunkBytes(0) {}
+    inline uint64_t alive() const { return allocations - deallocations; }
+};
+
+class Pool
+{
+public:
+    static const size_t MaxBlockSize = 256;
+
+    static void *allocate(size_t size);
+    static void  deallocate(void *block, size_t size);
+
+    static AllocationStats stats(); // current thread
+    static bool            enabled();
+};
+
+}
+
+// Class-specific allocation through the pool
+#define NDA_POOL_ALLOCATED \
+    static void *operator new(size_t size)             { return Nda::Pool::allocate(size); } \
+    static void  operator delete(void *p, size_t size) { Nda::Pool::deallocate(p, size); }
+
+#endif // LIB_NEOADA_POOL_H
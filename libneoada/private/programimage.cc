@@ -0,0 +1,341 @@
+#include <cassert>
+#include <cstring>
+#include <unordered_map>
+#include "programimage.h"
+#include "../interpreter.h"
+#include "../lexer.h"
+#include "../state.h"
+
+namespace {
+
+const char     ImageMagic[4] = { 'N', 'D', 'A', 'C' };
+const uint32_t NoIndex       = 0xFFFFFFFF;
+
+//-------------------------------------------------------------------------------------------------
+uint64_t fnv1a(const char *data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+struct NodeRecord {
+    uint32_t call;      // NoIndex: nullptr
+    uint8_t  type;      // Nda::CallMetaType
+    uint8_t  literal;   // NoAtom
+    uint32_t display;   // string index
+    uint32_t lower;
+    int32_t  line;
+    int32_t  column;
+    uint32_t childrenCount;
+    uint32_t rangeLoop; // node index or NoIndex
+};
+
+//-------------------------------------------------------------------------------------------------
+class ImageWriter
+{
+public:
+    ImageWriter(const std::vector<Nda::RunnableCall> &calls) : mCalls(calls) {}
+
+    void add(const Nda::Runnable *node) {
+        mIndex[node] = (uint32_t)mNodes.size();
+
+        NodeRecord r;
+        r.call          = callIndex(node->call);
+        r.type          = (uint8_t)node->type;
+        r.literal       = node->value.atom == Nda::NoAtom;
+        r.display       = string(node->value.displayValue);
+        r.lower         = string(node->value.lowerValue);
+        r.line          = node->line;
+        r.column        = node->column;
+        r.childrenCount = (uint32_t)node->childrenCount;
+        r.rangeLoop     = node->rangeLoop ? mIndex.at(node->rangeLoop) : NoIndex;
+        mNodes.push_back(r);
+    }
+
+    // same order as NdaInterpreter::prepare: siblings first, then their subtrees
+    void addChildren(const Nda::Runnable *node) {
+        for (int i = 0; i < node->childrenCount; i++)
+            add(node->children[i]);
+        for (int i = 0; i < node->childrenCount; i++)
+            addChildren(node->children[i]);
+    }
+
+    std::string image(uint64_t sourceHash) {
+        u32((uint32_t)mNodes.size());
+        u32((uint32_t)mStrings.size());
+
+        for (const auto *s : mStrings) {
+            u32((uint32_t)s->size());
+            mOut.append(*s);
+        }
+
+        for (const auto &r : mNodes) {
+            u32(r.call);
+            mOut += (char)r.type;
+            mOut += (char)r.literal;
+            u32(r.display);
+            u32(r.lower);
+            u32((uint32_t)r.line);
+            u32((uint32_t)r.column);
+            u32(r.childrenCount);
+            u32(r.rangeLoop);
+        }
+
+        const std::string body = std::move(mOut);
+        mOut.clear();
+        mOut.append(ImageMagic, sizeof(ImageMagic));
+        u32(Nda::ProgramImage::FormatVersion);
+        u32((uint32_t)mCalls.size());
+        u64(sourceHash);
+        u64(fnv1a(body.data(), body.size()));
+        return mOut + body;
+    }
+
+private:
+    uint32_t callIndex(Nda::RunnableCall call) const {
+        if (!call)
+            return NoIndex;
+        for (size_t i = 0; i < mCalls.size(); i++)
+            if (mCalls[i] == call)
+                return (uint32_t)i;
+        assert(0 && "dispatch target missing in the call table");
+        return NoIndex;
+    }
+
+    uint32_t string(const std::string &s) {
+        auto it = mStringIndex.find(s);
+        if (it != mStringIndex.end())
+            return it->second;
+        it = mStringIndex.emplace(s, (uint32_t)mStrings.size()).first;
+        mStrings.push_back(&it->first);
+        return it->second;
+    }
+
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; i++)
+            mOut += (char)((v >> (8 * i)) & 0xFF);
+    }
+
+    void u64(uint64_t v) {
+        u32((uint32_t)v);
+        u32((uint32_t)(v >> 32));
+    }
+
+    const std::vector<Nda::RunnableCall>             &mCalls;
+    std::unordered_map<const Nda::Runnable*, uint32_t> mIndex;
+    std::unordered_map<std::string, uint32_t>          mStringIndex;
+    std::vector<const std::string*>                    mStrings;
+    std::vector<NodeRecord>                            mNodes;
+    std::string                                        mOut;
+};
+
+//-------------------------------------------------------------------------------------------------
+class ImageReader
+{
+public:
+    ImageReader(const std::string &image) : mData(image), mPos(0), mOk(true) {}
+
+    inline bool ok() const { return mOk; }
+
+    bool header(uint32_t &version, uint32_t &callCount, uint64_t &sourceHash, uint64_t &checksum) {
+        if (mData.size() < sizeof(ImageMagic) || std::memcmp(mData.data(), ImageMagic, sizeof(ImageMagic)) != 0)
+            return false;
+        mPos       = sizeof(ImageMagic);
+        version    = u32();
+        callCount  = u32();
+        sourceHash = u64();
+        checksum   = u64();
+        return mOk;
+    }
+
+    // hash of the remaining bytes (everything after the header)
+    uint64_t bodyHash() const { return fnv1a(mData.data() + mPos, mData.size() - mPos); }
+
+    uint8_t u8() {
+        if (mPos + 1 > mData.size())
+            return fail();
+        return (uint8_t)mData[mPos++];
+    }
+
+    uint32_t u32() {
+        if (mPos + 4 > mData.size())
+            return fail();
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++)
+            v |= (uint32_t)(uint8_t)mData[mPos++] << (8 * i);
+        return v;
+    }
+
+    uint64_t u64() {
+        uint64_t low = u32();
+        return low | ((uint64_t)u32() << 32);
+    }
+
+    bool bytes(std::string &s, uint32_t length) {
+        if (length > mData.size() - mPos)
+            return fail();
+        s.assign(mData, mPos, length);
+        mPos += length;
+        return true;
+    }
+
+    uint32_t fail() { mOk = false; mPos = mData.size(); return 0; }
+
+private:
+    const std::string &mData;
+    size_t             mPos;
+    bool               mOk;
+};
+
+//-------------------------------------------------------------------------------------------------
+class ProgramBuilder
+{
+public:
+    ProgramBuilder(ImageReader &in, Nda::RunnableArena &arena, Nda::AtomTable &atoms,
+                   const std::vector<Nda::RunnableCall> &calls, const std::vector<std::string> &strings, uint32_t nodeCount)
+        : mIn(in), mArena(arena), mAtoms(atoms), mCalls(calls), mStrings(strings), mNodeCount(nodeCount) {}
+
+    Nda::Runnable *node() {
+        if (!mIn.ok() || mNodes.size() >= mNodeCount)
+            return fail();
+
+        const uint32_t call      = mIn.u32();
+        const uint8_t  type      = mIn.u8();
+        const bool     literal   = mIn.u8() != 0;
+        const uint32_t display   = mIn.u32();
+        const uint32_t lower     = mIn.u32();
+        const int      line      = (int)mIn.u32();
+        const int      column    = (int)mIn.u32();
+        const uint32_t children  = mIn.u32();
+        const uint32_t rangeLoop = mIn.u32();
+
+        if (!mIn.ok() || (call != NoIndex && call >= mCalls.size()) || type > Nda::NcMethodContext ||
+            display >= mStrings.size() || lower >= mStrings.size() ||
+            children > mNodeCount - mNodes.size() - 1 ||
+            (rangeLoop != NoIndex && rangeLoop >= mNodes.size()))
+            return fail();
+
+        // like NdaInterpreter::createRunnable
+        const Nda::AtomString value = mArena.value(mAtoms, literal, mStrings[display], mStrings[lower]);
+
+        Nda::Runnable *ret = mArena.create(line, column, (int)children, value);
+        ret->call      = call != NoIndex ? mCalls[call] : nullptr;
+        ret->type      = (Nda::CallMetaType)type;
+        ret->rangeLoop = rangeLoop != NoIndex ? mNodes[rangeLoop] : nullptr;
+        mNodes.push_back(ret);
+        return ret;
+    }
+
+    bool children(Nda::Runnable *node) {
+        for (int i = 0; i < node->childrenCount; i++) {
+            if (!(node->children[i] = this->node()))
+                return false;
+            node->children[i]->parent = node;
+        }
+        for (int i = 0; i < node->childrenCount; i++) {
+            if (!children(node->children[i]))
+                return false;
+        }
+        return true;
+    }
+
+    inline bool complete() const { return mIn.ok() && mNodes.size() == mNodeCount; }
+
+private:
+    Nda::Runnable *fail() { mIn.fail(); return nullptr; }
+
+    ImageReader                          &mIn;
+    Nda::RunnableArena                   &mArena;
+    Nda::AtomTable                       &mAtoms;
+    const std::vector<Nda::RunnableCall> &mCalls;
+    const std::vector<std::string>       &mStrings;
+    const uint32_t                        mNodeCount;
+    std::vector<Nda::Runnable*>           mNodes;
+};
+
+}
+
+//-------------------------------------------------------------------------------------------------
+uint64_t Nda::ProgramImage::sourceHash(const std::string &source)
+{
+    return fnv1a(source.data(), source.size());
+}
+
+//-------------------------------------------------------------------------------------------------
+bool Nda::ProgramImage::isImage(const std::string &data)
+{
+    return data.size() >= sizeof(ImageMagic) && std::memcmp(data.data(), ImageMagic, sizeof(ImageMagic)) == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool Nda::ProgramImage::header(const std::string &image, uint64_t &sourceHash)
+{
+    ImageReader in(image);
+    uint32_t version = 0, callCount = 0;
+    uint64_t checksum = 0;
+    return in.header(version, callCount, sourceHash, checksum) && version == FormatVersion;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::string Nda::ProgramImage::write(const Runnable *program, const std::string &source, const std::vector<RunnableCall> &calls)
+{
+    assert(program);
+
+    ImageWriter out(calls);
+    out.add(program);
+    out.addChildren(program);
+    return out.image(sourceHash(source));
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::Runnable *Nda::ProgramImage::read(const std::string &image, RunnableArena &arena, AtomTable &atoms, const std::vector<RunnableCall> &calls)
+{
+    ImageReader in(image);
+
+    uint32_t version = 0, callCount = 0;
+    uint64_t hash = 0, checksum = 0;
+    if (!in.header(version, callCount, hash, checksum) || version != FormatVersion || callCount != calls.size())
+        return nullptr;
+
+    // damaged images could still decode to a tree the interpreter cannot run
+    if (in.bodyHash() != checksum)
+        return nullptr;
+
+    const uint32_t nodeCount   = in.u32();
+    const uint32_t stringCount = in.u32();
+    if (!in.ok() || nodeCount == 0 || stringCount > image.size())
+        return nullptr;
+
+    std::vector<std::string> strings(stringCount);
+    for (auto &s : strings) {
+        if (!in.bytes(s, in.u32()))
+            return nullptr;
+    }
+
+    ProgramBuilder builder(in, arena, atoms, calls, strings, nodeCount);
+    Runnable *program = builder.node();
+    if (!program || !builder.children(program) || !builder.complete())
+        return nullptr;
+
+    return program;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::string Nda::ProgramImage::compile(const std::string &source, const std::function<void (const NdaParser::AST &)> &parsed)
+{
+    NdaState       state; // interns the names while lowering, the image stores them as text
+    NdaLexer       lexer;
+    NdaParser      parser(lexer);
+    NdaInterpreter compiler(&state);
+
+    NdaParser::AST ast = parser.parse(source);
+    if (parsed)
+        parsed(ast);
+
+    Runnable *program = compiler.load(ast);
+    return compiler.saveProgram(program, source);
+}
@@ -0,0 +1,59 @@
+#ifndef LIB_NEOADA_PROGRAMIMAGE_H
+#define LIB_NEOADA_PROGRAMIMAGE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "runnable.h"
+#include "../parser.h"
+
+/*
+    ProgramImage
+
+    Versioned binary form of a prepared program (the Runnable tree of NdaInterpreter::load()),
+    written by "neoada --compile" and loaded by NdaRuntime::runCompiled()/runFile() without
+    running lexer and parser.
+
+        header:  "NDAC" | format version | number of dispatch targets | source hash (FNV-1a)
+                 | checksum (FNV-1a of everything behind the header)  (little endian integers)
+        counts:  node count | string count
+        strings: length + bytes, every spelling once
+        nodes:   call index, meta type, display/lower string, literal flag, line, column,
+                 children count, hoisted range loop; in the creation order of NdaInterpreter::prepare
+
+    Dispatch targets are stored as index into the call table of the interpreter, atoms are
+    re-interned by name when loading. Runtime caches (symbols, types, literal values) are not
+    stored, the interpreter rebuilds the literal values after read().
+
+    compile() runs lexer, parser and lowering on a scratch state of its own, so any thread may
+    compile (NdaRuntime::runScripts(), Nda::PackageCache).
+
+    Bump FormatVersion whenever the layout, the call table or the lowering changes.
+*/
+
+namespace Nda {
+
+class ProgramImage
+{
+public:
+    static const uint32_t FormatVersion = 2;
+
+    static uint64_t    sourceHash(const std::string &source);
+    static bool        isImage(const std::string &data);
+    static bool        header(const std::string &image, uint64_t &sourceHash); // false: no (compatible) image
+
+    static std::string write(const Runnable *program, const std::string &source,
+                             const std::vector<RunnableCall> &calls);
+    static Runnable   *read(const std::string &image, RunnableArena &arena, AtomTable &atoms,
+                            const std::vector<RunnableCall> &calls); // nullptr: invalid or incompatible
+
+    // throws NdaException; parsed: called with the AST before lowering (checks, "with"ed packages)
+    static std::string compile(const std::string &source,
+                               const std::function<void (const NdaParser::AST &ast)> &parsed = nullptr);
+};
+
+}
+
+#endif // LIB_NEOADA_PROGRAMIMAGE_H
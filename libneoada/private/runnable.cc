@@ -1,41 +1,102 @@
+#include <new>
 #include "runnable.h"
-#include "../variant.h" // delete variantCache
+#include "../variant.h" // destroy variantCache
 
 //-------------------------------------------------------------------------------------------------
-Nda::Runnable::Runnable(int l, int c, int ccount, const std::string &v)
-    : value(v), parent(nullptr), line(l)
+Nda::Runnable::Runnable(int l, int c, int ccount, const AtomString &v)
+    : call(nullptr), type(CallNOP)
+    , value(v), parent(nullptr), line(l)
     , column(c), variantCache(nullptr)
     , symbolIndex(-1), symbolScope(-1), symbolIsGlobal(false)
+    , typeCache(nullptr)
+    , rangeLoop(nullptr)
 {
     childrenCount = ccount;
-    if (childrenCount > 0) {
-        children = new Runnable*[childrenCount];
-        // children-pointer will be set from caller
-    }
+    children      = nullptr; // allocated by RunnableArena::create, set from caller
 }
 
 //-------------------------------------------------------------------------------------------------
-Nda::Runnable::Runnable(int l, int c, int ccount, const LowerString &v)
-    : value(v), parent(nullptr), line(l)
-    , column(c), variantCache(nullptr)
-    , symbolIndex(-1), symbolScope(-1), symbolIsGlobal(false)
+Nda::RunnableArena::RunnableArena()
+    : mNodeCount(0)
 {
-    childrenCount = ccount;
-    if (childrenCount > 0) {
-        children = new Runnable*[childrenCount];
-        // children-pointer will be set from caller
-    }
 }
 
 //-------------------------------------------------------------------------------------------------
-Nda::Runnable::~Runnable()
+Nda::RunnableArena::~RunnableArena()
+{
+    clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::Runnable *Nda::RunnableArena::create(int l, int c, int ccount, const AtomString &v)
 {
-    if (childrenCount > 0) {
-        for (int i=0; i<childrenCount; i++)
-            delete children[i];
-        delete [] children;
+    // node and its children array in one block
+    const size_t nodeSize = BumpArena::aligned(sizeof(Runnable));
+    char *block = static_cast<char*>(mMemory.allocate(nodeSize + (ccount > 0 ? ccount * sizeof(Runnable*) : 0)));
+
+    Runnable *ret = ::new (block) Runnable(l, c, ccount, v);
+    if (ccount > 0)
+        ret->children = reinterpret_cast<Runnable**>(block + nodeSize);
+
+    if (v.atom != NoAtom)
+        mAtoms.push_back(v.atom);
+    mNodeCount++;
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+/*
+    Names refer to the text of their atom, the spelling and literals are copied into the arena
+    if different (no string is kept by the state for a released program).
+*/
+Nda::AtomString Nda::RunnableArena::value(AtomTable &atoms, bool literal, const std::string &displayValue, const std::string &lowerValue)
+{
+    if (literal) {
+        const std::string &display = text(displayValue);
+        return AtomString{NoAtom, display, lowerValue == displayValue ? display : text(lowerValue)};
     }
 
-    if (variantCache)
-        delete variantCache;
+    const Atom atom = atoms.intern(lowerValue);
+    const std::string &name = atoms.name(atom);
+    return AtomString{atom, displayValue == name ? name : text(displayValue), name};
+}
+
+//-------------------------------------------------------------------------------------------------
+const std::string &Nda::RunnableArena::text(const std::string &value)
+{
+    std::string *ret = ::new (mMemory.allocate(sizeof(std::string))) std::string(value);
+    mTexts.push_back(ret);
+    return *ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant *Nda::RunnableArena::createVariant(const NdaVariant &value, NdaVariant *slot)
+{
+    void *memory = slot ? slot : mMemory.allocate(sizeof(NdaVariant));
+    NdaVariant *ret = ::new (memory) NdaVariant(value); // not NdaPool::allocate
+    mVariants.push_back(ret);
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+void Nda::RunnableArena::releaseVariants()
+{
+    for (auto *variant : mVariants)
+        variant->~NdaVariant();
+    mVariants.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+void Nda::RunnableArena::clear()
+{
+    releaseVariants();
+
+    for (auto *text : mTexts)
+        text->~basic_string();
+    mTexts.clear();
+    mAtoms.clear();
+
+    // Runnables are trivially destructible: just drop the memory
+    mMemory.clear();
+    mNodeCount = 0;
 }
@@ -1,13 +1,20 @@
 #ifndef LIB_NEOADA_RUNNABLE_H
 #define LIB_NEOADA_RUNNABLE_H
 
-#include "utils.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "atomtable.h"
 
 class NdaVariant;
 class NdaInterpreter;
 
 namespace Nda {
 
+struct RuntimeType;
+
 enum CallMetaType {
     CallNOP,
     CallType,
@@ -22,12 +29,15 @@ enum CallMetaType {
     NcMethodContext,
 };
 
+struct Runnable;
+using RunnableCall = void (NdaInterpreter::*)(Runnable* self);
+
 struct Runnable
 {
-    void (NdaInterpreter::*call)(Runnable* self);
+    RunnableCall      call;
     CallMetaType      type;
 
-    Nda::LowerString  value;
+    Nda::AtomString   value;         // see RunnableArena::value()
     Runnable         *parent;
     Runnable        **children;
     int               childrenCount;
@@ -35,14 +45,61 @@ struct Runnable
     int               line;
     int               column;
 
-    NdaVariant       *variantCache;
+    NdaVariant       *variantCache;  // literal value, owned by the RunnableArena
     int               symbolIndex;
     int               symbolScope;
     bool              symbolIsGlobal;
 
-    Runnable(int l, int c, int ccount, const std::string& v = "");
-    Runnable(int l, int c, int ccount, const Nda::LowerString& v);
-    ~Runnable();
+    const RuntimeType *typeCache;     // FieldAccess: record type of the last lookup, symbolIndex == field index
+                                      // ForLoop "A'Range": array type of the running loop
+    Runnable          *rangeLoop;     // AccessOperator "A[i]" in "for i in A'Range": index check hoisted into this loop
+
+    Runnable(int l, int c, int ccount, const Nda::AtomString& v);
+};
+
+/*
+    RunnableArena
+
+    Owns a prepared program: the Runnables, their children arrays and the cached literal values
+    are bump allocated (Nda::BumpArena). A node and its children array are adjacent, siblings are
+    created one after another (see NdaInterpreter::prepare), so the dispatch loop walks mostly
+    sequential memory. Runnables are never destroyed one by one: clear() destroys the cached
+    variants and releases the chunks.
+
+    The cached variants refer to runtime types of the state, so they are released before the
+    state resets its types (releaseVariants) and constructed again in the same place.
+
+    The arena owns the text of literals and records the atoms of its names: the state keeps
+    these atoms over NdaState::reset() (AtomTable::release()).
+*/
+class RunnableArena
+{
+public:
+    RunnableArena();
+    ~RunnableArena();
+
+    Runnable   *create(int l, int c, int ccount, const Nda::AtomString& v);
+    AtomString  value(AtomTable &atoms, bool literal, const std::string &displayValue, const std::string &lowerValue);
+    NdaVariant *createVariant(const NdaVariant &value, NdaVariant *slot = nullptr); // slot: a released variant
+
+    void        releaseVariants(); // destroys the cached variants, their memory stays as slots
+    void        clear();
+
+    inline int    nodeCount() const   { return mNodeCount; }
+    inline const std::vector<Atom> &atoms() const { return mAtoms; }
+    inline size_t memoryUsage() const { return mMemory.memoryUsage(); }
+
+private:
+    RunnableArena(const RunnableArena&) = delete;
+    RunnableArena &operator=(const RunnableArena&) = delete;
+
+    const std::string &text(const std::string &value);
+
+    BumpArena                 mMemory;
+    std::vector<NdaVariant*>  mVariants;
+    std::vector<std::string*> mTexts;    // literals and spellings, see value()
+    std::vector<Atom>         mAtoms;    // of the names, see create()
+    int                       mNodeCount;
 };
 
 }
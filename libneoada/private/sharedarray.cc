@@ -0,0 +1,42 @@
+#include <cassert>
+#include "sharedarray.h"
+
+namespace Nda {
+
+SharedArray::SharedArray(const RuntimeType *type)
+    : SharedData()
+    , mSize((size_t)type->arrayLength())
+{
+    assert(type->dataType == Nda::Array);
+    assert(type->elementType);
+    size_t bytes = mSize * elementSize(type->elementType->dataType);
+    mWords.resize((bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+}
+
+//-------------------------------------------------------------------------------------------------
+SharedArray::SharedArray(const SharedArray *other)
+    : SharedData()
+    , mWords(other->mWords)
+    , mSize(other->mSize)
+{}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedArray::elementSize(Type elementType)
+{
+    switch (elementType) {
+    case Nda::Number:       return sizeof(double);
+    case Nda::Natural:      return sizeof(int64_t);
+    case Nda::Supernatural: return sizeof(uint64_t);
+    case Nda::Boolean:      return 1;
+    case Nda::Byte:         return 1;
+    default:                return 0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedArray::memoryUsage() const
+{
+    return sizeof(SharedArray) + mWords.capacity() * sizeof(uint64_t);
+}
+
+}
@@ -0,0 +1,42 @@
+#ifndef LIB_NEOADA_SHAREDARRAY_H
+#define LIB_NEOADA_SHAREDARRAY_H
+
+#include <cstddef>
+#include <vector>
+
+#include "type.h"
+#include "shareddata.h"
+
+/*
+    SharedArray
+
+    Storage of a constrained array "type Vec is array (1..N) of Number;". The elements are
+    scalars (Number, Natural, Supernatural, Boolean, Byte) and are stored unboxed and
+    contiguous: a Number array of N elements needs N*8 bytes instead of N NdaVariants.
+    Element "first" of the type is at offset 0.
+*/
+
+namespace Nda {
+
+class SharedArray : public Nda::SharedData
+{
+public:
+    SharedArray(const Nda::RuntimeType *type);  // zero initialized
+    SharedArray(const SharedArray *other);      // copy
+
+    static size_t elementSize(Nda::Type elementType); // 0: not a valid element type
+
+    size_t memoryUsage() const override;
+
+    inline unsigned char       *data()        { return (unsigned char*)mWords.data(); }
+    inline const unsigned char *cData() const { return (const unsigned char*)mWords.data(); }
+    inline size_t               size()  const { return mSize; }
+
+private:
+    std::vector<uint64_t> mWords; // 8 byte aligned
+    size_t                mSize;
+};
+
+}
+
+#endif // LIB_NEOADA_SHAREDARRAY_H
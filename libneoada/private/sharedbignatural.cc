@@ -0,0 +1,17 @@
+#include "sharedbignatural.h"
+
+namespace Nda {
+
+//-------------------------------------------------------------------------------------------------
+SharedBigNatural::SharedBigNatural(NdaBigNatural::Digits &&digits)
+    : SharedData()
+    , mDigits(std::move(digits))
+{}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedBigNatural::memoryUsage() const
+{
+    return sizeof(SharedBigNatural) + mDigits.capacity() * sizeof(uint32_t);
+}
+
+}
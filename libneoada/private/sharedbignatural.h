@@ -0,0 +1,31 @@
+#ifndef LIB_NEOADA_SHAREDBIGNATURAL_H
+#define LIB_NEOADA_SHAREDBIGNATURAL_H
+
+#include "bignatural.h"
+#include "shareddata.h"
+
+/*
+    SharedBigNatural
+
+    Immutable digits of a BigNatural, see bignatural.h. Every operation creates a new value,
+    so copies of a BigNatural never detach.
+*/
+
+namespace Nda {
+
+class SharedBigNatural : public Nda::SharedData
+{
+public:
+    SharedBigNatural(NdaBigNatural::Digits &&digits);
+
+    size_t memoryUsage() const override;
+
+    inline const NdaBigNatural::Digits &cDigits() const { return mDigits; }
+
+private:
+    const NdaBigNatural::Digits mDigits;
+};
+
+}
+
+#endif // LIB_NEOADA_SHAREDBIGNATURAL_H
@@ -1,8 +1,78 @@
+#include <cassert>
 #include "sharedbytes.h"
 
 namespace Nda {
 
 SharedBytes::SharedBytes()
+    : mMaterialized(true)
+    , mSource(nullptr)
+    , mOffset(0)
+    , mLength(0)
 {}
 
+//-------------------------------------------------------------------------------------------------
+SharedBytes::SharedBytes(const SharedBytes *source, size_t offset, size_t length)
+    : mMaterialized(false)
+    , mSource(nullptr)
+    , mOffset(offset)
+    , mLength(length)
+{
+    assert(source);
+    assert(offset + length <= source->size());
+
+    if (!source->mMaterialized) { // view of a view -> view of the origin
+        mOffset += source->mOffset;
+        source   = source->mSource;
+    }
+    mSource = const_cast<SharedBytes*>(source);
+    mSource->addRef();
+}
+
+//-------------------------------------------------------------------------------------------------
+SharedBytes::~SharedBytes()
+{
+    if (mSource)
+        mSource->releaseRef();
+}
+
+//-------------------------------------------------------------------------------------------------
+std::vector<NdaVariant> &SharedBytes::array()
+{
+    materialize();
+    return mArray;
+}
+
+//-------------------------------------------------------------------------------------------------
+const std::vector<NdaVariant> &SharedBytes::cArray() const
+{
+    materialize();
+    return mArray;
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedBytes::size() const
+{
+    return mMaterialized ? mArray.size() : mLength;
+}
+
+//-------------------------------------------------------------------------------------------------
+const NdaVariant &SharedBytes::at(size_t index) const
+{
+    assert(index < size());
+    return mMaterialized ? mArray[index] : mSource->at(mOffset + index);
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedBytes::materialize() const
+{
+    if (mMaterialized)
+        return;
+    auto first = mSource->cArray().begin() + mOffset;
+    mArray.assign(first, first + mLength);
+    mMaterialized = true;
+
+    mSource->releaseRef(); // the copy doesn't need it anymore
+    mSource = nullptr;
+}
+
 }
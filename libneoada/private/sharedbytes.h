@@ -6,18 +6,37 @@
 #include "../variant.h"
 #include "shareddata.h"
 
+/*
+    SharedBytes
+
+    Either owns its bytes or is a view (offset + length) into another SharedBytes,
+    see SharedString for the materialization rules.
+*/
+
 namespace Nda {
 
 class SharedBytes : public Nda::SharedData
 {
 public:
     SharedBytes();
+    SharedBytes(const SharedBytes *source, size_t offset, size_t length);
+    ~SharedBytes() override;
 
-    inline std::vector<NdaVariant>        &array()        { return mArray; }
-    inline const std::vector<NdaVariant>  &cArray() const { return mArray; }
+    std::vector<NdaVariant>        &array();
+    const std::vector<NdaVariant>  &cArray() const;
+
+    size_t            size() const;
+    const NdaVariant &at(size_t index) const;
+    inline bool       isView() const { return mSource != nullptr; }
 
 private:
-    std::vector<NdaVariant>  mArray;
+    void materialize() const;
+
+    mutable std::vector<NdaVariant>  mArray;
+    mutable bool                     mMaterialized;
+    mutable SharedBytes             *mSource;
+    size_t                           mOffset;
+    size_t                           mLength;
 };
 
 }
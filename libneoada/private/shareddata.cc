@@ -1,13 +1,21 @@
 #include "shareddata.h"
+#include "cyclecollector.h"
 #include <cassert>
 
 namespace Nda {
 
 //-------------------------------------------------------------------------------------------------
-SharedData::SharedData() : mReferences(1) {}
+SharedData::SharedData(bool isContainer)
+    : mReferences(1)
+    , mIsContainer(isContainer)
+    , mCandidates(nullptr)
+    , mColor(0)
+{}
 
 SharedData::~SharedData()
 {
+    if (mCandidates)
+        CycleCollector::removeCandidate(this); // through the set of the thread that added it
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -23,6 +31,24 @@ void SharedData::releaseRef()
 
     if (--mReferences == 0)
         delete this;
+    else if (mIsContainer && !mCandidates && CycleCollector::isTracking())
+        CycleCollector::addCandidate(this); // may be the last external reference of a cycle
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedData::containerChildren(std::vector<SharedData *> &) const
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedData::clearChildren()
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedData::memoryUsage() const
+{
+    return sizeof(SharedData);
 }
 
 }
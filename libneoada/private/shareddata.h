@@ -1,19 +1,31 @@
 #ifndef LIB_NEOADA_SHAREDDATA_H
 #define LIB_NEOADA_SHAREDDATA_H
 
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "pool.h"
+
 /*
     NadaSharedData
 
     To be used only on HEAP. Shared-Data-Container for Copy-On-Write Values
     like "String" and "Struct"
+
+    Containers (List, Dict) may reference each other in cycles. They are tracked by the
+    Nda::CycleCollector, see cyclecollector.h.
 */
 
 namespace Nda {
 
+class CycleCollector;
+class CycleCollectorPrivate;
+struct CandidateSet;
+
 class SharedData
 {
 public:
-    SharedData();
+    SharedData(bool isContainer = false);
     virtual ~SharedData();
 
     void addRef();
@@ -21,11 +33,24 @@ public:
 
     inline int  refCount() const { return mReferences; }
 
+    // cycle collector interface
+    virtual void   containerChildren(std::vector<SharedData*> &children) const;
+    virtual void   clearChildren();
+    virtual size_t memoryUsage() const;
+
     SharedData(const SharedData&) = delete;            // No Copy
     SharedData& operator=(const SharedData&) = delete; // No Assigment
 
+    NDA_POOL_ALLOCATED
+
 private:
-    int mReferences;
+    friend class CycleCollector;
+    friend class CycleCollectorPrivate;
+
+    int           mReferences;
+    bool          mIsContainer;
+    std::atomic<CandidateSet*> mCandidates; // root buffer of the cycle collector holding it
+    unsigned char mColor;
 };
 
 }
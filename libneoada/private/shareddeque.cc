@@ -0,0 +1,38 @@
+#include "shareddeque.h"
+#include "cyclecollector.h"
+
+namespace Nda {
+
+SharedDeque::SharedDeque()
+    : SharedData(true)
+{}
+
+//-------------------------------------------------------------------------------------------------
+SharedDeque::SharedDeque(const std::deque<NdaVariant> &elements)
+    : SharedData(true)
+    , mDeque(elements)
+{}
+
+//-------------------------------------------------------------------------------------------------
+void SharedDeque::containerChildren(std::vector<SharedData *> &children) const
+{
+    for (const auto &v : mDeque) {
+        auto *child = CycleCollector::containerOf(v);
+        if (child)
+            children.push_back(child);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedDeque::clearChildren()
+{
+    mDeque.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedDeque::memoryUsage() const
+{
+    return sizeof(SharedDeque) + mDeque.size() * sizeof(NdaVariant);
+}
+
+}
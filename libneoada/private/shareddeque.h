@@ -0,0 +1,37 @@
+#ifndef LIB_NEOADA_SHAREDDEQUE_H
+#define LIB_NEOADA_SHAREDDEQUE_H
+
+#include <deque>
+
+#include "../variant.h"
+#include "shareddata.h"
+
+/*
+    SharedDeque
+
+    Double ended queue: constant time push/pop at both ends, unlike List.removeFirst(),
+    which shifts the whole array.
+*/
+
+namespace Nda {
+
+class SharedDeque : public Nda::SharedData
+{
+public:
+    SharedDeque();
+    SharedDeque(const std::deque<NdaVariant> &elements);    // copy
+
+    void   containerChildren(std::vector<SharedData*> &children) const override;
+    void   clearChildren() override;
+    size_t memoryUsage() const override;
+
+    inline std::deque<NdaVariant>        &deque()        { return mDeque; }
+    inline const std::deque<NdaVariant>  &cDeque() const { return mDeque; }
+
+private:
+    std::deque<NdaVariant>  mDeque;
+};
+
+}
+
+#endif // LIB_NEOADA_SHAREDDEQUE_H
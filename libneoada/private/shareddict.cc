@@ -1,7 +1,55 @@
+#include <atomic>
 #include "shareddict.h"
+#include "cyclecollector.h"
 
 namespace Nda {
 
-SharedDict::SharedDict() {}
+namespace {
+
+uint64_t nextGeneration()
+{
+    static std::atomic<uint64_t> generation(0);
+    return generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+}
+
+SharedDict::SharedDict()
+    : SharedData(true)
+    , mIterations(0)
+    , mGeneration(nextGeneration())
+{}
+
+//-------------------------------------------------------------------------------------------------
+void SharedDict::keysChanged()
+{
+    mGeneration = nextGeneration();
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedDict::containerChildren(std::vector<SharedData *> &children) const
+{
+    for (const auto &item : mDict) {
+        auto *child = CycleCollector::containerOf(item.first);
+        if (child)
+            children.push_back(child);
+        child = CycleCollector::containerOf(item.second);
+        if (child)
+            children.push_back(child);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedDict::clearChildren()
+{
+    mDict.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedDict::memoryUsage() const
+{
+    // std::map: one node (key, value, 3 pointers + color) per item
+    return sizeof(SharedDict) + mDict.size() * (2 * sizeof(NdaVariant) + 4 * sizeof(void*));
+}
 
 }
@@ -3,10 +3,22 @@
 
 #include <unordered_map>
 #include <map>
+#include <cstdint>
 
 #include "../variant.h"
 #include "shareddata.h"
 
+/*
+    SharedDict
+
+    Iterations (NdaVariant::forEachDictItem()) hold a reference on the dict, but don't count as
+    a sharing owner: writes through the iterated variable stay in place, see sharingOwners().
+    Inserting or erasing keys changes the generation, which stops the iteration.
+
+    Generations are unique over all dicts, a copy of the keys (detach) takes the generation of
+    its source: the same generation means the same keys.
+*/
+
 namespace Nda {
 
 using StdMap = std::map<NdaVariant,NdaVariant>;
@@ -16,11 +28,24 @@ class SharedDict : public Nda::SharedData
 public:
     SharedDict();
 
+    void   containerChildren(std::vector<SharedData*> &children) const override;
+    void   clearChildren() override;
+    size_t memoryUsage() const override;
+
     inline StdMap        &dict()        { return mDict; }
     inline const StdMap  &cDict() const { return mDict; }
 
+    inline int       sharingOwners() const { return refCount() - mIterations; } // COW decision
+    inline void      beginIteration()      { addRef(); mIterations++; }
+    inline void      endIteration()        { mIterations--; releaseRef(); }
+    inline uint64_t  generation() const    { return mGeneration; }
+    void             keysChanged();
+    inline void      keysCopied(const SharedDict &from) { mGeneration = from.mGeneration; }
+
 private:
-    StdMap  mDict;
+    StdMap    mDict;
+    int       mIterations;
+    uint64_t  mGeneration;
 };
 
 }
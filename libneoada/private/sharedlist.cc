@@ -1,8 +1,113 @@
+#include <cassert>
 #include "sharedlist.h"
+#include "cyclecollector.h"
 
 namespace Nda {
 
 SharedList::SharedList()
+    : SharedData(true)
+    , mMaterialized(true)
+    , mSource(nullptr)
 {}
 
+//-------------------------------------------------------------------------------------------------
+SharedList::SharedList(const SharedList *source)
+    : SharedData(true)
+    , mMaterialized(false)
+    , mSource(const_cast<SharedList*>(source))
+{
+    assert(source);
+    assert(source->mMaterialized);
+    mSource->addRef();
+}
+
+//-------------------------------------------------------------------------------------------------
+SharedList *SharedList::reversed(const SharedList *source)
+{
+    assert(source);
+    if (!source->mMaterialized) { // flipped(flipped(l)) == l
+        source->mSource->addRef();
+        return source->mSource;
+    }
+    return new SharedList(source);
+}
+
+//-------------------------------------------------------------------------------------------------
+SharedList::~SharedList()
+{
+    if (mSource)
+        mSource->releaseRef();
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedList::containerChildren(std::vector<SharedData *> &children) const
+{
+    if (mSource)
+        children.push_back(mSource);
+
+    for (const auto &v : mArray) {
+        auto *child = CycleCollector::containerOf(v);
+        if (child)
+            children.push_back(child);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedList::clearChildren()
+{
+    mArray.clear();
+    mMaterialized = true;
+    if (mSource) {
+        mSource->releaseRef();
+        mSource = nullptr;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedList::memoryUsage() const
+{
+    return sizeof(SharedList) + mArray.capacity() * sizeof(NdaVariant);
+}
+
+//-------------------------------------------------------------------------------------------------
+std::vector<NdaVariant> &SharedList::array()
+{
+    materialize();
+    if (mSource) {
+        mSource->releaseRef();
+        mSource = nullptr;
+    }
+    return mArray;
+}
+
+//-------------------------------------------------------------------------------------------------
+const std::vector<NdaVariant> &SharedList::cArray() const
+{
+    materialize();
+    return mArray;
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedList::size() const
+{
+    return mMaterialized ? mArray.size() : mSource->size();
+}
+
+//-------------------------------------------------------------------------------------------------
+const NdaVariant &SharedList::at(size_t index) const
+{
+    assert(index < size());
+    return mMaterialized ? mArray[index] : mSource->at(mSource->size() - 1 - index);
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedList::materialize() const
+{
+    if (mMaterialized)
+        return;
+    const auto &source = mSource->cArray();
+    mArray.assign(source.rbegin(), source.rend());
+    mMaterialized = true;
+}
+
 }
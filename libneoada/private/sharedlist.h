@@ -6,6 +6,13 @@
 #include "../variant.h"
 #include "shareddata.h"
 
+/*
+    SharedList
+
+    Either owns its elements or is a reversed view into another SharedList (List.flipped()),
+    see SharedString for the materialization rules.
+*/
+
 namespace Nda {
 
 
@@ -13,12 +20,28 @@ class SharedList : public Nda::SharedData
 {
 public:
     SharedList();
+    ~SharedList() override;
+
+    static SharedList *reversed(const SharedList *source); // new reference
 
-    inline std::vector<NdaVariant>        &array()        { return mArray; }
-    inline const std::vector<NdaVariant>  &cArray() const { return mArray; }
+    void   containerChildren(std::vector<SharedData*> &children) const override;
+    void   clearChildren() override;
+    size_t memoryUsage() const override;
+
+    std::vector<NdaVariant>        &array();
+    const std::vector<NdaVariant>  &cArray() const;
+
+    size_t            size() const;
+    const NdaVariant &at(size_t index) const;
+    inline bool       isView() const { return mSource != nullptr; }
 
 private:
-    std::vector<NdaVariant>  mArray;
+    SharedList(const SharedList *source); // reversed view
+    void materialize() const;
+
+    mutable std::vector<NdaVariant>  mArray;
+    mutable bool                     mMaterialized;
+    SharedList                      *mSource;
 };
 
 }
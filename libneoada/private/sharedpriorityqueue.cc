@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cassert>
+#include "sharedpriorityqueue.h"
+#include "cyclecollector.h"
+
+namespace Nda {
+
+SharedPriorityQueue::SharedPriorityQueue()
+    : SharedData(true)
+    , mSequence(0)
+{}
+
+//-------------------------------------------------------------------------------------------------
+SharedPriorityQueue::SharedPriorityQueue(const SharedPriorityQueue *other)
+    : SharedData(true)
+    , mHeap(other->mHeap)
+    , mSequence(other->mSequence)
+{}
+
+//-------------------------------------------------------------------------------------------------
+void SharedPriorityQueue::containerChildren(std::vector<SharedData *> &children) const
+{
+    for (const auto &e : mHeap) {
+        auto *child = CycleCollector::containerOf(e.value);
+        if (child)
+            children.push_back(child);
+        child = CycleCollector::containerOf(e.priority);
+        if (child)
+            children.push_back(child);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedPriorityQueue::clearChildren()
+{
+    mHeap.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedPriorityQueue::memoryUsage() const
+{
+    return sizeof(SharedPriorityQueue) + mHeap.capacity() * sizeof(PriorityQueueEntry);
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedPriorityQueue::push(const NdaVariant &value, const NdaVariant &priority)
+{
+    mHeap.push_back({priority, value, mSequence++});
+    std::push_heap(mHeap.begin(), mHeap.end(), &SharedPriorityQueue::lowerPriority);
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedPriorityQueue::pop()
+{
+    assert(!mHeap.empty());
+    std::pop_heap(mHeap.begin(), mHeap.end(), &SharedPriorityQueue::lowerPriority);
+    mHeap.pop_back();
+}
+
+//-------------------------------------------------------------------------------------------------
+const PriorityQueueEntry &SharedPriorityQueue::top() const
+{
+    assert(!mHeap.empty());
+    return mHeap.front();
+}
+
+//-------------------------------------------------------------------------------------------------
+std::vector<NdaVariant> SharedPriorityQueue::sortedValues() const
+{
+    auto entries = mHeap;
+    std::sort_heap(entries.begin(), entries.end(), &SharedPriorityQueue::lowerPriority);
+
+    // sort_heap: ascending by "lowerPriority" -> the top entry is the last one
+    std::vector<NdaVariant> ret;
+    ret.reserve(entries.size());
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+        ret.push_back(it->value);
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedPriorityQueue::clear()
+{
+    mHeap.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool SharedPriorityQueue::lowerPriority(const PriorityQueueEntry &a, const PriorityQueueEntry &b)
+{
+    // std heaps are max-heaps: "a < b" means a is served after b
+    if (b.priority < a.priority)
+        return true;
+    if (a.priority < b.priority)
+        return false;
+    return a.sequence > b.sequence; // FIFO for equal priorities
+}
+
+}
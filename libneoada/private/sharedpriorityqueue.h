@@ -0,0 +1,53 @@
+#ifndef LIB_NEOADA_SHAREDPRIORITYQUEUE_H
+#define LIB_NEOADA_SHAREDPRIORITYQUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../variant.h"
+#include "shareddata.h"
+
+/*
+    SharedPriorityQueue
+
+    Binary min-heap: the entry with the lowest priority is on top. Without an explicit
+    priority, the value itself is the key. Equal priorities are served in insertion
+    order (mSequence).
+*/
+
+namespace Nda {
+
+struct PriorityQueueEntry {
+    NdaVariant priority;
+    NdaVariant value;
+    uint64_t   sequence;
+};
+
+class SharedPriorityQueue : public Nda::SharedData
+{
+public:
+    SharedPriorityQueue();
+    SharedPriorityQueue(const SharedPriorityQueue *other);  // copy
+
+    void   containerChildren(std::vector<SharedData*> &children) const override;
+    void   clearChildren() override;
+    size_t memoryUsage() const override;
+
+    void                       push(const NdaVariant &value, const NdaVariant &priority);
+    void                       pop();
+    const PriorityQueueEntry  &top() const;
+    std::vector<NdaVariant>    sortedValues() const;        // in pop order
+    void                       clear();
+
+    inline size_t size() const { return mHeap.size(); }
+
+private:
+    static bool lowerPriority(const PriorityQueueEntry &a, const PriorityQueueEntry &b);
+
+    std::vector<PriorityQueueEntry>  mHeap;
+    uint64_t                         mSequence;
+};
+
+}
+
+#endif // LIB_NEOADA_SHAREDPRIORITYQUEUE_H
@@ -0,0 +1,44 @@
+#include <cassert>
+#include "sharedrecord.h"
+#include "cyclecollector.h"
+
+namespace Nda {
+
+SharedRecord::SharedRecord(const RuntimeType *type)
+    : SharedData(true)
+    , mFields(type->fields.size())
+{
+    assert(type->dataType == Nda::Record);
+    for (size_t i = 0; i < mFields.size(); i++)
+        mFields[i].initType(type->fields[i].type);
+}
+
+//-------------------------------------------------------------------------------------------------
+SharedRecord::SharedRecord(const std::vector<NdaVariant> &fields)
+    : SharedData(true)
+    , mFields(fields)
+{}
+
+//-------------------------------------------------------------------------------------------------
+void SharedRecord::containerChildren(std::vector<SharedData *> &children) const
+{
+    for (const auto &v : mFields) {
+        auto *child = CycleCollector::containerOf(v);
+        if (child)
+            children.push_back(child);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedRecord::clearChildren()
+{
+    mFields.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedRecord::memoryUsage() const
+{
+    return sizeof(SharedRecord) + mFields.capacity() * sizeof(NdaVariant);
+}
+
+}
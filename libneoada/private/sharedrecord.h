@@ -0,0 +1,37 @@
+#ifndef LIB_NEOADA_SHAREDRECORD_H
+#define LIB_NEOADA_SHAREDRECORD_H
+
+#include <vector>
+
+#include "../variant.h"
+#include "shareddata.h"
+
+/*
+    SharedRecord
+
+    Field storage of a record value. The layout is defined by RuntimeType::fields,
+    field "i" of the type is mFields[i].
+*/
+
+namespace Nda {
+
+class SharedRecord : public Nda::SharedData
+{
+public:
+    SharedRecord(const Nda::RuntimeType *type);             // initial field values
+    SharedRecord(const std::vector<NdaVariant> &fields);    // copy
+
+    void   containerChildren(std::vector<SharedData*> &children) const override;
+    void   clearChildren() override;
+    size_t memoryUsage() const override;
+
+    inline std::vector<NdaVariant>        &fields()        { return mFields; }
+    inline const std::vector<NdaVariant>  &cFields() const { return mFields; }
+
+private:
+    std::vector<NdaVariant>  mFields;
+};
+
+}
+
+#endif // LIB_NEOADA_SHAREDRECORD_H
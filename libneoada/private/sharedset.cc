@@ -0,0 +1,26 @@
+#include "sharedset.h"
+
+namespace Nda {
+
+//-------------------------------------------------------------------------------------------------
+bool VariantEqual::operator()(const NdaVariant &a, const NdaVariant &b) const
+{
+    if (a.isNan() && b.isNan())
+        return true;
+    return a.equal(b);
+}
+
+//-------------------------------------------------------------------------------------------------
+SharedSet::SharedSet()
+    : SharedData()
+{}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedSet::memoryUsage() const
+{
+    // node: value + next pointer + cached hash
+    return sizeof(SharedSet) + mSet.size() * (sizeof(NdaVariant) + 2 * sizeof(void*))
+                             + mSet.bucket_count() * sizeof(void*);
+}
+
+}
@@ -0,0 +1,44 @@
+#ifndef LIB_NEOADA_SHAREDSET_H
+#define LIB_NEOADA_SHAREDSET_H
+
+#include <unordered_set>
+
+#include "../variant.h"
+#include "shareddata.h"
+
+/*
+    SharedSet
+
+    Hash set of scalar and string values, see NdaVariant::hash(). Elements are compared with
+    NdaVariant::equal(), so 1 and 1.0 are the same element. NaN is treated as one element.
+*/
+
+namespace Nda {
+
+struct VariantHash {
+    inline size_t operator()(const NdaVariant &value) const { return value.hash(); }
+};
+
+struct VariantEqual {
+    bool operator()(const NdaVariant &a, const NdaVariant &b) const;
+};
+
+using StdSet = std::unordered_set<NdaVariant, VariantHash, VariantEqual>;
+
+class SharedSet : public Nda::SharedData
+{
+public:
+    SharedSet();
+
+    size_t memoryUsage() const override;
+
+    inline StdSet        &set()        { return mSet; }
+    inline const StdSet  &cSet() const { return mSet; }
+
+private:
+    StdSet  mSet;
+};
+
+}
+
+#endif // LIB_NEOADA_SHAREDSET_H
@@ -1,3 +1,4 @@
+#include <cassert>
 #include "sharedstring.h"
 
 namespace Nda {
@@ -5,6 +6,73 @@ namespace Nda {
 
 SharedString::SharedString(const std::string &value)
     : mValue(value)
+    , mMaterialized(true)
+    , mSource(nullptr)
+    , mOffset(0)
+    , mLength(0)
 {}
 
+//-------------------------------------------------------------------------------------------------
+SharedString::SharedString(const SharedString *source, size_t offset, size_t length)
+    : mMaterialized(false)
+    , mSource(nullptr)
+    , mOffset(offset)
+    , mLength(length)
+{
+    assert(source);
+    assert(offset + length <= source->length());
+
+    if (!source->mMaterialized) { // view of a view -> view of the origin
+        mOffset += source->mOffset;
+        source   = source->mSource;
+    }
+    mSource = const_cast<SharedString*>(source);
+    mSource->addRef();
+}
+
+//-------------------------------------------------------------------------------------------------
+SharedString::~SharedString()
+{
+    if (mSource)
+        mSource->releaseRef();
+}
+
+//-------------------------------------------------------------------------------------------------
+std::string &SharedString::value()
+{
+    materialize();
+    return mValue;
+}
+
+//-------------------------------------------------------------------------------------------------
+const std::string &SharedString::cValue() const
+{
+    materialize();
+    return mValue;
+}
+
+//-------------------------------------------------------------------------------------------------
+const char *SharedString::data() const
+{
+    return mMaterialized ? mValue.data() : mSource->data() + mOffset;
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t SharedString::length() const
+{
+    return mMaterialized ? mValue.length() : mLength;
+}
+
+//-------------------------------------------------------------------------------------------------
+void SharedString::materialize() const
+{
+    if (mMaterialized)
+        return;
+    mValue.assign(mSource->data() + mOffset, mLength);
+    mMaterialized = true;
+
+    mSource->releaseRef(); // the copy doesn't need it anymore
+    mSource = nullptr;
+}
+
 }
@@ -4,6 +4,15 @@
 #include <string>
 #include "shareddata.h"
 
+/*
+    SharedString
+
+    Either owns its characters or is a view (offset + length) into another SharedString.
+    A view keeps its source alive by holding a reference. Read access through data()/length()
+    never copies, cValue() and value() (write access) materialize the view once and drop the
+    source.
+*/
+
 namespace Nda {
 
 
@@ -11,13 +20,24 @@ class SharedString : public Nda::SharedData
 {
 public:
     SharedString(const std::string &value = "");
+    SharedString(const SharedString *source, size_t offset, size_t length);
+    ~SharedString() override;
+
+    std::string        &value();
+    const std::string  &cValue() const;
 
-    inline std::string        &value()        { return mValue; }
-    inline const std::string  &cValue() const { return mValue; }
+    const char *data() const;
+    size_t      length() const;
+    inline bool isView() const { return mSource != nullptr; }
 
 private:
-    std::string  mValue;
+    void materialize() const;
 
+    mutable std::string   mValue;
+    mutable bool          mMaterialized;
+    mutable SharedString *mSource;
+    size_t                mOffset;
+    size_t                mLength;
 };
 
 }
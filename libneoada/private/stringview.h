@@ -0,0 +1,59 @@
+#ifndef LIB_NEOADA_STRINGVIEW_H
+#define LIB_NEOADA_STRINGVIEW_H
+
+#include <cstring>
+#include <string>
+
+/*
+    StringView
+
+    Non-owning reference to characters of a string (C++11 stand-in for std::string_view).
+    The referenced buffer must outlive the view. Converts implicitly to std::string, so call
+    sites that keep the text just copy it.
+*/
+
+namespace Nda {
+
+class StringView
+{
+public:
+    StringView() : mData(""), mSize(0) {}
+    StringView(const char *data, size_t size) : mData(data), mSize(size) {}
+    explicit StringView(const std::string &s) : mData(s.data()), mSize(s.size()) {}
+
+    inline const char *data() const  { return mData; }
+    inline size_t      size() const  { return mSize; }
+    inline size_t      length() const { return mSize; }
+    inline bool        empty() const { return mSize == 0; }
+    inline char        operator[](size_t i) const { return mData[i]; }
+
+    inline std::string toString() const { return std::string(mData, mSize); }
+    inline operator std::string() const { return toString(); }
+
+    inline bool operator==(const StringView &other) const {
+        return mSize == other.mSize && std::memcmp(mData, other.mData, mSize) == 0;
+    }
+    inline bool operator==(const char *other) const {
+        return std::strncmp(mData, other, mSize) == 0 && other[mSize] == '\0';
+    }
+    inline bool operator==(const std::string &other) const { return *this == StringView(other); }
+
+    template <typename T>
+    inline bool operator!=(const T &other) const { return !(*this == other); }
+
+private:
+    const char *mData;
+    size_t      mSize;
+};
+
+inline bool operator==(const std::string &a, const StringView &b) { return b == a; }
+inline bool operator!=(const std::string &a, const StringView &b) { return !(b == a); }
+inline bool operator==(const char *a, const StringView &b)        { return b == a; }
+inline bool operator!=(const char *a, const StringView &b)        { return !(b == a); }
+
+inline std::string operator+(const std::string &a, const StringView &b) { return std::string(a).append(b.data(), b.size()); }
+inline std::string operator+(const StringView &a, const std::string &b) { return a.toString() + b; }
+
+}
+
+#endif // LIB_NEOADA_STRINGVIEW_H
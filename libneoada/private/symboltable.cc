@@ -21,20 +21,20 @@ NadaSymbolTable::~NadaSymbolTable()
 }
 
 //-------------------------------------------------------------------------------------------------
-bool NadaSymbolTable::contains(const std::string& name) const {
+bool NadaSymbolTable::contains(Nda::Atom name) const {
 
     // return mTable.find(name) != mTable.end();
     for (int i=0; i<mTable.size(); i++)
-        if (mTable.at(i)->name.lowerValue == name)
+        if (mTable.at(i)->atom == name)
             return true;
     return false;
 }
 
 //-------------------------------------------------------------------------------------------------
-int NadaSymbolTable::indexOf(const std::string &name) const
+int NadaSymbolTable::indexOf(Nda::Atom name) const
 {
     for (int i=0; i<mTable.size(); i++)
-        if (mTable.at(i)->name.lowerValue == name)
+        if (mTable.at(i)->atom == name)
             return i;
     return -1;
 }
@@ -42,12 +42,12 @@ int NadaSymbolTable::indexOf(const std::string &name) const
 //-------------------------------------------------------------------------------------------------
 bool NadaSymbolTable::add(const Nda::Symbol &symbol)
 {
-    if (contains(symbol.name.lowerValue))
+    if (contains(symbol.atom))
         return false;
 
     mTable.push_back(new Nda::Symbol());
 
-    mTable.back()->name = symbol.name;
+    mTable.back()->atom = symbol.atom;
     mTable.back()->type = symbol.type;
     mTable.back()->isVolatile = symbol.isVolatile;
     mTable.back()->value = new NdaVariant();
@@ -83,7 +83,7 @@ bool NadaSymbolTable::get(const std::string &name, Nda::Symbol &symbol) const
 
 
 //-------------------------------------------------------------------------------------------------
-bool NadaSymbolTable::get2(const std::string &name, Nda::Symbol **symbol) const
+bool NadaSymbolTable::get2(Nda::Atom name, Nda::Symbol **symbol) const
 {
     /*
     if (mTable.empty())
@@ -98,7 +98,7 @@ bool NadaSymbolTable::get2(const std::string &name, Nda::Symbol **symbol) const
     */
 
     for (int i=0; i<mTable.size(); i++)
-        if (mTable.at(i)->name.lowerValue == name) {
+        if (mTable.at(i)->atom == name) {
             *symbol = mTable.at(i);
             return true;
         }
@@ -111,13 +111,3 @@ void NadaSymbolTable::lookUp(int index, Nda::Symbol **symbol) const
 {
     *symbol = mTable.at(index);
 }
-
-//-------------------------------------------------------------------------------------------------
-std::vector<std::string> NadaSymbolTable::symbolNames() const
-{
-    std::vector<std::string> ret;
-    for (int i=0; i<mTable.size(); i++)
-        ret.push_back(mTable.at(i)->name.displayValue);
-
-    return ret;
-}
@@ -10,17 +10,21 @@
 #include "type.h"
 #include "variant.h"
 #include "utils.h"
+#include "atomtable.h"
+#include "pool.h"
 
 namespace Nda {
 
 struct Symbol {
-    Nda::LowerString        name;
+    Nda::Atom               atom; // name, see Nda::AtomTable
     NdaVariant             *value;
     const Nda::RuntimeType *type;
     bool                    isVolatile;
 
-    Symbol() : value(nullptr), type(nullptr), isVolatile(false) {}
-    Symbol(const std::string &n, const Nda::RuntimeType *t, bool v = false) : name(n), value(nullptr), type(t), isVolatile(v)  {}
+    Symbol() : atom(Nda::NoAtom), value(nullptr), type(nullptr), isVolatile(false) {}
+    Symbol(Nda::Atom a, const Nda::RuntimeType *t, bool v = false) : atom(a), value(nullptr), type(t), isVolatile(v)  {}
+
+    NDA_POOL_ALLOCATED
 };
 
 
@@ -40,16 +44,14 @@ public:
 
     inline Scope scope() const { return mScope; }
 
-    bool contains(const std::string& name) const;
-    int  indexOf(const std::string& name) const;
+    bool contains(Nda::Atom name) const;
+    int  indexOf(Nda::Atom name) const;
 
     bool add(const Nda::Symbol &symbol);
     // bool get(const std::string& name, Nda::Symbol &symbol) const;
-    bool get2(const std::string& name, Nda::Symbol **symbol) const;
+    bool get2(Nda::Atom name, Nda::Symbol **symbol) const;
     void lookUp(int index, Nda::Symbol **symbol) const;
     bool initValue(const std::string& name);
-
-    std::vector<std::string> symbolNames() const;
 private:
     struct MyHash {
         std::size_t operator()(const std::string& key) const {
@@ -36,5 +36,33 @@ Nda::Type Nda::typeByString(const std::string &name)
     if (lowerName == "dict")
         return Nda::Dict;
 
+    if (lowerName == "record")
+        return Nda::Record;
+
+    if (lowerName == "array")
+        return Nda::Array;
+
+    if (lowerName == "set")
+        return Nda::Set;
+
+    if (lowerName == "deque")
+        return Nda::Deque;
+
+    if (lowerName == "priorityqueue")
+        return Nda::PriorityQueue;
+
+    if (lowerName == "bignatural")
+        return Nda::BigNatural;
+
     return Nda::Undefined;
 }
+
+//-------------------------------------------------------------------------------------------------
+int Nda::RuntimeType::fieldIndex(const std::string &lowerName) const
+{
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (fields[i].name.lowerValue == lowerName)
+            return (int)i;
+    }
+    return -1;
+}
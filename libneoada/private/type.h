@@ -1,27 +1,46 @@
 #ifndef TYPE_H
 #define TYPE_H
 
+#include <stdint.h>
 #include <string>
+#include <vector>
 #include <unordered_map>
 #include "utils.h"
+#include "atomtable.h"
 
 namespace Nda {
-    enum Type { Undefined, Reference, Any, Number, Natural, Supernatural, Boolean, Byte, String, List, Bytes, Dict };
+    enum Type { Undefined, Reference, Any, Number, Natural, Supernatural, Boolean, Byte, String, List, Bytes, Dict, Record, Array, Set, Deque, PriorityQueue, BigNatural };
 
     Type typeByString(const std::string &name);
 
+    struct RuntimeType;
+
+    struct RecordField {
+        LowerString        name;
+        const RuntimeType *type;
+    };
+
     struct RuntimeType {
         LowerString name;
+        Atom        atom;        // name, see Nda::AtomTable
         Type        dataType;
         LowerString baseType;
         bool        instantiable;
+        std::vector<RecordField> fields; // Record: fixed layout, index == slot in SharedRecord
+
+        const RuntimeType *elementType;  // Array: scalar element type, stored unboxed in SharedArray
+        int64_t            first;        // Array: index range "first..last"
+        int64_t            last;
+
+        int     fieldIndex(const std::string &lowerName) const; // -1: no such field
+        inline int64_t arrayLength() const { return last - first + 1; }
 
-        RuntimeType() : name(""), dataType(Undefined), baseType(""), instantiable(false) {}
-        RuntimeType(std::string n, Type t, std::string bn, bool i) : name(n), dataType(t), baseType(bn), instantiable(i) {}
-        RuntimeType(LowerString n, Type t, std::string bn, bool i) : name(n), dataType(t), baseType(bn), instantiable(i) {}
+        RuntimeType() : name(""), atom(NoAtom), dataType(Undefined), baseType(""), instantiable(false), elementType(nullptr), first(0), last(-1) {}
+        RuntimeType(std::string n, Type t, std::string bn, bool i) : name(n), atom(NoAtom), dataType(t), baseType(bn), instantiable(i), elementType(nullptr), first(0), last(-1) {}
+        RuntimeType(LowerString n, Type t, std::string bn, bool i) : name(n), atom(NoAtom), dataType(t), baseType(bn), instantiable(i), elementType(nullptr), first(0), last(-1) {}
     };
 
-    using RuntimeTypes = std::unordered_map<std::string, Nda::RuntimeType>;
+    using RuntimeTypes = std::unordered_map<Atom, Nda::RuntimeType>;
 }
 
 
@@ -1,24 +1,25 @@
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <exception>
+#include <fstream>
 #include <iostream>
 #include <ostream>
+#include <sstream>
+#include <thread>
 
 #include "runtime.h"
+#include "document.h"
 #include "exception.h"
 #include "state.h"
 #include "lexer.h"
 #include "parser.h"
 #include "interpreter.h"
+#include "private/builtins.h"
+#include "private/packagecache.h"
+#include "private/programimage.h"
 
-#include "addons/AdaList.h"
 #include "addons/AdaDict.h"
-#include "addons/AdaBytes.h"
-#include "addons/AdaString.h"
-#include "addons/AdaMath.h"
-#include "addons/AdaTextEncoding.h"
-#include "addons/AdaIoFile.h"
-#include "addons/AdaDateTime.h"
-#include "addons/AdaRegexp.h"
-#include "addons/AdaJson.h"
 
 //-------------------------------------------------------------------------------------------------
 NdaRuntime::NdaRuntime()
@@ -47,6 +48,12 @@ void NdaRuntime::reset()
             loadAddonAdaList();
         if (addonName == "ada.dict")
             loadAddonAdaDict();
+        if (addonName == "ada.set")
+            loadAddonAdaSet();
+        if (addonName == "ada.deque")
+            loadAddonAdaDeque();
+        if (addonName == "ada.priorityqueue")
+            loadAddonAdaPriorityQueue();
         if (addonName == "ada.bytes")
             loadAddonAdaBytes();
         if (addonName == "ada.string")
@@ -63,6 +70,7 @@ void NdaRuntime::reset()
             loadAddonAdaRegexp();
         if (addonName == "ada.json")
             loadAddonAdaJson();
+        loadPackage(addonName);
     });
 }
 
@@ -80,17 +88,304 @@ std::string NdaRuntime::lastError() const
 
 //-------------------------------------------------------------------------------------------------
 NdaVariant NdaRuntime::runScript(const std::string &script, NdaException *exception)
+{
+    return run(script, false, exception);
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaRuntime::runCompiled(const std::string &image, NdaException *exception)
+{
+    return run(image, true, exception);
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaRuntime::runFile(const std::string &fileName, NdaException *exception)
+{
+    std::ifstream file(fileName, std::ios::in | std::ios::binary);
+    if (!file) {
+        mLastError = "Cannot open file: " + fileName;
+        std::cerr << mLastError << std::endl;
+        return NdaVariant();
+    }
+
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    const std::string content = buffer.str();
+
+    return run(content, isCompiled(content), exception);
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaRuntime::runDocument(NdaDocument &document, const std::string &script, NdaException *exception)
+{
+    if (!mState)
+        reset();
+
+    mLastError.clear();
+    try {
+        document.update(script);
+        return document.execute(mState);
+    } catch (...) {
+        reportError(exception);
+    }
+
+    return NdaVariant();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaRuntime::reloadFunctions(const std::string &script, NdaException *exception)
+{
+    if (!mState)
+        reset();
+
+    mLastError.clear();
+    try {
+        NdaLexer  lexer;
+        NdaParser parser(lexer);
+        NdaParser::AST ast = parser.parse(script);
+
+        // kept while it owns bound entries: the replaced bodies may still be running
+        NdaInterpreter *unit = new NdaInterpreter(mState);
+        mUnits.push_back(unit);
+        Nda::Runnable *program = unit->loadDefinitions(ast);
+        unit->execute(program);
+        releaseUnits();
+        return true;
+    } catch (...) {
+        reportError(exception);
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaRuntime::compileScript(const std::string &script, std::string &image, NdaException *exception)
 {
     if (!mState)
         reset();
 
     NdaLexer       lexer;
     NdaParser      parser(lexer);
+    NdaInterpreter compiler(mState); // keeps the running program of mInterpreter
+
+    mLastError.clear();
+    try {
+        Nda::Runnable *program = compiler.load(parser.parse(script));
+        image = compiler.saveProgram(program, script);
+        return true;
+    } catch (NdaException &ex) {
+        mLastError = ex.what();
+        if (exception)
+            *exception = ex;
+        else
+            std::cerr << ex.what() << std::endl;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaRuntime::isCompiled(const std::string &data)
+{
+    return Nda::ProgramImage::isImage(data);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaRuntime::isCompiledFrom(const std::string &image, const std::string &script)
+{
+    uint64_t sourceHash = 0;
+    return Nda::ProgramImage::header(image, sourceHash) && sourceHash == Nda::ProgramImage::sourceHash(script);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaRuntime::setPackagePath(const std::vector<std::string> &directories)
+{
+    mPackagePath = directories;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::vector<std::string> NdaRuntime::packagePath() const
+{
+    return mPackagePath;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaRuntime::loadPackage(const std::string &name)
+{
+    if (name.find('.') != std::string::npos) // Ada.* addons, no child packages
+        return;
+
+    std::string source;
+    const std::string fileName = packageFile(name, source);
+    if (fileName.empty())
+        return;
+
+    Nda::PackageCache::Image image = Nda::PackageCache::image(name, fileName, source);
+
+    // an interpreter of its own: the bound subprograms reference its Runnable tree
+    NdaInterpreter *&package = mPackages[name];
+    if (!package)
+        package = new NdaInterpreter(mState);
+
+    Nda::Runnable *program = package->loadProgram(*image, mState);
+    if (!program)
+        throw NdaException(Nada::Error::InvalidProgramImage, 0, 0, fileName);
+    package->execute(program);
+}
+
+//-------------------------------------------------------------------------------------------------
+std::string NdaRuntime::packageFile(const std::string &name, std::string &source) const
+{
+    if (name.find('.') != std::string::npos) // Ada.* addons, no child packages
+        return std::string();
+
+    for (const auto &directory : mPackagePath) {
+        const std::string fileName = directory + "/" + name + ".ada";
+        std::ifstream file(fileName, std::ios::in | std::ios::binary);
+        if (!file)
+            continue;
+
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        source = buffer.str();
+        return fileName;
+    }
+
+    return std::string();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaRuntime::runScripts(const std::vector<std::string> &scripts, NdaException *exception, unsigned threads)
+{
+    if (!mState)
+        reset();
+
+    mLastError.clear();
+
+    // lexer, parser and lowering: the units are taken in turn by the workers
+    std::vector<std::string>        images(scripts.size());
+    std::vector<std::exception_ptr> errors(scripts.size());
+    std::atomic<size_t>             next(0);
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < scripts.size(); i = next++) {
+            try {
+                compileUnit(scripts[i], images[i]);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned)std::min<size_t>(threads, scripts.size());
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker(); // the calling thread takes part
+    for (auto &thread : pool)
+        thread.join();
+
+    // merged in the given order, independent of the scheduling
+    try {
+        for (const auto &error : errors) {
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+        for (const auto &image : images) {
+            NdaInterpreter *unit = new NdaInterpreter(mState); // bound subprograms reference the tree
+            mUnits.push_back(unit);
+            Nda::Runnable *program = unit->loadProgram(image, mState);
+            if (!program)
+                throw NdaException(Nada::Error::InvalidProgramImage, 0, 0);
+
+            unit->execute(program);
+            if (mState->hasUnhandledException())
+                break;
+        }
+        releaseUnits();
+        return !mState->hasUnhandledException();
+    } catch (...) {
+        reportError(exception);
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaRuntime::compileUnit(const std::string &source, std::string &image) const
+//                         any thread: nothing of the runtime is written
+{
+    image = Nda::ProgramImage::compile(source, [this](const NdaParser::AST &ast) {
+        // "with"ed packages are compiled here as well (Nda::PackageCache is shared)
+        for (const auto &node : ast.root()->children) {
+            if (node->type != NdaParser::ASTNodeType::WithAddon)
+                continue;
+
+            std::string packageSource;
+            const std::string fileName = packageFile(node->value.lowerValue, packageSource);
+            if (!fileName.empty())
+                Nda::PackageCache::image(node->value.lowerValue, fileName, packageSource);
+        }
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaRuntime::run(const std::string &input, bool compiled, NdaException *exception)
+{
+    if (!mState)
+        reset();
 
     mLastError.clear();
     try {
-        auto ast = parser.parse(script);
-        return mInterpreter->execute(ast);
+        if (mInterpreter->boundSubprograms()) {
+            // the state calls into the previous program: kept like a unit of runScripts()
+            mUnits.push_back(mInterpreter);
+            mInterpreter = new NdaInterpreter(mState);
+        }
+
+        Nda::Runnable *program = nullptr;
+        if (compiled) {
+            program = mInterpreter->loadProgram(input); // no lexer and parser
+            if (!program)
+                throw NdaException(Nada::Error::InvalidProgramImage, 0, 0);
+        } else {
+            NdaLexer  lexer;
+            NdaParser parser(lexer);
+            program = mInterpreter->load(parser.parse(input)); // the AST is released right after lowering
+        }
+        NdaVariant ret = mInterpreter->execute(program);
+        releaseUnits(); // its definitions may have replaced the ones of previous programs
+        return ret;
+    } catch (...) {
+        reportError(exception);
+    }
+
+    return NdaVariant();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaRuntime::releaseUnits()
+{
+    // all subprograms replaced (hot reload, a script run again): nothing calls into the tree
+    for (size_t i = 0; i < mUnits.size(); ) {
+        if (mUnits[i]->boundSubprograms() || mUnits[i]->running()) {
+            i++;
+            continue;
+        }
+        delete mUnits[i];
+        mUnits.erase(mUnits.begin() + i);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaRuntime::reportError(NdaException *exception)
+{
+    try {
+        throw; // the exception being handled
     } catch (NdaException &ex) {
         mLastError = ex.what();
         if (exception)
@@ -104,8 +399,6 @@ NdaVariant NdaRuntime::runScript(const std::string &script, NdaException *except
         mLastError = "NeoAda Unknown Fatal Runtime Error";
         std::cerr << "NeoAda Fatal Runtime Error!" << std::endl;
     }
-
-    return NdaVariant();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -122,6 +415,24 @@ std::vector<std::string> NdaRuntime::globalFunctions() const
     return mState->globalFunctions();
 }
 
+//-------------------------------------------------------------------------------------------------
+Nda::AllocationStats NdaRuntime::allocationStats() const
+{
+    return Nda::Pool::stats();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaRuntime::setCycleCollection(bool enabled)
+{
+    Nda::CycleCollector::setTracking(enabled);
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::CycleStats NdaRuntime::collectCycles(size_t maxVisited)
+{
+    return Nda::CycleCollector::collect(maxVisited);
+}
+
 
 //-------------------------------------------------------------------------------------------------
 NdaValue NdaRuntime::invokeFnc(const std::string &fncName)
@@ -263,7 +574,7 @@ void NdaRuntime::loadAddonAdaString()
 {
     if (!mState)
         reset();
-    Nda::add_AdaString_symbols(mState);
+    mState->useAddon(Nda::Builtins::AdaString);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -271,7 +582,7 @@ void NdaRuntime::loadAddonAdaList()
 {
     if (!mState)
         reset();
-    Nda::add_AdaList_symbols(mState);
+    mState->useAddon(Nda::Builtins::AdaList);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -282,12 +593,36 @@ void NdaRuntime::loadAddonAdaDict()
     Nda::add_AdaDict_symbols(mState);
 }
 
+//-------------------------------------------------------------------------------------------------
+void NdaRuntime::loadAddonAdaSet()
+{
+    if (!mState)
+        reset();
+    mState->useAddon(Nda::Builtins::AdaSet);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaRuntime::loadAddonAdaDeque()
+{
+    if (!mState)
+        reset();
+    mState->useAddon(Nda::Builtins::AdaDeque);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaRuntime::loadAddonAdaPriorityQueue()
+{
+    if (!mState)
+        reset();
+    mState->useAddon(Nda::Builtins::AdaPriorityQueue);
+}
+
 //-------------------------------------------------------------------------------------------------
 void NdaRuntime::loadAddonAdaBytes()
 {
     if (!mState)
         reset();
-    Nda::add_AdaBytes_symbols(mState);
+    mState->useAddon(Nda::Builtins::AdaBytes);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -295,7 +630,7 @@ void NdaRuntime::loadAddonAdaMath()
 {
     if (!mState)
         reset();
-    Nda::add_AdaMath_symbols(mState);
+    mState->useAddon(Nda::Builtins::AdaMath);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -303,7 +638,7 @@ void NdaRuntime::loadAddonAdaIoFile()
 {
     if (!mState)
         reset();
-    Nda::add_AdaIoFile_symbols(mState);
+    mState->useAddon(Nda::Builtins::AdaIoFile);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -311,7 +646,7 @@ void NdaRuntime::loadAddonAdaTextEncoding()
 {
     if (!mState)
         reset();
-    Nda::add_AdaTextEncoding_symbols(mState);
+    mState->useAddon(Nda::Builtins::AdaTextEncoding);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -319,7 +654,7 @@ void NdaRuntime::loadAddonAdaDateTime()
 {
     if (!mState)
         reset();
-    Nda::add_AdaDateTime_symbols(mState);
+    mState->useAddon(Nda::Builtins::AdaDateTime);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -327,7 +662,7 @@ void NdaRuntime::loadAddonAdaRegexp()
 {
     if (!mState)
         reset();
-    Nda::add_AdaRegexp_symbols(mState);
+    mState->useAddon(Nda::Builtins::AdaRegexp);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -336,12 +671,19 @@ void NdaRuntime::loadAddonAdaJson()
     if (!mState)
         reset();
     loadAddonAdaIoFile();
-    Nda::add_AdaJson_symbols(mState);
+    mState->useAddon(Nda::Builtins::AdaJson);
 }
 
 //-------------------------------------------------------------------------------------------------
 void NdaRuntime::destroy()
 {
+    for (auto &package : mPackages)
+        delete package.second;
+    mPackages.clear();
+    for (auto *unit : mUnits)
+        delete unit;
+    mUnits.clear();
+
     if (mInterpreter) {
         delete mInterpreter;
         mInterpreter = nullptr;
@@ -2,10 +2,14 @@
 #define LIB_NEOADA_RUNTIME_H
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "variant.h"
 #include "value.h"
+#include "private/cyclecollector.h"
 
 class NdaException;
+class NdaDocument;
 class NdaState;
 class NdaInterpreter;
 
@@ -20,9 +24,39 @@ public:
     std::string lastError() const;
 
     NdaVariant runScript(const std::string &script, NdaException *e = nullptr);
-    NdaVariant runFile(const std::string &fileName, NdaException *e = nullptr);
+    NdaVariant runFile(const std::string &fileName, NdaException *e = nullptr);   // source or precompiled program
+
+    // edited script (e.g. in an editor): just the statements changed since the last run are parsed again
+    NdaVariant runDocument(NdaDocument &document, const std::string &script, NdaException *e = nullptr);
+
+    // hot reload: binds the functions and procedures of script into the running program, they
+    // replace the ones with the same parameter types. Globals are kept, the other statements of
+    // script are not run. Between runs or from a native callback.
+    bool       reloadFunctions(const std::string &script, NdaException *e = nullptr);
+
+    // compilation units (e.g. the scripts of an application): lexed, parsed and prepared on up to
+    // "threads" threads (0: one per core), then run one after the other in the given order. Errors
+    // are reported for the first failing unit; nothing runs, if a unit does not compile.
+    bool       runScripts(const std::vector<std::string> &scripts, NdaException *e = nullptr, unsigned threads = 0);
+
+    // precompiled programs: lexer and parser are skipped when running an image
+    bool        compileScript(const std::string &script, std::string &image, NdaException *e = nullptr);
+    NdaVariant  runCompiled(const std::string &image, NdaException *e = nullptr);
+    static bool isCompiled(const std::string &data);                                 // starts like an image
+    static bool isCompiledFrom(const std::string &image, const std::string &script); // same source hash
+
+    // user packages: "with Utils;" loads utils.ada from the first directory that has it. Package
+    // files are parsed once per process and shared by all runtimes (Nda::PackageCache).
+    void        setPackagePath(const std::vector<std::string> &directories);
+    std::vector<std::string> packagePath() const;
+
     NdaState  *state();
     std::vector<std::string> globalFunctions() const;
+    Nda::AllocationStats     allocationStats() const; // pooled objects of the current thread
+
+    // cycle collector: tracking is off by default
+    void            setCycleCollection(bool enabled);
+    Nda::CycleStats collectCycles(size_t maxVisited = 0); // bounded work per call: objects walked, 0: all
 
     NdaValue   invokeFnc(const std::string &fncName);    // function fncName(arg1: any) return any;
     NdaValue   invokeFnc(const std::string &fncName, const NdaValue &arg1);    // function fncName(arg1: any) return any;
@@ -38,6 +72,9 @@ public:
     virtual void loadAddonAdaString();
     virtual void loadAddonAdaList();
     virtual void loadAddonAdaDict();
+    virtual void loadAddonAdaSet();
+    virtual void loadAddonAdaDeque();
+    virtual void loadAddonAdaPriorityQueue();
     virtual void loadAddonAdaBytes();
     virtual void loadAddonAdaMath();
     virtual void loadAddonAdaIoFile();
@@ -48,11 +85,21 @@ public:
 
 private:
     void destroy();
+    NdaVariant run(const std::string &input, bool compiled, NdaException *e);
+    void loadPackage(const std::string &name);
+    std::string packageFile(const std::string &name, std::string &source) const; // empty: not on the path
+    void compileUnit(const std::string &source, std::string &image) const;
+    void reportError(NdaException *e);                                          // in a catch block
+    void releaseUnits();                                                        // the ones without bound subprograms
 
     NdaState        *mState;
     NdaInterpreter  *mInterpreter;
 
     std::string      mLastError;
+
+    std::vector<std::string>                         mPackagePath;
+    std::unordered_map<std::string, NdaInterpreter*> mPackages; // own the subprograms of loaded packages
+    std::vector<NdaInterpreter*>                     mUnits;    // same for runScripts(), reloadFunctions() and previous programs, see releaseUnits()
 };
 
 #endif // NDARUNTIME_H
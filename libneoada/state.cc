@@ -1,18 +1,35 @@
 #include "private/utils.h"
 #include "state.h"
 #include "variant.h"
+#include "interpreter.h"
+#include <algorithm>
 #include <cassert>
+#include <exception>
 
-#define BUILD_METHOD(t,n) (t + ":" + n)
+#define TYPE_ATOM(t) (t.empty() ? Nda::NoAtom : mAtoms.intern(Nda::toLower(t))) // "": global function
 
 //-------------------------------------------------------------------------------------------------
 NdaState::NdaState()
-    : mBooleanType(nullptr)
+    : NdaState(&Nda::Builtins::instance())
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaState::NdaState(const Nda::Builtins *builtins)
+    : mBuiltins(builtins)
+    , mAtoms(builtins ? &builtins->atoms() : nullptr)
+    , mFunctions(mAtoms, builtins ? &builtins->functions() : nullptr)
+    , mBooleanType(nullptr)
     , mNumberType(nullptr)
     , mNaturalType(nullptr)
     , mStringType(nullptr)
     , mListType(nullptr)
     , mBytesType(nullptr)
+    , mDictType(nullptr)
+    , mSetType(nullptr)
+    , mDequeType(nullptr)
+    , mPriorityQueueType(nullptr)
+    , mBigNaturalType(nullptr)
     , mReferenceType(nullptr)
 {
     reset();
@@ -22,6 +39,9 @@ NdaState::NdaState()
 NdaState::~NdaState()
 {
     destroy();
+
+    for (auto *interpreter : mInterpreters)
+        interpreter->mState = nullptr;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -29,17 +49,45 @@ void NdaState::reset()
 {
     destroy();
 
+    // nothing but the loaded programs refers to the names of the state now
+    std::vector<bool> used(mAtoms.size(), false);
+    for (auto *interpreter : mInterpreters)
+        interpreter->markAtoms(used);
+    mAtoms.release(used);
+
     mUnhandledException.clear();
 
     mGlobals.push_back(new NadaSymbolTable(NadaSymbolTable::GlobalScope));
 
-    // register all standard NeoAda Datatypes
+    if (mBuiltins) {
+        // the standard types and "typeof" are shared, see Nda::Builtins
+        const NdaState &core = mBuiltins->state();
+        mFunctions.setAddons(Nda::Builtins::mask(Nda::Builtins::Core));
+
+        mReferenceType     = core.mReferenceType;
+        mNumberType        = core.mNumberType;
+        mNaturalType       = core.mNaturalType;
+        mBigNaturalType    = core.mBigNaturalType;
+        mBooleanType       = core.mBooleanType;
+        mStringType        = core.mStringType;
+        mListType          = core.mListType;
+        mBytesType         = core.mBytesType;
+        mDictType          = core.mDictType;
+        mSetType           = core.mSetType;
+        mDequeType         = core.mDequeType;
+        mPriorityQueueType = core.mPriorityQueueType;
+        return;
+    }
+
+    // register all standard NeoAda Datatypes (once, into the state of Nda::Builtins)
+    mFunctions.setAddon(Nda::Builtins::Core);
     mReferenceType = registerType("Reference",Nda::Reference, false); assert(mReferenceType);
     registerType("Any",Nda::Any, true);
     mNumberType = registerType("Number",Nda::Number, true); assert(mNumberType);
 
     mNaturalType = registerType("Natural",Nda::Natural, true); assert(mNaturalType);
     registerType("Supernatural",Nda::Supernatural, true);
+    mBigNaturalType = registerType("BigNatural",Nda::BigNatural, true); assert(mBigNaturalType);
     registerType("Byte",Nda::Byte, true);
 
     mBooleanType = registerType("Boolean",Nda::Boolean, true); assert(mBooleanType);
@@ -47,13 +95,16 @@ void NdaState::reset()
     mListType    = registerType("List",Nda::List, true);       assert(mListType);
     mBytesType   = registerType("Bytes",Nda::Bytes, true);     assert(mBytesType);
     mDictType    = registerType("Dict",Nda::Dict, true);       assert(mDictType);
+    mSetType     = registerType("Set",Nda::Set, true);         assert(mSetType);
+    mDequeType   = registerType("Deque",Nda::Deque, true);     assert(mDequeType);
+    mPriorityQueueType = registerType("PriorityQueue",Nda::PriorityQueue, true); assert(mPriorityQueueType);
 
-    bindFnc("typeof", {{"value", "Any", Nda::InMode}}, [this](const Nda::FncValues &args, NdaVariant &ret) -> bool {
+    bindFnc("typeof", {{"value", "Any", Nda::InMode}}, [](NdaState *state, const Nda::FncValues &args, NdaVariant &ret) -> bool {
         const auto type = args.at("value").runtimeType();
         if (!type)
             return false;
 
-        ret.fromString(stringType(), type->name.lowerValue);
+        ret.fromString(state->stringType(), type->name.lowerValue);
         return true;
     });
 
@@ -63,21 +114,24 @@ void NdaState::reset()
 const Nda::RuntimeType *NdaState::registerType(std::string name, Nda::Type type, bool instantiable)
 {
     Nda::LowerString lname(name);
-    const auto *currentType = typeByName(lname.lowerValue);
+    const Nda::Atom atom = mAtoms.intern(lname.lowerValue);
+    const auto *currentType = typeByAtom(atom);
     if (currentType) {
         if (currentType->dataType == type) // already registered -> ok..
             return currentType;
     }
 
-    mTypes[lname.lowerValue] = Nda::RuntimeType(lname,type,"",instantiable);
-    return &mTypes[lname.lowerValue];
+    mTypes[atom] = Nda::RuntimeType(lname,type,"",instantiable);
+    mTypes[atom].atom = atom;
+    return &mTypes[atom];
 }
 
 //-------------------------------------------------------------------------------------------------
 const Nda::RuntimeType *NdaState::registerType(std::string name, std::string basename)
 {
     name = Nda::toLower(name);
-    if (mTypes.find(name) != mTypes.end())
+    const Nda::Atom atom = mAtoms.intern(name);
+    if (typeByAtom(atom))
         return nullptr;
 
     const auto *baseType = typeByName(basename);
@@ -87,17 +141,95 @@ const Nda::RuntimeType *NdaState::registerType(std::string name, std::string bas
     if (baseType->instantiable == false) // dont subclass "Reference"!!
         return nullptr;
 
-    mTypes[name] = Nda::RuntimeType(name,baseType->dataType,basename,true);
-    return &mTypes.at(name);
+    mTypes[atom] = Nda::RuntimeType(name,baseType->dataType,basename,true);
+    mTypes[atom].atom = atom;
+    mTypes[atom].fields = baseType->fields; // "type Point3 is Point;" -> same layout
+    mTypes[atom].elementType = baseType->elementType;
+    mTypes[atom].first       = baseType->first;
+    mTypes[atom].last        = baseType->last;
+    return &mTypes.at(atom);
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::RuntimeType *NdaState::registerRecord(std::string name, const std::vector<std::pair<std::string, std::string> > &fields)
+{
+    Nda::LowerString lname(name);
+    const Nda::Atom atom = mAtoms.intern(lname.lowerValue);
+    if (typeByAtom(atom))
+        return nullptr;
+
+    Nda::RuntimeType recordType(lname,Nda::Record,"record",true);
+    recordType.atom = atom;
+    for (const auto &field : fields) {
+        Nda::LowerString fieldName(field.first);
+        const auto *fieldType = typeByName(Nda::toLower(field.second));
+        if (!fieldType || !fieldType->instantiable)
+            return nullptr;
+        if (recordType.fieldIndex(fieldName.lowerValue) >= 0) // duplicate
+            return nullptr;
+        recordType.fields.push_back({fieldName, fieldType});
+    }
+
+    mTypes[atom] = recordType;
+    return &mTypes.at(atom);
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::RuntimeType *NdaState::registerArray(std::string name, int64_t first, int64_t last, const std::string &elementType)
+{
+    Nda::LowerString lname(name);
+    const Nda::Atom atom = mAtoms.intern(lname.lowerValue);
+    if (typeByAtom(atom))
+        return nullptr;
+
+    if (last < first - 1 || last - first + 1 > INT32_MAX) // "1..0" is a valid, empty range
+        return nullptr;
+
+    const auto *type = typeByName(Nda::toLower(elementType));
+    if (!type || !type->instantiable)
+        return nullptr;
+
+    switch (type->dataType) { // unboxed storage, see Nda::SharedArray
+    case Nda::Number:
+    case Nda::Natural:
+    case Nda::Supernatural:
+    case Nda::Boolean:
+    case Nda::Byte:
+        break;
+    default:
+        return nullptr;
+    }
+
+    Nda::RuntimeType arrayType(lname,Nda::Array,"array",true);
+    arrayType.atom        = atom;
+    arrayType.elementType = type;
+    arrayType.first       = first;
+    arrayType.last        = last;
+
+    mTypes[atom] = arrayType;
+    return &mTypes.at(atom);
 }
 
 //-------------------------------------------------------------------------------------------------
 const Nda::RuntimeType *NdaState::typeByName(std::string name) const
 {
-    if (mTypes.find(name) == mTypes.end())
+    return typeByAtom(mAtoms.find(name));
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::RuntimeType *NdaState::typeByAtom(Nda::Atom name) const
+{
+    if (mBuiltins) {
+        const auto *type = mBuiltins->type(name, mFunctions.addons());
+        if (type)
+            return type;
+    }
+
+    auto it = mTypes.find(name);
+    if (it == mTypes.end())
         return nullptr;
 
-    return &mTypes.at(name);
+    return &it->second;
 }
 
 
@@ -113,8 +245,25 @@ bool NdaState::define(const std::string &name, const std::string &typeName, bool
 
 //-------------------------------------------------------------------------------------------------
 bool NdaState::define(const std::string &name, const Nda::RuntimeType *type, bool isVolatile)
+{
+    return define(mAtoms.intern(Nda::toLower(name)), type, isVolatile);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaState::define(Nda::Atom name, Nda::Atom typeName, bool isVolatile)
+{
+    const Nda::RuntimeType *t = typeByAtom(typeName);
+    if (!t || !t->instantiable)
+        return false;
+
+    return define(name,t,isVolatile);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaState::define(Nda::Atom name, const Nda::RuntimeType *type, bool isVolatile)
 {
     assert(type);
+    assert(name != Nda::NoAtom);
 
     bool done;
     if (mCallStack.empty())
@@ -125,7 +274,7 @@ bool NdaState::define(const std::string &name, const Nda::RuntimeType *type, boo
     if (done && isVolatile) {
         NdaVariant &value = valueRef(name);
         if (mVolatileCtor)
-            mVolatileCtor(name,value);
+            mVolatileCtor(mAtoms.name(name),value);
     }
 
     return done;
@@ -144,118 +293,151 @@ Nda::Type NdaState::typeOf(const std::string &name) const
 //-------------------------------------------------------------------------------------------------
 bool NdaState::bindFnc(const std::string &name, const Nda::FncParameters &parameters, Nda::FncCallback cb)
 {
-    assert(!name.empty());
-    return mFunctions.bindFnc(name,parameters,cb);
+    return bindFnc(name, parameters, Nda::StateFncCallback([cb](NdaState *, const Nda::FncValues &args, NdaVariant &ret) { return cb(args, ret); }));
 }
 
 //-------------------------------------------------------------------------------------------------
 bool NdaState::bindPrc(const std::string &name, const Nda::FncParameters &parameters, Nda::PrcCallback cb)
+{
+    return bindPrc(name, parameters, Nda::StatePrcCallback([cb](NdaState *, const Nda::FncValues &args) { return cb(args); }));
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaState::bindFnc(const std::string &name, const Nda::FncParameters &parameters, Nda::StateFncCallback cb)
 {
     assert(!name.empty());
-    return mFunctions.bindPrc(name,parameters,std::move(cb));
+    return mFunctions.bindFnc(Nda::NoAtom,mAtoms.intern(Nda::toLower(name)),parameters,std::move(cb));
 }
 
 //-------------------------------------------------------------------------------------------------
-bool NdaState::bind(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, const std::shared_ptr<NdaParser::ASTNode> &block, const std::string &returnType)
+bool NdaState::bindPrc(const std::string &name, const Nda::FncParameters &parameters, Nda::StatePrcCallback cb)
 {
     assert(!name.empty());
-    return mFunctions.bind(type.empty() ? name : BUILD_METHOD(type,name),parameters,block,returnType);
+    return mFunctions.bindPrc(Nda::NoAtom,mAtoms.intern(Nda::toLower(name)),parameters,std::move(cb));
 }
 
 //-------------------------------------------------------------------------------------------------
-bool NdaState::bind(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::Runnable *block, const std::string &returnType)
+bool NdaState::bind(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::Runnable *block, NdaInterpreter *program, const std::string &returnType)
 {
     assert(!name.empty());
-    return mFunctions.bind(type.empty() ? name : BUILD_METHOD(type,name),parameters,block,returnType);
+    return mFunctions.bind(TYPE_ATOM(type),mAtoms.intern(Nda::toLower(name)),parameters,block,program,returnType);
 }
 
 //-------------------------------------------------------------------------------------------------
-bool NdaState::hasFunction(const std::string &type, const std::string &name, const NdaVariants &parameters)
+bool NdaState::hasFunction(const std::string &type, const std::string &name, const NdaVariants &parameters) const
 {
     return functionPtr(type, name, parameters) != nullptr;
 }
 
 //-------------------------------------------------------------------------------------------------
-Nda::FunctionEntry *NdaState::functionPtr(const std::string &type, const std::string &name, const NdaVariants &parameters)
+const Nda::FunctionEntry *NdaState::functionPtr(const std::string &type, const std::string &name, const NdaVariants &parameters) const
+{
+    // never interned -> never bound
+    const Nda::Atom typeAtom = type.empty() ? Nda::NoAtom : mAtoms.find(Nda::toLower(type));
+    const Nda::Atom nameAtom = mAtoms.find(Nda::toLower(name));
+    if (nameAtom == Nda::NoAtom || (!type.empty() && typeAtom == Nda::NoAtom))
+        return nullptr;
+
+    return functionPtr(typeAtom, nameAtom, parameters);
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::FunctionEntry *NdaState::functionPtr(Nda::Atom type, Nda::Atom name, const NdaVariants &parameters) const
 {
-    return mFunctions.symbolPtr(type.empty() ? name : BUILD_METHOD(type,name),parameters);
+    return mFunctions.symbolPtr(type, name, parameters);
 }
 
 //-------------------------------------------------------------------------------------------------
-Nda::FunctionEntry &NdaState::function(const std::string &type, const std::string &name, const NdaVariants &parameters)
+const Nda::FunctionEntry &NdaState::function(const std::string &type, const std::string &name, const NdaVariants &parameters) const
 {
-    return mFunctions.symbol(type.empty() ? name : BUILD_METHOD(type,name),parameters);
+    auto *entry = functionPtr(type, name, parameters);
+    if (entry)
+        return *entry;
+
+    assert(false && "symbol lookup error");
+    std::terminate();
 }
 
 //-------------------------------------------------------------------------------------------------
 bool NdaState::bindFnc(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::FncCallback cb)
+{
+    return bindFnc(type, name, parameters, Nda::StateFncCallback([cb](NdaState *, const Nda::FncValues &args, NdaVariant &ret) { return cb(args, ret); }));
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaState::bindPrc(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::PrcCallback cb)
+{
+    return bindPrc(type, name, parameters, Nda::StatePrcCallback([cb](NdaState *, const Nda::FncValues &args) { return cb(args); }));
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaState::bindFnc(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::StateFncCallback cb)
 {
     assert(!type.empty());
     assert(!name.empty());
-    return bindFnc(BUILD_METHOD(type,name), parameters, std::move(cb));
+    return mFunctions.bindFnc(TYPE_ATOM(type), mAtoms.intern(Nda::toLower(name)), parameters, std::move(cb));
 }
 
 //-------------------------------------------------------------------------------------------------
-bool NdaState::bindPrc(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::PrcCallback cb)
+bool NdaState::bindPrc(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::StatePrcCallback cb)
 {
     assert(!type.empty());
     assert(!name.empty());
-    return bindPrc(BUILD_METHOD(type,name), parameters, std::move(cb));
+    return mFunctions.bindPrc(TYPE_ATOM(type), mAtoms.intern(Nda::toLower(name)), parameters, std::move(cb));
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaState::useAddon(Nda::Builtins::Addon addon)
+{
+    assert(mBuiltins);
+    mFunctions.setAddons(mFunctions.addons() | Nda::Builtins::mask(addon));
 }
 
 //-------------------------------------------------------------------------------------------------
 bool NdaState::find(const std::string &symbolName, Nda::Symbol **symbol) const
 {
+    return find(mAtoms.find(symbolName), symbol);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaState::find(const std::string &symbolName, int &index, int &scope, bool &isGlobal) const
+{
+    return find(mAtoms.find(symbolName), index, scope, isGlobal);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaState::find(Nda::Atom symbolName, Nda::Symbol **symbol) const
+{
+    if (symbolName == Nda::NoAtom)
+        return false;
+
     // First priority: current function scope:
     if (!mCallStack.empty()) {
         const auto& currentFrame = mCallStack.back();
-
-        /*
-        for (auto it = currentFrame->rbegin(); it != currentFrame->rend(); ++it) {
-            if ((*it)->get2(symbolName,symbol)) {
-                return true;
-            }
-        }
-        */
         for (int i=(*currentFrame).size()-1; i >= 0; i-- ) {
             if ((*currentFrame)[i]->get2(symbolName,symbol))
                 return true;
         }
-
-
     }
 
     // second: globals:
-    /*
-    for (auto it = mGlobals.rbegin(); it != mGlobals.rend(); ++it) {
-        if ((*it)->get2(symbolName,symbol)) {
-            return true;
-        }
-    }
-    */
     for (int i=mGlobals.size()-1; i >= 0; i-- ) {
         if (mGlobals[i]->get2(symbolName,symbol))
             return true;
     }
 
-
     return false;
 }
 
 //-------------------------------------------------------------------------------------------------
-bool NdaState::find(const std::string &symbolName, int &index, int &scope, bool &isGlobal) const
+bool NdaState::find(Nda::Atom symbolName, int &index, int &scope, bool &isGlobal) const
 {
+    if (symbolName == Nda::NoAtom)
+        return false;
+
     // First priority: current function scope:
     if (!mCallStack.empty()) {
         const auto& currentFrame = mCallStack.back();
-
-        /*
-        for (auto it = currentFrame->rbegin(); it != currentFrame->rend(); ++it) {
-            if ((*it)->get2(symbolName,symbol)) {
-                return true;
-            }
-        }
-        */
         for (int i=(*currentFrame).size()-1; i >= 0; i-- ) {
             if ((index = (*currentFrame)[i]->indexOf(symbolName)) >= 0) {
                 scope    = i;
@@ -266,13 +448,6 @@ bool NdaState::find(const std::string &symbolName, int &index, int &scope, bool
     }
 
     // second: globals:
-    /*
-    for (auto it = mGlobals.rbegin(); it != mGlobals.rend(); ++it) {
-        if ((*it)->get2(symbolName,symbol)) {
-            return true;
-        }
-    }
-    */
     for (int i=mGlobals.size()-1; i >= 0; i-- ) {
         if ((index = mGlobals[i]->indexOf(symbolName)) >= 0) {
             scope    = i;
@@ -298,6 +473,12 @@ NdaVariant NdaState::value(const std::string &symbolName) const
 NdaVariant &NdaState::valueRef(const std::string &symbolName)
 {
     assert(!symbolName.empty());
+    return valueRef(mAtoms.find(symbolName));
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant &NdaState::valueRef(Nda::Atom symbolName)
+{
     Nda::Symbol *symbol;
     bool done = find(symbolName,&symbol);
     assert(done);
@@ -431,6 +612,9 @@ void NdaState::destroy()
 {
     mRetValue.reset(); // detach references
 
+    for (auto *interpreter : mInterpreters) // while the types are still alive
+        interpreter->releaseCaches();
+
     mFunctions.clear(); // release shared-pointers: ASTNodes
     mLoadedAddons.clear();
 
@@ -540,7 +724,12 @@ void NdaState::requestAddon(std::string name)
         return;
 
     mLoadedAddons.insert(name);
-    mWithCallback(name);
+    try {
+        mWithCallback(name);
+    } catch (...) {
+        mLoadedAddons.erase(name); // a fixed package file is loaded by the next "with"
+        throw;
+    }
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -569,3 +758,40 @@ void NdaState::popScope()
         frame->pop_back();
     }
 }
+
+//-------------------------------------------------------------------------------------------------
+void NdaState::scopeDepth(size_t &frames, size_t &scopes) const
+{
+    frames = mCallStack.size();
+    scopes = mCallStack.empty() ? mGlobals.size() : mCallStack.back()->size();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaState::unwind(size_t frames, size_t scopes)
+{
+    while (mCallStack.size() > frames) {
+        auto *tables = mCallStack.back();
+        while (!tables->empty()) {
+            delete tables->back();
+            tables->pop_back();
+        }
+        delete tables;
+        mCallStack.pop_back();
+    }
+
+    while ((mCallStack.empty() ? mGlobals.size() : mCallStack.back()->size()) > scopes)
+        popScope();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaState::attach(NdaInterpreter *interpreter)
+{
+    if (std::find(mInterpreters.begin(), mInterpreters.end(), interpreter) == mInterpreters.end())
+        mInterpreters.push_back(interpreter);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaState::detach(NdaInterpreter *interpreter)
+{
+    mInterpreters.erase(std::remove(mInterpreters.begin(), mInterpreters.end(), interpreter), mInterpreters.end());
+}
@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include "private/symboltable.h"
 #include "private/functiontable.h"
+#include "private/builtins.h"
 #include "parser.h"
 #include "value.h"
 
@@ -23,7 +24,14 @@ public:
     // runtime type information
     const Nda::RuntimeType *registerType(std::string name, Nda::Type type, bool instantiable);
     const Nda::RuntimeType *registerType(std::string name, std::string basename); // "type mytype as list;"
+    const Nda::RuntimeType *registerRecord(std::string name, const std::vector<std::pair<std::string,std::string>> &fields); // name, type
+    const Nda::RuntimeType *registerArray(std::string name, int64_t first, int64_t last, const std::string &elementType);
     const Nda::RuntimeType *typeByName(std::string name) const;
+    const Nda::RuntimeType *typeByAtom(Nda::Atom name) const;
+
+    // interned identifiers and type names
+    inline Nda::AtomTable       &atoms()       { return mAtoms; }
+    inline const Nda::AtomTable &atoms() const { return mAtoms; }
 
     // cache.. just for performance reasons:
     inline const Nda::RuntimeType *booleanType() const   { return mBooleanType; }
@@ -33,32 +41,48 @@ public:
     inline const Nda::RuntimeType *listType() const      { return mListType; }
     inline const Nda::RuntimeType *bytesType() const     { return mBytesType; }
     inline const Nda::RuntimeType *dictType() const      { return mDictType; }
+    inline const Nda::RuntimeType *setType() const       { return mSetType; }
+    inline const Nda::RuntimeType *dequeType() const     { return mDequeType; }
+    inline const Nda::RuntimeType *priorityQueueType() const { return mPriorityQueueType; }
+    inline const Nda::RuntimeType *bigNaturalType() const    { return mBigNaturalType; }
     inline const Nda::RuntimeType *referenceType() const { return mReferenceType; }
 
     // variable definition
     bool       define(const std::string &name, const std::string &typeName, bool isVolatile = false);
     bool       define(const std::string &name, const Nda::RuntimeType *type, bool isVolatile = false);
+    bool       define(Nda::Atom name, Nda::Atom typeName, bool isVolatile = false);
+    bool       define(Nda::Atom name, const Nda::RuntimeType *type, bool isVolatile = false);
     Nda::Type  typeOf(const std::string &name) const;
 
     // procedure/function
     bool               bindFnc(const std::string &name, const Nda::FncParameters &parameters, Nda::FncCallback cb); // function
     bool               bindPrc(const std::string &name, const Nda::FncParameters &parameters, Nda::PrcCallback cb); // procedure
-    bool               bind(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, const std::shared_ptr<NdaParser::ASTNode> &block, const std::string &returnType = "");
-    bool               bind(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::Runnable *block, const std::string &returnType = "");
-    bool               hasFunction(const std::string &type, const std::string &name, const NdaVariants &parameters);
-    Nda::FunctionEntry *functionPtr(const std::string &type, const std::string &name, const NdaVariants &parameters);
-    Nda::FunctionEntry &function(const std::string &type, const std::string &name, const NdaVariants &parameters);
+    bool               bindFnc(const std::string &name, const Nda::FncParameters &parameters, Nda::StateFncCallback cb);
+    bool               bindPrc(const std::string &name, const Nda::FncParameters &parameters, Nda::StatePrcCallback cb);
+    bool               bind(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::Runnable *block, NdaInterpreter *program, const std::string &returnType = "");
+    bool               hasFunction(const std::string &type, const std::string &name, const NdaVariants &parameters) const;
+    const Nda::FunctionEntry *functionPtr(const std::string &type, const std::string &name, const NdaVariants &parameters) const;
+    const Nda::FunctionEntry &function(const std::string &type, const std::string &name, const NdaVariants &parameters) const;
+    const Nda::FunctionEntry *functionPtr(Nda::Atom type, Nda::Atom name, const NdaVariants &parameters) const;
 
     // methods
     bool               bindFnc(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::FncCallback cb);
     bool               bindPrc(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::PrcCallback cb);
+    bool               bindFnc(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::StateFncCallback cb);
+    bool               bindPrc(const std::string &type, const std::string &name, const Nda::FncParameters &parameters, Nda::StatePrcCallback cb);
+
+    // "with" of a builtin addon: its types and functions, shared with all states, see Nda::Builtins
+    void               useAddon(Nda::Builtins::Addon addon);
 
     bool               find(const std::string &symbolName,Nda::Symbol **symbol) const;
     bool               find(const std::string &symbolName,int &index, int &scope, bool &isGlobal) const;
+    bool               find(Nda::Atom symbolName,Nda::Symbol **symbol) const;
+    bool               find(Nda::Atom symbolName,int &index, int &scope, bool &isGlobal) const;
 
     // Variant lookup
     NdaVariant          value(const std::string &symbolName) const;
     NdaVariant         &valueRef(const std::string &symbolName);
+    NdaVariant         &valueRef(Nda::Atom symbolName);
     NdaVariant         *valuePtr(const std::string &symbolName);
     Nda::Symbol        *symbolPtr(int index, int scope, bool isGlobal);
     NdaVariant         *valuePtr(int index, int scope, bool isGlobal);
@@ -112,15 +136,31 @@ public:
 
 private:
     friend class NdaInterpreter;
+    friend class Nda::Builtins;
+
+    explicit NdaState(const Nda::Builtins *builtins); // nullptr: the state the builtins are registered into
 
     inline void         setUnhandledException(const std::string &name) { mUnhandledException = name; }
     inline void         clearUnhandledException() { mUnhandledException.clear(); }
 
+    // interpreters holding a program prepared for this state: their caches refer to symbols
+    // and types, which are released by reset()
+    void attach(NdaInterpreter *interpreter);
+    void detach(NdaInterpreter *interpreter);
+
+    // leaves all call frames and scopes entered after scopeDepth(), also after an exception
+    void scopeDepth(size_t &frames, size_t &scopes) const;
+    void unwind(size_t frames, size_t scopes);
+
     void destroy();
 
     NdaVariant         mRetValue;
     std::string        mUnhandledException;
 
+    const Nda::Builtins *mBuiltins;
+
+    Nda::AtomTable     mAtoms; // declared before the tables: outlives everything referencing its names
+
     NadaSymbolTables   mGlobals;
     NadaStackFrames    mCallStack;
 
@@ -136,6 +176,8 @@ private:
     WithCallback       mWithCallback;
     std::unordered_set<std::string> mLoadedAddons;
 
+    std::vector<NdaInterpreter*> mInterpreters;
+
     // cache
     const Nda::RuntimeType *mBooleanType;
     const Nda::RuntimeType *mNumberType;
@@ -144,6 +186,10 @@ private:
     const Nda::RuntimeType *mListType;
     const Nda::RuntimeType *mBytesType;
     const Nda::RuntimeType *mDictType;
+    const Nda::RuntimeType *mSetType;
+    const Nda::RuntimeType *mDequeType;
+    const Nda::RuntimeType *mPriorityQueueType;
+    const Nda::RuntimeType *mBigNaturalType;
     const Nda::RuntimeType *mReferenceType;
 };
 
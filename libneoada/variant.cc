@@ -1,9 +1,16 @@
 #include "variant.h"
 #include "private/sharedstring.h"
 #include "private/numericparser.h"
+#include "private/numberformat.h"
 #include "private/sharedlist.h"
 #include "private/sharedbytes.h"
 #include "private/shareddict.h"
+#include "private/sharedrecord.h"
+#include "private/sharedarray.h"
+#include "private/sharedset.h"
+#include "private/shareddeque.h"
+#include "private/sharedpriorityqueue.h"
+#include "private/sharedbignatural.h"
 
 #include <cassert>
 #include <cmath>
@@ -15,6 +22,7 @@
 #include <sstream>
 #include <limits>
 #include <algorithm> // std::find
+#include <cstring>   // std::memcmp
 
 #define OP_SPACESHIP(v1, v2) ((int64_t)((v1) == (v2) ? 0 : ((v1) > (v2) ? +1 : -1)))
 #define NDA_NAN               std::numeric_limits<double>::quiet_NaN()
@@ -22,13 +30,24 @@
 bool       operator==(const NdaVariant &v1, const NdaVariant &v2);
 
 //-------------------------------------------------------------------------------------------------
-bool nadaParseDoubleLiteral(const std::string &s, double &out)
+static const NdaBigNatural::Digits &bigNaturalDigitsOf(const Nda::SharedBigNatural *value)
 {
-    std::istringstream in(s);
-    in.imbue(std::locale::classic());
+    static const NdaBigNatural::Digits zero;
+    return value ? value->cDigits() : zero;
+}
 
-    in >> out;
-    return in && in.eof();
+//-------------------------------------------------------------------------------------------------
+static std::string decimalLiteral(const std::string &literal) // 1_000.5e-3_d -> 1000.5e-3
+{
+    std::string ret;
+    ret.reserve(literal.size());
+    for (char c : literal) {
+        if (c != '_')
+            ret += c;
+    }
+    if (!ret.empty() && (ret.back() == 'd' || ret.back() == 'D'))
+        ret.pop_back();
+    return ret;
 }
 
 
@@ -37,6 +56,8 @@ NdaVariant::NdaVariant(const Nda::RuntimeType *type)
     : mRuntimeType(type)
 {
     mValue.uInt64 = 0;
+    if (myType() == Nda::Record) // fields are read through const accessors -> always allocated
+        mValue.uPtr = new Nda::SharedRecord(type);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -79,10 +100,16 @@ void NdaVariant::initType(const Nda::RuntimeType *type)
     case Nda::Boolean:      mValue.uByte   =  0;  break;
     case Nda::Byte:         mValue.uByte   =  0;  break;
 
-    case Nda::String:       mValue.uPtr    =  new Nda::SharedString(); break;
+    case Nda::String:       mValue.uPtr    =  nullptr; break; // empty string
     case Nda::List:         mValue.uPtr    =  new Nda::SharedList();   break;
     case Nda::Bytes:        mValue.uPtr    =  new Nda::SharedBytes();  break;
     case Nda::Dict:         mValue.uPtr    =  new Nda::SharedDict();   break;
+    case Nda::Record:       mValue.uPtr    =  new Nda::SharedRecord(type); break;
+    case Nda::Array:        mValue.uPtr    =  new Nda::SharedArray(type);  break;
+    case Nda::Set:          mValue.uPtr    =  new Nda::SharedSet();        break;
+    case Nda::Deque:        mValue.uPtr    =  new Nda::SharedDeque();      break;
+    case Nda::PriorityQueue: mValue.uPtr   =  new Nda::SharedPriorityQueue(); break;
+    case Nda::BigNatural:   mValue.uPtr    =  nullptr; break; // zero
 
     default:
         assert(0 && "not implemented");
@@ -96,7 +123,10 @@ void NdaVariant::fromString(const Nda::RuntimeType *t, const std::string &value)
     if (mRuntimeType) reset();
     mRuntimeType = t;
     assert(type() == Nda::String);
-    mValue.uPtr = new Nda::SharedString(value);
+    if (value.length() <= InlineStringSize)
+        setInlineString(value.data(), value.length());
+    else
+        mValue.uPtr = new Nda::SharedString(value);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -107,18 +137,12 @@ bool NdaVariant::fromNumberLiteral(const Nda::RuntimeType *t, const std::string
     mRuntimeType = t;
     assert(type() == Nda::Number);
 
-    std::string cleanLiteral = NadaNumericParser::removeSeparators(value);
-
-    long long i32;
-    if (NadaNumericParser::isInteger32(cleanLiteral, &i32)) {
-        mValue.uDouble = (int32_t)i32;
-        return true;
-    }
-    if (!NadaNumericParser::isFloatingPointLiteral(cleanLiteral))
+    std::string cleanLiteral = decimalLiteral(value);
+    if (cleanLiteral.empty() || cleanLiteral[0] == '+' || cleanLiteral[0] == '-') // no sign in literals
         return false;
 
     double parsed = 0.0;
-    if (!nadaParseDoubleLiteral(cleanLiteral, parsed))
+    if (!NdaNumberFormat::parseDouble(cleanLiteral, parsed))
         return false;
 
     mValue.uDouble = parsed;
@@ -242,6 +266,26 @@ bool NdaVariant::fromSNaturalLiteral(const Nda::RuntimeType *t, const std::strin
     return true;
 }
 
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::fromBigNaturalLiteral(const Nda::RuntimeType *t, const std::string &value)
+{
+    assert(t);
+    NdaBigNatural::Digits digits;
+    if (!NdaBigNatural::fromString(NadaNumericParser::removeSeparators(value), digits)) {
+        reset();
+        return false;
+    }
+
+    fromBigNaturalDigits(t, std::move(digits));
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::fromBigNatural(const Nda::RuntimeType *t, uint64_t value)
+{
+    fromBigNaturalDigits(t, NdaBigNatural::fromUInt64(value));
+}
+
 //-------------------------------------------------------------------------------------------------
 bool NdaVariant::fromByteLiteral(const Nda::RuntimeType *t, const std::string &value)
 {
@@ -375,6 +419,10 @@ bool NdaVariant::setBool(bool value)
 void NdaVariant::fromReference(const Nda::RuntimeType *t, NdaVariant *other)
 {
     assert(other);
+    while (other->myType() == Nda::Reference) // collapse chains: always point to the final storage
+        other = other->internalReference();
+    assert(other != this);
+
     if (mRuntimeType) reset();
     mRuntimeType = t;
     mValue.uPtr  = other;
@@ -397,6 +445,10 @@ bool NdaVariant::toBool(bool *ok) const
         if (ok) *ok = true;
         return mValue.uInt64 != 0;
         break;
+    case Nda::BigNatural:
+        if (ok) *ok = true;
+        return mValue.uPtr != nullptr;
+        break;
     case Nda::Boolean:
         if (ok) *ok = true;
         return mValue.uByte != 0;
@@ -407,6 +459,13 @@ bool NdaVariant::toBool(bool *ok) const
         break;
     case Nda::String:    return false; break;
     case Nda::Bytes:     return false; break;
+    case Nda::List:
+    case Nda::Dict:
+    case Nda::Record:
+    case Nda::Array:
+    case Nda::Set:
+    case Nda::Deque:
+    case Nda::PriorityQueue: return false; break;
     }
     return false;
 }
@@ -431,6 +490,10 @@ double NdaVariant::toDouble(bool *ok) const
         if (ok) *ok = true;
         return (double)mValue.uUInt64;
         break;
+    case Nda::BigNatural:
+        if (ok) *ok = true;
+        return NdaBigNatural::toDouble(bigNaturalDigitsOf(cInternalBigNatural()));
+        break;
     case Nda::Boolean:
         if (ok) *ok = true;
         return (double)mValue.uByte;
@@ -472,6 +535,13 @@ int64_t NdaVariant::toInt64(bool *ok) const
             return (int64_t)mValue.uUInt64;
         }
         break;
+    case Nda::BigNatural: {
+        uint64_t value;
+        if (NdaBigNatural::toUInt64(bigNaturalDigitsOf(cInternalBigNatural()), value) && value <= (uint64_t)INT64_MAX) {
+            if (ok) *ok = true;
+            return (int64_t)value;
+        }
+    } break;
     case Nda::Boolean:
         if (ok) *ok = true;
         return (bool)mValue.uByte;
@@ -483,7 +553,13 @@ int64_t NdaVariant::toInt64(bool *ok) const
 
     case Nda::String:    return false; break;
     case Nda::Bytes:     return false; break;
-
+    case Nda::List:
+    case Nda::Dict:
+    case Nda::Record:
+    case Nda::Array:
+    case Nda::Set:
+    case Nda::Deque:
+    case Nda::PriorityQueue: return false; break;
     }
     return false;
 
@@ -504,6 +580,13 @@ uint64_t NdaVariant::toUInt64(bool *ok) const
     case Nda::Supernatural:
         if (ok) *ok = true;
         return mValue.uUInt64;
+    case Nda::BigNatural: {
+        uint64_t value;
+        if (!NdaBigNatural::toUInt64(bigNaturalDigitsOf(cInternalBigNatural()), value))
+            return 0;
+        if (ok) *ok = true;
+        return value;
+    }
     case Nda::Byte:
         if (ok) *ok = true;
         return mValue.uByte;
@@ -543,12 +626,24 @@ bool NdaVariant::assign(const NdaVariant &other)
             mValue.uDouble = (double)other.cuValue()->uInt64;
             return true;
         }
+        if (other.type() == Nda::BigNatural) {
+            mValue.uDouble = other.toDouble();
+            return true;
+        }
     } break;
     case Nda::Natural: {
         if (other.type() == Nda::Natural || other.type() == Nda::Byte) {
             mValue.uInt64 = other.cuValue()->uInt64;
             return true;
         }
+        if (other.type() == Nda::BigNatural) {
+            bool fits;
+            int64_t value = other.toInt64(&fits);
+            if (fits) {
+                mValue.uInt64 = value;
+                return true;
+            }
+        }
     } break;
     case Nda::Supernatural: {
         if (other.type() == Nda::Supernatural || other.type() == Nda::Byte) {
@@ -567,7 +662,28 @@ bool NdaVariant::assign(const NdaVariant &other)
                 return true;
             }
         }
-
+        if (other.type() == Nda::BigNatural) {
+            bool fits;
+            uint64_t value = other.toUInt64(&fits);
+            if (fits) {
+                mValue.uUInt64 = value;
+                return true;
+            }
+        }
+    } break;
+    case Nda::BigNatural: {
+        if (other.type() == Nda::BigNatural) {
+            if (other.cInternalBigNatural() == cInternalBigNatural())
+                return true;
+            reset();
+            assignOtherBigNatural(other);
+            return true;
+        }
+        NdaBigNatural::Digits buffer;
+        if (other.bigNaturalDigits(buffer)) { // Natural >= 0, Supernatural, Byte
+            fromBigNaturalDigits(mRuntimeType, std::move(buffer));
+            return true;
+        }
     } break;
     case Nda::Boolean: {
         if (other.type() == Nda::Boolean) {
@@ -618,6 +734,63 @@ bool NdaVariant::assign(const NdaVariant &other)
             return true;
         }
     } break;
+    case Nda::Record: {
+        if (other.runtimeType() == runtimeType()) { // records are only compatible to the same type
+            if (other.cInternalRecord() == cInternalRecord())
+                return true;
+            reset();
+            assignOtherRecord(other);
+            return true;
+        }
+    } break;
+    case Nda::Array: {
+        if (other.runtimeType() == runtimeType()) { // the index range is part of the type
+            if (other.cInternalArray() == cInternalArray())
+                return true;
+            reset();
+            assignOtherArray(other);
+            return true;
+        }
+        if (other.type() == Nda::List) // A := [1.0, 2.0, 3.0];
+            return assignListToArray(other);
+    } break;
+    case Nda::Set: {
+        if (other.type() == Nda::Set) {
+            if (other.cInternalSet() == cInternalSet())
+                return true;
+            reset();
+            assignOtherSet(other);
+            return true;
+        }
+        if (other.type() == Nda::List) // S := [1, 2, 3];
+            return assignListToSet(other);
+    } break;
+    case Nda::Deque: {
+        if (other.type() == Nda::Deque) {
+            if (other.cInternalDeque() == cInternalDeque())
+                return true;
+            reset();
+            assignOtherDeque(other);
+            return true;
+        }
+        if (other.type() == Nda::List) { // D := [1, 2, 3];
+            assignListToDeque(other);
+            return true;
+        }
+    } break;
+    case Nda::PriorityQueue: {
+        if (other.type() == Nda::PriorityQueue) {
+            if (other.cInternalQueue() == cInternalQueue())
+                return true;
+            reset();
+            assignOtherQueue(other);
+            return true;
+        }
+        if (other.type() == Nda::List) { // Q := [3, 1, 2]; values are their own priority
+            assignListToQueue(other);
+            return true;
+        }
+    } break;
     }
     return false;
 }
@@ -760,6 +933,16 @@ double NdaVariant::spaceship(const NdaVariant &other, bool *ok) const
 {
     if (ok) *ok = false;
 
+    // Number vs. integer: exact
+    if (type() != other.type() && (type() == Nda::Number || other.type() == Nda::Number)) {
+        bool exact;
+        double ret = numberSpaceship(other, &exact);
+        if (exact) {
+            if (ok) *ok = true;
+            return ret;
+        }
+    }
+
     // double camparison
     if (type() != other.type() && (type() == Nda::Number || other.type() == Nda::Number)) {
         bool vok = true;
@@ -778,6 +961,9 @@ double NdaVariant::spaceship(const NdaVariant &other, bool *ok) const
         return OP_SPACESHIP(v1,v2);
     }
 
+    if (type() == Nda::BigNatural || other.type() == Nda::BigNatural)
+        return bigNaturalSpaceship(other, ok);
+
     switch (myType()) {
     case Nda::Undefined: return NDA_NAN;
     case Nda::Reference: return cInternalReference()->spaceship(other, ok);
@@ -867,14 +1053,71 @@ double NdaVariant::spaceship(const NdaVariant &other, bool *ok) const
         if (other.type() != myType())
             return NDA_NAN;
         if (ok) *ok = true;
-        if (!mValue.uPtr && !other.cuValue()->uPtr)   // both are empty
+        {
+            size_t myLength, otherLength;
+            const char *myData    = cStringData(myLength);
+            const char *otherData = other.cStringData(otherLength);
+            int cmp = (myLength && otherLength) ? std::memcmp(myData, otherData, std::min(myLength, otherLength)) : 0;
+            if (cmp != 0)
+                return cmp < 0 ? -1 : +1;
+            return OP_SPACESHIP(myLength, otherLength);
+        }
+        break;
+    case Nda::Record:
+        if (other.runtimeType() != runtimeType())
+            return NDA_NAN;
+        if (ok) *ok = true;
+        for (int i = 0; i < lengthOperator(); i++) {
+            if (!readFieldAccess(i).equal(other.readFieldAccess(i)))
+                return NDA_NAN; // unordered: only "=" and "<>" are defined
+        }
+        return 0;
+    case Nda::Array: {
+        if (other.runtimeType() != runtimeType())
+            return NDA_NAN;
+        if (ok) *ok = true;
+        int64_t first = runtimeType()->first;
+        for (int64_t i = first; i <= runtimeType()->last; i++) {
+            if (!readArrayElement(i).equal(other.readArrayElement(i)))
+                return NDA_NAN; // unordered, like records
+        }
+        return 0;
+    }
+    case Nda::Set: {
+        if (other.type() != Nda::Set)
+            return NDA_NAN;
+        if (ok) *ok = true;
+        if (setSize() != other.setSize())
+            return NDA_NAN;
+        if (cInternalSet() == other.cInternalSet())
+            return 0;
+        for (const auto &element : cInternalSet()->cSet()) {
+            if (!other.containsInSet(element))
+                return NDA_NAN; // unordered: only "=" and "<>" are defined
+        }
+        return 0;
+    }
+    case Nda::Deque: {
+        if (other.type() != Nda::Deque)
+            return NDA_NAN;
+        if (ok) *ok = true;
+        if (cInternalDeque() == other.cInternalDeque())
             return 0;
-        else if (!mValue.uPtr)                    // I'm empty the other is not -> not greater
-            return -1;
-        if (!other.cuValue()->uPtr)                //  I'm not empty the other is empty -> greater
-            return +1;
-        else
-            return OP_SPACESHIP(cInternalString()->cValue(),other.cInternalString()->cValue());
+        if (dequeSize() != other.dequeSize())
+            return NDA_NAN;
+        const auto &mine   = cInternalDeque()->cDeque();
+        const auto &theirs = other.cInternalDeque()->cDeque();
+        for (size_t i = 0; i < mine.size(); i++) {
+            if (!mine[i].equal(theirs[i]))
+                return NDA_NAN; // unordered, like records
+        }
+        return 0;
+    }
+    case Nda::BigNatural: // bigNaturalSpaceship() above
+    case Nda::Bytes:
+    case Nda::List:
+    case Nda::Dict:
+    case Nda::PriorityQueue:
         break;
     }
     return NDA_NAN;
@@ -931,6 +1174,11 @@ NdaVariant NdaVariant::subtract(const NdaVariant &other, bool *ok) const
     if ((type() == Nda::Number) || (other.type() == Nda::Number))
         return doubleSubtraction(other,  ok);
 
+    if ((type() == Nda::BigNatural) || (other.type() == Nda::BigNatural)) {
+        bool dbz;
+        return bigNaturalArithmetic('-', other, dbz, ok);
+    }
+
     switch (myType()) {
     case Nda::Natural: {
         bool isLong;
@@ -996,6 +1244,11 @@ NdaVariant NdaVariant::add(const NdaVariant &other, bool *ok) const
     if ((type() == Nda::Number) || (other.type() == Nda::Number))
         return doubleAddition(other,  ok);
 
+    if ((type() == Nda::BigNatural) || (other.type() == Nda::BigNatural)) {
+        bool dbz;
+        return bigNaturalArithmetic('+', other, dbz, ok);
+    }
+
     switch (myType()) {
     case Nda::Number: {
         NdaVariant ret;
@@ -1056,6 +1309,11 @@ NdaVariant NdaVariant::modulo(const NdaVariant &other, bool *ok) const
     if ((type() == Nda::Number) || (other.type() == Nda::Number))
         return NdaVariant();
 
+    if ((type() == Nda::BigNatural) || (other.type() == Nda::BigNatural)) {
+        bool dbz;
+        return bigNaturalArithmetic('%', other, dbz, ok);
+    }
+
     switch (myType()) {
     case Nda::Natural: {
         bool isLong;
@@ -1116,6 +1374,11 @@ NdaVariant NdaVariant::multiply(const NdaVariant &other, bool *ok) const
     if ((type() == Nda::Number) || (other.type() == Nda::Number))
         return doubleMultiply(other, ok);
 
+    if ((type() == Nda::BigNatural) || (other.type() == Nda::BigNatural)) {
+        bool dbz;
+        return bigNaturalArithmetic('*', other, dbz, ok);
+    }
+
     switch (myType()) {
     case Nda::Natural: {
         bool isLong;
@@ -1177,6 +1440,9 @@ NdaVariant NdaVariant::division(const NdaVariant &other, bool &dbz, bool *ok) co
     if ((type() == Nda::Number) || (other.type() == Nda::Number))
         return doubleDivision(other, dbz, ok);
 
+    if ((type() == Nda::BigNatural) || (other.type() == Nda::BigNatural))
+        return bigNaturalArithmetic('/', other, dbz, ok);
+
     switch (myType()) {
     case Nda::Natural: {
         bool isLong;
@@ -1245,6 +1511,28 @@ NdaVariant NdaVariant::division(const NdaVariant &other, bool &dbz, bool *ok) co
 
 }
 
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaVariant::power(const NdaVariant &exponent, bool *ok) const
+{
+    if (ok) *ok = false;
+    if (type() != Nda::BigNatural)
+        return NdaVariant();
+
+    bool isNatural;
+    uint64_t n = exponent.toUInt64(&isNatural);
+    if (!isNatural)
+        return NdaVariant();
+
+    NdaBigNatural::Digits digits;
+    if (!NdaBigNatural::power(bigNaturalDigitsOf(cInternalBigNatural()), n, digits))
+        return NdaVariant();
+
+    NdaVariant ret;
+    ret.fromBigNaturalDigits(runtimeType(), std::move(digits));
+    if (ok) *ok = true;
+    return ret;
+}
+
 //-------------------------------------------------------------------------------------------------
 NdaVariant NdaVariant::unaryOperator(const std::string &op, bool *ok) const
 {
@@ -1279,7 +1567,8 @@ NdaVariant NdaVariant::unaryOperator(const std::string &op, bool *ok) const
             ret.fromNatural(mRuntimeType, -mValue.uInt64);
         }
     } break;
-    case Nda::Supernatural:{
+    case Nda::Supernatural:
+    case Nda::BigNatural: {
         if (op == "+") {
             if (ok) *ok = true;
             return *this;
@@ -1291,6 +1580,16 @@ NdaVariant NdaVariant::unaryOperator(const std::string &op, bool *ok) const
         break;
     case Nda::String:
         break;
+    case Nda::Reference: // resolved above
+    case Nda::Bytes:
+    case Nda::List:
+    case Nda::Dict:
+    case Nda::Record:
+    case Nda::Array:
+    case Nda::Set:
+    case Nda::Deque:
+    case Nda::PriorityQueue:
+        break;
     }
 
     return ret;
@@ -1311,22 +1610,42 @@ int NdaVariant::lengthOperator() const
     case Nda::Number:
     case Nda::Natural:
     case Nda::Supernatural:
+    case Nda::BigNatural:
     case Nda::Boolean:
     case Nda::Byte:
         length = 1;
         break;
     case Nda::String:
-        length = cInternalString() ? cInternalString()->cValue().length() : 0;
+        {
+            size_t stringLength;
+            cStringData(stringLength);
+            length = (int)stringLength;
+        }
         break;
     case Nda::List:
-        length = cInternalList() ? cInternalList()->cArray().size() : 0;
+        length = cInternalList() ? cInternalList()->size() : 0;
         break;
     case Nda::Bytes:
-        length = cInternalBytes() ? cInternalBytes()->cArray().size() : 0;
+        length = cInternalBytes() ? cInternalBytes()->size() : 0;
         break;
     case Nda::Dict:
         length = cInternalDict() ? cInternalDict()->cDict().size() : 0;
         break;
+    case Nda::Record:
+        length = (int)runtimeType()->fields.size();
+        break;
+    case Nda::Array:
+        length = (int)runtimeType()->arrayLength();
+        break;
+    case Nda::Set:
+        length = cInternalSet() ? (int)cInternalSet()->cSet().size() : 0;
+        break;
+    case Nda::Deque:
+        length = cInternalDeque() ? (int)cInternalDeque()->cDeque().size() : 0;
+        break;
+    case Nda::PriorityQueue:
+        length = cInternalQueue() ? (int)cInternalQueue()->size() : 0;
+        break;
     }
 
     return length;
@@ -1409,8 +1728,7 @@ const NdaVariant &NdaVariant::readAccess(int index) const
     assert(index >= 0);
     assert(index < lengthOperator());
 
-    const auto &array = cInternalList()->cArray();
-    return array.at(index);
+    return cInternalList()->at(index);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1453,6 +1771,25 @@ void NdaVariant::reverseList()
     std::reverse(array.begin(), array.end());
 }
 
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaVariant::flippedList() const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->flippedList();
+
+    assert(type() == Nda::List);
+
+    NdaVariant ret;
+    if (lengthOperator() <= 1) {
+        ret = *this;
+        return ret;
+    }
+
+    ret.mRuntimeType = runtimeType();
+    ret.mValue.uPtr  = Nda::SharedList::reversed(cInternalList());
+    return ret;
+}
+
 //-------------------------------------------------------------------------------------------------
 void NdaVariant::clearList()
 {
@@ -1510,7 +1847,35 @@ const NdaVariant &NdaVariant::readBytesAccess(int index) const
     assert(index >= 0);
     assert(index < lengthOperator());
 
-    return cInternalBytes()->cArray()[index];
+    return cInternalBytes()->at(index);
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaVariant::midBytes(int64_t pos, int64_t count) const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->midBytes(pos, count);
+
+    assert(type() == Nda::Bytes);
+
+    int64_t size = lengthOperator();
+    if (pos < 0)
+        pos = 0;
+    if (count < 0 || pos >= size)
+        count = 0;
+    if (count > size - pos)
+        count = size - pos;
+
+    NdaVariant ret;
+    if (count == size) {
+        ret = *this;
+        return ret;
+    }
+
+    ret.mRuntimeType = runtimeType();
+    if (count > 0)
+        ret.mValue.uPtr = new Nda::SharedBytes(cInternalBytes(), (size_t)pos, (size_t)count);
+    return ret;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1538,7 +1903,14 @@ void NdaVariant::appendToDict(const NdaVariant &key, const NdaVariant &value)
 
     assert(mValue.uPtr);
     detachDict();
-    internalDict()->dict()[key] = value;
+    auto &dict = internalDict()->dict();
+    auto it = dict.find(key);
+    if (it != dict.end()) {
+        it->second = value;
+        return;
+    }
+    dict.emplace(key, value);
+    internalDict()->keysChanged();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1561,7 +1933,12 @@ NdaVariant &NdaVariant::writeDictAccess(const NdaVariant &key)
     assert(mValue.uPtr);
     detachDict();
 
-    return internalDict()->dict()[key]; // read only: internalDict()->dict().at(key);
+    auto &dict = internalDict()->dict();
+    auto it = dict.find(key);
+    if (it != dict.end())
+        return it->second;
+    internalDict()->keysChanged();
+    return dict[key];
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1580,6 +1957,52 @@ std::vector<std::pair<NdaVariant, NdaVariant>> NdaVariant::dictItems() const
     return ret;
 }
 
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::forEachDictItem(const DictVisitor &visitor) const
+{
+    assert(type() == Nda::Dict);
+
+    /*
+        The storage is pinned while iterating, writes of values through the iterated variable
+        stay in place (see SharedDict). A modification is detected by the generation of the keys.
+        If the variable got a copy of the same keys (detached from another owner), the iteration
+        goes on after the last key in the copy.
+    */
+    struct Pin {
+        Pin(const Nda::SharedDict *d) : dict(const_cast<Nda::SharedDict*>(d)) { dict->beginIteration(); }
+        ~Pin() { dict->endIteration(); }
+        void move(const Nda::SharedDict *d) {
+            dict->endIteration();
+            dict = const_cast<Nda::SharedDict*>(d);
+            dict->beginIteration();
+        }
+        Nda::SharedDict *dict;
+    };
+
+    const Nda::SharedDict *dict = cInternalDict(); // follows references
+    if (!dict)
+        return true;
+
+    Pin pin(dict);
+    const uint64_t generation = dict->generation();
+    for (auto it = dict->cDict().begin(); it != dict->cDict().end();) {
+        if (!visitor(it->first, it->second))
+            break;
+
+        const Nda::SharedDict *current = cInternalDict();
+        if (!current || current->generation() != generation)
+            return false; // "it" may be erased
+        if (current != dict) { // detached: the same keys in new storage
+            it = current->cDict().upper_bound(it->first);
+            pin.move(current);
+            dict = current;
+            continue;
+        }
+        ++it;
+    }
+    return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 void NdaVariant::takeFromDict(const NdaVariant &key)
 {
@@ -1593,69 +2016,533 @@ void NdaVariant::takeFromDict(const NdaVariant &key)
     detachDict();
 
     internalDict()->dict().erase(key);
+    internalDict()->keysChanged();
 }
 
 //-------------------------------------------------------------------------------------------------
-void NdaVariant::assignOther(const NdaVariant &other)
+NdaVariant &NdaVariant::writeFieldAccess(int index)
 {
-    if (mRuntimeType) reset();
+    if (myType() == Nda::Reference)
+        return internalReference()->writeFieldAccess(index);
 
-    switch (other.myType()) {
-    case Nda::Undefined: return;
-    case Nda::Reference: {
-        mRuntimeType = other.mRuntimeType;
-        mValue.uPtr  = other.mValue.uPtr;
-        return;
-    } break;
-    case Nda::Any:       return;
-    case Nda::Number:
-    case Nda::Natural:
-    case Nda::Supernatural:
-    case Nda::Boolean:
-    case Nda::Byte: {
-        mRuntimeType  = other.mRuntimeType;
-        mValue.uInt64 = other.mValue.uInt64;
-        return;
-    } break;
-    case Nda::String:
-        assignOtherString(other);
-        return;
-    case Nda::List:
-        assignOtherList(other);
-        return;
-    case Nda::Bytes:
-        assignOtherBytes(other);
-        return;
-    case Nda::Dict:
-        assignOtherDict(other);
-        return;
-    }
+    assert(type() == Nda::Record);
+    assert(index >= 0);
+    assert(index < lengthOperator());
+
+    detachRecord();
+    return internalRecord()->fields()[index];
 }
 
 //-------------------------------------------------------------------------------------------------
-void NdaVariant::assignAny(const NdaVariant &other)
+const NdaVariant &NdaVariant::readFieldAccess(int index) const
 {
-    switch (other.type()) {
-    case Nda::Undefined: return;
-    case Nda::Reference: return;
-    case Nda::Any:       return;
-    case Nda::Number:
-    case Nda::Natural:
-    case Nda::Supernatural:
-    case Nda::Boolean:
-    case Nda::Byte: {
-        mRuntimeType  = other.runtimeType();
-        mValue.uInt64 = other.cuValue()->uUInt64;
-        return;
-    } break;
-    case Nda::String:
-        reset();
-        assignOtherString(other);
-        return;
-    case Nda::List:
-        reset();
-        assignOtherList(other);
-        return;
+    if (myType() == Nda::Reference)
+        return cInternalReference()->readFieldAccess(index);
+
+    assert(type() == Nda::Record);
+    assert(index >= 0);
+    assert(index < lengthOperator());
+
+    return cInternalRecord()->cFields()[index];
+}
+
+//-------------------------------------------------------------------------------------------------
+int NdaVariant::fieldIndex(const std::string &name) const
+{
+    if (type() != Nda::Record)
+        return -1;
+    return runtimeType()->fieldIndex(Nda::toLower(name));
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaVariant::readArrayElement(int64_t index) const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->readArrayElement(index);
+
+    assert(type() == Nda::Array);
+    assert(index >= mRuntimeType->first);
+    assert(index <= mRuntimeType->last);
+
+    const Nda::RuntimeType *elementType = mRuntimeType->elementType;
+    NdaVariant ret(elementType);
+    if (!mValue.uPtr) // not yet touched -> zero
+        return ret;
+
+    size_t offset = (size_t)(index - mRuntimeType->first);
+    const unsigned char *data = cInternalArray()->cData();
+    switch (elementType->dataType) {
+    case Nda::Number:       ret.mValue.uDouble = ((const double*)data)[offset];   break;
+    case Nda::Natural:      ret.mValue.uInt64  = ((const int64_t*)data)[offset];  break;
+    case Nda::Supernatural: ret.mValue.uUInt64 = ((const uint64_t*)data)[offset]; break;
+    case Nda::Boolean:
+    case Nda::Byte:         ret.mValue.uByte   = data[offset];                    break;
+    default:
+        assert(0 && "not an array element type");
+    }
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::writeArrayElement(int64_t index, const NdaVariant &value)
+{
+    if (myType() == Nda::Reference)
+        return internalReference()->writeArrayElement(index, value);
+
+    assert(type() == Nda::Array);
+    assert(index >= mRuntimeType->first);
+    assert(index <= mRuntimeType->last);
+
+    const Nda::RuntimeType *elementType = mRuntimeType->elementType;
+    NdaVariant element(elementType);
+    if (!element.assign(value)) // same conversion rules as "X : Number := value;"
+        return false;
+
+    detachArray();
+
+    size_t offset = (size_t)(index - mRuntimeType->first);
+    unsigned char *data = internalArray()->data();
+    switch (elementType->dataType) {
+    case Nda::Number:       ((double*)data)[offset]   = element.mValue.uDouble; break;
+    case Nda::Natural:      ((int64_t*)data)[offset]  = element.mValue.uInt64;  break;
+    case Nda::Supernatural: ((uint64_t*)data)[offset] = element.mValue.uUInt64; break;
+    case Nda::Boolean:
+    case Nda::Byte:         data[offset]              = element.mValue.uByte;   break;
+    default:
+        assert(0 && "not an array element type");
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::insertIntoSet(const NdaVariant &value)
+{
+    assert(type() == Nda::Set);
+    if (myType() == Nda::Reference)
+        return internalReference()->insertIntoSet(value);
+
+    if (!value.isHashable())
+        return false;
+    if (containsInSet(value))
+        return true;
+
+    NdaVariant element(value);
+    element.dereference(); // store the value, not the variable
+    detachSet();
+    internalSet()->set().insert(element);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::removeFromSet(const NdaVariant &value)
+{
+    assert(type() == Nda::Set);
+    if (myType() == Nda::Reference)
+        return internalReference()->removeFromSet(value);
+
+    if (!containsInSet(value))
+        return false;
+
+    detachSet();
+    internalSet()->set().erase(value);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::containsInSet(const NdaVariant &value) const
+{
+    assert(type() == Nda::Set);
+    if (myType() == Nda::Reference)
+        return cInternalReference()->containsInSet(value);
+
+    if (!mValue.uPtr || !value.isHashable())
+        return false;
+    return cInternalSet()->cSet().count(value) > 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::vector<NdaVariant> NdaVariant::setItems() const
+{
+    assert(type() == Nda::Set);
+    if (myType() == Nda::Reference)
+        return cInternalReference()->setItems();
+
+    std::vector<NdaVariant> ret;
+    if (!mValue.uPtr)
+        return ret;
+
+    ret.assign(cInternalSet()->cSet().begin(), cInternalSet()->cSet().end());
+    std::sort(ret.begin(), ret.end()); // stable output, the hash order is random
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaVariant::setUnion(const NdaVariant &other, bool *ok) const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->setUnion(other, ok);
+
+    assert(type() == Nda::Set);
+    if (ok) *ok = false;
+    if (other.type() != Nda::Set)
+        return NdaVariant();
+
+    // grow the bigger one: COW shares it, only the elements of the smaller one are inserted
+    const NdaVariant &big   = setSize() >= other.setSize() ? *this : other;
+    const NdaVariant &small = setSize() >= other.setSize() ? other : *this;
+
+    NdaVariant ret;
+    ret.assignAny(big);
+    if (small.cInternalSet()) {
+        for (const auto &element : small.cInternalSet()->cSet())
+            ret.insertIntoSet(element);
+    }
+    if (ok) *ok = true;
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaVariant::setIntersection(const NdaVariant &other, bool *ok) const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->setIntersection(other, ok);
+
+    assert(type() == Nda::Set);
+    if (ok) *ok = false;
+    if (other.type() != Nda::Set)
+        return NdaVariant();
+
+    // lookups in the bigger one
+    const NdaVariant &big   = setSize() >= other.setSize() ? *this : other;
+    const NdaVariant &small = setSize() >= other.setSize() ? other : *this;
+
+    NdaVariant ret(mRuntimeType);
+    if (small.cInternalSet()) {
+        for (const auto &element : small.cInternalSet()->cSet()) {
+            if (big.containsInSet(element))
+                ret.internalSet()->set().insert(element);
+        }
+    }
+    if (ok) *ok = true;
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaVariant::setDifference(const NdaVariant &other, bool *ok) const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->setDifference(other, ok);
+
+    assert(type() == Nda::Set);
+    if (ok) *ok = false;
+    if (other.type() != Nda::Set)
+        return NdaVariant();
+
+    NdaVariant ret(mRuntimeType);
+    if (cInternalSet()) {
+        for (const auto &element : cInternalSet()->cSet()) {
+            if (!other.containsInSet(element))
+                ret.internalSet()->set().insert(element);
+        }
+    }
+    if (ok) *ok = true;
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::clearSet()
+{
+    assert(type() == Nda::Set);
+    if (myType() == Nda::Reference)
+        return internalReference()->clearSet();
+
+    detachSet();
+    internalSet()->set().clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::isHashable() const
+{
+    switch (type()) {
+    case Nda::Number:
+    case Nda::Natural:
+    case Nda::Supernatural:
+    case Nda::BigNatural:
+    case Nda::Boolean:
+    case Nda::Byte:
+    case Nda::String:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t NdaVariant::hash() const
+{
+    // numeric types are compared by value (1 = 1.0 = true) -> integral values hash as int64
+
+    switch (myType()) {
+    case Nda::Reference:
+        return cInternalReference()->hash();
+    case Nda::Number: {
+        double value = mValue.uDouble;
+        if (std::isinf(value) || value != std::floor(value)) // NaN too
+            return std::hash<double>()(value);
+        if (value >= -9223372036854775808.0 && value < 9223372036854775808.0)
+            return std::hash<int64_t>()((int64_t)value);
+        if (value > 0 && value < 18446744073709551616.0) // as an equal Supernatural
+            return std::hash<uint64_t>()((uint64_t)value);
+        if (value > 0)                                   // as an equal BigNatural
+            return NdaBigNatural::hash(NdaBigNatural::fromDouble(value));
+        return std::hash<double>()(value);
+    }
+    case Nda::Natural:
+        return std::hash<int64_t>()(mValue.uInt64);
+    case Nda::Supernatural:
+        if (mValue.uUInt64 <= (uint64_t)INT64_MAX)
+            return std::hash<int64_t>()((int64_t)mValue.uUInt64);
+        return std::hash<uint64_t>()(mValue.uUInt64);
+    case Nda::BigNatural:
+        return NdaBigNatural::hash(bigNaturalDigitsOf(cInternalBigNatural()));
+    case Nda::Boolean:
+    case Nda::Byte:
+        return std::hash<int64_t>()(mValue.uByte);
+    case Nda::String: {
+        size_t length;
+        const char *data = cStringData(length);
+        uint64_t h = 14695981039346656037ULL; // FNV-1a
+        for (size_t i = 0; i < length; i++) {
+            h ^= (unsigned char)data[i];
+            h *= 1099511628211ULL;
+        }
+        return (size_t)h;
+    }
+    default:
+        return 0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::pushToDeque(const NdaVariant &value, bool front)
+{
+    assert(type() == Nda::Deque);
+    if (myType() == Nda::Reference)
+        return internalReference()->pushToDeque(value, front);
+
+    detachDeque();
+    if (front)
+        internalDeque()->deque().push_front(value);
+    else
+        internalDeque()->deque().push_back(value);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::popFromDeque(NdaVariant &value, bool front)
+{
+    assert(type() == Nda::Deque);
+    if (myType() == Nda::Reference)
+        return internalReference()->popFromDeque(value, front);
+
+    if (dequeSize() == 0)
+        return false;
+
+    detachDeque();
+    auto &deque = internalDeque()->deque();
+    if (front) {
+        value = deque.front();
+        deque.pop_front();
+    } else {
+        value = deque.back();
+        deque.pop_back();
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::peekDeque(NdaVariant &value, bool front) const
+{
+    assert(type() == Nda::Deque);
+    if (myType() == Nda::Reference)
+        return cInternalReference()->peekDeque(value, front);
+
+    if (dequeSize() == 0)
+        return false;
+
+    const auto &deque = cInternalDeque()->cDeque();
+    value = front ? deque.front() : deque.back();
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::vector<NdaVariant> NdaVariant::dequeItems() const
+{
+    assert(type() == Nda::Deque);
+    if (myType() == Nda::Reference)
+        return cInternalReference()->dequeItems();
+
+    if (!mValue.uPtr)
+        return std::vector<NdaVariant>();
+    const auto &deque = cInternalDeque()->cDeque();
+    return std::vector<NdaVariant>(deque.begin(), deque.end());
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::clearDeque()
+{
+    assert(type() == Nda::Deque);
+    if (myType() == Nda::Reference)
+        return internalReference()->clearDeque();
+
+    detachDeque();
+    internalDeque()->deque().clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::pushToQueue(const NdaVariant &value, const NdaVariant &priority)
+{
+    assert(type() == Nda::PriorityQueue);
+    if (myType() == Nda::Reference)
+        return internalReference()->pushToQueue(value, priority);
+
+    NdaVariant key(priority);
+    key.dereference(); // compared on every sift, must not change behind the heap
+    detachQueue();
+    internalQueue()->push(value, key);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::popFromQueue(NdaVariant &value)
+{
+    assert(type() == Nda::PriorityQueue);
+    if (myType() == Nda::Reference)
+        return internalReference()->popFromQueue(value);
+
+    if (queueSize() == 0)
+        return false;
+
+    detachQueue();
+    value = internalQueue()->top().value;
+    internalQueue()->pop();
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::peekQueue(NdaVariant &value) const
+{
+    assert(type() == Nda::PriorityQueue);
+    if (myType() == Nda::Reference)
+        return cInternalReference()->peekQueue(value);
+
+    if (queueSize() == 0)
+        return false;
+
+    value = cInternalQueue()->top().value;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::vector<NdaVariant> NdaVariant::queueItems() const
+{
+    assert(type() == Nda::PriorityQueue);
+    if (myType() == Nda::Reference)
+        return cInternalReference()->queueItems();
+
+    if (!mValue.uPtr)
+        return std::vector<NdaVariant>();
+    return cInternalQueue()->sortedValues();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::clearQueue()
+{
+    assert(type() == Nda::PriorityQueue);
+    if (myType() == Nda::Reference)
+        return internalReference()->clearQueue();
+
+    detachQueue();
+    internalQueue()->clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::assignOther(const NdaVariant &other)
+{
+    if (mRuntimeType) reset();
+
+    switch (other.myType()) {
+    case Nda::Undefined: return;
+    case Nda::Reference: {
+        mRuntimeType = other.mRuntimeType;
+        mValue.uPtr  = other.mValue.uPtr;
+        return;
+    } break;
+    case Nda::Any:       return;
+    case Nda::Number:
+    case Nda::Natural:
+    case Nda::Supernatural:
+    case Nda::Boolean:
+    case Nda::Byte: {
+        mRuntimeType  = other.mRuntimeType;
+        mValue.uInt64 = other.mValue.uInt64;
+        return;
+    } break;
+    case Nda::String:
+        assignOtherString(other);
+        return;
+    case Nda::List:
+        assignOtherList(other);
+        return;
+    case Nda::Bytes:
+        assignOtherBytes(other);
+        return;
+    case Nda::Dict:
+        assignOtherDict(other);
+        return;
+    case Nda::Record:
+        assignOtherRecord(other);
+        return;
+    case Nda::Array:
+        assignOtherArray(other);
+        return;
+    case Nda::Set:
+        assignOtherSet(other);
+        return;
+    case Nda::Deque:
+        assignOtherDeque(other);
+        return;
+    case Nda::PriorityQueue:
+        assignOtherQueue(other);
+        return;
+    case Nda::BigNatural:
+        assignOtherBigNatural(other);
+        return;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::assignAny(const NdaVariant &other)
+{
+    switch (other.type()) {
+    case Nda::Undefined: return;
+    case Nda::Reference: return;
+    case Nda::Any:       return;
+    case Nda::Number:
+    case Nda::Natural:
+    case Nda::Supernatural:
+    case Nda::Boolean:
+    case Nda::Byte: {
+        mRuntimeType  = other.runtimeType();
+        mValue.uInt64 = other.cuValue()->uUInt64;
+        return;
+    } break;
+    case Nda::String:
+        reset();
+        assignOtherString(other);
+        return;
+    case Nda::List:
+        reset();
+        assignOtherList(other);
+        return;
     case Nda::Bytes:
         reset();
         assignOtherBytes(other);
@@ -1664,6 +2551,30 @@ void NdaVariant::assignAny(const NdaVariant &other)
         reset();
         assignOtherDict(other);
         return;
+    case Nda::Record:
+        reset();
+        assignOtherRecord(other);
+        return;
+    case Nda::Array:
+        reset();
+        assignOtherArray(other);
+        return;
+    case Nda::Set:
+        reset();
+        assignOtherSet(other);
+        return;
+    case Nda::Deque:
+        reset();
+        assignOtherDeque(other);
+        return;
+    case Nda::PriorityQueue:
+        reset();
+        assignOtherQueue(other);
+        return;
+    case Nda::BigNatural:
+        reset();
+        assignOtherBigNatural(other);
+        return;
     }
 }
 
@@ -1680,6 +2591,8 @@ void NdaVariant::assignOtherString(const NdaVariant &other)
         return;
 
     mValue.uPtr = other.cuValue()->uPtr;
+    if (hasInlineString()) // inline strings are just copied
+        return;
     internalString()->addRef();
 }
 
@@ -1729,6 +2642,158 @@ void NdaVariant::assignOtherDict(const NdaVariant &other)
     internalDict()->addRef();
 }
 
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::assignOtherRecord(const NdaVariant &other)
+{
+    assert(myType()    == Nda::Undefined);
+    assert(mValue.uPtr == nullptr);
+
+    mRuntimeType = other.runtimeType();
+    assert(type() == Nda::Record);
+
+    mValue.uPtr = other.cuValue()->uPtr;
+    internalRecord()->addRef();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::assignOtherArray(const NdaVariant &other)
+{
+    assert(myType()    == Nda::Undefined);
+    assert(mValue.uPtr == nullptr);
+
+    mRuntimeType = other.runtimeType();
+    assert(type() == Nda::Array);
+
+    if (!other.cuValue()->uPtr)
+        return;
+    mValue.uPtr = other.cuValue()->uPtr;
+    internalArray()->addRef();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::assignListToArray(const NdaVariant &list)
+{
+    assert(myType() == Nda::Array);
+    assert(list.type() == Nda::List);
+
+    if (list.listSize() != lengthOperator())
+        return false;
+
+    NdaVariant result(mRuntimeType); // all or nothing
+    int64_t first = mRuntimeType->first;
+    for (int i = 0; i < list.listSize(); i++) {
+        if (!result.writeArrayElement(first + i, list.readAccess(i)))
+            return false;
+    }
+
+    reset();
+    assignOtherArray(result);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::assignOtherSet(const NdaVariant &other)
+{
+    assert(myType()    == Nda::Undefined);
+    assert(mValue.uPtr == nullptr);
+
+    mRuntimeType = other.runtimeType();
+    assert(type() == Nda::Set);
+
+    if (!other.cuValue()->uPtr)
+        return;
+    mValue.uPtr = other.cuValue()->uPtr;
+    internalSet()->addRef();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::assignListToSet(const NdaVariant &list)
+{
+    assert(myType() == Nda::Set);
+    assert(list.type() == Nda::List);
+
+    NdaVariant result(mRuntimeType); // all or nothing
+    for (int i = 0; i < list.listSize(); i++) {
+        if (!result.insertIntoSet(list.readAccess(i)))
+            return false;
+    }
+
+    reset();
+    assignOtherSet(result);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::assignOtherDeque(const NdaVariant &other)
+{
+    assert(myType()    == Nda::Undefined);
+    assert(mValue.uPtr == nullptr);
+
+    mRuntimeType = other.runtimeType();
+    assert(type() == Nda::Deque);
+
+    if (!other.cuValue()->uPtr)
+        return;
+    mValue.uPtr = other.cuValue()->uPtr;
+    internalDeque()->addRef();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::assignListToDeque(const NdaVariant &list)
+{
+    assert(myType() == Nda::Deque);
+    assert(list.type() == Nda::List);
+
+    std::deque<NdaVariant> elements;
+    for (int i = 0; i < list.listSize(); i++)
+        elements.push_back(list.readAccess(i));
+
+    if (internalDeque()->refCount() > 1) {
+        internalDeque()->releaseRef();
+        mValue.uPtr = new Nda::SharedDeque(elements);
+        return;
+    }
+    internalDeque()->deque().swap(elements);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::assignOtherQueue(const NdaVariant &other)
+{
+    assert(myType()    == Nda::Undefined);
+    assert(mValue.uPtr == nullptr);
+
+    mRuntimeType = other.runtimeType();
+    assert(type() == Nda::PriorityQueue);
+
+    if (!other.cuValue()->uPtr)
+        return;
+    mValue.uPtr = other.cuValue()->uPtr;
+    internalQueue()->addRef();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::assignListToQueue(const NdaVariant &list)
+{
+    assert(myType() == Nda::PriorityQueue);
+    assert(list.type() == Nda::List);
+
+    clearQueue();
+    for (int i = 0; i < list.listSize(); i++)
+        pushToQueue(list.readAccess(i), list.readAccess(i));
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::assignOtherBigNatural(const NdaVariant &other)
+{
+    assert(myType()     == Nda::Undefined);
+    assert(other.type() == Nda::BigNatural);
+
+    mRuntimeType = other.runtimeType();
+    mValue.uPtr  = other.cuValue()->uPtr;
+    if (mValue.uPtr) // immutable -> shared, never detached
+        internalSharedObject()->addRef();
+}
+
 //-------------------------------------------------------------------------------------------------
 NdaVariant NdaVariant::doubleAddition(const NdaVariant &other, bool *ok) const
 {
@@ -1783,25 +2848,140 @@ NdaVariant NdaVariant::doubleDivision(const NdaVariant &other, bool &dbz, bool *
     NdaVariant ret;
     ret.fromNumber(type() == Nda::Number ? runtimeType() : other.runtimeType(), value/divisor);
 
-    if (ok) *ok = true;
-    return ret;
+    if (ok) *ok = true;
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaVariant::doubleMultiply(const NdaVariant &other, bool *ok) const
+{
+    bool isDouble;
+    auto divisor = other.toDouble(&isDouble);
+    if (!isDouble)
+        return NdaVariant();
+
+    auto value = toDouble(ok);
+
+    NdaVariant ret;
+    ret.fromNumber(type() == Nda::Number ? runtimeType() : other.runtimeType(), value*divisor);
+
+    if (ok) *ok = true;
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaVariant::bigNaturalArithmetic(char op, const NdaVariant &other, bool &dbz, bool *ok) const
+{
+    // one operand is a BigNatural, the other one has to be a natural number as well
+    dbz = false;
+    if (ok) *ok = false;
+
+    NdaBigNatural::Digits leftBuffer, rightBuffer;
+    const auto *left  = bigNaturalDigits(leftBuffer);
+    const auto *right = other.bigNaturalDigits(rightBuffer);
+    if (!left || !right)
+        return NdaVariant();
+
+    NdaBigNatural::Digits digits;
+    switch (op) {
+    case '+':
+        digits = NdaBigNatural::add(*left, *right);
+        break;
+    case '-':
+        if (!NdaBigNatural::subtract(*left, *right, digits))
+            return NdaVariant(); // below zero
+        break;
+    case '*':
+        digits = NdaBigNatural::multiply(*left, *right);
+        break;
+    case '/':
+    case '%': {
+        NdaBigNatural::Digits remainder;
+        if (!NdaBigNatural::divide(*left, *right, digits, remainder)) {
+            dbz = true;
+            return NdaVariant();
+        }
+        if (op == '%')
+            digits.swap(remainder);
+    } break;
+    default:
+        assert(0 && "not implemented");
+        return NdaVariant();
+    }
+
+    NdaVariant ret;
+    ret.fromBigNaturalDigits(type() == Nda::BigNatural ? runtimeType() : other.runtimeType(), std::move(digits));
+    if (ok) *ok = true;
+    return ret;
+}
+
+//-------------------------------------------------------------------------------------------------
+double NdaVariant::bigNaturalSpaceship(const NdaVariant &other, bool *ok) const
+{
+    if (ok) *ok = false;
+
+    NdaBigNatural::Digits leftBuffer, rightBuffer;
+    const auto *left  = bigNaturalDigits(leftBuffer);
+    const auto *right = other.bigNaturalDigits(rightBuffer);
+    if (left && right) {
+        if (ok) *ok = true;
+        return NdaBigNatural::compare(*left, *right);
+    }
+
+    // negative Naturals are less than any BigNatural
+    if (left && other.type() == Nda::Natural) {
+        if (ok) *ok = true;
+        return 1;
+    }
+    if (right && type() == Nda::Natural) {
+        if (ok) *ok = true;
+        return -1;
+    }
+
+    return NDA_NAN;
 }
 
 //-------------------------------------------------------------------------------------------------
-NdaVariant NdaVariant::doubleMultiply(const NdaVariant &other, bool *ok) const
+double NdaVariant::numberSpaceship(const NdaVariant &other, bool *ok) const
 {
-    bool isDouble;
-    auto divisor = other.toDouble(&isDouble);
-    if (!isDouble)
-        return NdaVariant();
-
-    auto value = toDouble(ok);
+    // Number vs. Natural, Supernatural, Byte or BigNatural without rounding the integer to
+    // double: 2**53 + 1 /= 9007199254740992.0, see hash()
+    if (ok) *ok = false;
 
-    NdaVariant ret;
-    ret.fromNumber(type() == Nda::Number ? runtimeType() : other.runtimeType(), value*divisor);
+    const bool numberLeft = type() == Nda::Number;
+    const NdaVariant &integer = numberLeft ? other : *this;
+    double value = numberLeft ? toDouble() : other.toDouble();
+
+    NdaBigNatural::Digits buffer;
+    const auto *digits = integer.bigNaturalDigits(buffer);
+    bool negative = false;
+    if (!digits && integer.type() == Nda::Natural) { // compare the magnitudes
+        buffer   = NdaBigNatural::fromUInt64(0 - (uint64_t)integer.toInt64());
+        digits   = &buffer;
+        negative = true;
+        value    = -value;
+    }
+    if (!digits)
+        return NDA_NAN;
 
     if (ok) *ok = true;
-    return ret;
+    if (std::isnan(value))
+        return NDA_NAN;
+
+    int ret;
+    if (value < 0)
+        ret = -1;
+    else if (std::isinf(value))
+        ret = 1;
+    else {
+        double whole = std::floor(value);
+        ret = NdaBigNatural::compare(NdaBigNatural::fromDouble(whole), *digits);
+        if (!ret && value > whole)
+            ret = 1;
+    }
+    if (negative)
+        ret = -ret;
+    return numberLeft ? ret : -ret;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1814,17 +2994,24 @@ bool NdaVariant::setString(const std::string &newValue)
         return false;
     if (newValue.empty() && !mValue.uPtr)  // nothing to to
         return true;
-    if (newValue.empty() &&  mValue.uPtr){ // almost nothing to to
-        internalString()->releaseRef();
-        mValue.uPtr = nullptr;
-        return true;
-    }
 
     // same value.. nothing to to
-    if (mValue.uPtr && (newValue == internalString()->cValue()))
+    if (hasSharedString()) {
+        size_t length;
+        const char *data = cStringData(length);
+        if (newValue.length() == length && !newValue.compare(0, length, data, length))
+            return true;
+    }
+
+    if (newValue.length() <= InlineStringSize) {
+        if (hasSharedString())
+            internalString()->releaseRef();
+        mValue.uPtr = nullptr;
+        setInlineString(newValue.data(), newValue.length());
         return true;
+    }
 
-    if (mValue.uPtr) {
+    if (hasSharedString()) {
         if (internalString()->refCount() > 1) { // detach?
             internalString()->releaseRef();
             mValue.uPtr = new Nda::SharedString(newValue);
@@ -1838,6 +3025,79 @@ bool NdaVariant::setString(const std::string &newValue)
     return true;
 }
 
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::appendToString(const NdaVariant &value)
+{
+    if (myType() == Nda::Reference)
+        return internalReference()->appendToString(value);
+
+    if (myType() != Nda::String)
+        return false;
+
+    const std::string tail = value.toString();
+    if (tail.empty())
+        return true;
+
+    if (hasSharedString() && internalString()->refCount() == 1) { // not shared -> amortized O(1)
+        internalString()->value() += tail;
+        return true;
+    }
+
+    size_t length;
+    const char *data = cStringData(length);
+    if (length + tail.length() <= InlineStringSize) {
+        char buffer[InlineStringSize];
+        std::memcpy(buffer, data, length);
+        std::memcpy(buffer + length, tail.data(), tail.length());
+        if (hasSharedString())
+            internalString()->releaseRef();
+        mValue.uPtr = nullptr;
+        setInlineString(buffer, length + tail.length());
+        return true;
+    }
+
+    auto *newString = new Nda::SharedString();
+    newString->value().reserve(2 * (length + tail.length()));
+    newString->value().append(data, length);
+    newString->value() += tail;
+    if (hasSharedString())
+        internalString()->releaseRef();
+    mValue.uPtr = newString;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+NdaVariant NdaVariant::midString(int64_t pos, int64_t count) const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->midString(pos, count);
+
+    assert(myType() == Nda::String);
+
+    size_t length;
+    const char *data = cStringData(length);
+    if (pos < 0)
+        pos = 0;
+    if (count < 0 || (size_t)pos >= length)
+        count = 0;
+    if ((size_t)count > length - pos)
+        count = length - pos;
+
+    NdaVariant ret;
+    if ((size_t)count == length) {
+        ret = *this;
+        return ret;
+    }
+
+    ret.mRuntimeType = runtimeType();
+    ret.mValue.uPtr  = nullptr;
+    if ((size_t)count <= InlineStringSize)
+        ret.setInlineString(data + pos, (size_t)count);
+    else
+        ret.mValue.uPtr = new Nda::SharedString(cInternalString(), (size_t)pos, (size_t)count);
+    return ret;
+}
+
 //-------------------------------------------------------------------------------------------------
 std::string NdaVariant::toString() const
 {
@@ -1848,30 +3108,34 @@ std::string NdaVariant::toString() const
     case Nda::Reference: return cInternalReference()->toString();
     case Nda::Any:       return "";
     case Nda::Number:
-        oss << std::setprecision(15) << std::fixed << mValue.uDouble;
-        break;
+        return NdaNumberFormat::formatDouble(mValue.uDouble);
     case Nda::Natural:
         oss << mValue.uInt64;
         break;
     case Nda::Supernatural:
         oss << mValue.uUInt64;
         break;
+    case Nda::BigNatural:
+        return NdaBigNatural::toString(bigNaturalDigitsOf(cInternalBigNatural()));
     case Nda::Boolean:
         return mValue.uByte ? "true" : "false";
     case Nda::Byte:
         oss << (int)mValue.uByte;
         break;
     case Nda::String:
-        if (mValue.uPtr)
-            return cInternalString()->cValue();
-        return "";
+        {
+            size_t length;
+            const char *data = cStringData(length);
+            return std::string(data, length);
+        }
     case Nda::List:
         if (mValue.uPtr) {
             std::string ret;
-            for (const auto &v : cInternalList()->cArray()) {
+            const auto *list = cInternalList();
+            for (size_t i = 0; i < list->size(); i++) {
                 if (!ret.empty())
                     ret = ret + ",";
-                ret += v.toString();
+                ret += list->at(i).toString();
             }
             ret = "[" + ret + "]";
             return ret;
@@ -1881,10 +3145,11 @@ std::string NdaVariant::toString() const
     case Nda::Bytes:
         if (mValue.uPtr) {
             std::string ret;
-            for (const auto &v : cInternalBytes()->cArray()) {
+            const auto *bytes = cInternalBytes();
+            for (size_t i = 0; i < bytes->size(); i++) {
                 if (!ret.empty())
                     ret = ret + ",";
-                ret += v.toString();
+                ret += bytes->at(i).toString();
             }
             ret = "Bytes[" + ret + "]";
             return ret;
@@ -1905,6 +3170,44 @@ std::string NdaVariant::toString() const
         }
 
         return "{}";
+    case Nda::Record: {
+            std::string ret;
+            const auto &fields = mRuntimeType->fields;
+            for (size_t i = 0; i < fields.size(); i++) {
+                if (!ret.empty())
+                    ret = ret + ",";
+                ret += fields[i].name.displayValue + "=>" + readFieldAccess((int)i).toString();
+            }
+            return "(" + ret + ")";
+        }
+    case Nda::Array: {
+            std::string ret;
+            for (int64_t i = mRuntimeType->first; i <= mRuntimeType->last; i++) {
+                if (!ret.empty())
+                    ret = ret + ",";
+                ret += readArrayElement(i).toString();
+            }
+            return "(" + ret + ")";
+        }
+    case Nda::Set: {
+            std::string ret;
+            for (const auto &element : setItems()) {
+                if (!ret.empty())
+                    ret = ret + ",";
+                ret += element.toString();
+            }
+            return "Set{" + ret + "}";
+        }
+    case Nda::Deque:
+    case Nda::PriorityQueue: {
+            std::string ret;
+            for (const auto &element : myType() == Nda::Deque ? dequeItems() : queueItems()) {
+                if (!ret.empty())
+                    ret = ret + ",";
+                ret += element.toString();
+            }
+            return "[" + ret + "]";
+        }
     }
 
     return oss.str();
@@ -1916,7 +3219,7 @@ std::string NdaVariant::toString() const
 Nda::Type NdaVariant::type() const
 {
     if (myType() == Nda::Reference)
-        return cInternalReference()->type();
+        return cInternalReference()->myType();
 
     if (mRuntimeType)
         return mRuntimeType->dataType;
@@ -1928,7 +3231,7 @@ Nda::Type NdaVariant::type() const
 const Nda::RuntimeType *NdaVariant::runtimeType() const
 {
     if (myType() == Nda::Reference)
-        return cInternalReference()->runtimeType();
+        return cInternalReference()->mRuntimeType;
     return mRuntimeType;
 }
 
@@ -1954,7 +3257,7 @@ int NdaVariant::refCount() const
 
     // TODO: one for all.. cInternalSharedObject?
     if (myType() == Nda::String)
-        return cInternalString()->refCount();
+        return hasInlineString() ? 0 : cInternalString()->refCount();
 
     if (myType() == Nda::List)
         return cInternalList()->refCount();
@@ -1965,10 +3268,66 @@ int NdaVariant::refCount() const
     if (myType() == Nda::Dict)
         return cInternalDict()->refCount();
 
+    if (myType() == Nda::Record)
+        return cInternalRecord()->refCount();
+
+    if (myType() == Nda::Array)
+        return cInternalArray()->refCount();
+
+    if (myType() == Nda::Set)
+        return cInternalSet()->refCount();
+
+    if (myType() == Nda::Deque)
+        return cInternalDeque()->refCount();
+
+    if (myType() == Nda::PriorityQueue)
+        return cInternalQueue()->refCount();
+
+    if (myType() == Nda::BigNatural)
+        return cInternalBigNatural()->refCount();
+
     assert(0 && "Not Implemented");
     return 0;
 }
 
+//-------------------------------------------------------------------------------------------------
+int NdaVariant::referenceDepth() const
+{
+    int depth = 0;
+    const NdaVariant *v = this;
+    while (v->myType() == Nda::Reference) {
+        v = v->cInternalReference();
+        depth++;
+    }
+    return depth;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::isInlineString() const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->isInlineString();
+    return (myType() == Nda::String) && hasInlineString();
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NdaVariant::isView() const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->isView();
+    if (!mValue.uPtr)
+        return false;
+
+    switch (myType()) {
+    case Nda::String: return hasSharedString() && cInternalString()->isView();
+    case Nda::List:   return cInternalList()->isView();
+    case Nda::Bytes:  return cInternalBytes()->isView();
+    default:
+        break;
+    }
+    return false;
+}
+
 //-------------------------------------------------------------------------------------------------
 Nda::Type NdaVariant::numericType(const std::string &literal)
 {
@@ -1997,7 +3356,7 @@ Nda::Type NdaVariant::numericType(const std::string &literal)
 
     // no explizit typing -> default guessing:
 
-    if (NadaNumericParser::isFloatingPointLiteral(cleanLiteral))
+    if (NadaNumericParser::isFloatingPointLiteral(decimalLiteral(literal))) // removeSeparators() drops the exponent
         return Nda::Number;
 
     if (NadaNumericParser::isBasedLiteral(cleanLiteral))
@@ -2011,6 +3370,11 @@ Nda::Type NdaVariant::numericType(const std::string &literal)
         } else {
             return Nda::Supernatural;
         }
+    } catch (const std::out_of_range&) {
+        // too big for Supernatural: decimal literals become BigNaturals
+        if (cleanLiteral[0] != '0' && std::all_of(cleanLiteral.begin(), cleanLiteral.end(), ::isdigit))
+            return Nda::BigNatural;
+        return Nda::Undefined;
     } catch (const std::runtime_error&) {
         return Nda::Undefined;
     } catch (...) {
@@ -2052,9 +3416,19 @@ void NdaVariant::reset()
         mValue.uPtr = nullptr;
         break;
     case Nda::String:
+        if (hasSharedString())
+            internalSharedObject()->releaseRef();
+        mValue.uPtr = nullptr;
+        break;
     case Nda::List:
     case Nda::Bytes:
     case Nda::Dict:
+    case Nda::Record:
+    case Nda::Array:
+    case Nda::Set:
+    case Nda::Deque:
+    case Nda::PriorityQueue:
+    case Nda::BigNatural:
         if (mValue.uPtr) {
             internalSharedObject()->releaseRef();
             mValue.uPtr = nullptr;
@@ -2068,7 +3442,7 @@ void NdaVariant::reset()
 Nda::SharedString *NdaVariant::internalString()
 {
     assert(myType() == Nda::String);
-    assert(mValue.uPtr);
+    assert(hasSharedString());
     return ((Nda::SharedString*)mValue.uPtr);
 }
 
@@ -2076,14 +3450,48 @@ Nda::SharedString *NdaVariant::internalString()
 const Nda::SharedString *NdaVariant::cInternalString() const
 {
     assert(myType() == Nda::String);
+    assert(!hasInlineString());
     return ((Nda::SharedString*)mValue.uPtr);
 }
 
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::setInlineString(const char *data, size_t length)
+{
+    assert(length <= InlineStringSize);
+    assert(!hasSharedString());
+
+    mValue.uInt64 = 0;
+    if (!length) // empty string -> nullptr
+        return;
+    mValue.uChars[NDA_SSO_TAG_BYTE] = (unsigned char)((length << 1) | 0x01);
+    std::memcpy(&mValue.uChars[NDA_SSO_DATA_BYTE], data, length);
+}
+
+//-------------------------------------------------------------------------------------------------
+const char *NdaVariant::cStringData(size_t &length) const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->cStringData(length);
+
+    assert(myType() == Nda::String);
+    if (!mValue.uPtr) {
+        length = 0;
+        return "";
+    }
+    if (hasInlineString()) {
+        length = mValue.uChars[NDA_SSO_TAG_BYTE] >> 1;
+        return (const char*)&mValue.uChars[NDA_SSO_DATA_BYTE];
+    }
+    length = cInternalString()->length();
+    return cInternalString()->data();
+}
+
 //-------------------------------------------------------------------------------------------------
 NdaVariant *NdaVariant::internalReference()
 {
     assert(myType() == Nda::Reference);
     assert(mValue.uPtr);
+    assert(((NdaVariant*)mValue.uPtr)->myType() != Nda::Reference); // no chains
     return ((NdaVariant*)mValue.uPtr);
 }
 
@@ -2092,6 +3500,7 @@ const NdaVariant *NdaVariant::cInternalReference() const
 {
     assert(myType() == Nda::Reference);
     assert(mValue.uPtr);
+    assert(((NdaVariant*)mValue.uPtr)->myType() != Nda::Reference); // no chains
     return ((NdaVariant*)mValue.uPtr);
 }
 
@@ -2126,7 +3535,7 @@ void NdaVariant::detachList()
         return;
 
     auto *newList = new Nda::SharedList();
-    newList->array() = internalList()->array(); // deep copy
+    newList->array() = internalList()->cArray(); // deep copy
     internalList()->releaseRef();
     mValue.uPtr = newList;
 }
@@ -2163,7 +3572,7 @@ void NdaVariant::detachBytes()
         return;
 
     auto *newBytes = new Nda::SharedBytes();
-    newBytes->array() = internalBytes()->array();
+    newBytes->array() = internalBytes()->cArray();
     internalBytes()->releaseRef();
     mValue.uPtr = newBytes;
 }
@@ -2195,15 +3604,227 @@ void NdaVariant::detachDict()
 {
     assert(myType() == Nda::Dict);
     assert(mValue.uPtr);
-    if (internalDict()->refCount() <= 1)
+    if (internalDict()->sharingOwners() <= 1)
         return;
 
     auto *newDict = new Nda::SharedDict();
     newDict->dict() = internalDict()->dict(); // deep copy
+    newDict->keysCopied(*internalDict());
     internalDict()->releaseRef();
     mValue.uPtr = newDict;
 }
 
+//-------------------------------------------------------------------------------------------------
+Nda::SharedRecord *NdaVariant::internalRecord()
+{
+    if (myType() == Nda::Reference)
+        return internalReference()->internalRecord();
+
+    assert(myType() == Nda::Record);
+    assert(mValue.uPtr); // allocated by initType()/the constructor
+    return ((Nda::SharedRecord*)mValue.uPtr);
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::SharedRecord *NdaVariant::cInternalRecord() const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->cInternalRecord();
+
+    assert(myType() == Nda::Record);
+    return ((Nda::SharedRecord*)mValue.uPtr);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::detachRecord()
+{
+    assert(myType() == Nda::Record);
+    if (internalRecord()->refCount() <= 1)
+        return;
+
+    auto *newRecord = new Nda::SharedRecord(internalRecord()->cFields()); // field values are COW themselves
+    internalRecord()->releaseRef();
+    mValue.uPtr = newRecord;
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::SharedArray *NdaVariant::internalArray()
+{
+    if (myType() == Nda::Reference)
+        return internalReference()->internalArray();
+
+    assert(myType() == Nda::Array);
+    if (!mValue.uPtr)
+        mValue.uPtr = new Nda::SharedArray(mRuntimeType);
+    return ((Nda::SharedArray*)mValue.uPtr);
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::SharedArray *NdaVariant::cInternalArray() const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->cInternalArray();
+
+    assert(myType() == Nda::Array);
+    return ((Nda::SharedArray*)mValue.uPtr);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::detachArray()
+{
+    assert(myType() == Nda::Array);
+    if (internalArray()->refCount() <= 1)
+        return;
+
+    auto *newArray = new Nda::SharedArray(internalArray()); // plain memory copy
+    internalArray()->releaseRef();
+    mValue.uPtr = newArray;
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::SharedSet *NdaVariant::internalSet()
+{
+    if (myType() == Nda::Reference)
+        return internalReference()->internalSet();
+
+    assert(myType() == Nda::Set);
+    if (!mValue.uPtr)
+        mValue.uPtr = new Nda::SharedSet();
+    return ((Nda::SharedSet*)mValue.uPtr);
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::SharedSet *NdaVariant::cInternalSet() const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->cInternalSet();
+
+    assert(myType() == Nda::Set);
+    return ((Nda::SharedSet*)mValue.uPtr);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::detachSet()
+{
+    assert(myType() == Nda::Set);
+    if (internalSet()->refCount() <= 1)
+        return;
+
+    auto *newSet = new Nda::SharedSet();
+    newSet->set() = internalSet()->cSet(); // elements are COW themselves
+    internalSet()->releaseRef();
+    mValue.uPtr = newSet;
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::SharedDeque *NdaVariant::internalDeque()
+{
+    if (myType() == Nda::Reference)
+        return internalReference()->internalDeque();
+
+    assert(myType() == Nda::Deque);
+    if (!mValue.uPtr)
+        mValue.uPtr = new Nda::SharedDeque();
+    return ((Nda::SharedDeque*)mValue.uPtr);
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::SharedDeque *NdaVariant::cInternalDeque() const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->cInternalDeque();
+
+    assert(myType() == Nda::Deque);
+    return ((Nda::SharedDeque*)mValue.uPtr);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::detachDeque()
+{
+    assert(myType() == Nda::Deque);
+    if (internalDeque()->refCount() <= 1)
+        return;
+
+    auto *newDeque = new Nda::SharedDeque(internalDeque()->cDeque()); // elements are COW themselves
+    internalDeque()->releaseRef();
+    mValue.uPtr = newDeque;
+}
+
+//-------------------------------------------------------------------------------------------------
+Nda::SharedPriorityQueue *NdaVariant::internalQueue()
+{
+    if (myType() == Nda::Reference)
+        return internalReference()->internalQueue();
+
+    assert(myType() == Nda::PriorityQueue);
+    if (!mValue.uPtr)
+        mValue.uPtr = new Nda::SharedPriorityQueue();
+    return ((Nda::SharedPriorityQueue*)mValue.uPtr);
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::SharedPriorityQueue *NdaVariant::cInternalQueue() const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->cInternalQueue();
+
+    assert(myType() == Nda::PriorityQueue);
+    return ((Nda::SharedPriorityQueue*)mValue.uPtr);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::detachQueue()
+{
+    assert(myType() == Nda::PriorityQueue);
+    if (internalQueue()->refCount() <= 1)
+        return;
+
+    auto *newQueue = new Nda::SharedPriorityQueue(internalQueue()); // entries are COW themselves
+    internalQueue()->releaseRef();
+    mValue.uPtr = newQueue;
+}
+
+//-------------------------------------------------------------------------------------------------
+const Nda::SharedBigNatural *NdaVariant::cInternalBigNatural() const
+{
+    if (myType() == Nda::Reference)
+        return cInternalReference()->cInternalBigNatural();
+
+    assert(myType() == Nda::BigNatural);
+    return ((const Nda::SharedBigNatural*)mValue.uPtr);
+}
+
+//-------------------------------------------------------------------------------------------------
+const std::vector<uint32_t> *NdaVariant::bigNaturalDigits(std::vector<uint32_t> &buffer) const
+{
+    switch (type()) {
+    case Nda::BigNatural:
+        return &bigNaturalDigitsOf(cInternalBigNatural());
+    case Nda::Natural:
+    case Nda::Supernatural:
+    case Nda::Byte: {
+        bool isNatural;
+        uint64_t value = toUInt64(&isNatural); // fails on negative Naturals
+        if (!isNatural)
+            return nullptr;
+        buffer = NdaBigNatural::fromUInt64(value);
+        return &buffer;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void NdaVariant::fromBigNaturalDigits(const Nda::RuntimeType *t, std::vector<uint32_t> &&digits)
+{
+    assert(t);
+    if (mRuntimeType) reset();
+    mRuntimeType = t;
+    assert(type() == Nda::BigNatural);
+    mValue.uPtr = digits.empty() ? nullptr : new Nda::SharedBigNatural(std::move(digits));
+}
+
 //-------------------------------------------------------------------------------------------------
 Nda::SharedData *NdaVariant::internalSharedObject()
 {
@@ -2212,6 +3833,12 @@ Nda::SharedData *NdaVariant::internalSharedObject()
     case Nda::List:
     case Nda::Bytes:
     case Nda::Dict:
+    case Nda::Record:
+    case Nda::Array:
+    case Nda::Set:
+    case Nda::Deque:
+    case Nda::PriorityQueue:
+    case Nda::BigNatural:
         return (Nda::SharedData*)mValue.uPtr;
         break;
     default:
@@ -2265,6 +3892,15 @@ bool NdaVariant::exact64BitDbl(double &value) const
     case Nda::Reference:
     case Nda::Any:
     case Nda::String:
+    case Nda::BigNatural:
+    case Nda::Bytes:
+    case Nda::List:
+    case Nda::Dict:
+    case Nda::Record:
+    case Nda::Array:
+    case Nda::Set:
+    case Nda::Deque:
+    case Nda::PriorityQueue:
         return false;
 
     case Nda::Number: {
@@ -5,7 +5,9 @@
 #include <vector>
 #include <string>
 #include <utility>
+#include <functional>
 #include "private/type.h"
+#include "private/pool.h"
 
 namespace Nda {
 class  SharedData;
@@ -13,8 +15,25 @@ class  SharedString;
 class  SharedList;
 class  SharedBytes;
 class  SharedDict;
+class  SharedRecord;
+class  SharedArray;
+class  SharedSet;
+class  SharedDeque;
+class  SharedPriorityQueue;
+class  SharedBigNatural;
+class  CycleCollector;
 }
 
+// Short strings are stored inside the variant (see NdaVariant::InlineStringSize). The tag byte
+// is the byte holding the lowest address bit of mValue.uPtr.
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define NDA_SSO_TAG_BYTE   7
+#define NDA_SSO_DATA_BYTE  0
+#else
+#define NDA_SSO_TAG_BYTE   0
+#define NDA_SSO_DATA_BYTE  1
+#endif
+
 class NdaVariant
 {
 public:
@@ -40,6 +59,9 @@ public:
     void fromSNatural(const Nda::RuntimeType *type, uint64_t value);
     bool setSupernatural(uint64_t value);
 
+    bool fromBigNaturalLiteral(const Nda::RuntimeType *type, const std::string &value); // decimal digits only
+    void fromBigNatural(const Nda::RuntimeType *type, uint64_t value);
+
     bool fromByteLiteral(const Nda::RuntimeType *type,const std::string &value);
     void fromByte(const Nda::RuntimeType *type, unsigned char value);
     bool setByte(unsigned char value);
@@ -73,6 +95,7 @@ public:
     NdaVariant modulo(const NdaVariant &other, bool *ok= nullptr) const;
     NdaVariant multiply(const NdaVariant &other, bool *ok= nullptr) const;
     NdaVariant division(const NdaVariant &other, bool &dbz, bool *ok= nullptr) const;
+    NdaVariant power(const NdaVariant &exponent, bool *ok= nullptr) const; // BigNatural base
 
     NdaVariant unaryOperator(const std::string &op, bool *ok = nullptr) const;
     int        lengthOperator() const;
@@ -87,6 +110,7 @@ public:
     int               indexInList(const NdaVariant &value) const;
     bool              containsInList(const NdaVariant &value) const;
     void              reverseList();
+    NdaVariant        flippedList() const;       // zero-copy view, materialized on write
     void              clearList();
 
     // Bytes interface
@@ -94,6 +118,7 @@ public:
     bool              appendToBytes(const NdaVariant &value);
     NdaVariant&       writeBytesAccess(int index);
     const NdaVariant& readBytesAccess(int index) const;
+    NdaVariant        midBytes(int64_t pos, int64_t count) const; // zero-copy view
     void              clearBytes();
 
     // Dict interface
@@ -101,11 +126,58 @@ public:
     void              appendToDict(const NdaVariant &key, const NdaVariant &value);
     bool              contains(const NdaVariant&) const;
     NdaVariant&       writeDictAccess(const NdaVariant &key);
-    std::vector<std::pair<NdaVariant, NdaVariant>> dictItems() const;
+    std::vector<std::pair<NdaVariant, NdaVariant>> dictItems() const; // copies every item
     void              takeFromDict(const NdaVariant&);
 
+    // borrowed key/value, only valid inside the visitor; return false to stop
+    using DictVisitor = std::function<bool(const NdaVariant &key, const NdaVariant &value)>;
+    bool              forEachDictItem(const DictVisitor &visitor) const; // false: modified while iterating
+
+    // Record interface: fields by index, see RuntimeType::fieldIndex()
+    inline int        recordSize() const { return lengthOperator(); }
+    NdaVariant&       writeFieldAccess(int index);
+    const NdaVariant& readFieldAccess(int index) const;
+    int               fieldIndex(const std::string &name) const; // -1: no such field
+
+    // Array interface: index range is runtimeType()->first .. runtimeType()->last
+    inline int        arraySize() const { return lengthOperator(); }
+    NdaVariant        readArrayElement(int64_t index) const;
+    bool              writeArrayElement(int64_t index, const NdaVariant &value); // false: incompatible value
+
+    // Set interface: elements must be hashable, see isHashable()
+    inline int        setSize() const { return lengthOperator(); }
+    bool              insertIntoSet(const NdaVariant &value);        // false: not hashable
+    bool              removeFromSet(const NdaVariant &value);        // false: not an element
+    bool              containsInSet(const NdaVariant &value) const;
+    std::vector<NdaVariant> setItems() const;                        // sorted
+    NdaVariant        setUnion(const NdaVariant &other, bool *ok = nullptr) const;
+    NdaVariant        setIntersection(const NdaVariant &other, bool *ok = nullptr) const;
+    NdaVariant        setDifference(const NdaVariant &other, bool *ok = nullptr) const;
+    void              clearSet();
+
+    bool              isHashable() const;  // scalars and strings
+
+    // Deque interface
+    inline int        dequeSize() const { return lengthOperator(); }
+    void              pushToDeque(const NdaVariant &value, bool front);
+    bool              popFromDeque(NdaVariant &value, bool front);       // false: empty
+    bool              peekDeque(NdaVariant &value, bool front) const;    // false: empty
+    std::vector<NdaVariant> dequeItems() const;                          // front to back
+    void              clearDeque();
+
+    // PriorityQueue interface: lowest priority first, FIFO on equal priorities
+    inline int        queueSize() const { return lengthOperator(); }
+    void              pushToQueue(const NdaVariant &value, const NdaVariant &priority);
+    bool              popFromQueue(NdaVariant &value);                   // false: empty
+    bool              peekQueue(NdaVariant &value) const;                // false: empty
+    std::vector<NdaVariant> queueItems() const;                          // in pop order
+    void              clearQueue();
+    size_t            hash() const;        // equal() values have the same hash
+
     // generic string interface
     bool        setString(const std::string &newValue);
+    bool        appendToString(const NdaVariant &value); // in-place, if not shared
+    NdaVariant  midString(int64_t pos, int64_t count) const; // zero-copy view for long strings
     std::string toString() const;
     Nda::Type   type() const;
 
@@ -115,29 +187,55 @@ public:
 
     NdaVariant& operator=(const NdaVariant&other);
 
+    NDA_POOL_ALLOCATED // symbol values, runnable caches
+
     void dereference();
 
     // Unit-Test only
     int         refCount() const;
+    bool        isInlineString() const;
+    bool        isView() const;
+    int         referenceDepth() const;
+
+    static const int InlineStringSize = 7; // Strings up to 7 bytes don't need a SharedString
 
     static Nda::Type numericType(const std::string &literal);
     static bool fromNumber(const std::string &value, int64_t &ret);
 
 private:
+    friend class Nda::CycleCollector;
+
     void assignOther(const NdaVariant &other);     // C++ Operator
     void assignAny(const NdaVariant &other);       // NeoAdas Any := ...
     void assignOtherString(const NdaVariant &other);
     void assignOtherList(const NdaVariant &other);
     void assignOtherBytes(const NdaVariant &other);
     void assignOtherDict(const NdaVariant &other);
+    void assignOtherRecord(const NdaVariant &other);
+    void assignOtherArray(const NdaVariant &other);
+    void assignOtherSet(const NdaVariant &other);
+    bool assignListToSet(const NdaVariant &list);
+    void assignOtherDeque(const NdaVariant &other);
+    void assignListToDeque(const NdaVariant &list);
+    void assignOtherQueue(const NdaVariant &other);
+    void assignListToQueue(const NdaVariant &list);
+    void assignOtherBigNatural(const NdaVariant &other);
+    bool assignListToArray(const NdaVariant &list);
     NdaVariant doubleAddition(const NdaVariant &other, bool *ok= nullptr) const;
     NdaVariant doubleSubtraction(const NdaVariant &other, bool *ok= nullptr) const;
     NdaVariant doubleDivision(const NdaVariant &other, bool &dbz, bool *ok= nullptr) const;
     NdaVariant doubleMultiply(const NdaVariant &other, bool *ok= nullptr) const;
+    NdaVariant bigNaturalArithmetic(char op, const NdaVariant &other, bool &dbz, bool *ok= nullptr) const;
+    double     bigNaturalSpaceship(const NdaVariant &other, bool *ok = nullptr) const;
+    double     numberSpaceship(const NdaVariant &other, bool *ok = nullptr) const;
 
     // Helper unterschiedlicher Datentypen
     Nda::SharedString       *internalString();
     const Nda::SharedString *cInternalString() const;
+    inline bool              hasInlineString() const { return mValue.uChars[NDA_SSO_TAG_BYTE] & 0x01; }
+    inline bool              hasSharedString() const { return mValue.uPtr && !hasInlineString(); }
+    void                     setInlineString(const char *data, size_t length);
+    const char              *cStringData(size_t &length) const;
     NdaVariant               *internalReference();
     const NdaVariant         *cInternalReference() const;
 
@@ -153,6 +251,30 @@ private:
     const Nda::SharedDict   *cInternalDict() const;
     void                     detachDict();
 
+    Nda::SharedRecord       *internalRecord();
+    const Nda::SharedRecord *cInternalRecord() const;
+    void                     detachRecord();
+
+    Nda::SharedArray        *internalArray();
+    const Nda::SharedArray  *cInternalArray() const;
+    void                     detachArray();
+
+    Nda::SharedSet          *internalSet();
+    const Nda::SharedSet    *cInternalSet() const;
+    void                     detachSet();
+
+    Nda::SharedDeque         *internalDeque();
+    const Nda::SharedDeque   *cInternalDeque() const;
+    void                      detachDeque();
+
+    Nda::SharedPriorityQueue       *internalQueue();
+    const Nda::SharedPriorityQueue *cInternalQueue() const;
+    void                            detachQueue();
+
+    const Nda::SharedBigNatural *cInternalBigNatural() const;
+    const std::vector<uint32_t> *bigNaturalDigits(std::vector<uint32_t> &buffer) const; // borrowed or converted into buffer, nullptr: no natural number
+    void                     fromBigNaturalDigits(const Nda::RuntimeType *type, std::vector<uint32_t> &&digits);
+
     Nda::SharedData         *internalSharedObject();
 
     bool exact32BitInt(int &value) const;
@@ -166,12 +288,14 @@ private:
         int64_t       uInt64;
         uint64_t      uUInt64;
         void         *uPtr;
+        unsigned char uChars[8]; // Inline String: [Tag: (length << 1) | 1][up to 7 Bytes]
     };
 
     UValue mValue;
 
-    inline UValue       *uValue()        { return (myType() == Nda::Reference) ?  internalReference()->uValue()  : &mValue; }
-    inline const UValue *cuValue() const { return (myType() == Nda::Reference) ? cInternalReference()->cuValue() : &mValue; }
+    // References always point to the final storage (see fromReference) -> one indirection
+    inline UValue       *uValue()        { return (myType() == Nda::Reference) ?  &internalReference()->mValue  : &mValue; }
+    inline const UValue *cuValue() const { return (myType() == Nda::Reference) ? &cInternalReference()->mValue : &mValue; }
 
 };
 
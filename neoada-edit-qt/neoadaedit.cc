@@ -39,6 +39,7 @@
 #include "scenarios/asteroiddefensescenario.h"
 #include "scenarios/marsroverscenario.h"
 #include "scenarios/rocketscenario.h"
+#include <document.h>
 #include <state.h>
 #include <runtime.h>
 
@@ -95,6 +96,7 @@ NeoAdaEdit::NeoAdaEdit(QWidget *parent)
     , ui(new Ui::NeoAdaEdit)
     , mHighlighter(nullptr)
     , mAda(*(new NdaRuntime()))
+    , mDocument(new NdaDocument())
     , mGuide(nullptr)
     , mMainSplitter(nullptr)
     , mActiveScenario(nullptr)
@@ -121,6 +123,7 @@ NeoAdaEdit::NeoAdaEdit(QWidget *parent)
     new QShortcut(QKeySequence::Open, this, SLOT(onOpen()));
     new QShortcut(QKeySequence::Save, this, SLOT(onSave()));
     new QShortcut(QKeySequence(Qt::Key_F5), this, SLOT(onPlay()));
+    new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_F5), this, SLOT(onReload()));
 
     if (ui->txtScript->toPlainText().isEmpty())
         setScriptText(defaultScript());
@@ -134,6 +137,7 @@ NeoAdaEdit::~NeoAdaEdit()
     qDeleteAll(mScenarios);
     mScenarios.clear();
     delete ui;
+    delete mDocument;
     delete &mAda;
 }
 
@@ -960,7 +964,7 @@ void NeoAdaEdit::onPlay()
 
     QElapsedTimer timer;
     timer.start();
-    auto ret = mAda.runScript(ui->txtScript->toPlainText().toStdString());
+    auto ret = mAda.runDocument(*mDocument, ui->txtScript->toPlainText().toStdString());
     const qint64 elapsed = timer.elapsed();
 
     QApplication::restoreOverrideCursor();
@@ -1000,6 +1004,21 @@ void NeoAdaEdit::onPlay()
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+void NeoAdaEdit::onReload()
+{
+    if (mRunning)
+        return;
+
+    if (!mAda.reloadFunctions(ui->txtScript->toPlainText().toStdString())) {
+        const QString message = QString::fromStdString(mAda.lastError());
+        appendOutputLine(ui->txtOutput, QString("Error: %1").arg(message), QColor("#b00020"));
+        return;
+    }
+
+    ui->txtOutput->appendPlainText(tr("Functions and procedures reloaded"));
+}
+
 //-------------------------------------------------------------------------------------------------
 void NeoAdaEdit::onStop()
 {
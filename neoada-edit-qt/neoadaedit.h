@@ -10,6 +10,7 @@ namespace Ui {
 class NeoAdaEdit;
 }
 
+class NdaDocument;
 class NdaRuntime;
 class NeoAdaHighlighter;
 class QComboBox;
@@ -42,6 +43,7 @@ private slots:
 
     // Script handling
     void onPlay();
+    void onReload();  // hot reload: functions and procedures of the script, the running scenario keeps its globals
     void onStop();
     void updateTitle();
 
@@ -59,6 +61,7 @@ private:
     QString            mCurrentFileName;
     NeoAdaHighlighter *mHighlighter;
     NdaRuntime         &mAda;
+    NdaDocument        *mDocument; // the script of the last run: just the edited statements are parsed again
     QVector<Example>    mExamples;
     QVector<AbstractScenario*> mScenarios;
     QTextBrowser       *mGuide;
@@ -49,7 +49,7 @@ NeoAdaHighlighter::NeoAdaHighlighter(QTextDocument* document)
 
     // ---------- Keywords ----------
     const QStringList keywords = {
-        "declare", "type", "is", "of", "list", "with", "volatile",
+        "declare", "type", "is", "of", "list", "with", "package", "volatile",
         "if", "then", "elsif", "else", "case", "end",
         "for", "in", "while", "loop",
         "procedure", "function", "return", "begin",
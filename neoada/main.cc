@@ -6,11 +6,60 @@
 #include <runtime.h>
 #include <neoadaapi.h>
 
+// neoada --compile script.ada [-o script.nac]
+static int compile(int argc, char* argv[]) {
+    std::string input, output;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+            output = argv[++i];
+        else if (input.empty())
+            input = arg;
+        else {
+            std::cerr << "Unbekanntes Argument: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (input.empty()) {
+        std::cerr << "Aufruf: neoada --compile script.ada [-o script.nac]\n";
+        return 1;
+    }
+    if (output.empty()) {
+        size_t dot = input.find_last_of('.');
+        size_t sep = input.find_last_of("/\\");
+        output = (dot != std::string::npos && (sep == std::string::npos || dot > sep) ? input.substr(0, dot) : input) + ".nac";
+    }
+
+    std::ifstream file(input, std::ios::in | std::ios::binary);
+    if (!file) {
+        std::cerr << "Fehler beim Öffnen der Datei: " << input << "\n";
+        return 1;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+
+    NdaRuntime  runTime;
+    std::string image;
+    if (!runTime.compileScript(buffer.str(), image))
+        return 1;
+
+    std::ofstream out(output, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out || !out.write(image.data(), image.size())) {
+        std::cerr << "Fehler beim Schreiben der Datei: " << output << "\n";
+        return 1;
+    }
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     std::string script;
     
+    if (argc >= 2 && std::string(argv[1]) == "--compile")
+        return compile(argc, argv);
+
     // Wenn ein Kommandozeilenargument übergeben wurde, dann versuchen wir,
-    // dieses als Dateinamen zu interpretieren und daraus zu lesen.
+    // dieses als Dateinamen zu interpretieren und daraus zu lesen
+    // (Quelltext oder mit --compile vorübersetztes Programm).
     // Ansonsten lesen wir von der Standardeingabe (stdin).
     if (argc == 2) {
         std::ifstream file(argv[1], std::ios::in | std::ios::binary);
@@ -39,14 +88,21 @@ int main(int argc, char* argv[]) {
     // std::cout << "Eingelesener Inhalt:\n" << script << "\n";
     
     NdaRuntime   runTime;
-
+    if (argc == 2) { // "with Utils;" -> utils.ada next to the script
+        std::string path = argv[1];
+        size_t sep = path.find_last_of("/\\");
+        runTime.setPackagePath({sep == std::string::npos ? std::string(".") : path.substr(0, sep)});
+    }
 
     runTime.state()->bindPrc("print",{{"message", "Any", Nda::InMode}}, [&](const Nda::FncValues& args) -> bool {
         std::cout << args.at("message").toString() << std::endl;
         return true;
     });
 
-    runTime.runScript(script);
+    if (NdaRuntime::isCompiled(script))
+        runTime.runCompiled(script);
+    else
+        runTime.runScript(script);
 
     return 0;
 }
@@ -14,6 +14,7 @@ private slots:
     void test_api_runtime_AdaDateTime_ChainedMethods();
     void test_api_runtime_AdaDateTime_SetDateTimeSecsTo();
     void test_api_runtime_AdaDateTime_Now();
+    void test_api_runtime_AdaDateTime_Fields();
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -150,6 +151,27 @@ void TstAdaDateTime::test_api_runtime_AdaDateTime_Now()
     QVERIFY(ret.toInt64() == 1);
 }
 
+//-------------------------------------------------------------------------------------------------
+void TstAdaDateTime::test_api_runtime_AdaDateTime_Fields()
+{
+    std::string script = R"(
+    with Ada.DateTime;
+
+    declare dt : DateTime := DateTime:fromString("2026-05-21 23:59:50", "yyyy-MM-dd HH:mm:ss");
+    declare d : Date;
+    d.Year  := dt.Year;
+    d.Month := dt.Month;
+    d.Day   := 1;
+
+    return d.toString("yyyy-MM-dd") & " " & dt.addSecs(15).Day & " " & dt.Second;
+    )";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QCOMPARE(ret.toString(), "2026-05-01 22 50");
+}
+
 static bool hasRequestedTest(const QMetaObject *metaObject, int argc, char **argv)
 {
     bool hasFilter = false;
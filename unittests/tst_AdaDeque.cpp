@@ -0,0 +1,114 @@
+#include <QtTest>
+#include <QString>
+
+#include <libneoada/runtime.h>
+
+class TstAdaDeque : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_api_runtime_AdaDeque_Basic();
+    void test_api_runtime_AdaDeque_CopyOnWrite();
+    void test_api_runtime_AdaDeque_Empty();
+};
+
+//-------------------------------------------------------------------------------------------------
+void TstAdaDeque::test_api_runtime_AdaDeque_Basic()
+{
+    std::string script = R"NEOADA(
+    with Ada.Deque;
+
+    declare d : Deque := [2, 3];
+    d.pushFront(1);
+    d.pushBack(4);
+
+    declare first : Natural := d.popFront();
+    declare last  : Natural := d.popBack();
+
+    if first = 1 and last = 4 and #d = 2 and d.length() = 2 and d.front() = 2 and d.back() = 3 and d.isEmpty() = false then
+        return 1;
+    end if;
+    return 0;
+    )NEOADA";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QVERIFY(ret.toInt64() == 1);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstAdaDeque::test_api_runtime_AdaDeque_CopyOnWrite()
+{
+    std::string script = R"NEOADA(
+    with Ada.Deque;
+
+    declare a : Deque := [1, 2, 3];
+    declare b : Deque := a;
+    b.popFront();
+    b.pushBack("x");
+
+    declare l : List := b.toList();
+    if #a = 3 and a.front() = 1 and #l = 3 and l[0] = 2 and l[2] = "x" and a <> b then
+        return 1;
+    end if;
+    return 0;
+    )NEOADA";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QVERIFY(ret.toInt64() == 1);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstAdaDeque::test_api_runtime_AdaDeque_Empty()
+{
+    std::string script = R"NEOADA(
+    with Ada.Deque;
+
+    declare d : Deque;
+    begin
+        d.popFront();
+    exception
+        when ConstraintError => return #d;
+    end;
+    return 42;
+    )NEOADA";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QVERIFY(ret.toInt64() == 0);
+}
+
+static bool hasRequestedTest(const QMetaObject *metaObject, int argc, char **argv)
+{
+    bool hasFilter = false;
+
+    for (int i = 1; i < argc; ++i) {
+        QString name = QString::fromLocal8Bit(argv[i]);
+        if (!name.startsWith(QStringLiteral("test_")))
+            continue;
+
+        hasFilter = true;
+        name = name.section(':', 0, 0);
+        const QByteArray signature = name.toLocal8Bit() + "()";
+        if (metaObject->indexOfSlot(signature.constData()) >= 0)
+            return true;
+    }
+
+    return !hasFilter;
+}
+
+int runAdaDequeTests(int argc, char **argv)
+{
+    TstAdaDeque tests;
+    if (!hasRequestedTest(tests.metaObject(), argc, argv))
+        return 0;
+
+    return QTest::qExec(&tests, argc, argv);
+}
+
+#include "tst_AdaDeque.moc"
@@ -13,7 +13,7 @@ private slots:
     void test_api_runtime_AdaIoFile_FileBytes_CreateReadAll();
     void test_api_runtime_AdaIoFile_TextFile_CreateReadAll();
     void test_api_runtime_AdaIoFile_TextFile_ExistsOpenRead();
-    void test_api_runtime_AdaIoFile_TextFile_DictMembers();
+    void test_api_runtime_AdaIoFile_TextFile_RecordFields();
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -84,20 +84,22 @@ void TstAdaIoFile::test_api_runtime_AdaIoFile_TextFile_ExistsOpenRead()
 }
 
 //-------------------------------------------------------------------------------------------------
-void TstAdaIoFile::test_api_runtime_AdaIoFile_TextFile_DictMembers()
+void TstAdaIoFile::test_api_runtime_AdaIoFile_TextFile_RecordFields()
 {
     std::string script = R"(
     with Ada.Io.File;
 
     declare f : TextFile := TextFile:create("/tmp/neoada_io_textfile_members.txt");
-    f{"encoding"} := "latin1";
-    return f{"__type"} & ":" & f{"mode"} & ":" & f{"encoding"};
+    f.Encoding := "latin1";
+    declare wasClosed : Boolean := f.Closed;
+    f.close();
+    return f.Mode & ":" & f.Encoding & ":" & wasClosed & ":" & f.Closed & ":" & f.Handle;
     )";
 
     NdaRuntime r;
     auto ret = r.runScript(script);
 
-    QVERIFY(ret.toString() == "TextFile:create:latin1");
+    QCOMPARE(ret.toString(), "create:latin1:false:true:0");
 }
 
 
@@ -9,6 +9,7 @@ class TstAdaJson : public QObject
 
 private slots:
     void test_api_runtime_AdaJson_StringifyParse();
+    void test_api_runtime_AdaJson_StringifyTypes();
     void test_api_runtime_AdaJson_TextFile();
 };
 
@@ -34,6 +35,39 @@ void TstAdaJson::test_api_runtime_AdaJson_StringifyParse()
     QVERIFY(ret.toInt64() == 1);
 }
 
+//-------------------------------------------------------------------------------------------------
+void TstAdaJson::test_api_runtime_AdaJson_StringifyTypes()
+{
+    std::string script = R"NEOADA(
+    with Ada.Json;
+    with Ada.DateTime;
+    with Ada.Set;
+    with Ada.Deque;
+
+    type Pair is record
+        name  : String;
+        count : Natural;
+    end record;
+    type Vec is array (1 .. 3) of Number;
+
+    declare p : Pair;
+    p.name  := "x";
+    p.count := 2;
+    declare v : Vec := [1, 2.5, 3];
+    declare s : Set := [3, 1, 2, 3];
+    declare d : Deque := [2, 3];
+    d.pushFront(1);
+
+    return Json:toString(Date:fromString("2026-05-21", "yyyy-MM-dd")) & "|" & Json:toString(p) & "|" &
+           Json:toString(v) & "|" & Json:toString(s) & "|" & Json:toString(d);
+    )NEOADA";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QCOMPARE(ret.toString(), std::string(R"({"Year":2026,"Month":5,"Day":21}|{"name":"x","count":2}|[1.0,2.5,3.0]|[1,2,3]|[1,2,3])"));
+}
+
 //-------------------------------------------------------------------------------------------------
 void TstAdaJson::test_api_runtime_AdaJson_TextFile()
 {
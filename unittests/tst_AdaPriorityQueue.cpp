@@ -0,0 +1,94 @@
+#include <QtTest>
+#include <QString>
+
+#include <libneoada/runtime.h>
+
+class TstAdaPriorityQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_api_runtime_AdaPriorityQueue_Basic();
+    void test_api_runtime_AdaPriorityQueue_ExplicitPriority();
+};
+
+//-------------------------------------------------------------------------------------------------
+void TstAdaPriorityQueue::test_api_runtime_AdaPriorityQueue_Basic()
+{
+    std::string script = R"NEOADA(
+    with Ada.PriorityQueue;
+
+    declare q : PriorityQueue := [5, 1, 4];
+    q.push(3);
+    q.push(2);
+
+    declare l : List := q.toList();
+    declare first : Natural := q.pop();
+    declare second : Natural := q.pop();
+
+    if first = 1 and second = 2 and q.peek() = 3 and #q = 3 and l[0] = 1 and l[4] = 5 then
+        return 1;
+    end if;
+    return 0;
+    )NEOADA";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QVERIFY(ret.toInt64() == 1);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstAdaPriorityQueue::test_api_runtime_AdaPriorityQueue_ExplicitPriority()
+{
+    std::string script = R"NEOADA(
+    with Ada.PriorityQueue;
+
+    declare q : PriorityQueue;
+    q.push("late", 30);
+    q.push("first", 10);
+    q.push("second", 10);
+    q.push("middle", 20);
+
+    declare order : String := "";
+    while q.isEmpty() = false loop
+        order := order & q.pop() & " ";
+    end loop;
+    return order;
+    )NEOADA";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QCOMPARE(ret.toString(), "first second middle late ");
+}
+
+static bool hasRequestedTest(const QMetaObject *metaObject, int argc, char **argv)
+{
+    bool hasFilter = false;
+
+    for (int i = 1; i < argc; ++i) {
+        QString name = QString::fromLocal8Bit(argv[i]);
+        if (!name.startsWith(QStringLiteral("test_")))
+            continue;
+
+        hasFilter = true;
+        name = name.section(':', 0, 0);
+        const QByteArray signature = name.toLocal8Bit() + "()";
+        if (metaObject->indexOfSlot(signature.constData()) >= 0)
+            return true;
+    }
+
+    return !hasFilter;
+}
+
+int runAdaPriorityQueueTests(int argc, char **argv)
+{
+    TstAdaPriorityQueue tests;
+    if (!hasRequestedTest(tests.metaObject(), argc, argv))
+        return 0;
+
+    return QTest::qExec(&tests, argc, argv);
+}
+
+#include "tst_AdaPriorityQueue.moc"
@@ -0,0 +1,118 @@
+#include <QtTest>
+#include <QString>
+
+#include <libneoada/runtime.h>
+
+class TstAdaSet : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_api_runtime_AdaSet_Basic();
+    void test_api_runtime_AdaSet_Operations();
+    void test_api_runtime_AdaSet_NotHashable();
+};
+
+//-------------------------------------------------------------------------------------------------
+void TstAdaSet::test_api_runtime_AdaSet_Basic()
+{
+    std::string script = R"NEOADA(
+    with Ada.Set;
+
+    declare s : Set := [3, 1, 2, 3];
+    s.add(4);
+    s.add(1.0);
+    s.add("four");
+    s.remove(3);
+    s.remove(42);
+
+    if s.length() = 4 and #s = 4 and s.contains(1) and s.contains("four") and (s.contains(3) = false) then
+        return 1;
+    end if;
+    return 0;
+    )NEOADA";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QVERIFY(ret.toInt64() == 1);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstAdaSet::test_api_runtime_AdaSet_Operations()
+{
+    std::string script = R"NEOADA(
+    with Ada.Set;
+
+    declare a : Set := [1, 2, 3, 4];
+    declare b : Set := [3, 4, 5];
+    declare u : Set := a.union(b);
+    declare i : Set := a.intersection(b);
+    declare d : Set := a.difference(b);
+    declare c : Set := a;
+    c.clear();
+
+    declare e : Set  := [4, 3];
+    declare l : List := u.toList();
+    if #u = 5 and #i = 2 and #d = 2 and d.contains(1) and (d.contains(3) = false) and #a = 4 and #c = 0 and l[0] = 1 and l[4] = 5 and i = e then
+        return 1;
+    end if;
+    return 0;
+    )NEOADA";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QVERIFY(ret.toInt64() == 1);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstAdaSet::test_api_runtime_AdaSet_NotHashable()
+{
+    std::string script = R"NEOADA(
+    with Ada.Set;
+
+    declare s : Set;
+    begin
+        s.add([1, 2]);
+    exception
+        when ConstraintError => return #s;
+    end;
+    return 42;
+    )NEOADA";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QVERIFY(ret.toInt64() == 0);
+}
+
+static bool hasRequestedTest(const QMetaObject *metaObject, int argc, char **argv)
+{
+    bool hasFilter = false;
+
+    for (int i = 1; i < argc; ++i) {
+        QString name = QString::fromLocal8Bit(argv[i]);
+        if (!name.startsWith(QStringLiteral("test_")))
+            continue;
+
+        hasFilter = true;
+        name = name.section(':', 0, 0);
+        const QByteArray signature = name.toLocal8Bit() + "()";
+        if (metaObject->indexOfSlot(signature.constData()) >= 0)
+            return true;
+    }
+
+    return !hasFilter;
+}
+
+int runAdaSetTests(int argc, char **argv)
+{
+    TstAdaSet tests;
+    if (!hasRequestedTest(tests.metaObject(), argc, argv))
+        return 0;
+
+    return QTest::qExec(&tests, argc, argv);
+}
+
+#include "tst_AdaSet.moc"
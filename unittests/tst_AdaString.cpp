@@ -35,6 +35,8 @@ private slots:
     void test_api_runtime_AdaString_ToBool();
     void test_api_runtime_AdaString_IsConversions();
     void test_api_runtime_AdaString_ConversionProgramError();
+    void test_api_runtime_AdaString_AppendAssignment();
+    void test_api_runtime_AdaString_StringBuilder();
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -601,6 +603,70 @@ void TstAdaString::test_api_runtime_AdaString_ConversionProgramError()
     QVERIFY(r.state()->unhandledException().empty());
 }
 
+//-------------------------------------------------------------------------------------------------
+void TstAdaString::test_api_runtime_AdaString_AppendAssignment()
+{
+    std::string script = R"(
+
+    declare s    : String := "";
+    declare copy : String;
+
+    for i in 1..20 loop
+        s := s & i;
+        if i = 10 then
+            copy := s;
+        end if;
+    end loop;
+
+    if copy <> "12345678910" then
+        return "copy modified: " & copy;
+    end if;
+
+    s := s & "x" & 42;
+
+    return s;
+    )";
+
+    NdaRuntime r;
+
+    auto ret = r.runScript(script);
+
+    QCOMPARE(ret.toString(), "1234567891011121314151617181920x42");
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstAdaString::test_api_runtime_AdaString_StringBuilder()
+{
+    std::string script = R"(
+
+    with Ada.String;
+
+    declare sb : StringBuilder;
+
+    for i in 1..5 loop
+        sb.append(i);
+        sb.append(",");
+    end loop;
+
+    if sb.length() <> 10 then
+        return "invalid length";
+    end if;
+
+    declare s : String := sb.toString();
+    sb.clear();
+    sb.append("x");
+
+    return s & sb.toString() & typeOf(s);
+    )";
+
+    NdaRuntime r;
+
+    auto ret = r.runScript(script);
+
+    QCOMPARE(ret.toString(), "1,2,3,4,5,xstring");
+}
+
+
 
 static bool hasRequestedTest(const QMetaObject *metaObject, int argc, char **argv)
 {
@@ -0,0 +1,467 @@
+#include <QtTest>
+#include <QString>
+
+#include <fstream>
+
+#include <libneoada/document.h>
+#include <libneoada/lexer.h>
+#include <libneoada/neoadaapi.h>
+#include <libneoada/parser.h>
+#include <libneoada/runtime.h>
+#include <libneoada/state.h>
+
+/*
+    Benchmarks: not part of the default test selection, run them explicitly:
+
+        unittests test_benchmark_StringConcat10MB
+*/
+
+class TstBenchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_benchmark_StringConcat10MB();
+    void test_benchmark_StringBuilder10MB();
+    void test_benchmark_NumberToStringAndBack1M();
+    void test_benchmark_Lexer8MB();
+    void test_benchmark_Parse4MB();
+    void test_benchmark_RunCompiled4MB();
+    void test_benchmark_CompiledExpression1M();
+    void test_benchmark_BatchExpression1M();
+    void test_benchmark_Package200Runtimes();
+    void test_benchmark_RunScripts32Units();
+    void test_benchmark_DocumentEdits10kLines();
+    void test_benchmark_HotReload100();
+    void test_benchmark_FreshRuntime1000();
+    void test_benchmark_BigNaturalFactorial100000();
+};
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_StringConcat10MB()
+{
+    std::string script = R"(
+
+    declare s : String;
+
+    for i in 1..1000000 loop
+        s := s & "0123456789";
+    end loop;
+
+    return #s;
+    )";
+
+    NdaRuntime r;
+    NdaVariant ret;
+
+    QBENCHMARK_ONCE {
+        ret = r.runScript(script);
+    }
+
+    QVERIFY(ret.toInt64() == 10000000);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_StringBuilder10MB()
+{
+    std::string script = R"(
+
+    with Ada.String;
+
+    declare sb : StringBuilder;
+
+    for i in 1..1000000 loop
+        sb.append("0123456789");
+    end loop;
+
+    return sb.length();
+    )";
+
+    NdaRuntime r;
+    NdaVariant ret;
+
+    QBENCHMARK_ONCE {
+        ret = r.runScript(script);
+    }
+
+    QVERIFY(ret.toInt64() == 10000000);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_NumberToStringAndBack1M()
+{
+    NdaState   state;
+    NdaVariant value, parsed;
+    int        roundTrips = 0;
+
+    QBENCHMARK_ONCE {
+        for (int i = 1; i <= 1000000; i++) {
+            value.fromNumber(state.numberType(), i / 7.0);
+            if (parsed.fromNumberLiteral(state.numberType(), value.toString()) && parsed.equal(value))
+                roundTrips++;
+        }
+    }
+
+    QCOMPARE(roundTrips, 1000000);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_Lexer8MB()
+{
+    const std::string block = R"(
+    -- generated block
+    declare Counter : Natural := 16#FF#;
+    declare Name    : String  := "Neo""Ada";
+    procedure Step(x : in out Number) is
+    begin
+        if x >= 1.5E+3 and not Done then
+            x := x * 2 + Counter mod 7;
+        elsif x <> 0 then
+            Name := Name & "x";
+        end if;
+    end Step;
+    )";
+
+    NdaLexer lexer;
+    int      tokensPerBlock = 0;
+    lexer.setScript(block);
+    while (lexer.nextToken())
+        tokensPerBlock++;
+
+    std::string script;
+    while (script.size() < 8 * 1024 * 1024)
+        script += block;
+    const int blocks = (int)(script.size() / block.size());
+
+    int tokens = 0;
+
+    QBENCHMARK_ONCE {
+        lexer.setScript(script.data(), script.size());
+        while (lexer.nextToken())
+            tokens++;
+    }
+
+    QCOMPARE(tokens, blocks * tokensPerBlock);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_Parse4MB()
+{
+    const std::string block = R"(
+    procedure Step(x : out Number) is
+    begin
+        declare a, b : Number := x * 2 + 1;
+        if a >= b and x <> 0 then
+            x := (a + b) mod 7;
+        else
+            x := [1, 2, 3][0] + {"k": 1}{"k"};
+        end if;
+    end Step;
+    )";
+
+    std::string script;
+    while (script.size() < 4 * 1024 * 1024)
+        script += block;
+    const int blocks = (int)(script.size() / block.size());
+
+    NdaLexer  lexer;
+    NdaParser parser(lexer);
+    NdaParser::AST ast;
+
+    QBENCHMARK_ONCE {
+        ast = parser.parse(script);
+    }
+
+    QCOMPARE((int)ast->children.size(), blocks);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_RunCompiled4MB()
+{
+    std::string script;
+    int blocks = 0;
+    while (script.size() < 4 * 1024 * 1024) {
+        const std::string name = "Step" + std::to_string(++blocks);
+        script += R"(
+    procedure )" + name + R"((x : out Natural) is
+    begin
+        declare a, b : Natural := x * 2 + 1;
+        if a >= b and x <> 0 then
+            x := (a + b) mod 7;
+        else
+            x := [1, 2, 3][0] + {"k": 1}{"k"};
+        end if;
+    end )" + name + ";\n";
+    }
+    script += "declare y : Natural := 1;\nStep1(y);\nreturn y;\n";
+
+    std::string image;
+    NdaRuntime compiler;
+    QVERIFY(compiler.compileScript(script, image));
+
+    // lexing, parsing and lowering are skipped, compare with runScript of the same source
+    NdaRuntime r;
+    NdaVariant ret;
+    QBENCHMARK_ONCE {
+        ret = r.runCompiled(image);
+    }
+
+    QVERIFY(!r.hasError());
+    QCOMPARE(ret.toInt64(), (int64_t)6);
+    QCOMPARE((int)r.globalFunctions().size() >= blocks, true);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_CompiledExpression1M()
+{
+    NdaState state;
+    state.define("price", "Number");
+    state.define("qty", "Natural");
+
+    auto rule = NeoAda::compile("return price * qty > 1000.0 and qty mod 2 = 0;", state);
+    QVERIFY(rule.isValid());
+
+    NdaVariant &price = state.valueRef("price");
+    NdaVariant &qty   = state.valueRef("qty");
+    int matches = 0;
+
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < 1000000; i++) {
+            price.fromNumber(state.numberType(), (i % 500) * 0.5);
+            qty.fromNatural(state.naturalType(), i % 20);
+            if (NeoAda::evaluate(rule, state).toBool())
+                matches++;
+        }
+    }
+
+    QVERIFY(matches > 0);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_BatchExpression1M()
+{
+    const size_t rows = 1000000;
+    std::vector<double>  price(rows);
+    std::vector<int64_t> qty(rows);
+    for (size_t i = 0; i < rows; i++) {
+        price[i] = (i % 500) * 0.5;
+        qty[i]   = i % 20;
+    }
+    const std::vector<NeoAda::Column> columns = {
+        NeoAda::Column("price", price.data()), NeoAda::Column("qty", qty.data())
+    };
+
+    NdaState state;
+    auto rule = NeoAda::compile("return price * qty > 1000.0 and qty mod 2 = 0;", state);
+    QVERIFY(rule.isValid());
+
+    NeoAda::ResultColumn result;
+    QBENCHMARK_ONCE {
+        QVERIFY(NeoAda::evaluateBatch(rule, state, columns, rows, result));
+    }
+
+    size_t matches = 0;
+    for (uint8_t b : result.booleans)
+        matches += b;
+    QVERIFY(matches > 0);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_Package200Runtimes()
+{
+    // ~5000 lines of library code, "with"ed by 200 runtimes
+    std::string library = "package NdaBenchLib is\n";
+    for (int i = 0; i < 700; i++) {
+        library += "    function Step" + std::to_string(i) + "(x : Natural) return Natural is\n"
+                   "    begin\n"
+                   "        return (x * 3 + " + std::to_string(i) + ") mod 1000;\n"
+                   "    end Step" + std::to_string(i) + ";\n"
+                   "\n";
+    }
+    library += "end NdaBenchLib;\n";
+    {
+        std::ofstream f("/tmp/ndabenchlib.ada", std::ios::out | std::ios::trunc);
+        f << library;
+    }
+
+    int64_t sum = 0;
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < 200; i++) {
+            NdaRuntime runtime;
+            runtime.setPackagePath({"/tmp"});
+            sum += runtime.runScript("with NdaBenchLib; return NdaBenchLib:Step699(NdaBenchLib:Step1(2));").toInt64();
+        }
+    }
+
+    std::remove("/tmp/ndabenchlib.ada");
+    QCOMPARE(sum, (int64_t)(200 * ((7 * 3 + 699) % 1000)));
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_RunScripts32Units()
+{
+    // cold start: 32 units of 200 functions, compiled on all cores
+    std::vector<std::string> units;
+    for (int u = 0; u < 32; u++) {
+        std::string unit;
+        for (int i = 0; i < 200; i++) {
+            const std::string name = "U" + std::to_string(u) + "Step" + std::to_string(i);
+            unit += "function " + name + "(x : Natural) return Natural is\n"
+                    "begin\n"
+                    "    return (x * 3 + " + std::to_string(i) + ") mod 1000;\n"
+                    "end " + name + ";\n";
+        }
+        units.push_back(unit);
+    }
+
+    NdaRuntime runtime;
+    QBENCHMARK_ONCE {
+        QVERIFY(runtime.runScripts(units));
+    }
+
+    QCOMPARE(runtime.runScript("return U31Step199(U0Step1(2));").toInt64(), (int64_t)((7 * 3 + 199) % 1000));
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_DocumentEdits10kLines()
+{
+    // editor session: 10000 lines, 200 edits of one function in the middle, each one run
+    std::string text;
+    for (int i = 0; i < 2500; i++) {
+        const std::string name = "Step" + std::to_string(i);
+        text += "function " + name + "(x : Natural) return Natural is\n"
+                "begin\n"
+                "    return (x * 3 + " + std::to_string(i) + ") mod 1000;\n"
+                "end " + name + ";\n";
+    }
+    const size_t edit = text.find("+ 1250)");
+
+    NdaDocument document;
+    NdaRuntime  runtime;
+    runtime.runDocument(document, text + "return Step1250(2);");
+
+    int64_t sum = 0;
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < 200; i++) {
+            text.replace(edit, 7, "+ " + std::to_string(1000 + i % 10) + ")");
+            runtime.reset(); // like NeoAdaEdit::onPlay()
+            sum += runtime.runDocument(document, text + "return Step1250(2);").toInt64();
+        }
+    }
+
+    QCOMPARE(document.statementCount(), 2501);
+    QVERIFY(!runtime.hasError());
+    QCOMPARE(sum, (int64_t)(200 * 6 + 20 * 45));
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_HotReload100()
+{
+    // simulation with an expensive start (1M steps into a global), its step procedure edited 100 times
+    const std::string simulation = R"(
+        declare position : Natural := 0;
+        declare speed    : Natural := 0;
+
+        procedure Step() is
+        begin
+            position := position + speed + 1;
+        end Step;
+
+        for i in 1 .. 1000000 loop
+            speed := (speed + i) mod 7;
+        end loop;
+    )";
+
+    NdaRuntime runtime;
+    runtime.runScript(simulation);
+
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < 100; i++) {
+            std::string edited = simulation;
+            edited.replace(edited.find("speed + 1"), 9, "speed + " + std::to_string(i % 3));
+            QVERIFY(runtime.reloadFunctions(edited));
+            runtime.invokePrc("Step");
+        }
+    }
+
+    QVERIFY(!runtime.hasError());
+    const int64_t speed = runtime.runScript("return speed;").toInt64();
+    QCOMPARE(runtime.runScript("return position;").toInt64(), 100 * speed + 33 * 1 + 33 * 2);
+}
+
+void TstBenchmarks::test_benchmark_FreshRuntime1000()
+{
+    // a new runtime per request, the addons of each "with" come from the shared builtin tables
+    const std::string request = R"(
+        with Ada.String;
+        with Ada.Math;
+        with Ada.List;
+        with Ada.Json;
+
+        declare s : String := "request";
+        return s.length() + Math:floor(Math:sqrt(16));
+    )";
+
+    int64_t sum = 0;
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < 1000; i++) {
+            NdaRuntime runtime;
+            sum += runtime.runScript(request).toInt64();
+        }
+    }
+
+    QCOMPARE(sum, (int64_t)1000 * 11);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstBenchmarks::test_benchmark_BigNaturalFactorial100000()
+{
+    // 100000! has 456574 decimal digits: converted to text and back
+    NdaRuntime runtime;
+    NdaVariant factorial = runtime.runScript(R"(
+        declare ret : BigNatural := 1;
+        for i in 2..100000 loop
+            ret := ret * i;
+        end loop;
+        return ret;
+    )");
+    QCOMPARE(factorial.type(), Nda::BigNatural);
+
+    std::string decimal;
+    NdaVariant parsed;
+    QBENCHMARK_ONCE {
+        decimal = factorial.toString();
+        QVERIFY(parsed.fromBigNaturalLiteral(runtime.state()->bigNaturalType(), decimal));
+    }
+
+    QCOMPARE(decimal.size(), (size_t)456574);
+    QCOMPARE(decimal.substr(0, 10), std::string("2824229407"));
+    QVERIFY(parsed.equal(factorial));
+}
+
+static bool hasRequestedTest(const QMetaObject *metaObject, int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        QString name = QString::fromLocal8Bit(argv[i]);
+        if (!name.startsWith(QStringLiteral("test_")))
+            continue;
+
+        name = name.section(':', 0, 0);
+        const QByteArray signature = name.toLocal8Bit() + "()";
+        if (metaObject->indexOfSlot(signature.constData()) >= 0)
+            return true;
+    }
+
+    return false; // benchmarks are opt-in
+}
+
+int runBenchmarkTests(int argc, char **argv)
+{
+    TstBenchmarks tests;
+    if (!hasRequestedTest(tests.metaObject(), argc, argv))
+        return 0;
+
+    return QTest::qExec(&tests, argc, argv);
+}
+
+#include "tst_Benchmarks.moc"
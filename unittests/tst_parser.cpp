@@ -6,7 +6,10 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <future>
+#include <thread>
 
+#include <libneoada/document.h>
 #include <libneoada/exception.h>
 #include <libneoada/lexer.h>
 #include <libneoada/parser.h>
@@ -15,6 +18,11 @@
 #include <libneoada/runtime.h>
 #include <libneoada/value.h>
 #include <libneoada/private/sharedstring.h>
+#include <libneoada/private/sharedarray.h>
+#include <libneoada/private/runnable.h>
+#include <libneoada/private/numberformat.h>
+#include <libneoada/private/packagecache.h>
+#include <libneoada/private/cyclecollector.h>
 
 
 // add necessary includes here
@@ -59,17 +67,38 @@ private slots:
     void test_core_NumericLiterals();
     void test_core_NumericValues();
     void test_core_NumericValues_Invalid();
+    void test_core_NumberFormat();
+    void test_core_AtomTable();
+    void test_core_RunnableArena();
+    void test_core_ASTArena();
+    void test_core_ProgramImage();
+    void test_core_Packages();
+    void test_core_RunScripts();
+    void test_core_Document();
+    void test_core_HotReload();
+    void test_core_SharedBuiltins();
     void test_core_VariantToString_Boolean();
     void test_core_VariantToString_Byte();
     void test_core_SharedString();
+    void test_core_InlineString();
+    void test_core_Views();
     void test_core_Assignment();
     void test_core_References();
+    void test_core_ReferenceChains();
     void test_core_List_COW();
     void test_core_List_REF();
     void test_core_List_Contains();
     void test_core_List_Concat();
 
     void test_core_Dict_COW();
+    void test_core_Dict_Iteration();
+    void test_core_Pool();
+    void test_core_CycleCollector();
+    void test_core_Record();
+    void test_core_Array();
+    void test_core_Set();
+    void test_core_Deque_PriorityQueue();
+    void test_core_BigNatural();
 
     void test_core_Value_CTor();
 
@@ -90,6 +119,7 @@ private slots:
     void test_lexer_Expression2();
     void test_lexer_HelloWorld();
     void test_lexer_HelloWorld2();
+    void test_lexer_KeywordsAndLookAhead();
 
     void test_parser_Declaration1();
     void test_parser_Declaration2();
@@ -103,6 +133,8 @@ private slots:
 
     void test_parser_With();
     void test_parser_Type();
+    void test_parser_Record();
+    void test_parser_Array();
     void test_parser_Exception();
     void test_parser_ExceptionReraise();
 
@@ -215,6 +247,15 @@ private slots:
     void test_interpreter_CustomType_Procedure();
     void test_interpreter_CustomType_Cast();
     void test_interpreter_CustomType_CastProgramError();
+    void test_interpreter_Record();
+    void test_interpreter_Record_Nested();
+    void test_interpreter_Record_TypeMismatch();
+    void test_interpreter_Array();
+    void test_interpreter_Array_Bounds();
+    void test_interpreter_Array_OutArgument();
+    void test_interpreter_Array_HoistedBounds();
+    void test_interpreter_ForLoop_Dict();
+    void test_interpreter_BigNatural();
 
     void test_interpreter_Volatile_CTor();
     void test_interpreter_Volatile_Read();
@@ -227,6 +268,11 @@ private slots:
 
     void test_interpreter_static_method();
 
+    void test_api_compile_Expression();
+    void test_api_compile_Cache();
+    void test_api_evaluateBatch_Columns();
+    void test_api_evaluateBatch_Fallback();
+
     void test_api_evaluate_Literals();
     void test_api_evaluate_TypeOf();
     void test_api_evaluate_Length();
@@ -376,36 +422,39 @@ TstParser::~TstParser() {}
 void TstParser::test_core_SharedString()
 {
     NdaState state;
-    // Test "Copy on Write"
+    // Test "Copy on Write". Short strings are stored inline -> use strings > NdaVariant::InlineStringSize
+    const std::string long1 = "Hello World 1";
+    const std::string long2 = "Hello World 2";
+
     NdaVariant s1;
 
     QCOMPARE(s1.refCount(), 0);
 
     s1.fromString(state.typeByName("string"),"");
-    QCOMPARE(s1.refCount(), 1);
+    QCOMPARE(s1.refCount(), 0);
     QCOMPARE(s1.toString(), "");
 
-    s1.fromString(state.typeByName("string"),"1");
+    s1.fromString(state.typeByName("string"),long1);
     QCOMPARE(s1.refCount(), 1);
-    QCOMPARE(s1.toString(), "1");
+    QCOMPARE(s1.toString(), long1);
 
     NdaVariant s2(s1);
     QCOMPARE(s1.refCount(), 2);
     QCOMPARE(s2.refCount(), 2);
-    QCOMPARE(s2.toString(), "1");
+    QCOMPARE(s2.toString(), long1);
 
     // same value -> don't change situation
-    s2.setString("1");
+    s2.setString(long1);
     QCOMPARE(s1.refCount(), 2);
     QCOMPARE(s2.refCount(), 2);
-    QCOMPARE(s2.toString(), "1");
+    QCOMPARE(s2.toString(), long1);
 
 
     // new value -> detach shared data
-    s2.setString("2");
+    s2.setString(long2);
     QCOMPARE(s1.refCount(), 1);
     QCOMPARE(s2.refCount(), 1);
-    QCOMPARE(s2.toString(), "2");
+    QCOMPARE(s2.toString(), long2);
 
     s1.setString("");
     QCOMPARE(s1.refCount(), 0);
@@ -415,7 +464,7 @@ void TstParser::test_core_SharedString()
     QCOMPARE(s1.refCount(), 0);
     QCOMPARE(s2.refCount(), 0);
 
-    s1.setString("1");
+    s1.setString(long1);
 
     {
         NdaVariant s3;
@@ -428,6 +477,151 @@ void TstParser::test_core_SharedString()
     }
     QCOMPARE(s1.refCount(), 1);
 }
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_InlineString()
+{
+    NdaState state;
+    QCOMPARE((int)sizeof(NdaVariant), 16);
+
+    NdaVariant s1;
+    s1.fromString(state.typeByName("string"),"1234567");
+    QVERIFY(s1.isInlineString());
+    QCOMPARE(s1.refCount(), 0);
+    QCOMPARE(s1.toString(), "1234567");
+    QCOMPARE(s1.lengthOperator(), 7);
+
+    NdaVariant s2(s1);
+    QVERIFY(s2.isInlineString());
+    QCOMPARE(s2.toString(), "1234567");
+    QVERIFY(s1.equal(s2));
+
+    // grow -> promoted to SharedString
+    s2.setString("12345678");
+    QVERIFY(!s2.isInlineString());
+    QCOMPARE(s2.refCount(), 1);
+    QCOMPARE(s2.toString(), "12345678");
+    QCOMPARE(s1.toString(), "1234567");
+    QVERIFY(s1.lessThen(s2));
+    QVERIFY(s2.greaterThen(s1));
+
+    // shrink -> inline again
+    s2.setString("abc");
+    QVERIFY(s2.isInlineString());
+    QCOMPARE(s2.toString(), "abc");
+    QVERIFY(s1.lessThen(s2));
+
+    // embedded zeros are part of the value
+    s2.setString(std::string("a\0b",3));
+    QCOMPARE(s2.lengthOperator(), 3);
+    QCOMPARE(s2.toString(), std::string("a\0b",3));
+
+    // references see the inline value
+    NdaVariant ref;
+    ref.fromReference(state.referenceType(), &s1);
+    QVERIFY(ref.isInlineString());
+    QCOMPARE(ref.toString(), "1234567");
+    QCOMPARE(ref.lengthOperator(), 7);
+
+    NdaVariant s3;
+    s3.fromString(state.typeByName("string"),"");
+    QVERIFY(s3.assign(ref));
+    QCOMPARE(s3.toString(), "1234567");
+
+    // concat results are inline or shared, depending on the length
+    auto c = s1.concat(s3);
+    QCOMPARE(c.toString(), "12345671234567");
+    QVERIFY(!c.isInlineString());
+    c = s2.concat(s2);
+    QVERIFY(c.isInlineString());
+    QCOMPARE(c.lengthOperator(), 6);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_Views()
+{
+    NdaState state;
+
+    // String views share the buffer of their source
+    NdaVariant s;
+    s.fromString(state.typeByName("string"),"abcdefghijklmnopqrstuvwxyz");
+    auto v1 = s.midString(2, 20);
+    QVERIFY(v1.isView());
+    QCOMPARE(s.refCount(), 2);
+    QCOMPARE(v1.toString(), "cdefghijklmnopqrstuv");
+    QCOMPARE(v1.lengthOperator(), 20);
+
+    auto v2 = v1.midString(1, 10); // view of a view -> view of the source
+    QVERIFY(v2.isView());
+    QCOMPARE(s.refCount(), 3);
+    QCOMPARE(v2.toString(), "defghijklm");
+
+    auto v3 = v1.midString(18, 100); // short results are inline
+    QVERIFY(v3.isInlineString());
+    QCOMPARE(v3.toString(), "uv");
+
+    QVERIFY(v1.appendToString(v3)); // write -> materialized
+    QVERIFY(!v1.isView());
+    QCOMPARE(v1.toString(), "cdefghijklmnopqrstuvuv");
+    QCOMPARE(v2.toString(), "defghijklm");
+    QCOMPARE(s.toString(), "abcdefghijklmnopqrstuvwxyz");
+    QCOMPARE(s.refCount(), 2);
+
+    v2.setString("another long string");
+    QCOMPARE(s.refCount(), 1);
+
+    // a view copied out by read access doesn't keep its source alive
+    auto *source = new Nda::SharedString("abcdefghijklmnopqrstuvwxyz");
+    auto *view   = new Nda::SharedString(source, 2, 20);
+    QCOMPARE(source->refCount(), 2);
+    QCOMPARE(static_cast<const Nda::SharedString*>(view)->cValue(), std::string("cdefghijklmnopqrstuv"));
+    QVERIFY(!view->isView());
+    QCOMPARE(source->refCount(), 1);
+    view->releaseRef();
+    source->releaseRef();
+
+    NdaVariant raw, byte;
+    raw.initType(state.bytesType());
+    for (int i = 0; i < 10; i++) {
+        byte.fromByte(state.typeByName("byte"), (unsigned char)i);
+        raw.appendToBytes(byte);
+    }
+    auto part = raw.midBytes(2, 5);
+    NdaVariant copy(part);             // shares the view
+    QCOMPARE(raw.refCount(), 2);
+    QVERIFY(copy.appendToBytes(byte)); // detach: copies the view out
+    QVERIFY(!part.isView());
+    QCOMPARE(raw.refCount(), 1);
+    QCOMPARE(part.toString(), "Bytes[2,3,4,5,6]");
+    QCOMPARE(copy.toString(), "Bytes[2,3,4,5,6,9]");
+
+    // Script level
+    NdaRuntime r;
+    auto ret = r.runScript(R"(
+        with Ada.String;
+        with Ada.List;
+        with Ada.Bytes;
+
+        declare text : String := "The quick brown fox jumps";
+        declare word : String := text.sliced(10, 9);
+        declare head : String := text.chopped(6);
+
+        declare raw : Bytes;
+        raw.append(1_b); raw.append(2_b); raw.append(3_b); raw.append(4_b); raw.append(5_b);
+        raw.append(6_b); raw.append(7_b); raw.append(8_b); raw.append(9_b); raw.append(10_b);
+        declare part : Bytes := raw.mid(2, 5);
+        part[0] := 42_b;
+
+        declare l : List := [1, 2, 3, 4];
+        declare f : List := l.flipped();
+        declare ff : List := f.flipped();
+        f.append(0);
+
+        return word & "|" & head & "|" & part & raw[2] & "|" & f & ff & l;
+    )");
+    QCOMPARE(ret.toString(), "brown fox|The quick brown fox|Bytes[42,4,5,6,7]3|[4,3,2,1,0][1,2,3,4][1,2,3,4]");
+}
+
 //-------------------------------------------------------------------------------------------------
 void TstParser::test_core_NumericLiterals()
 {
@@ -497,6 +691,614 @@ void TstParser::test_core_NumericValues_Invalid()
     QCOMPARE(v.type(), Nda::Undefined);
 }
 
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_NumberFormat()
+{
+    NdaState   state;
+    NdaVariant v;
+
+    // shortest text that parses back to the same value
+    const double values[] = { 1.0, 0.1, -2.5, 1e16, 1.5e-5, 123.456, 0.0001, 5e-324, 1.7976931348623157e308 };
+    const char  *texts[]  = { "1.0", "0.1", "-2.5", "1e+16", "1.5e-5", "123.456", "0.0001", "5e-324", "1.7976931348623157e+308" };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        v.fromNumber(state.numberType(), values[i]);
+        QCOMPARE(v.toString(), std::string(texts[i]));
+
+        double parsed;
+        QVERIFY(NdaNumberFormat::parseDouble(texts[i], parsed));
+        QCOMPARE(parsed, values[i]);
+    }
+
+    double parsed;
+    QVERIFY(NdaNumberFormat::parseDouble("0.30000000000000004441", parsed)); // > 19 digits
+    QVERIFY(parsed != 0.3);
+    QVERIFY(!NdaNumberFormat::parseDouble("12abc", parsed));
+    QVERIFY(!NdaNumberFormat::parseDouble("1e", parsed));
+    QVERIFY(!NdaNumberFormat::parseDouble(".", parsed));
+
+    // literals keep their exponent
+    QVERIFY(v.fromNumberLiteral(state.numberType(), "1.23e+10"));
+    QCOMPARE(v.toDouble(), 1.23e10);
+    QVERIFY(v.fromNumberLiteral(state.numberType(), "1_000.5_d"));
+    QCOMPARE(v.toDouble(), 1000.5);
+    QVERIFY(NdaVariant::numericType("1e3") == Nda::Number);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_AtomTable()
+{
+    NdaState state;
+    Nda::AtomTable &atoms = state.atoms();
+
+    // builtin names have fixed atoms
+    QCOMPARE(atoms.find("natural"), (Nda::Atom)Nda::NaturalAtom);
+    QCOMPARE(atoms.name(Nda::OthersAtom), std::string("others"));
+    QCOMPARE(atoms.find(""), (Nda::Atom)Nda::NoAtom);
+    QCOMPARE(state.typeByAtom(Nda::StringAtom), state.stringType());
+
+    const Nda::Atom counter = atoms.intern("counter");
+    QVERIFY(counter >= Nda::WellKnownAtomCount);
+    QCOMPARE(atoms.intern("counter"), counter);
+    QCOMPARE(atoms.find("unknownname"), (Nda::Atom)Nda::NoAtom);
+
+    // string and atom api address the same symbols
+    QVERIFY(state.define("Total", "Natural"));
+    const Nda::Atom total = atoms.find("total");
+    QVERIFY(total != Nda::NoAtom);
+    QVERIFY(!state.define(total, Nda::NaturalAtom)); // already defined
+    state.valueRef(total).fromNatural(state.naturalType(), 42);
+    QCOMPARE(state.value("total").toInt64(), (int64_t)42);
+
+    const auto *pointType = state.registerRecord("Point", {{"x","Number"},{"y","Number"}});
+    QVERIFY(pointType);
+    QCOMPARE(state.typeByAtom(atoms.find("point")), pointType);
+
+    // no program refers to the names: released by reset(), the numbers are reused
+    const int size = atoms.size();
+    state.reset();
+    QCOMPARE(atoms.find("counter"), (Nda::Atom)Nda::NoAtom);
+    QCOMPARE(atoms.find("natural"), (Nda::Atom)Nda::NaturalAtom);
+    QVERIFY(atoms.intern("other") < size);
+    QCOMPARE(atoms.size(), size);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_RunnableArena()
+{
+    NdaState state;
+    Nda::AtomTable &atoms = state.atoms();
+    Nda::RunnableArena arena;
+    const Nda::AtomString plus = arena.value(atoms, false, "+", "+");
+    const Nda::AtomString one  = arena.value(atoms, true, "1", "1");
+    QCOMPARE(&plus.lowerValue, &atoms.name(plus.atom));
+    QCOMPARE(arena.atoms().size(), (size_t)0); // recorded by create()
+
+    Nda::Runnable *op = arena.create(1, 3, 2, plus);
+    QVERIFY(op->children != nullptr);
+    QVERIFY(op->call == nullptr);
+    for (int i = 0; i < op->childrenCount; i++)
+        op->children[i] = arena.create(1, 1 + 4*i, 0, one);
+
+#ifndef NEOADA_NO_POOL
+    // siblings are next to each other
+    QVERIFY((char*)op->children[1] > (char*)op->children[0]);
+    QVERIFY((char*)op->children[1] - (char*)op->children[0] < 2 * (std::ptrdiff_t)sizeof(Nda::Runnable));
+#endif
+    QCOMPARE(op->children[1]->value.displayValue, std::string("1"));
+
+    NdaVariant value;
+    value.fromString(state.stringType(), std::string(100, 'x')); // shared, not inline
+    op->children[0]->variantCache = arena.createVariant(value);
+    QCOMPARE(arena.nodeCount(), 3);
+    QCOMPARE(arena.atoms().size(), (size_t)1);
+    QVERIFY(arena.memoryUsage() >= 3 * sizeof(Nda::Runnable));
+
+    arena.clear(); // releases the cached string
+    QCOMPARE(arena.nodeCount(), 0);
+    QCOMPARE(value.toString(), std::string(100, 'x'));
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_ASTArena()
+{
+    NdaLexer       lexer;
+    NdaParser      parser(lexer);
+    NdaState       state;
+    NdaInterpreter interpreter(&state);
+
+    // a failed parse releases its partial tree with the next parse
+    bool failed = false;
+    try {
+        parser.parse("declare x : Number := (1 + ;");
+    } catch (NdaException &) {
+        failed = true;
+    }
+    QVERIFY(failed);
+
+    auto ast = parser.parse(R"(
+        declare a, b : Number := 1 + 2;
+        function Add(x : Number; y : Number) return Number is
+        begin
+            return x + y;
+        end;
+        return Add(a, b);
+    )");
+    QVERIFY(ast);
+    QVERIFY(ast.nodeCount() > 20);
+    QVERIFY(ast.memoryUsage() >= ast.nodeCount() * sizeof(NdaParser::ASTNode));
+    QCOMPARE(ast->children.size(), (size_t)3);
+    QVERIFY(ast->children[0]->type == NdaParser::ASTNodeType::DeclarationGroup);
+    QVERIFY(ast->children[0]->children[1]->parent == ast->children[0]);
+    QVERIFY(ast->children.back()->type == NdaParser::ASTNodeType::Return);
+
+    NdaParser::AST moved = std::move(ast);
+    QVERIFY(!ast);
+    QCOMPARE(ast.nodeCount(), 0);
+
+    // functions keep the lowered Runnables only: the AST can go before the call
+    Nda::Runnable *program = interpreter.load(moved);
+    moved = NdaParser::AST();
+    QVERIFY(!moved);
+
+    QCOMPARE(interpreter.execute(program).toInt64(), (int64_t)6);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_ProgramImage()
+{
+    std::string script = R"(
+        type Vec is array (1 .. 4) of Number;
+        function Sum(v : Vec) return Number is
+        begin
+            declare s : Number := 0;
+            for i in v'Range loop
+                s := s + v[i];
+            end loop;
+            return s;
+        end;
+        declare v : Vec;
+        declare ok : Boolean := true;
+        for i in 1 .. 4 loop
+            v[i] := i * 1.5;
+        end loop;
+        if ok then
+            return "say """ & Sum(v) & """";
+        end if;
+        return "";
+    )";
+
+    NdaRuntime source;
+    std::string expected = source.runScript(script).toString();
+    QCOMPARE(expected, std::string("say \"15.0\""));
+
+    std::string image;
+    NdaRuntime compiler;
+    QVERIFY(compiler.compileScript(script, image));
+    QVERIFY(NdaRuntime::isCompiled(image));
+    QVERIFY(!NdaRuntime::isCompiled(script));
+    QVERIFY(NdaRuntime::isCompiledFrom(image, script));
+    QVERIFY(!NdaRuntime::isCompiledFrom(image, script + " "));
+
+    // the image runs in a fresh runtime, also again after a reset
+    NdaRuntime r;
+    QCOMPARE(r.runCompiled(image).toString(), expected);
+    r.reset();
+    QCOMPARE(r.runCompiled(image).toString(), expected);
+    QVERIFY(!r.hasError());
+
+    // truncated or damaged images are rejected, never executed
+    std::string broken[] = { image.substr(0, image.size() / 2), image, image, image.substr(0, 8) };
+    broken[1][4] ^= 0x01;                // format version
+    broken[2][image.size() - 5] ^= 0x40; // checksum
+    for (const std::string &b : broken) {
+        NdaException e;
+        r.runCompiled(b, &e);
+        QVERIFY(r.hasError());
+        QCOMPARE(e.code(), Nada::Error::InvalidProgramImage);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+static void writeFile(const std::string &fileName, const std::string &content)
+{
+    std::ofstream f(fileName, std::ios::out | std::ios::trunc);
+    f << content;
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_Packages()
+{
+    writeFile("/tmp/ndapkgcalc.ada", R"(
+        with Ada.String;
+
+        package NdaPkgCalc is
+            type Pair is record
+                a : Natural;
+                b : Natural;
+            end record;
+
+            function Twice(x : Natural) return Natural is
+            begin
+                return x * 2;
+            end Twice;
+
+            function Quad(x : Natural) return Natural is
+            begin
+                return NdaPkgCalc:Twice(NdaPkgCalc:Twice(x)); -- qualified inside the package, too
+            end Quad;
+
+            function Sum(p : Pair) return Natural is
+            begin
+                return p.a + p.b;
+            end Sum;
+
+            procedure Inc(x : out Natural) is
+            begin
+                x := x + 1;
+            end Inc;
+        end NdaPkgCalc;
+    )");
+
+    const std::string script = R"(
+        with NdaPkgCalc;
+        declare p : Pair;
+        p.a := 1;
+        p.b := NdaPkgCalc:Quad(5);
+        NdaPkgCalc:Inc(p.a);
+        return NdaPkgCalc:Sum(p) & " " & p.a & " " & String:format(7, "d2"); -- Ada.String, loaded by the package
+    )";
+
+    Nda::PackageCache::clear();
+
+    // parsed once, loaded by both runtimes
+    NdaRuntime first;
+    NdaRuntime second;
+    first.setPackagePath({"/tmp/neoada_missing_dir", "/tmp"});
+    second.setPackagePath({"/tmp"});
+    QCOMPARE(first.runScript(script).toString(), std::string("22 2 07"));
+    QCOMPARE(second.runScript(script).toString(), std::string("22 2 07"));
+    QCOMPARE(Nda::PackageCache::size(), (size_t)1);
+
+    second.reset();
+    QCOMPARE(second.packagePath().size(), (size_t)1);
+    QCOMPARE(second.runScript(script).toString(), std::string("22 2 07"));
+
+    // unknown packages are ignored like unknown addons, their subprograms are not
+    NdaException e;
+    NdaRuntime plain;
+    plain.runScript("with NdaPkgCalc; return NdaPkgCalc:Twice(1);", &e);
+    QCOMPARE(e.code(), Nada::Error::UnknownSymbol);
+
+    // a package file declares the package and nothing else
+    writeFile("/tmp/ndapkgcalc.ada", "package NdaPkgCalc is end NdaPkgCalc;\ndeclare x : Natural := 1;");
+    NdaRuntime third;
+    third.setPackagePath({"/tmp"});
+    third.runScript("with NdaPkgCalc;", &e);
+    QCOMPARE(e.code(), Nada::Error::InvalidPackage);
+
+    writeFile("/tmp/ndapkgcalc.ada", "package Other is end Other;");
+    third.runScript("with NdaPkgCalc;", &e);
+    QCOMPARE(e.code(), Nada::Error::InvalidPackage);
+
+    writeFile("/tmp/ndapkgcalc.ada", "package NdaPkgCalc is declare x : Natural; end NdaPkgCalc;");
+    third.runScript("with NdaPkgCalc;", &e);
+    QCOMPARE(e.code(), Nada::Error::InvalidStatement);
+
+    writeFile("/tmp/ndapkgcalc.ada", "package NdaPkgCalc is end Other;");
+    third.runScript("with NdaPkgCalc;", &e);
+    QCOMPARE(e.code(), Nada::Error::InvalidToken);
+
+    // changed files are compiled again, also for a runtime that failed to load them
+    writeFile("/tmp/ndapkgcalc.ada", R"(
+        package NdaPkgCalc is
+            function Twice(x : Natural) return Natural is
+            begin
+                return x + x + 1;
+            end Twice;
+        end NdaPkgCalc;
+    )");
+    QCOMPARE(third.runScript("with NdaPkgCalc; return NdaPkgCalc:Twice(1);").toInt64(), (int64_t)3);
+    QCOMPARE(Nda::PackageCache::size(), (size_t)1);
+
+    // packages may also be declared inline
+    NdaRuntime inline_;
+    QCOMPARE(inline_.runScript(R"(
+        package Geo is
+            function Area(w : Number; h : Number) return Number is
+            begin
+                return w * h;
+            end Area;
+        end Geo;
+        return Geo:Area(2.0, 3.5);
+    )").toString(), std::string("7.0"));
+
+    std::remove("/tmp/ndapkgcalc.ada");
+    Nda::PackageCache::clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_RunScripts()
+{
+    // every unit defines a function and appends to "order": the units run in the given order
+    std::vector<std::string> units = { "declare order : String := \"\";" };
+    for (int i = 0; i < 24; i++) {
+        units.push_back("function F" + std::to_string(i) + "() return Natural is\n"
+                        "begin\n"
+                        "    return " + std::to_string(i) + ";\n"
+                        "end F" + std::to_string(i) + ";\n"
+                        "order := order & \"" + std::to_string(i % 10) + "\";\n");
+    }
+
+    std::string sum = "return F0()";
+    for (int i = 1; i < 24; i++)
+        sum += " + F" + std::to_string(i) + "()";
+    sum += ";";
+
+    for (unsigned threads : {1u, 4u, 0u}) {
+        NdaRuntime runtime;
+        QVERIFY(runtime.runScripts(units, nullptr, threads));
+        QCOMPARE(runtime.runScript(sum).toInt64(), (int64_t)(23 * 24 / 2));
+        QCOMPARE(runtime.runScript("return order;").toString(), std::string("012345678901234567890123"));
+    }
+
+    // the first failing unit is reported, nothing runs
+    units[7]  = "declare x : Natural := (1 + ;";
+    units[12] = "if x then";
+    NdaException e;
+    NdaRuntime failing;
+    QVERIFY(!failing.runScripts(units, &e, 4));
+    QCOMPARE(e.code(), Nada::Error::InvalidToken);
+    QVERIFY(!failing.lastError().empty());
+    Nda::Symbol *symbol = nullptr;
+    QVERIFY(!failing.state()->find("order", &symbol));
+
+    // runtime errors stop the remaining units
+    units[7]  = "order := order & \"6\";";
+    units[12] = "order := order & missing;";
+    QVERIFY(!failing.runScripts(units, &e, 4));
+    QCOMPARE(e.code(), Nada::Error::UnknownSymbol);
+    QCOMPARE(failing.runScript("return order;").toString(), std::string("01234567890"));
+
+    // packages of the units are compiled by the workers
+    writeFile("/tmp/ndapkgunits.ada", R"(
+        package NdaPkgUnits is
+            function Hello() return String is
+            begin
+                return "hello";
+            end Hello;
+        end NdaPkgUnits;
+    )");
+    Nda::PackageCache::clear();
+    NdaRuntime packages;
+    packages.setPackagePath({"/tmp"});
+    QVERIFY(packages.runScripts({"with NdaPkgUnits; declare a : String := NdaPkgUnits:Hello();",
+                                 "with NdaPkgUnits; declare b : String := a & \" \" & NdaPkgUnits:Hello();"}, nullptr, 2));
+    QCOMPARE(Nda::PackageCache::size(), (size_t)1);
+    QCOMPARE(packages.runScript("return b;").toString(), std::string("hello hello"));
+
+    std::remove("/tmp/ndapkgunits.ada");
+    Nda::PackageCache::clear();
+}
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_Document()
+{
+    // result and error position of the document vs. the same text run in full
+    auto check = [](NdaDocument &document, const std::string &text) {
+        NdaException full;
+        NdaRuntime fullRuntime;
+        const std::string expected = fullRuntime.runScript(text, &full).toString();
+
+        NdaException e;
+        NdaRuntime runtime;
+        const std::string result = runtime.runDocument(document, text, &e).toString();
+        QCOMPARE(result, expected);
+        QCOMPARE(e.code(), full.code());
+        QCOMPARE(e.line(), full.line());
+        QCOMPARE(e.column(), full.column());
+        QCOMPARE(runtime.hasError(), fullRuntime.hasError());
+    };
+
+    const std::string head =
+        "function Twice(x : Natural) return Natural is\n"
+        "begin\n"
+        "    return x * 2;\n"
+        "end Twice;\n";
+    const std::string body =
+        "function Inc(x : Natural) return Natural is\n"
+        "begin\n"
+        "    return x + 1;\n"
+        "end Inc;\n"
+        "declare a : Natural := Twice(20); declare b : Natural := Inc(a);\n";
+    const std::string tail = "return a + b;\n";
+
+    NdaDocument document;
+    check(document, head + body + tail);
+    QCOMPARE(document.statementCount(), 5);
+    QCOMPARE(document.reparsedCount(), 5);
+
+    // one function changed: one statement parsed
+    std::string text = head;
+    text.replace(text.find("x * 2"), 5, "x * 3");
+    check(document, text + body + tail);
+    QCOMPARE(document.reparsedCount(), 1);
+    QCOMPARE(document.statementCount(), 5);
+
+    // lines inserted: the errors behind them are reported at their new place
+    check(document, text + body + "return a + missing;\n");
+    text.insert(text.find("begin"), "-- one\n-- two\n");
+    check(document, text + body + "return a + missing;\n");
+    QCOMPARE(document.reparsedCount(), 1);
+    check(document, text + body + tail);
+
+    // columns on the line of the change move as well
+    std::string moved = body;
+    moved.replace(moved.find("Twice(20)"), 9, "Twice(20000)");
+    check(document, text + moved + "return a + missing;\n");
+    moved.replace(moved.find("Inc(a)"), 6, "Inc(  a  ) + missing");
+    check(document, text + moved + "return a + missing;\n");
+    QCOMPARE(document.reparsedCount(), 1);
+
+    // a comment opened in front of a statement takes in the rest of the line
+    moved = body;
+    moved.replace(moved.find("declare b"), 0, "-- ");
+    check(document, text + moved + tail);
+    QCOMPARE(document.statementCount(), 4);
+
+    // statements added and removed at the end, nothing in front is parsed again
+    check(document, text + body + tail + "declare c : Natural := 7;\n");
+    check(document, text + body + tail);
+    QCOMPARE(document.statementCount(), 5);
+    QCOMPARE(document.reparsedCount(), 0);
+
+    // syntax errors: positions of a full parse, the document keeps the previous text
+    const std::string valid = text + body + tail;
+    std::string broken = valid;
+    broken.replace(broken.find("x + 1;"), 6, "x + ;");
+    check(document, broken);
+    QCOMPARE(document.text(), valid);
+    broken = valid;
+    broken.erase(broken.find("end Inc;") + 7, 1); // ";" of Inc
+    check(document, broken);
+    check(document, valid);
+
+    // the same state: only the changed statement is prepared again
+    const std::string steps =
+        "function Step(x : Natural) return Natural is\n"
+        "begin\n"
+        "    return x + 1;\n"
+        "end Step;\n";
+    NdaDocument session;
+    NdaRuntime runtime;
+    QCOMPARE(runtime.runDocument(session, steps + "return Step(10);").toInt64(), (int64_t)11);
+    QCOMPARE(runtime.runDocument(session, steps + "return Step(10) * 2;").toInt64(), (int64_t)22);
+    QCOMPARE(session.reparsedCount(), 1);
+    runtime.state()->reset(); // types released, restored by the next run
+    QCOMPARE(runtime.runDocument(session, steps + "return Step(20) * 2;").toInt64(), (int64_t)42);
+    runtime.reset();          // another state: all statements are prepared again
+    QCOMPARE(runtime.runDocument(session, steps + "return Step(20) * 2;").toInt64(), (int64_t)42);
+    QCOMPARE(session.reparsedCount(), 0);
+}
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_HotReload()
+{
+    // a simulation with state in globals, stepped from the host
+    const std::string simulation = R"(
+        type Rover is record
+            x : Natural;
+        end record;
+
+        declare rover : Rover;
+        declare steps : Natural := 0;
+
+        procedure Step() is
+        begin
+            rover.x := rover.x + 1;
+            steps   := steps + 1;
+        end Step;
+
+        function Rover:Position(self : Rover) return Natural is
+        begin
+            return self.x;
+        end Position;
+
+        rover.x := 0;
+    )";
+
+    NdaRuntime runtime;
+    runtime.runScript(simulation);
+    QVERIFY(!runtime.hasError());
+    for (int i = 0; i < 3; i++)
+        runtime.invokePrc("Step");
+
+    // the whole edited script: only the subprograms are bound again, the globals keep their values
+    std::string edited = simulation;
+    edited.replace(edited.find("rover.x + 1"), 11, "rover.x + 10");
+    edited.replace(edited.find("return self.x;"), 14, "return self.x * 2;");
+    edited += "function Speed() return Natural is begin return 10; end Speed;\n";
+    QVERIFY(runtime.reloadFunctions(edited));
+
+    runtime.invokePrc("Step");
+    QCOMPARE(runtime.runScript("return steps;").toInt64(), (int64_t)4);
+    QCOMPARE(runtime.runScript("return rover.x;").toInt64(), (int64_t)13);
+    QCOMPARE(runtime.runScript("return Rover:Position(rover);").toInt64(), (int64_t)26);
+    QCOMPARE(runtime.runScript("return Speed();").toInt64(), (int64_t)10);
+
+    // other parameter types: an overload next to the existing function
+    QVERIFY(runtime.reloadFunctions("function Speed(factor : Natural) return Natural is begin return 10 * factor; end Speed;"));
+    QCOMPARE(runtime.runScript("return Speed() + Speed(3);").toInt64(), (int64_t)40);
+
+    // syntax errors leave the bound subprograms alone
+    NdaException e;
+    QVERIFY(!runtime.reloadFunctions("procedure Step() is begin steps := ; end Step;", &e));
+    QCOMPARE(e.code(), Nada::Error::InvalidToken);
+    QVERIFY(runtime.hasError());
+    runtime.invokePrc("Step");
+    QCOMPARE(runtime.runScript("return steps;").toInt64(), (int64_t)5);
+
+    // a script run again binds its subprograms again: the last definition wins
+    NdaRuntime scripts;
+    const std::string step = "function Next(x : Natural) return Natural is begin return x + 1; end Next;\n";
+    QCOMPARE(scripts.runScript(step + "return Next(1);").toInt64(), (int64_t)2);
+    std::string changed = step;
+    changed.replace(changed.find("x + 1"), 5, "x + 2");
+    QCOMPARE(scripts.runScript(changed + "return Next(1);").toInt64(), (int64_t)3);
+    QCOMPARE(scripts.runScript("return Next(1);").toInt64(), (int64_t)3);
+
+    // replaced by a callback of the running body: its program is released after the call returns
+    NdaRuntime nested;
+    nested.state()->bindPrc("reload", {}, [&nested](const Nda::FncValues&) -> bool {
+        return nested.reloadFunctions("function Next(x : Natural) return Natural is begin return x + 5; end Next;");
+    });
+    QVERIFY(nested.reloadFunctions("function Next(x : Natural) return Natural is\n"
+                                   "begin\n"
+                                   "    reload();\n"
+                                   "    return x + 1;\n"
+                                   "end Next;\n"));
+    QCOMPARE(nested.runScript("return Next(1);").toInt64(), (int64_t)2);
+    QCOMPARE(nested.runScript("return Next(1);").toInt64(), (int64_t)6);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_SharedBuiltins()
+{
+    // builtin types and addon functions are shared by all states, the "with" clauses of a state decide what it sees
+    NdaRuntime math;
+    NdaRuntime plain;
+    QCOMPARE(math.state()->stringType(), plain.state()->stringType());
+    QCOMPARE(math.state()->atoms().find("sqrt"), plain.state()->atoms().find("sqrt"));
+
+    QCOMPARE(math.runScript("with Ada.Math; return Math:sqrt(16);").toDouble(), 4.0);
+    QVERIFY(!math.hasError());
+
+    NdaException e;
+    plain.runScript("return Math:sqrt(16);", &e);
+    QCOMPARE(e.code(), Nada::Error::UnknownSymbol);
+    QCOMPARE(plain.state()->typeByName("math"), nullptr);
+    QVERIFY(math.state()->typeByName("math") != nullptr);
+
+    // own definitions and host callbacks stay in their state
+    QVERIFY(math.runScript("function Half(x : Number) return Number is begin return x / 2; end Half; return Half(Math:sqrt(64));").toDouble() == 4.0);
+    NdaState *state = math.state();
+    QVERIFY(state->bindFnc("Answer", {}, [state](const Nda::FncValues &, NdaVariant &ret) -> bool {
+        ret.fromNatural(state->naturalType(), 42);
+        return true;
+    }));
+    QCOMPARE(math.runScript("return Answer();").toInt64(), 42);
+    plain.runScript("return Half(2.0);", &e);
+    QCOMPARE(e.code(), Nada::Error::UnknownFunctionCall);
+    plain.runScript("return Answer();", &e);
+    QCOMPARE(e.code(), Nada::Error::UnknownFunctionCall);
+
+    // a user type next to the builtin ones
+    QCOMPARE(plain.runScript("with Ada.String; type Name is String; declare n : Name := \"abc\"; declare s : String := \"xy\"; return n & s.length();").toString(), std::string("abc2"));
+
+    // reset: the addons are gone again
+    math.reset();
+    math.runScript("return Math:sqrt(16);", &e);
+    QCOMPARE(e.code(), Nada::Error::UnknownSymbol);
+}
+
 //-------------------------------------------------------------------------------------------------
 void TstParser::test_core_VariantToString_Boolean()
 {
@@ -575,6 +1377,54 @@ void TstParser::test_core_References()
     QCOMPARE(r2.toString(), v1.toString());
 }
 
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_ReferenceChains()
+{
+    NdaState   state;
+    NdaVariant v1;
+    v1.fromNatural(state.naturalType(), 42);
+
+    NdaVariant r1;
+    r1.fromReference(state.referenceType(),&v1);
+    QCOMPARE(r1.referenceDepth(), 1);
+
+    NdaVariant r2;
+    r2.fromReference(state.referenceType(),&r1); // collapsed: r2 -> v1
+    QCOMPARE(r2.referenceDepth(), 1);
+
+    NdaVariant r3;
+    r3.fromReference(state.referenceType(),&r2);
+    QCOMPARE(r3.referenceDepth(), 1);
+
+    r1.reset();                                  // r3 doesn't depend on r1/r2
+    QVERIFY(r3.assign(NdaVariant(v1)));
+    QVERIFY(r3.setNatural(43));
+    QCOMPARE(v1.toInt64(), 43);
+
+    NdaVariant copy(r3);
+    QCOMPARE(copy.referenceDepth(), 1);
+
+    // out-parameters of out-parameters
+    NdaRuntime r;
+    auto ret = r.runScript(R"(
+        procedure inner(x : out Natural) is
+        begin
+            x := x + 1;
+        end;
+
+        procedure outer(x : out Natural) is
+        begin
+            inner(x);
+            inner(x);
+        end;
+
+        declare n : Natural := 40;
+        outer(n);
+        return n;
+    )");
+    QCOMPARE(ret.toInt64(), 42);
+}
+
 //-------------------------------------------------------------------------------------------------
 void TstParser::test_core_List_COW()
 {
@@ -844,6 +1694,532 @@ void TstParser::test_core_Dict_COW()
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_Dict_Iteration()
+{
+    NdaState state;
+
+    NdaVariant d;
+    d.initType(state.dictType());
+    NdaVariant key, value;
+    for (int i = 0; i < 3; i++) {
+        key.fromNatural(state.naturalType(), i);
+        value.fromString(state.stringType(), "a long string value, not inlined " + std::to_string(i));
+        d.appendToDict(key, value);
+    }
+
+    // borrowed: neither the dict nor the values are copied
+    int count = 0;
+    QVERIFY(d.forEachDictItem([&](const NdaVariant &k, const NdaVariant &v) -> bool {
+        QCOMPARE(k.toInt64(), (int64_t)count);
+        QCOMPARE(v.refCount(), count == 2 ? 2 : 1);  // the last one is shared with "value"
+        count++;
+        return true;
+    }));
+    QCOMPARE(count, 3);
+    QCOMPARE(d.refCount(), 1);
+
+    // stop early
+    count = 0;
+    QVERIFY(d.forEachDictItem([&](const NdaVariant &, const NdaVariant &) -> bool { return ++count < 2; }));
+    QCOMPARE(count, 2);
+
+    // values can be written in place, the iteration doesn't count as a COW owner
+    NdaVariant ref;
+    ref.fromReference(state.referenceType(), &d);
+    count = 0;
+    QVERIFY(ref.forEachDictItem([&](const NdaVariant &k, const NdaVariant &v) -> bool {
+        d.writeDictAccess(k).fromNatural(state.naturalType(), 7);
+        QCOMPARE(v.toInt64(), (int64_t)7);                // borrowed, not a snapshot
+        return ++count;
+    }));
+    QCOMPARE(count, 3);
+    QCOMPARE(d.refCount(), 1);
+
+    // new keys stop the iteration
+    count = 0;
+    QVERIFY(!ref.forEachDictItem([&](const NdaVariant &, const NdaVariant &) -> bool {
+        key.fromNatural(state.naturalType(), 100 + count++);
+        d.appendToDict(key, value);
+        return true;
+    }));
+    QCOMPARE(count, 1);
+    QCOMPARE(d.dictSize(), 4);
+
+    // another owner of the storage: the variable detaches, the iteration goes on in the copy
+    NdaVariant other(d);
+    count = 0;
+    QVERIFY(ref.forEachDictItem([&](const NdaVariant &k, const NdaVariant &) -> bool {
+        d.writeDictAccess(k).fromNatural(state.naturalType(), 8);
+        return ++count;
+    }));
+    QCOMPARE(count, 4);
+    QCOMPARE(d.refCount(), 1);
+    QCOMPARE(other.refCount(), 1);
+    for (const auto &item : d.dictItems())
+        QCOMPARE(item.second.toInt64(), (int64_t)8);
+    QCOMPARE(other.dictItems().front().second.toInt64(), (int64_t)7);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_Pool()
+{
+    auto before = Nda::Pool::stats();
+    {
+        NdaRuntime r;
+        auto ret = r.runScript(R"(
+            declare l : List;
+            for i in 1..100 loop
+                declare s : String := "a long string value " & i;
+                l := [s, i];
+            end loop;
+            return #l;
+        )");
+        QCOMPARE(ret.toInt64(), 2);
+
+        auto during = r.allocationStats();
+        QVERIFY(during.allocations > before.allocations + 200);
+        if (Nda::Pool::enabled())
+            QVERIFY(during.reused > before.reused);
+    }
+    auto after = Nda::Pool::stats();
+    QCOMPARE(after.alive(), before.alive()); // no leaks
+
+    void *p1 = Nda::Pool::allocate(40);
+    Nda::Pool::deallocate(p1, 40);
+    void *p2 = Nda::Pool::allocate(33); // same size class
+    if (Nda::Pool::enabled())
+        QVERIFY(p1 == p2);
+    Nda::Pool::deallocate(p2, 33);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_Record()
+{
+    NdaState state;
+    const auto *pointType = state.registerRecord("Point", {{"X","number"},{"Y","number"},{"Tags","list"}});
+    QVERIFY(pointType);
+    QVERIFY(!state.registerRecord("Point", {}));                       // already defined
+    QVERIFY(!state.registerRecord("Broken", {{"X","unknown"}}));        // unknown field type
+    QVERIFY(!state.registerRecord("Twice", {{"X","number"},{"x","number"}}));
+
+    QCOMPARE(pointType->fieldIndex("y"), 1);
+    QCOMPARE(pointType->fieldIndex("z"), -1);
+
+    NdaVariant p;
+    p.initType(pointType);
+    QCOMPARE(p.recordSize(), 3);
+    QCOMPARE(p.fieldIndex("Tags"), 2);
+    QCOMPARE(p.readFieldAccess(0).type(), Nda::Number);
+    QCOMPARE(p.readFieldAccess(2).type(), Nda::List);
+
+    p.writeFieldAccess(0).fromNumber(state.numberType(), 1.0);
+    NdaVariant q(p);
+    QCOMPARE(p.refCount(), 2);
+    q.writeFieldAccess(0).fromNumber(state.numberType(), 2.0); // detach
+    QCOMPARE(p.refCount(), 1);
+    QCOMPARE(p.readFieldAccess(0).toDouble(), 1.0);
+    QCOMPARE(q.readFieldAccess(0).toDouble(), 2.0);
+    QVERIFY(!p.equal(q));
+    q.writeFieldAccess(0).fromNumber(state.numberType(), 1.0);
+    QVERIFY(!p.equal(q)); // lists have no "=" -> neither have records with list fields
+
+    const auto *sizeType = state.registerRecord("Size", {{"W","natural"},{"H","natural"}});
+    NdaVariant s1, s2;
+    s1.initType(sizeType);
+    s2.initType(sizeType);
+    QVERIFY(s1.equal(s2));
+    s2.writeFieldAccess(1).fromNatural(state.naturalType(), 5);
+    QVERIFY(!s1.equal(s2));
+    QCOMPARE(s2.toString(), "(W=>0,H=>5)");
+
+    NdaVariant l;
+    l.initType(state.listType());
+    QVERIFY(!l.assign(p));  // no implicit conversions
+    QVERIFY(!p.assign(l));
+
+    // records take part in cycle collection
+    auto before = Nda::Pool::stats();
+    {
+        NdaRuntime r;
+        r.setCycleCollection(true);
+        auto collected = r.collectCycles().collectedObjects;
+        r.runScript(R"(
+            type Node is record
+                Next : Any;
+            end record;
+
+            procedure leak() is
+                n : Node;
+            begin
+                n.Next := n;  -- self reference
+            end;
+
+            for i in 1..5 loop
+                leak();
+            end loop;
+            return 0;
+        )");
+        QCOMPARE(r.collectCycles().collectedObjects, collected + 5);
+        r.setCycleCollection(false);
+    }
+    QCOMPARE(Nda::Pool::stats().alive(), before.alive());
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_Array()
+{
+    NdaState state;
+    const auto *vecType = state.registerArray("Vec", 1, 3, "natural");
+    QVERIFY(vecType);
+    QVERIFY(!state.registerArray("Vec", 1, 3, "natural"));   // already defined
+    QVERIFY(!state.registerArray("Names", 1, 3, "string"));  // not a scalar
+    QVERIFY(!state.registerArray("Broken", 5, 1, "natural"));
+    QVERIFY(state.registerArray("Empty", 1, 0, "byte"));      // null range
+
+    NdaVariant v;
+    v.initType(vecType);
+    QCOMPARE(v.arraySize(), 3);
+    QCOMPARE(v.readArrayElement(1).type(), Nda::Natural);
+    QCOMPARE(v.toString(), "(0,0,0)");
+
+    NdaVariant n;
+    n.fromNatural(state.naturalType(), 7);
+    QVERIFY(v.writeArrayElement(3, n));
+    NdaVariant str;
+    str.fromString(state.stringType(), "x");
+    QVERIFY(!v.writeArrayElement(2, str));
+
+    NdaVariant w(v);
+    QCOMPARE(v.refCount(), 2);
+    QVERIFY(v.equal(w));
+    n.fromNatural(state.naturalType(), 8);
+    QVERIFY(w.writeArrayElement(3, n));                       // detach
+    QCOMPARE(v.refCount(), 1);
+    QCOMPARE(v.readArrayElement(3).toInt64(), 7);
+    QCOMPARE(w.readArrayElement(3).toInt64(), 8);
+    QVERIFY(!v.equal(w));
+
+    // contiguous storage: 8 bytes per Number instead of one NdaVariant per element
+    const auto *bigType = state.registerArray("Big", 0, 999, "number");
+    Nda::SharedArray storage(bigType);
+    QCOMPARE(storage.memoryUsage() - sizeof(Nda::SharedArray), 1000 * sizeof(double));
+
+    NdaVariant big;
+    big.initType(bigType);
+    QVERIFY(big.writeArrayElement(999, n));                   // Natural -> Number
+    QCOMPARE(big.readArrayElement(999).toDouble(), 8.0);
+
+    // aggregate from a list: all elements or nothing
+    NdaVariant l;
+    l.initType(state.listType());
+    l.appendToList(n);
+    QVERIFY(!v.assign(l));                                    // wrong length
+    l.appendToList(n);
+    l.appendToList(n);
+    QVERIFY(v.assign(l));
+    QCOMPARE(v.toString(), "(8,8,8)");
+    l.appendToList(str);
+    l.takeFromList(0);
+    QVERIFY(!v.assign(l));                                    // "x" is not a Natural
+    QCOMPARE(v.toString(), "(8,8,8)");
+    QVERIFY(!l.assign(v));                                    // no implicit conversion back
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_Set()
+{
+    NdaState state;
+
+    NdaVariant one, oneDouble, two, str, list;
+    one.fromNatural(state.naturalType(), 1);
+    oneDouble.fromNumber(state.numberType(), 1.0);
+    two.fromNatural(state.naturalType(), 2);
+    str.fromString(state.stringType(), "a long string beyond the small string buffer");
+    list.initType(state.listType());
+
+    // hash() must agree with equal(): 1 = 1.0
+    QVERIFY(one.equal(oneDouble));
+    QCOMPARE(one.hash(), oneDouble.hash());
+    QVERIFY(!list.isHashable());
+
+    // ... beyond 2**53 too: integers are compared with a Number exactly, not rounded to double
+    NdaVariant big, bigDouble, negative, negativeDouble;
+    big.fromNatural(state.naturalType(), (int64_t(1) << 53) + 1);
+    bigDouble.fromNumber(state.numberType(), 9007199254740992.0);
+    negative.fromNatural(state.naturalType(), -(int64_t(1) << 53) - 1);
+    negativeDouble.fromNumber(state.numberType(), -9007199254740992.0);
+    QVERIFY(!big.equal(bigDouble));
+    QVERIFY(bigDouble < big);
+    QVERIFY(!negative.equal(negativeDouble));
+    QVERIFY(negative < negativeDouble);
+
+    NdaVariant high, highSuper, highBig, highDouble;
+    high.fromNatural(state.naturalType(), INT64_MIN);
+    highDouble.fromNumber(state.numberType(), -9223372036854775808.0);
+    QVERIFY(high.equal(highDouble));
+    QCOMPARE(high.hash(), highDouble.hash());
+    highSuper.fromSNatural(state.typeByName("supernatural"), uint64_t(1) << 63);
+    highBig.fromBigNatural(state.bigNaturalType(), uint64_t(1) << 63);
+    highDouble.fromNumber(state.numberType(), 9223372036854775808.0);
+    QVERIFY(highSuper.equal(highDouble));
+    QVERIFY(highBig.equal(highDouble));
+    QCOMPARE(highSuper.hash(), highDouble.hash());
+    QCOMPARE(highBig.hash(), highDouble.hash());
+
+    NdaVariant s;
+    s.initType(state.setType());
+    QVERIFY(s.insertIntoSet(one));
+    QVERIFY(s.insertIntoSet(oneDouble));                      // duplicate
+    QVERIFY(s.insertIntoSet(two));
+    QVERIFY(s.insertIntoSet(str));
+    QVERIFY(!s.insertIntoSet(list));
+    QCOMPARE(s.setSize(), 3);
+    QVERIFY(s.containsInSet(oneDouble));
+    QVERIFY(!s.containsInSet(list));
+
+    NdaVariant t(s);
+    QCOMPARE(s.refCount(), 2);
+    QVERIFY(s.equal(t));
+    QVERIFY(t.removeFromSet(str));                            // detach
+    QCOMPARE(s.refCount(), 1);
+    QCOMPARE(s.setSize(), 3);
+    QCOMPARE(t.toString(), "Set{1,2}");
+    QVERIFY(!s.equal(t));
+
+    bool ok;
+    QCOMPARE(s.setIntersection(t, &ok).setSize(), 2);
+    QVERIFY(ok);
+    QCOMPARE(s.setDifference(t, &ok).setSize(), 1);
+    QCOMPARE(t.setUnion(s, &ok).setSize(), 3);
+    QCOMPARE(t.setSize(), 2);
+    s.setUnion(list, &ok);
+    QVERIFY(!ok);
+
+    // from a list: duplicates collapse, non-hashable elements fail
+    NdaVariant l;
+    l.initType(state.listType());
+    l.appendToList(two);
+    l.appendToList(two);
+    l.appendToList(one);
+    QVERIFY(t.assign(l));
+    QCOMPARE(t.toString(), "Set{1,2}");
+    l.appendToList(list);
+    QVERIFY(!t.assign(l));
+    QCOMPARE(t.setSize(), 2);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_Deque_PriorityQueue()
+{
+    NdaState state;
+
+    NdaVariant one, two, three;
+    one.fromNatural(state.naturalType(), 1);
+    two.fromNatural(state.naturalType(), 2);
+    three.fromNatural(state.naturalType(), 3);
+
+    NdaVariant d;
+    d.initType(state.dequeType());
+    d.pushToDeque(two, false);
+    d.pushToDeque(one, true);
+    d.pushToDeque(three, false);
+    QCOMPARE(d.toString(), "[1,2,3]");
+
+    NdaVariant e(d);
+    QCOMPARE(d.refCount(), 2);
+    NdaVariant value;
+    QVERIFY(e.popFromDeque(value, true));                     // detach
+    QCOMPARE(value.toInt64(), 1);
+    QCOMPARE(d.refCount(), 1);
+    QCOMPARE(d.dequeSize(), 3);
+    QCOMPARE(e.toString(), "[2,3]");
+    e.clearDeque();
+    QVERIFY(!e.popFromDeque(value, false));
+    QVERIFY(!e.peekDeque(value, true));
+
+    // equal priorities keep their insertion order
+    NdaVariant q;
+    q.initType(state.priorityQueueType());
+    NdaVariant a, b, c;
+    a.fromString(state.stringType(), "a");
+    b.fromString(state.stringType(), "b");
+    c.fromString(state.stringType(), "c");
+    q.pushToQueue(a, two);
+    q.pushToQueue(b, one);
+    q.pushToQueue(c, two);
+    QCOMPARE(q.toString(), "[b,a,c]");
+
+    NdaVariant r(q);
+    QVERIFY(r.popFromQueue(value));                           // detach
+    QCOMPARE(value.toString(), "b");
+    QCOMPARE(q.queueSize(), 3);
+    QVERIFY(r.peekQueue(value));
+    QCOMPARE(value.toString(), "a");
+
+    // both are containers: a list -> deque -> list cycle is collectable
+    {
+        NdaRuntime runtime;
+        runtime.setCycleCollection(true);
+        auto collected = runtime.collectCycles().collectedObjects;
+        {
+            NdaVariant l, m;
+            l.initType(state.listType());
+            l.appendToList(d);
+            l.writeListAccess(0).pushToDeque(l, false);
+            m.initType(state.listType());
+            m.appendToList(q);
+            m.writeListAccess(0).pushToQueue(m, one);
+        }
+        QCOMPARE(runtime.collectCycles().collectedObjects, collected + 4); // 2 * (list + container)
+        runtime.setCycleCollection(false);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_BigNatural()
+{
+    NdaState state;
+
+    // (10^600 - 1)^2 = 10^1200 - 2 * 10^600 + 1: 63 digits each -> Karatsuba
+    NdaVariant tenPow, one, nines;
+    QVERIFY(tenPow.fromBigNaturalLiteral(state.bigNaturalType(), "1" + std::string(600, '0')));
+    one.fromNatural(state.naturalType(), 1);
+    bool ok;
+    nines = tenPow.subtract(one, &ok);
+    QVERIFY(ok);
+    QCOMPARE(nines.toString(), std::string(600, '9'));
+
+    NdaVariant square = nines.multiply(nines, &ok);
+    QVERIFY(ok);
+    QCOMPARE(square.type(), Nda::BigNatural);
+    QCOMPARE(square.toString(), std::string(599, '9') + "8" + std::string(599, '0') + "1");
+
+    // thousands of digits: split by powers of 10^9 both ways, runs of zeros included
+    const std::string decimal = "7" + std::string(5000, '0') + "123456789" + std::string(3000, '0') + "1";
+    NdaVariant large;
+    QVERIFY(large.fromBigNaturalLiteral(state.bigNaturalType(), decimal));
+    QCOMPARE(large.toString(), decimal);
+
+    bool dbz;
+    QVERIFY(square.division(nines, dbz, &ok).equal(nines));
+    QCOMPARE(square.add(one).modulo(nines, &ok).toString(), "1");
+    QVERIFY(ok);
+
+    NdaVariant zero;
+    zero.fromBigNatural(state.bigNaturalType(), 0);
+    square.division(zero, dbz, &ok);
+    QVERIFY(!ok && dbz);
+    one.subtract(tenPow, &ok);                                // below zero
+    QVERIFY(!ok);
+
+    // mixed with the 64 bit types, immutable -> shared
+    NdaVariant big(tenPow), small, negative;
+    QCOMPARE(tenPow.refCount(), 2);
+    small.fromBigNatural(state.bigNaturalType(), 42);
+    negative.fromNatural(state.naturalType(), -1);
+    NdaVariant natural;
+    natural.fromNatural(state.naturalType(), 42);
+    QVERIFY(small.equal(natural));
+    QCOMPARE(small.hash(), natural.hash());
+    QVERIFY(tenPow.greaterThen(natural));
+    QVERIFY(negative.lessThen(small));
+    QCOMPARE(small.toInt64(&ok), 42);
+    QVERIFY(ok);
+    tenPow.toInt64(&ok);
+    QVERIFY(!ok);
+    QVERIFY(natural.assign(small));
+    QVERIFY(!natural.assign(tenPow));
+    QCOMPARE(natural.add(tenPow).type(), Nda::BigNatural);
+
+    QCOMPARE(small.power(natural, &ok).toString().size(), (size_t)69); // 42^42
+    QVERIFY(ok);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_core_CycleCollector()
+{
+    auto before = Nda::Pool::stats();
+    {
+        NdaRuntime r;
+        r.setCycleCollection(true);
+        r.collectCycles();
+
+        auto ret = r.runScript(R"(
+            declare keep : List := [[0]];
+            keep[0] := keep;                -- list contains itself, still in use
+
+            procedure leak() is
+                d : Dict := {"a": 1};
+                l : List := [[1], "a long string value"];
+            begin
+                d{"self"} := d;             -- self reference
+                l[0] := l;
+                d{"list"} := l;             -- dict -> list -> list
+            end;
+
+            for i in 1..10 loop
+                leak();
+            end loop;
+            return #keep;
+        )");
+        QCOMPARE(ret.toInt64(), 1);
+
+        auto first = r.collectCycles(1); // bounded: the first root, no more objects walked
+        auto stats = r.collectCycles(1);
+        QCOMPARE(stats.runs, first.runs + 1);
+        QVERIFY(stats.scanned >= 2);
+        QVERIFY(stats.visited > first.visited);
+        QVERIFY(stats.candidates > 0);          // left for the next calls
+
+        stats = r.collectCycles();
+        QCOMPARE(stats.candidates, (uint64_t)0);
+        QCOMPARE(stats.collectedObjects, (uint64_t)20); // 10 * (dict + list)
+        QVERIFY(stats.collectedBytes > 20 * sizeof(Nda::SharedData));
+
+        // "keep" must survive
+        ret = r.runScript(R"(
+            declare inner : List := keep[0];
+            return #inner;
+        )");
+        QCOMPARE(ret.toInt64(), 1);
+
+        r.runScript("keep := [1]; inner := [1];"); // last references to the remaining cycle
+        stats = r.collectCycles();
+        QCOMPARE(stats.collectedObjects, (uint64_t)21);
+        r.setCycleCollection(false);
+    }
+
+    auto after = Nda::Pool::stats();
+    QCOMPARE(after.alive(), before.alive());
+
+    // candidate of another thread, released on this one while that thread still collects
+    {
+        std::promise<NdaVariant> handOver;
+        std::promise<void>     released;
+        auto value = handOver.get_future();
+        uint64_t candidatesBefore = 0, candidatesAfter = 0;
+
+        std::thread worker([&]() {
+            NdaRuntime w;
+            w.setCycleCollection(true);
+            NdaVariant list = w.runScript("return [[1]];");
+            { NdaVariant copy(list); } // a released copy makes it a candidate
+            candidatesBefore = Nda::CycleCollector::stats().candidates;
+            handOver.set_value(std::move(list));
+            released.get_future().wait();
+            candidatesAfter = Nda::CycleCollector::collect().candidates;
+            Nda::CycleCollector::setTracking(false);
+        });
+
+        value.get(); // last reference, dies on this thread
+        released.set_value();
+        worker.join();
+        QVERIFY(candidatesBefore > 0);
+        QCOMPARE(candidatesAfter, (uint64_t)0);
+    }
+}
+
 //-------------------------------------------------------------------------------------------------
 void TstParser::test_core_Value_CTor()
 {
@@ -1157,6 +2533,42 @@ void TstParser::test_lexer_HelloWorld2()
     QVERIFY(results[9] == ";");
 }
 
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_lexer_KeywordsAndLookAhead()
+{
+    NdaLexer lexer;
+
+    // keywords case insensitive (canonical lowercase), identifiers keep their spelling
+    std::string script = "Declare PROCEDURES : Procedure; Elsif XORx TRUE";
+    lexer.setScript(script.data(), script.size());
+
+    QVERIFY(lexer.nextToken());
+    QVERIFY(lexer.token() == "declare");
+    QVERIFY(lexer.tokenType() == NdaLexer::TokenType::Keyword);
+    QVERIFY(lexer.token(1) == "PROCEDURES");
+    QVERIFY(lexer.tokenType(1) == NdaLexer::TokenType::Identifier);
+    QVERIFY(lexer.token(2) == ":");
+
+    QVERIFY(lexer.nextToken());
+    QVERIFY(lexer.nextToken());
+    QVERIFY(lexer.nextToken());
+    QVERIFY(lexer.token() == "procedure");
+    QVERIFY(lexer.tokenType() == NdaLexer::TokenType::Keyword);
+    QVERIFY(lexer.line() == 1);
+
+    QVERIFY(lexer.nextToken());
+    QVERIFY(lexer.nextToken());
+    QVERIFY(lexer.token() == "elsif");
+    QVERIFY(lexer.nextToken());
+    QVERIFY(lexer.token() == "XORx");
+    QVERIFY(lexer.tokenType() == NdaLexer::TokenType::Identifier);
+    QVERIFY(lexer.nextToken());
+    QVERIFY(lexer.token() == "true");
+    QVERIFY(lexer.tokenType() == NdaLexer::TokenType::BooleanLiteral);
+    QVERIFY(!lexer.nextToken());
+    QVERIFY(lexer.token().empty());
+}
+
 //-------------------------------------------------------------------------------------------------
 void TstParser::test_parser_Declaration1()
 {
@@ -1379,6 +2791,78 @@ Node(Program, "")
     QCOMPARE_TRIM(currentAST, expectedAST);
 }
 
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_parser_Record()
+{
+    std::string script = R"(
+        type Point is record
+            X, Y : Number;
+            Name : String;
+        end record;
+        p.X := p.Y;
+    )";
+
+    NdaLexer lexer;
+    NdaParser parser(lexer);
+    auto ast = parser.parse(script);
+
+    std::string expectedAST = R"(
+Node(Program, "")
+  Node(TypeDefinition, "Point")
+    Node(Identifier, "record")
+    Node(RecordField, "X")
+      Node(Identifier, "Number")
+    Node(RecordField, "Y")
+      Node(Identifier, "Number")
+    Node(RecordField, "Name")
+      Node(Identifier, "String")
+  Node(Assignment, ":=")
+    Node(FieldAccess, "X")
+      Node(Identifier, "p")
+    Node(FieldAccess, "Y")
+      Node(Identifier, "p")
+)";
+    std::string currentAST =  ast->serialize();
+    QCOMPARE_TRIM(currentAST, expectedAST);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_parser_Array()
+{
+    std::string script = R"(
+        type Vec is array (1 .. N) of Number;
+        for i in v'Range loop
+            v[i] := v'First;
+        end loop;
+    )";
+
+    NdaLexer lexer;
+    NdaParser parser(lexer);
+    auto ast = parser.parse(script);
+
+    std::string expectedAST = R"(
+Node(Program, "")
+  Node(TypeDefinition, "Vec")
+    Node(Identifier, "array")
+    Node(Range, "")
+      Node(Number, "1")
+      Node(Identifier, "N")
+    Node(Identifier, "Number")
+  Node(ForLoop, "i")
+    Node(Attribute, "Range")
+      Node(Identifier, "v")
+    Node(Block, "")
+      Node(Assignment, ":=")
+        Node(Unknown, "[")
+          Node(Identifier, "v")
+          Node(Identifier, "i")
+        Node(Attribute, "First")
+          Node(Identifier, "v")
+)";
+    std::string currentAST =  ast->serialize();
+    QCOMPARE_TRIM(currentAST, expectedAST);
+}
+
 //-------------------------------------------------------------------------------------------------
 void TstParser::test_parser_Exception()
 {
@@ -3842,6 +5326,377 @@ void TstParser::test_interpreter_CustomType_CastProgramError()
     QVERIFY(state.unhandledException() == "programerror");
 }
 
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_interpreter_Record()
+{
+    std::string script = R"(
+        type Point is record
+            X, Y : Number;
+            Name : String;
+        end record;
+
+        declare p : Point;
+        p.X    := 1.5;
+        p.Y    := 2;
+        p.Name := "p";
+
+        declare q : Point := p; -- copy on write
+        q.X := 10;
+
+        return p.X + q.X + p.Y;
+    )";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QCOMPARE(ret.toDouble(), 13.5);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_interpreter_Record_Nested()
+{
+    std::string script = R"(
+        type Point is record
+            X, Y : Natural;
+        end record;
+
+        type Line is record
+            A, B : Point;
+        end record;
+
+        declare p : Point;
+        p.X := 3;
+
+        declare l : Line;
+        l.A := p;
+        l.B.Y := 7;
+        p.X := 4;
+
+        return l & "|" & (l.A = p);
+    )";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QCOMPARE(ret.toString(), "(A=>(X=>3,Y=>0),B=>(X=>0,Y=>7))|false");
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_interpreter_Record_TypeMismatch()
+{
+    std::string script = R"(
+        type Point is record
+            X, Y : Natural;
+        end record;
+
+        type Size is record
+            X, Y : Natural;
+        end record;
+
+        declare p : Point;
+        declare s : Size;
+        p := s;
+    )";
+
+    NdaLexer       lexer;
+    NdaParser      parser(lexer);
+    NdaState       state;
+    NdaInterpreter interpreter(&state);
+
+    auto ast = parser.parse(script);
+    interpreter.execute(ast);
+
+    QVERIFY(state.unhandledException() == "programerror");
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_interpreter_Array()
+{
+    std::string script = R"(
+        declare n : Natural := 4;
+        type Signal is array (1 .. n) of Number;
+        type Kernel is array (-1 .. 1) of Number;
+        type Counts is array (0 .. 2) of Natural;
+
+        declare s : Signal := [1, 2, 3, 4];
+        declare k : Kernel;
+        k[-1] := 0.25;
+        k[0]  := 0.5;
+        k[1]  := 0.25;
+
+        declare f : Signal := s;  -- copy on write
+        for i in 2 .. s'Last - 1 loop
+            f[i] := 0;
+            for j in k'Range loop
+                f[i] := f[i] + k[j] * s[i + j];
+            end loop;
+        end loop;
+
+        declare sum : Number := 0;
+        for i in f'Range loop
+            sum := sum + f[i];
+        end loop;
+
+        declare v : Counts;
+        for i in v'Range loop
+            v[i] := i * i;
+        end loop;
+
+        return (sum = 10.0) & "|" & v & "|" & #f & "|" & k'First & "|" & k'Length;
+    )";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QCOMPARE(ret.toString(), "true|(0,1,4)|4|-1|3");
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_interpreter_Array_OutArgument()
+{
+    std::string script = R"(
+        type Small is array (0 .. 1) of Number;
+        procedure p(x : out Number) is
+        begin
+            x := x + 5;
+        end p;
+        function swap(a : out Number; b : out Number) return Number is
+        begin
+            declare t : Number := a;
+            a := b;
+            b := t;
+            return a;
+        end swap;
+        function keep(x : Number) return Number is
+        begin
+            x := 7;
+            return x;
+        end keep;
+
+        declare q : Small;
+        q[1] := 2;
+        p(q[0]);
+        declare r : Small := q;   -- copy on write
+        swap(r[0], r[1]);
+        keep(r[0]);
+        return q & "|" & r;
+    )";
+
+    NdaRuntime r;
+    auto ret = r.runScript(script);
+
+    QCOMPARE(ret.toString(), "(5.0,2.0)|(2.0,5.0)");
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_interpreter_Array_Bounds()
+{
+    const char *scripts[] = {
+        "type Vec is array (1 .. 3) of Natural; declare v : Vec; v[0] := 1;",
+        "type Vec is array (1 .. 3) of Natural; declare v : Vec; return v[4];",
+        // the loop variable is changed -> no hoisted check
+        "type Vec is array (1 .. 3) of Natural; declare v : Vec; for i in v'Range loop i := i + 2; v[i] := 1; end loop;",
+    };
+
+    for (const char *script : scripts) {
+        NdaLexer       lexer;
+        NdaParser      parser(lexer);
+        NdaState       state;
+        NdaInterpreter interpreter(&state);
+
+        auto ast = parser.parse(script);
+        interpreter.execute(ast);
+        QVERIFY(state.unhandledException() == "constrainterror");
+    }
+
+    NdaLexer       lexer;
+    NdaParser      parser(lexer);
+    NdaState       state;
+    NdaInterpreter interpreter(&state);
+
+    auto ast = parser.parse("type Vec is array (1 .. 3) of Byte; declare v : Vec; v[1] := 256;");
+    interpreter.execute(ast);
+    QVERIFY(state.unhandledException() == "programerror");
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_interpreter_Array_HoistedBounds()
+{
+    auto accessNodes = [](Nda::Runnable *root) {
+        std::vector<Nda::Runnable*> ret, pending = { root };
+        while (!pending.empty()) {
+            auto *r = pending.back();
+            pending.pop_back();
+            if (r->value.lowerValue == "[")
+                ret.push_back(r);
+            for (int i = 0; i < r->childrenCount; i++)
+                pending.push_back(r->children[i]);
+        }
+        return ret;
+    };
+
+    NdaLexer       lexer;
+    NdaParser      parser(lexer);
+    NdaState       state;
+    NdaInterpreter interpreter(&state);
+
+    auto ast = parser.parse(R"(
+        for i in v'Range loop
+            v[i] := v[i] * 2;
+        end loop;
+    )");
+    auto *runnable = interpreter.prepare(ast);
+    auto nodes = accessNodes(runnable);
+    QCOMPARE(nodes.size(), (size_t)2);
+    QVERIFY(nodes[0]->rangeLoop && nodes[1]->rangeLoop); // owned by the interpreter's arena
+
+    ast = parser.parse(R"(
+        for i in v'Range loop
+            inc(i);       -- may be an "out" parameter
+            v[i] := 0;
+        end loop;
+    )");
+    runnable = interpreter.prepare(ast);
+    nodes = accessNodes(runnable);
+    QCOMPARE(nodes.size(), (size_t)1);
+    QVERIFY(!nodes[0]->rangeLoop);
+
+    // dynamically scoped: a called procedure assigns the loop variable
+    NdaRuntime runtime;
+    runtime.runScript(R"(
+        type Vec is array (1 .. 3) of Natural;
+        declare A : Vec;
+        declare s : Natural := 0;
+        procedure bump() is begin i := 1000000; end;
+        for i in A'Range loop
+            bump();
+            s := s + A[i];
+        end loop;
+    )");
+    QVERIFY(runtime.state()->unhandledException() == "constrainterror");
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_interpreter_BigNatural()
+{
+    NdaLexer       lexer;
+    NdaParser      parser(lexer);
+    NdaState       state;
+    NdaInterpreter interpreter(&state);
+
+    auto ast = parser.parse(R"(
+        function factorial(n : Natural) return BigNatural is
+            ret : BigNatural := 1;
+        begin
+            for i in 2..n loop
+                ret := ret * i;
+            end loop;
+            return ret;
+        end;
+
+        declare two : BigNatural := 2;
+        declare huge : BigNatural := 340282366920938463463374607431768211456;  -- 2^128
+        declare ret : String := "";
+        ret := ret & factorial(30) & "|";
+        ret := ret & two ** 100 & "|";
+        ret := ret & (two ** 128 = huge) & "|";
+        ret := ret & huge / two ** 64 & "|";
+        ret := ret & factorial(25) mod 1000007;
+        return ret;
+    )");
+    auto ret = interpreter.execute(ast);
+    QCOMPARE(ret.toString(), "265252859812191058636308480000000|1267650600228229401496703205376|true|18446744073709551616|913534");
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_interpreter_ForLoop_Dict()
+{
+    {
+        NdaLexer       lexer;
+        NdaParser      parser(lexer);
+        NdaState       state;
+        NdaInterpreter interpreter(&state);
+
+        auto ast = parser.parse(R"(
+            declare d : Dict := {"a": 1, "b": 2, "c": 3, "skip": 100, "z": 1000};
+            declare m : Dict := {1: "one", "x": "ex"};  -- keys of different types
+            declare values : String := "";
+            declare keys : String := "";
+            declare sum : Natural := 0;
+            for k in d loop
+                if k = "skip" then
+                    continue;
+                end if;
+                if k = "z" then
+                    break;
+                end if;
+                keys := keys & k;
+                sum := sum + d{k};
+            end loop;
+            for k in m loop
+                values := values & m{k};
+                m{k} := "seen";                    -- values may change, keys may not
+            end loop;
+            return keys & "|" & sum & "|" & values;
+        )");
+        auto ret = interpreter.execute(ast);
+        QCOMPARE(ret.toString(), "abc|6|oneex");           // ordered by key
+    }
+
+    {
+        // modified while iterating
+        NdaLexer       lexer;
+        NdaParser      parser(lexer);
+        NdaState       state;
+        NdaInterpreter interpreter(&state);
+
+        auto ast = parser.parse(R"(
+            declare d : Dict := {"a": 1, "b": 2};
+            for k in d loop
+                d{"c"} := 3;
+            end loop;
+        )");
+        interpreter.execute(ast);
+        QVERIFY(state.unhandledException() == "programerror");
+    }
+
+    {
+        // a copy of the dict: writing a value detaches, the keys are the same
+        NdaRuntime r;
+        auto ret = r.runScript(R"(
+            declare d : Dict := {"a": 1, "b": 2, "c": 3};
+            declare e : Dict;
+            declare keys : String := "";
+            for k in d loop
+                e := d;
+                d{k} := 5;
+                keys := keys & k;
+            end loop;
+            return keys & "|" & d{"a"} & d{"b"} & d{"c"} & "|" & e{"c"};
+        )");
+        QCOMPARE(ret.toString(), "abc|555|3");
+        QVERIFY(r.state()->unhandledException().empty());
+
+        // keys changed in the copy
+        NdaRuntime changed;
+        changed.runScript(R"(
+            declare d : Dict := {"a": 1, "b": 2};
+            declare e : Dict;
+            for k in d loop
+                e := d;
+                d{k & "x"} := 5;
+            end loop;
+        )");
+        QVERIFY(changed.state()->unhandledException() == "programerror");
+    }
+
+    NdaRuntime r;
+    NdaException ex;
+    r.runScript("declare n : Natural := 3; for k in n loop end loop;", &ex);
+
+    QVERIFY(ex.code() == Nada::Error::InvalidContainerType);
+}
+
 //-------------------------------------------------------------------------------------------------
 void TstParser::test_interpreter_Volatile_CTor()
 {
@@ -4144,6 +5999,262 @@ void TstParser::test_interpreter_static_method()
     QVERIFY(ret.toString() == "10");
 }
 
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_api_compile_Expression()
+{
+    NdaState state;
+    QVERIFY(state.define("price", "Number"));
+    QVERIFY(state.define("qty", "Natural"));
+
+    auto rule = NeoAda::compile(R"(
+        declare total : Number := price * qty;
+        if total > 100.0 then
+            return "high";
+        end if;
+        return "low";
+    )", state);
+    QVERIFY(rule.isValid());
+
+    // bindings are updated by the host, the local "total" is declared again by every run
+    for (int i = 1; i <= 20; i++) {
+        state.valueRef("price").fromNumber(state.numberType(), 10.0);
+        state.valueRef("qty").fromNatural(state.naturalType(), i);
+        QCOMPARE(NeoAda::evaluate(rule, state).toString(), std::string(i * 10 > 100 ? "high" : "low"));
+    }
+    Nda::Symbol *symbol = nullptr;
+    QVERIFY(!state.find("total", &symbol));
+
+    // after a reset the bindings may be defined in another order
+    state.reset();
+    QVERIFY(state.define("qty", "Natural"));
+    QVERIFY(state.define("price", "Number"));
+    state.valueRef("price").fromNumber(state.numberType(), 50.5);
+    state.valueRef("qty").fromNatural(state.naturalType(), 2);
+    QCOMPARE(NeoAda::evaluate(rule, state).toString(), std::string("high"));
+
+    // a failed run leaves no scope behind
+    auto failing = NeoAda::compile("declare x : Natural := qty; return x + missing;", state);
+    QVERIFY(failing.isValid());
+    NdaException e;
+    for (int i = 0; i < 2; i++) {
+        NeoAda::evaluate(failing, state, &e);
+        QCOMPARE(e.code(), Nada::Error::UnknownSymbol);
+    }
+    QVERIFY(!state.find("x", &symbol));
+    QCOMPARE(NeoAda::evaluate(rule, state).toString(), std::string("high"));
+
+    // an exception raised by the script: no partial value
+    QVERIFY(state.define("divisor", "Number"));
+    auto raising = NeoAda::compile("return (1.0 - (((price / divisor) + 1.0) + 1.0));", state);
+    e = NdaException();
+    QCOMPARE(NeoAda::evaluate(raising, state, &e).type(), Nda::Undefined);
+    QCOMPARE(e.code(), Nada::Error::UnhandledException);
+    state.valueRef("divisor").fromNumber(state.numberType(), 0.5);
+    QCOMPARE(NeoAda::evaluate(raising, state, &e).toDouble(), -102.0);
+
+    // compile errors and foreign states
+    auto invalid = NeoAda::compile("return (1 + ;", state, &e);
+    QVERIFY(!invalid.isValid());
+    QCOMPARE(NeoAda::evaluate(invalid, state, &e).type(), Nda::Undefined);
+    QCOMPARE(e.code(), Nada::Error::InvalidExpression);
+
+    NdaState other;
+    NeoAda::evaluate(rule, other, &e);
+    QCOMPARE(e.code(), Nada::Error::InvalidExpression);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_api_compile_Cache()
+{
+    NeoAda::setCacheCapacity(0);
+    NeoAda::setCacheCapacity(2);
+    QCOMPARE(NeoAda::cacheSize(), (size_t)0);
+
+    {
+        NdaState state;
+        QCOMPARE(NeoAda::evaluate("declare a : Natural := 40; return a + 2;", state).toInt64(), (int64_t)42);
+        QCOMPARE(NeoAda::evaluate("declare a : Natural := 40; return a + 2;", state).toInt64(), (int64_t)42);
+        QCOMPARE(NeoAda::cacheSize(), (size_t)1);
+
+        // same source, another state: an entry of its own
+        NdaState other;
+        QCOMPARE(NeoAda::evaluate("declare a : Natural := 40; return a + 2;", other).toInt64(), (int64_t)42);
+        QCOMPARE(NeoAda::cacheSize(), (size_t)2);
+
+        QVERIFY(NeoAda::compile("return 1;", state).isValid()); // evicts the least recently used
+        QCOMPARE(NeoAda::cacheSize(), (size_t)2);
+    }
+
+    // cached programs of destroyed states are never reused
+    NdaState state;
+    auto expression = NeoAda::compile("return true;", state);
+    QVERIFY(expression.isValid());
+    QCOMPARE(NeoAda::evaluate("return 1;", state).toInt64(), (int64_t)1);
+    QCOMPARE(NeoAda::evaluate("declare a : Natural := 40; return a + 2;", state).toInt64(), (int64_t)42);
+
+    NeoAda::setCacheCapacity(0);
+    QCOMPARE(NeoAda::cacheSize(), (size_t)0);
+    QVERIFY(expression.isValid()); // handles own their program
+    QCOMPARE(NeoAda::evaluate(expression, state).toBool(), true);
+
+    // names of evicted programs are released by the next reset
+    NeoAda::setCacheCapacity(2);
+    NeoAda::evaluate("return 0;", state);
+    const int atoms = state.atoms().size();
+    for (int i = 0; i < 100; i++) {
+        const std::string name = "v" + std::to_string(i);
+        QCOMPARE(NeoAda::evaluate("declare " + name + " : Natural := " + std::to_string(i) + "; return " + name + " + 1;", state).toInt64(), (int64_t)i + 1);
+    }
+    QVERIFY(state.atoms().size() <= atoms + 3);
+
+    NeoAda::setCacheCapacity(64);
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_api_evaluateBatch_Columns()
+{
+    const size_t rows = 3000; // several chunks
+    std::vector<double>  price(rows);
+    std::vector<int64_t> qty(rows);
+    bool                 flag[rows];
+    std::string          chars;
+    std::vector<int64_t> offsets(1, 0);
+    static const char *const names[] = { "a", "b", "", "bb" };
+    for (size_t i = 0; i < rows; i++) {
+        price[i] = (i % 50) * 0.5;
+        qty[i]   = 1 + i % 13;
+        flag[i]  = i % 3 == 0;
+        chars   += names[i % 4];
+        offsets.push_back((int64_t)chars.size());
+    }
+    const std::vector<NeoAda::Column> columns = {
+        NeoAda::Column("Price", price.data()), NeoAda::Column("qty", qty.data()),
+        NeoAda::Column("flag", flag), NeoAda::Column("name", chars.data(), offsets.data())
+    };
+
+    NdaState state;
+    QVERIFY(state.define("rate", "Number"));
+    state.valueRef("rate").fromNumber(state.numberType(), 2.0);
+
+    NeoAda::ResultColumn result;
+    auto total = NeoAda::compile("return price * qty + rate;", state);
+    QVERIFY(NeoAda::evaluateBatch(total, state, columns, rows, result));
+    QCOMPARE(result.type, NeoAda::Column::Number);
+    QCOMPARE(result.size(), rows);
+    for (size_t i = 0; i < rows; i++)
+        QCOMPARE(result.numbers[i], price[i] * (double)qty[i] + 2.0);
+
+    auto natural = NeoAda::compile("return -(qty * 3 - 1) mod 5;", state);
+    QVERIFY(NeoAda::evaluateBatch(natural, state, columns, rows, result));
+    QCOMPARE(result.type, NeoAda::Column::Natural);
+    for (size_t i = 0; i < rows; i++)
+        QCOMPARE(result.naturals[i], -(qty[i] * 3 - 1) % 5);
+
+    auto rule = NeoAda::compile("return (price >= 10.0 and flag) or name = \"bb\" xor qty <> 7;", state);
+    QVERIFY(NeoAda::evaluateBatch(rule, state, columns, rows, result));
+    QCOMPARE(result.type, NeoAda::Column::Boolean);
+    QCOMPARE(result.size(), rows);
+    for (size_t i = 0; i < rows; i++) {
+        const bool expected = ((price[i] >= 10.0 && flag[i]) || names[i % 4] == std::string("bb")) != (qty[i] != 7);
+        QCOMPARE((bool)result.booleans[i], expected);
+    }
+
+    auto pass = NeoAda::compile("return name;", state);
+    QVERIFY(NeoAda::evaluateBatch(pass, state, columns, rows, result));
+    QCOMPARE(result.type, NeoAda::Column::String);
+    QVERIFY(result.chars == chars);
+    QVERIFY(result.offsets == offsets);
+
+    // the columns were never bound to the state
+    Nda::Symbol *symbol = nullptr;
+    QVERIFY(!state.find("price", &symbol));
+
+    // same results as the interpreter, row by row
+    auto rowRule = NeoAda::compile("return name < \"b\" or price * rate > qty;", state);
+    QVERIFY(NeoAda::evaluateBatch(rowRule, state, columns, rows, result));
+    QVERIFY(state.define("price", "Number"));
+    QVERIFY(state.define("qty", "Natural"));
+    QVERIFY(state.define("name", "String"));
+    for (size_t i = 0; i < 100; i++) {
+        state.valueRef("price").fromNumber(state.numberType(), price[i]);
+        state.valueRef("qty").fromNatural(state.naturalType(), qty[i]);
+        state.valueRef("name").fromString(state.stringType(), names[i % 4]);
+        QCOMPARE(NeoAda::evaluate(rowRule, state).toBool(), (bool)result.booleans[i]);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void TstParser::test_api_evaluateBatch_Fallback()
+{
+    const size_t rows = 2000;
+    std::vector<double>  price(rows);
+    std::vector<int64_t> qty(rows);
+    for (size_t i = 0; i < rows; i++) {
+        price[i] = i * 0.25;
+        qty[i]   = 1 + i % 10;
+    }
+    const std::vector<NeoAda::Column> columns = {
+        NeoAda::Column("price", price.data()), NeoAda::Column("qty", qty.data())
+    };
+
+    NdaState state;
+    NeoAda::ResultColumn result;
+    NdaException e;
+    Nda::Symbol *symbol = nullptr;
+
+    // statements other than a single return take the row path
+    auto script = NeoAda::compile(R"(
+        declare t : Number := price * 2.0;
+        if qty > 5 then
+            return t;
+        end if;
+        return -t;
+    )", state);
+    QVERIFY(NeoAda::evaluateBatch(script, state, columns, rows, result, &e));
+    QCOMPARE(result.type, NeoAda::Column::Number);
+    QCOMPARE(result.size(), rows);
+    for (size_t i = 0; i < rows; i++)
+        QCOMPARE(result.numbers[i], qty[i] > 5 ? price[i] * 2.0 : -(price[i] * 2.0));
+    QVERIFY(state.find("price", &symbol));
+
+    // a row the loops can't handle: the interpreter reports the row
+    qty[1500] = 0;
+    auto quotient = NeoAda::compile("return 100 / qty;", state);
+    QVERIFY(!NeoAda::evaluateBatch(quotient, state, columns, rows, result, &e));
+    QCOMPARE(e.code(), Nada::Error::UnhandledException);
+    QVERIFY(std::string(e.what()).find("row 1500") != std::string::npos);
+    QCOMPARE(result.size(), (size_t)0);
+    qty[1500] = 1;
+    QVERIFY(NeoAda::evaluateBatch(quotient, state, columns, rows, result, &e));
+    QCOMPARE(result.naturals[1500], (int64_t)100);
+
+    // the zero inside a composite expression: no stale value for the row
+    const double n[] = { 8, 8, 8 }, x[] = { 2, 0, 4 }, y[] = { 1, 1, 1 };
+    const std::vector<NeoAda::Column> nested = {
+        NeoAda::Column("n", n), NeoAda::Column("x", x), NeoAda::Column("y", y)
+    };
+    auto composite = NeoAda::compile("return (y - (((n / x) + y) + y));", state);
+    QVERIFY(!NeoAda::evaluateBatch(composite, state, nested, 3, result, &e));
+    QCOMPARE(e.code(), Nada::Error::UnhandledException);
+    QVERIFY(std::string(e.what()).find("row 1") != std::string::npos);
+    QCOMPARE(result.size(), (size_t)0);
+
+    auto difference = NeoAda::compile("return qty - 9223372036854775807 - 3;", state);
+    QVERIFY(!NeoAda::evaluateBatch(difference, state, columns, rows, result, &e));
+    QCOMPARE(e.code(), Nada::Error::OperatorTypeError);
+    QCOMPARE(result.size(), (size_t)0);
+
+    // results of different types
+    auto mixed = NeoAda::compile("if qty > 5 then return 1; end if; return \"x\";", state);
+    QVERIFY(!NeoAda::evaluateBatch(mixed, state, columns, rows, result, &e));
+    QCOMPARE(e.code(), Nada::Error::AssignmentError);
+
+    // foreign states
+    NdaState other;
+    QVERIFY(!NeoAda::evaluateBatch(quotient, other, columns, rows, result, &e));
+    QCOMPARE(e.code(), Nada::Error::InvalidExpression);
+}
+
 //-------------------------------------------------------------------------------------------------
 void TstParser::test_api_evaluate_Literals()
 {
@@ -6632,12 +8743,16 @@ void TstParser::test_error_runtime_divisionByZero()
 
 extern int runAdaStringTests(int argc, char **argv);
 extern int runAdaDictTests(int argc, char **argv);
+extern int runAdaSetTests(int argc, char **argv);
+extern int runAdaDequeTests(int argc, char **argv);
+extern int runAdaPriorityQueueTests(int argc, char **argv);
 extern int runAdaMathTests(int argc, char **argv);
 extern int runAdaTextEncodingTests(int argc, char **argv);
 extern int runAdaIoFileTests(int argc, char **argv);
 extern int runAdaDateTimeTests(int argc, char **argv);
 extern int runAdaRegexpTests(int argc, char **argv);
 extern int runAdaJsonTests(int argc, char **argv);
+extern int runBenchmarkTests(int argc, char **argv);
 
 static bool hasRequestedTest(const QMetaObject *metaObject, int argc, char **argv)
 {
@@ -6669,12 +8784,16 @@ int main(int argc, char **argv)
 
     status |= runAdaStringTests(argc, argv);
     status |= runAdaDictTests(argc, argv);
+    status |= runAdaSetTests(argc, argv);
+    status |= runAdaDequeTests(argc, argv);
+    status |= runAdaPriorityQueueTests(argc, argv);
     status |= runAdaMathTests(argc, argv);
     status |= runAdaTextEncodingTests(argc, argv);
     status |= runAdaIoFileTests(argc, argv);
     status |= runAdaDateTimeTests(argc, argv);
     status |= runAdaRegexpTests(argc, argv);
     status |= runAdaJsonTests(argc, argv);
+    status |= runBenchmarkTests(argc, argv);
 
     std::cout << "********* Finished testing *********" << std::endl;
     std::cout << "Status: " << status << " " << (status == 0 ? "(OK)":"(ERROR)") << std::endl;
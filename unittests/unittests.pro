@@ -13,9 +13,13 @@ include(../libneoada/libneoada.pro)
 SOURCES +=  tst_parser.cpp \
             tst_AdaString.cpp \
             tst_AdaDict.cpp \
+            tst_AdaSet.cpp \
+            tst_AdaDeque.cpp \
+            tst_AdaPriorityQueue.cpp \
             tst_AdaMath.cpp \
             tst_AdaTextEncoding.cpp \
             tst_AdaIoFile.cpp \
             tst_AdaDateTime.cpp \
             tst_AdaRegexp.cpp \
-            tst_AdaJson.cpp
+            tst_AdaJson.cpp \
+            tst_Benchmarks.cpp